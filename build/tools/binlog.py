@@ -0,0 +1,102 @@
+#
+# binlog.py - Скрипт перевода двоичного лога (log_bin) в текст.
+#
+# Использование: python binlog.py [путь к .binlog] [путь к выходному файлу]
+# По умолчанию читает "data/last.binlog" и выводит текст в консоль.
+# Формат файла описан в "src/cgdf/core/logger.c".
+#
+
+
+# Импортируем:
+import re
+import sys
+import struct
+
+
+# Определения:
+MAGIC          = b"CGDFBLOG"
+VERSION        = 1
+RECORD_FORMAT  = 1
+RECORD_MSG     = 2
+ARG_INT        = 1
+ARG_UINT       = 2
+ARG_FLOAT      = 3
+ARG_STRING     = 4
+ARG_PTR        = 5
+
+# Спецификатор формата printf (модификаторы длины python не понимает, поэтому их выкидываем):
+SPEC_RE = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGaAcsp%])")
+
+
+# Перевести строку формата C и аргументы в текст:
+def format_c(fmt: str, args: list) -> str:
+    it = iter(args)
+    def repl(m: re.Match) -> str:
+        flags, conv = m.group(1), m.group(3)
+        if conv == "%": return "%"
+        value = next(it, None)
+        if value is None: return m.group(0)
+        if conv == "p": return hex(value)
+        if conv in "aA": return float(value).hex()
+        if conv == "c": return chr(value & 0xFF)
+        if conv in "iu": conv = "d"
+        if conv in "diouxX" and isinstance(value, float): value = int(value)
+        if conv in "eEfFgG" and not isinstance(value, float): value = float(value)
+        if conv == "s": value = str(value)
+        try: return ("%" + flags + conv) % value
+        except (TypeError, ValueError): return str(value)
+    return SPEC_RE.sub(repl, fmt)
+
+
+# Прочитать все записи двоичного лога и вернуть строки текста:
+def decode(data: bytes) -> list:
+    if data[:8] != MAGIC: raise ValueError("Not a CGDF binary log.")
+    version, base_ns, base_day_ms = struct.unpack_from("<IQQ", data, 8)
+    if version != VERSION: raise ValueError(f"Unsupported binary log version: {version}.")
+
+    formats = {}
+    lines = []
+    pos = 28
+    while pos < len(data):
+        kind = data[pos]
+        if kind == RECORD_FORMAT:
+            fid, length = struct.unpack_from("<IH", data, pos + 1)
+            formats[fid] = data[pos + 7:pos + 7 + length].decode("utf-8", "replace")
+            pos += 7 + length
+        elif kind == RECORD_MSG:
+            fid, time_ns, argc = struct.unpack_from("<IQB", data, pos + 1)
+            pos += 14
+            args = []
+            for _ in range(argc):
+                atype = data[pos]
+                pos += 1
+                if atype == ARG_STRING:
+                    (length,) = struct.unpack_from("<H", data, pos)
+                    args.append(data[pos + 2:pos + 2 + length].decode("utf-8", "replace"))
+                    pos += 2 + length
+                else:
+                    code = {ARG_INT: "<q", ARG_FLOAT: "<d"}.get(atype, "<Q")
+                    args.append(struct.unpack_from(code, data, pos)[0])
+                    pos += 8
+
+            # Время дня, как у текстового лога:
+            ms = (base_day_ms + (time_ns - base_ns) // 1000000) % 86400000
+            stamp = f"[{ms // 3600000:02d}:{ms // 60000 % 60:02d}:{ms // 1000 % 60:02d}.{ms % 1000:03d}]: "
+            text = format_c(formats.get(fid, f"<unknown format {fid}>\n"), args)
+            lines.append(stamp + text)
+        else: raise ValueError(f"Broken record at offset {pos}.")
+    return lines
+
+
+# Основная функция:
+def main() -> None:
+    in_path = sys.argv[1] if len(sys.argv) > 1 else "data/last.binlog"
+    with open(in_path, "rb") as f: lines = decode(f.read())
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "w", encoding="utf-8") as f: f.write("".join(lines))
+    else: sys.stdout.write("".join(lines))
+
+
+# Если этот скрипт запускают:
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,174 @@
+#
+# pack.py - Скрипт сборки пакета ассетов (.pack) из папки.
+#
+# Использование: python pack.py [-c] <папка> <выходной .pack>
+#   -c, --compress - сжимать файлы LZ блоком (lz.h), если это экономит хотя бы 1/8 размера.
+# Пути в пакете начинаются с имени папки: "data/textures/a.png" для папки "bin/data".
+# Формат пакета описан в "src/cgdf/core/vfs.c".
+#
+
+
+# Импортируем:
+import os
+import sys
+import struct
+
+
+# Определения:
+MAGIC       = b"CGDFPACK"
+VERSION     = 2
+ALIGN       = 4096
+HEADER_FMT  = "<8sIIII4Q"
+ENTRY_FMT   = "<QQQQIIII"
+COMPRESSED  = 1              # Флаг записи: данные сжаты LZ блоком.
+MIN_MATCH   = 4              # Минимальная длина совпадения LZ4.
+LAST_LITS   = 5              # Последние байты блока всегда литералы.
+MATCH_LIMIT = 12             # Совпадение не может начинаться ближе к концу блока.
+MAX_OFFSET  = 65535          # Максимальное смещение совпадения.
+
+
+# Хэш пути (FNV-1a 64, как VFS_hash_path):
+def hash_path(path: bytes) -> int:
+    h = 0xcbf29ce484222325
+    for b in path:
+        h ^= b
+        h = (h * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+# Выровнять значение вверх:
+def align(value: int, alignment: int) -> int:
+    return (value + alignment - 1) // alignment * alignment
+
+
+# Записать длину в формате LZ4 (продолжение байтами 255):
+def lz_length(out: bytearray, length: int) -> None:
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+# Сжать данные одним блоком LZ4 (совместим с LZ_decompress):
+def lz_compress(data: bytes) -> bytes:
+    n = len(data)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    pos = 0
+    limit = n - MATCH_LIMIT
+    while pos < limit:
+        key = data[pos:pos + MIN_MATCH]
+        ref = table.get(key, -1)
+        table[key] = pos
+        if ref < 0 or pos - ref > MAX_OFFSET:
+            pos += 1
+            continue
+
+        # Расширяем совпадение вперёд (не заходя в последние литералы):
+        end = pos + MIN_MATCH
+        max_end = n - LAST_LITS
+        while end < max_end and data[end] == data[ref + end - pos]: end += 1
+
+        literals = pos - anchor
+        match = end - pos - MIN_MATCH
+        out.append((min(literals, 15) << 4) | min(match, 15))
+        if literals >= 15: lz_length(out, literals - 15)
+        out += data[anchor:pos]
+        out += struct.pack("<H", pos - ref)
+        if match >= 15: lz_length(out, match - 15)
+        pos = anchor = end
+
+    # Хвост литералов:
+    literals = n - anchor
+    out.append(min(literals, 15) << 4)
+    if literals >= 15: lz_length(out, literals - 15)
+    out += data[anchor:]
+    return bytes(out)
+
+
+# Собрать список файлов папки (путь на диске, путь в пакете):
+def collect(root: str) -> list:
+    root = os.path.normpath(root)
+    base = os.path.dirname(root)
+    files = []
+    for dirpath, dirnames, filenames in os.walk(root):
+        dirnames.sort()
+        for name in sorted(filenames):
+            disk_path = os.path.join(dirpath, name)
+            pack_path = os.path.relpath(disk_path, base).replace(os.sep, "/")
+            files.append((disk_path, pack_path.encode("utf-8")))
+    return files
+
+
+# Прочитать файлы (данные в пакете, размер файла, флаги):
+def load_files(files: list, compress: bool) -> list:
+    blobs = []
+    for disk_path, _ in files:
+        with open(disk_path, "rb") as src: raw = src.read()
+        if compress and raw:
+            packed = lz_compress(raw)
+            if len(packed) <= len(raw) - len(raw) // 8:
+                blobs.append((packed, len(raw), COMPRESSED))
+                continue
+        blobs.append((raw, len(raw), 0))
+    return blobs
+
+
+# Записать пакет:
+def build_pack(files: list, out_path: str, compress: bool = False) -> None:
+    count = len(files)
+    blobs = load_files(files, compress)
+    table_size = 1
+    while table_size < count * 2 or table_size <= count: table_size *= 2  # Заполнение не больше половины.
+
+    # Раскладка: заголовок, записи, хэш-таблица, имена, данные (с выравниванием на ALIGN):
+    header_size = struct.calcsize(HEADER_FMT)
+    entries_offset = align(header_size, 8)
+    table_offset = entries_offset + count * struct.calcsize(ENTRY_FMT)
+    names_offset = table_offset + table_size * 4
+    names = b"".join(p for _, p in files)
+    data_offset = align(names_offset + len(names), ALIGN)
+
+    # Записи и хэш-таблица:
+    entries = []
+    table = [0] * table_size
+    name_pos = 0
+    offset = data_offset
+    for index, ((_, pack_path), (data, raw_size, flags)) in enumerate(zip(files, blobs)):
+        size = len(data)
+        h = hash_path(pack_path)
+        entries.append(struct.pack(ENTRY_FMT, h, offset, size, raw_size, name_pos, len(pack_path), flags, 0))
+        slot = h & (table_size - 1)
+        while table[slot]: slot = (slot + 1) & (table_size - 1)
+        table[slot] = index + 1
+        name_pos += len(pack_path)
+        offset = align(offset + size, ALIGN)
+
+    with open(out_path, "wb") as f:
+        f.write(struct.pack(HEADER_FMT, MAGIC, VERSION, count, table_size, 0,
+                            entries_offset, table_offset, names_offset, len(names)))
+        f.write(b"\0" * (entries_offset - header_size))
+        f.write(b"".join(entries))
+        f.write(struct.pack(f"<{table_size}I", *table))
+        f.write(names)
+        for data, _, _ in blobs:
+            f.write(b"\0" * (align(f.tell(), ALIGN) - f.tell()))
+            f.write(data)
+
+
+# Основная функция:
+def main() -> None:
+    args = [a for a in sys.argv[1:] if a not in ("-c", "--compress")]
+    compress = len(args) != len(sys.argv) - 1
+    if len(args) < 2:
+        print("Usage: python pack.py [-c] <directory> <output.pack>")
+        sys.exit(1)
+    files = collect(args[0])
+    build_pack(files, args[1], compress)
+    print(f"Packed {len(files)} files into \"{args[1]}\" ({os.path.getsize(args[1])} bytes).")
+
+
+# Если этот скрипт запускают:
+if __name__ == "__main__":
+    main()
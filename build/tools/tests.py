@@ -0,0 +1,113 @@
+#
+# tests.py - Скрипт сборки и запуска тестов и замеров из "src/tests/".
+#
+# Использование: python tests.py [--bench] [имена...]
+#   Без аргументов собирает и запускает все тесты (test_*.c), с --bench - все замеры (bench_*.c).
+#   Имена без ".c" выбирают конкретные программы: python tests.py test_texstream bench_resize
+#
+# Каждая программа - отдельный исполняемый файл из исходника теста и исходников ядра ("src/cgdf/core/").
+# Остальные нужные исходники тест перечисляет в строке "// Исходники: путь1 путь2" (пути от корня проекта).
+# Флаги компиляции берутся из "build/config.json". Программа провалена, если вернула не 0.
+#
+
+
+# Импортируем:
+import os
+import sys
+import glob
+import json
+import time
+import subprocess
+from concurrent.futures import ThreadPoolExecutor
+
+
+# Определения:
+ROOT_DIR    = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../"))
+TESTS_DIR   = "src/tests/"
+CORE_DIR    = "src/cgdf/core/"
+OUT_DIR     = "build/tests/"
+SOURCES_TAG = "// Исходники:"
+
+
+# Прочитать флаги компиляции из конфигурации:
+def get_flags(config: dict) -> list:
+    flags = [config["optimization"], f"-std={config['std-c']}"] + config["warnings"] + config["compile-flags-c"]
+    flags += [f"-D{d}" for d in config["defines"] if d]
+    flags += [f"-I{i}" for i in config["includes"]]
+    return flags
+
+
+# Получить дополнительные исходники теста:
+def get_extra_sources(path: str) -> list:
+    sources = []
+    with open(path, "r", encoding="utf-8") as f:
+        for line in f:
+            if line.startswith(SOURCES_TAG): sources += line[len(SOURCES_TAG):].split()
+    return sources
+
+
+# Скомпилировать исходник в объектный файл (если объектный файл старше исходника или его нет):
+def compile_object(compiler: str, flags: list, source: str) -> tuple:
+    obj = os.path.join(OUT_DIR, "obj", source.replace("/", "_").replace("\\", "_") + ".o")
+    if os.path.isfile(obj) and os.path.getmtime(obj) >= os.path.getmtime(source): return obj, ""
+    result = subprocess.run([compiler, *flags, "-c", source, "-o", obj], capture_output=True, text=True)
+    return (obj if result.returncode == 0 else None), result.stderr
+
+
+# Основная функция:
+def main() -> None:
+    os.chdir(ROOT_DIR)
+    with open("build/config.json", "r", encoding="utf-8") as f: config = json.load(f)
+    args = [a for a in sys.argv[1:] if not a.startswith("--")]
+    bench = "--bench" in sys.argv[1:]
+
+    # Выбираем программы:
+    if args: programs = [os.path.join(TESTS_DIR, f"{name}.c") for name in args]
+    else: programs = sorted(glob.glob(os.path.join(TESTS_DIR, "bench_*.c" if bench else "test_*.c")))
+    programs = [p.replace("\\", "/") for p in programs]
+    for path in programs:
+        if not os.path.isfile(path):
+            print(f"Test not found: {path}")
+            sys.exit(1)
+
+    # Компилируем исходники ядра один раз на все программы (заголовки не отслеживаются, при их
+    # изменении удалите "build/tests/obj/"):
+    os.makedirs(os.path.join(OUT_DIR, "obj"), exist_ok=True)
+    compiler, flags = config["compiler-c"], get_flags(config)
+    core = [p.replace("\\", "/") for p in glob.glob(os.path.join(CORE_DIR, "**/*.c"), recursive=True)]
+    extra = sorted({s for p in programs for s in get_extra_sources(p)})
+    with ThreadPoolExecutor(max_workers=os.cpu_count() or 1) as pool:
+        results = dict(zip(core + extra, pool.map(lambda s: compile_object(compiler, flags, s), core + extra)))
+    failed = [s for s, (obj, _) in results.items() if obj is None]
+    for source, (obj, errors) in results.items():
+        if errors: print(errors, end="")
+    if failed:
+        print(f"Failed to compile: {', '.join(failed)}")
+        sys.exit(1)
+    core_objects = [results[s][0] for s in core]
+
+    # Собираем и запускаем программы:
+    libs = [] if sys.platform == "win32" else ["-lm", "-lpthread"]
+    passed = 0
+    for path in programs:
+        name = os.path.splitext(os.path.basename(path))[0]
+        binary = os.path.join(OUT_DIR, f"{name}.exe" if sys.platform == "win32" else name)
+        objects = core_objects + [results[s][0] for s in get_extra_sources(path)]
+        link = subprocess.run([compiler, *flags, path, *objects, "-o", binary, *libs], capture_output=True, text=True)
+        if link.returncode != 0:
+            print(link.stderr, end="")
+            print(f"[FAIL] {name}: build failed.")
+            continue
+        print(f"{f' {name} ':-^60}")
+        start_time = time.time()
+        code = subprocess.run([os.path.normpath(binary)]).returncode
+        status = "OK" if code == 0 else f"FAIL ({code})"
+        print(f"[{status}] {name} ({round(time.time()-start_time, 3)}s)")
+        passed += code == 0
+    print(f"\nPassed: {passed}/{len(programs)}")
+    sys.exit(0 if passed == len(programs) else 1)
+
+
+# Если этот файл запускают:
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,306 @@
+//
+// assetcache.c - Реализация кэша подготовленных ассетов на диске.
+//
+// Запись кэша - файл "<папка>/<вид>-<ключ hex>.ck": заголовок (сигнатура, версия, ключ и размер данных)
+// и сами данные. Запись пишется во временный файл и переименовывается, поэтому недописанная запись
+// никогда не видна под своим именем, а несколько процессов или потоков могут писать один ключ
+// одновременно. Данные при чтении не хэшируются заново: это стоило бы больше, чем их копирование.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "logger.h"
+#include "counters.h"
+#include "files.h"
+#include "assetcache.h"
+#if defined(_WIN32)
+    #include <direct.h>
+    #include <process.h>
+    #include <windows.h>
+#else
+    #include <unistd.h>
+    #include <sys/stat.h>
+#endif
+
+
+// Заголовок записи кэша:
+typedef struct CookedHeader {
+    char magic[4];     // ASSETCACHE_MAGIC.
+    uint32_t version;  // ASSETCACHE_VERSION.
+    uint64_t key;      // Ключ ассета.
+    uint64_t size;     // Размер данных.
+} CookedHeader;
+
+
+// Состояние кэша:
+static struct {
+    bool enabled;           // Включён ли кэш.
+    char *dir;              // Папка кэша.
+    atomic_uint tmp_count;  // Счётчик имён временных файлов.
+} g_AssetCache;
+
+
+// Простые числа XXH64:
+#define XXH_P1 11400714785074694791ULL
+#define XXH_P2 14029467366897019727ULL
+#define XXH_P3 1609587929392839161ULL
+#define XXH_P4 9650029242287828579ULL
+#define XXH_P5 2870177450012600261ULL
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Циклический сдвиг влево:
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Прочитать 64 бита (little-endian, без требований к выравниванию):
+static inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Прочитать 32 бита (little-endian, без требований к выравниванию):
+static inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Раунд XXH64:
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_P2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_P1;
+}
+
+// Слить аккумулятор в хэш:
+static inline uint64_t xxh_merge(uint64_t hash, uint64_t acc) {
+    hash ^= xxh_round(0, acc);
+    return hash * XXH_P1 + XXH_P4;
+}
+
+// Создать папку со всеми родительскими папками:
+static bool make_dirs(const char *path) {
+    char buffer[1024];
+    size_t length = strlen(path);
+    if (length == 0 || length >= sizeof(buffer)) return false;
+    memcpy(buffer, path, length + 1);
+
+    for (size_t i = 1; i <= length; i++) {
+        if (buffer[i] != '/' && buffer[i] != '\\' && buffer[i] != '\0') continue;
+        char old = buffer[i];
+        buffer[i] = '\0';
+        #if defined(_WIN32)
+            int result = _mkdir(buffer);
+        #else
+            int result = mkdir(buffer, 0755);
+        #endif
+        if (result != 0 && errno != EEXIST) return false;
+        buffer[i] = old;
+    }
+    return true;
+}
+
+// Собрать путь к записи кэша:
+static void entry_path(const char *kind, uint64_t key, char *out, size_t size) {
+    snprintf(out, size, "%s/%s-%016llx.ck", g_AssetCache.dir, kind, (unsigned long long)key);
+}
+
+
+// -------- API кэша ассетов: --------
+
+
+// Включить кэш (dir - папка кэша, NULL - ASSETCACHE_DEFAULT_DIR). Папка создаётся при необходимости:
+bool AssetCache_init(const char *dir) {
+    if (!dir || !dir[0]) dir = ASSETCACHE_DEFAULT_DIR;
+    AssetCache_destroy();
+    if (!make_dirs(dir)) {
+        log_msg("[E] AssetCache_init: Cannot create cache directory \"%s\".\n", dir);
+        return false;
+    }
+    g_AssetCache.dir = mm_strdup(dir);
+    g_AssetCache.enabled = true;
+    return true;
+}
+
+
+// Выключить кэш:
+void AssetCache_destroy(void) {
+    if (!g_AssetCache.enabled) return;
+    g_AssetCache.enabled = false;
+    mm_free(g_AssetCache.dir);
+    g_AssetCache.dir = NULL;
+}
+
+
+// Включён ли кэш:
+bool AssetCache_is_enabled(void) {
+    return g_AssetCache.enabled;
+}
+
+
+// Получить папку кэша (NULL если кэш выключен):
+const char* AssetCache_get_dir(void) {
+    return g_AssetCache.enabled ? g_AssetCache.dir : NULL;
+}
+
+
+// Хэш данных (64 бита, совместим с XXH64):
+uint64_t AssetCache_hash(const void *data, size_t size, uint64_t seed) {
+    const unsigned char *p = (const unsigned char*)data;
+    const unsigned char *end = p + size;
+    uint64_t hash;
+
+    // Четыре независимых аккумулятора по 8 байт (32 байта за шаг):
+    if (size >= 32) {
+        uint64_t v1 = seed + XXH_P1 + XXH_P2;
+        uint64_t v2 = seed + XXH_P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_P1;
+        const unsigned char *limit = end - 32;
+        do {
+            v1 = xxh_round(v1, read64(p));
+            v2 = xxh_round(v2, read64(p + 8));
+            v3 = xxh_round(v3, read64(p + 16));
+            v4 = xxh_round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        hash = xxh_merge(hash, v1);
+        hash = xxh_merge(hash, v2);
+        hash = xxh_merge(hash, v3);
+        hash = xxh_merge(hash, v4);
+    } else hash = seed + XXH_P5;
+    hash += (uint64_t)size;
+
+    // Хвост:
+    for (; p + 8 <= end; p += 8) {
+        hash ^= xxh_round(0, read64(p));
+        hash = rotl64(hash, 27) * XXH_P1 + XXH_P4;
+    }
+    if (p + 4 <= end) {
+        hash ^= (uint64_t)read32(p) * XXH_P1;
+        hash = rotl64(hash, 23) * XXH_P2 + XXH_P3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= (uint64_t)(*p) * XXH_P5;
+        hash = rotl64(hash, 11) * XXH_P1;
+    }
+
+    // Перемешиваем биты:
+    hash ^= hash >> 33;
+    hash *= XXH_P2;
+    hash ^= hash >> 29;
+    hash *= XXH_P3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+
+// Ключ ассета: вид ассета, исходные байты и настройки импорта (settings может быть NULL):
+uint64_t AssetCache_key(const char *kind, const void *source, size_t source_size, const void *settings, size_t settings_size) {
+    uint64_t key = AssetCache_hash(kind, strlen(kind), ASSETCACHE_VERSION);
+    key = AssetCache_hash(source, source_size, key);
+    if (settings && settings_size > 0) key = AssetCache_hash(settings, settings_size, key);
+    return key;
+}
+
+
+// Найти подготовленные данные в кэше. После использования нужно вызвать AssetCache_release:
+bool AssetCache_load(const char *kind, uint64_t key, CookedAsset *out_asset) {
+    if (!out_asset) return false;
+    *out_asset = (CookedAsset){ 0 };
+    if (!g_AssetCache.enabled || !kind) return false;
+
+    char path[1024];
+    entry_path(kind, key, path, sizeof(path));
+    FileMap file = Files_map(path, FILE_MAP_SEQUENTIAL);
+    if (!file.data) {
+        COUNTER_INC("assetcache.misses");
+        return false;
+    }
+
+    // Проверяем заголовок (чужой файл, старая версия формата, обрезанный файл):
+    CookedHeader header;
+    bool valid = file.size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, file.data, sizeof(header));
+        valid = memcmp(header.magic, ASSETCACHE_MAGIC, 4) == 0 && header.version == ASSETCACHE_VERSION &&
+                header.key == key && header.size == file.size - sizeof(header);
+    }
+    if (!valid) {
+        log_msg("[W] AssetCache_load: Broken cache entry \"%s\", ignoring it.\n", path);
+        Files_unmap(&file);
+        COUNTER_INC("assetcache.misses");
+        return false;
+    }
+
+    out_asset->file = file;
+    out_asset->data = file.data + sizeof(header);
+    out_asset->size = (size_t)header.size;
+    COUNTER_INC("assetcache.hits");
+    COUNTER_ADD("assetcache.bytes_mapped", out_asset->size);
+    return true;
+}
+
+
+// Освободить отображение записи кэша:
+void AssetCache_release(CookedAsset *asset) {
+    if (!asset) return;
+    Files_unmap(&asset->file);
+    *asset = (CookedAsset){ 0 };
+}
+
+
+// Сохранить подготовленные данные в кэш (куски подряд). Запись атомарная - читатели видят либо старую, либо новую:
+bool AssetCache_store(const char *kind, uint64_t key, const CookedPart *parts, size_t count) {
+    if (!g_AssetCache.enabled || !kind || (!parts && count > 0)) return false;
+
+    // Собираем запись в один буфер (данные сразу за заголовком):
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) size += parts[i].size;
+    unsigned char *buffer = (unsigned char*)mm_alloc(sizeof(CookedHeader) + size);
+    unsigned char *cursor = buffer + sizeof(CookedHeader);
+    for (size_t i = 0; i < count; i++) {
+        if (parts[i].size > 0) memcpy(cursor, parts[i].data, parts[i].size);
+        cursor += parts[i].size;
+    }
+    CookedHeader header = {
+        .version = ASSETCACHE_VERSION,
+        .key = key,
+        .size = (uint64_t)size,
+    };
+    memcpy(header.magic, ASSETCACHE_MAGIC, 4);
+    memcpy(buffer, &header, sizeof(header));
+
+    // Пишем во временный файл и подменяем запись переименованием:
+    char path[1024], tmp_path[1100];
+    entry_path(kind, key, path, sizeof(path));
+    #if defined(_WIN32)
+        int pid = _getpid();
+    #else
+        int pid = (int)getpid();
+    #endif
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d.%u.tmp", path, pid, atomic_fetch_add(&g_AssetCache.tmp_count, 1));
+    bool ok = Files_save_bin(tmp_path, buffer, sizeof(CookedHeader) + size, "wb");
+    mm_free(buffer);
+    #if defined(_WIN32)
+        ok = ok && MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING);
+    #else
+        ok = ok && rename(tmp_path, path) == 0;
+    #endif
+    if (!ok) {
+        remove(tmp_path);
+        log_msg("[W] AssetCache_store: Cannot write cache entry \"%s\".\n", path);
+        return false;
+    }
+    COUNTER_INC("assetcache.stores");
+    return true;
+}
@@ -0,0 +1,78 @@
+//
+// assetcache.h - Кэш подготовленных ассетов на диске.
+//
+// Импорт ассета (декодирование PNG, разбор OBJ, растеризация глифов) дорогой, а его результат зависит
+// только от байтов исходного файла и настроек импорта. Кэш хранит готовые к загрузке в видеокарту данные
+// (пиксели, буферы вершин и индексов, глифы) в папке кэша, по файлу на ключ. Ключ - хэш исходных байтов,
+// настроек импорта, вида ассета и ASSETCACHE_VERSION, поэтому изменённый файл или другие настройки просто
+// дают другой ключ и кэш не нужно сбрасывать вручную. Запись кэша отображается в память (Files_map),
+// записи с чужим заголовком или размером игнорируются.
+//
+// Кэш выключен пока не вызван AssetCache_init. Загрузчики (Pixmap_load, ObjLoader_load, FontPixmap)
+// сами ищут подготовленные данные в кэше и сохраняют их туда после импорта.
+// Старые записи не удаляются сами - папку кэша можно удалить целиком в любой момент.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+#include "files.h"
+
+
+// Определения:
+#define ASSETCACHE_DEFAULT_DIR "cache"  // Папка кэша по умолчанию.
+#define ASSETCACHE_VERSION     1        // Версия формата (меняется - меняются все ключи).
+#define ASSETCACHE_MAGIC       "CGCK"   // Сигнатура записи кэша.
+
+
+// Объявление структур:
+typedef struct CookedAsset CookedAsset;  // Запись кэша, отображённая в память.
+typedef struct CookedPart CookedPart;    // Кусок данных для записи в кэш.
+
+
+// Запись кэша, отображённая в память:
+struct CookedAsset {
+    FileMap file;               // Отображение файла записи.
+    const unsigned char *data;  // Подготовленные данные (внутри file, только чтение).
+    size_t size;                // Размер данных.
+};
+
+
+// Кусок данных для записи в кэш (куски записываются подряд, без выравнивания):
+struct CookedPart {
+    const void *data;  // Данные.
+    size_t size;       // Размер данных.
+};
+
+
+// -------- API кэша ассетов: --------
+
+
+// Включить кэш (dir - папка кэша, NULL - ASSETCACHE_DEFAULT_DIR). Папка создаётся при необходимости:
+bool AssetCache_init(const char *dir);
+
+// Выключить кэш:
+void AssetCache_destroy(void);
+
+// Включён ли кэш:
+bool AssetCache_is_enabled(void);
+
+// Получить папку кэша (NULL если кэш выключен):
+const char* AssetCache_get_dir(void);
+
+// Хэш данных (64 бита, совместим с XXH64):
+uint64_t AssetCache_hash(const void *data, size_t size, uint64_t seed);
+
+// Ключ ассета: вид ассета, исходные байты и настройки импорта (settings может быть NULL):
+uint64_t AssetCache_key(const char *kind, const void *source, size_t source_size, const void *settings, size_t settings_size);
+
+// Найти подготовленные данные в кэше. После использования нужно вызвать AssetCache_release:
+bool AssetCache_load(const char *kind, uint64_t key, CookedAsset *out_asset);
+
+// Освободить отображение записи кэша:
+void AssetCache_release(CookedAsset *asset);
+
+// Сохранить подготовленные данные в кэш (куски подряд). Запись атомарная - читатели видят либо старую, либо новую:
+bool AssetCache_store(const char *kind, uint64_t key, const CookedPart *parts, size_t count);
@@ -0,0 +1,718 @@
+//
+// asyncio.c - Реализация асинхронного чтения файлов.
+//
+// Путь запроса: AsyncIO_read* занимает слот в таблице запросов и кладёт запрос в очередь отправки ->
+// поток ввода-вывода (или поток пула) копирует файл из пакета или открывает файл и читает его ->
+// finish_request ставит итог и доставляет завершение в очередь главного потока или задачей JobSystem ->
+// deliver вызывает обратный вызов, освобождает слот (поколение растёт) и сам запрос.
+//
+// io_uring используется напрямую через системные вызовы (без liburing): поток ввода-вывода забирает
+// из очереди сразу до ASYNCIO_URING_ENTRIES запросов, открывает файлы, заполняет SQE на чтение и
+// отправляет всю пачку одним io_uring_enter. Недочитанные запросы (короткое чтение) отправляются снова.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "libs.h"
+#include "logger.h"
+#include "jobsystem.h"
+#include "counters.h"
+#include "vfs.h"
+#include "asyncio.h"
+
+#if defined(__linux__) && !defined(CGDF_ASYNCIO_NO_URING) && __has_include(<linux/io_uring.h>)
+    #define ASYNCIO_HAS_URING 1
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <errno.h>
+#else
+    #define ASYNCIO_HAS_URING 0
+#endif
+
+// Перемещение по файлу с 64-битными смещениями (long в Windows 32-битный даже в 64-битной сборке):
+#if defined(_WIN32) || defined(_WIN64)
+    #define ASYNCIO_FSEEK(f, offset, whence) _fseeki64((f), (__int64)(offset), (whence))
+    #define ASYNCIO_FTELL(f) ((int64_t)_ftelli64(f))
+#else
+    #define ASYNCIO_FSEEK(f, offset, whence) fseeko((f), (off_t)(offset), (whence))
+    #define ASYNCIO_FTELL(f) ((int64_t)ftello(f))
+#endif
+
+
+// Запрос на чтение:
+struct AsyncIORequest {
+    AsyncIORequest *next;      // Следующий запрос в очереди.
+    AsyncIOHandle handle;      // Дескриптор запроса (слот в таблице).
+    char *path;                // Путь к файлу (копия).
+    unsigned char *buffer;     // Куда читаем.
+    size_t offset;             // Смещение в файле.
+    size_t size;               // Сколько читаем (для целого файла узнаём при открытии).
+    size_t done;               // Сколько уже прочитано.
+    bool whole_file;           // Читаем файл целиком (буфер наш).
+    int fd;                    // Открытый файл (для io_uring).
+    atomic_bool canceled;      // Запрос отменён.
+    AsyncIOStatus status;      // Итог запроса.
+    AsyncIOCallback callback;  // Обратный вызов.
+    void *user;                // Пользовательские данные.
+    AsyncIODelivery delivery;  // Куда доставлять завершение.
+};
+
+
+// Слот таблицы запросов:
+typedef struct AsyncIOSlot {
+    AsyncIORequest *request;  // Запрос (NULL - слот свободен).
+    uint32_t generation;      // Поколение слота.
+    uint32_t next_free;       // Следующий свободный слот (UINT32_MAX - нет).
+} AsyncIOSlot;
+
+
+// Очередь запросов (односвязный список):
+typedef struct AsyncIOQueue {
+    AsyncIORequest *head;
+    AsyncIORequest *tail;
+} AsyncIOQueue;
+
+
+// Кольца io_uring:
+#if ASYNCIO_HAS_URING
+typedef struct AsyncIORing {
+    int fd;                      // Дескриптор io_uring.
+    void *sq_ptr, *cq_ptr;       // Отображённые кольца.
+    size_t sq_size, cq_size;     // Их размеры.
+    struct io_uring_sqe *sqes;   // Массив SQE.
+    size_t sqes_size;            // Его размер.
+    atomic_uint *sq_tail;        // Хвост очереди отправки.
+    unsigned *sq_mask;           // Маска очереди отправки.
+    unsigned *sq_array;          // Индексы SQE.
+    atomic_uint *cq_head;        // Голова очереди завершений.
+    atomic_uint *cq_tail;        // Хвост очереди завершений.
+    unsigned *cq_mask;           // Маска очереди завершений.
+    struct io_uring_cqe *cqes;   // Массив CQE.
+} AsyncIORing;
+#endif
+
+
+// Состояние сервиса:
+typedef struct AsyncIOState {
+    bool initialized;          // Запущен ли сервис.
+    bool running;              // Потоки должны продолжать работу.
+    bool uring;                // Используется io_uring.
+    mtx_t mutex;               // Защищает очереди и счётчик.
+    cnd_t submit_cond;         // Появились запросы на отправку.
+    cnd_t idle_cond;           // Появились завершения или всё выполнено.
+    AsyncIOQueue submit;       // Очередь отправки.
+    AsyncIOQueue completed;    // Завершения для главного потока.
+    size_t pending;            // Незавершённые (не доставленные) запросы.
+    AsyncIOSlot *slots;        // Таблица запросов (по дескрипторам).
+    uint32_t slots_count;      // Сколько слотов создано.
+    uint32_t slots_capacity;   // Под сколько слотов выделена память.
+    uint32_t free_slot;        // Первый свободный слот (UINT32_MAX - нет).
+    thrd_t threads[ASYNCIO_FALLBACK_THREADS];  // Поток ввода-вывода или потоки пула.
+    size_t thread_count;       // Сколько потоков запущено.
+    #if ASYNCIO_HAS_URING
+        AsyncIORing ring;      // Кольца io_uring.
+    #endif
+} AsyncIOState;
+
+
+// Состояние сервиса:
+static AsyncIOState g_AsyncIO;
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Добавить запрос в конец очереди:
+static void queue_push(AsyncIOQueue *queue, AsyncIORequest *request) {
+    request->next = NULL;
+    if (queue->tail) queue->tail->next = request;
+    else queue->head = request;
+    queue->tail = request;
+}
+
+// Забрать запрос из начала очереди:
+static AsyncIORequest* queue_pop(AsyncIOQueue *queue) {
+    AsyncIORequest *request = queue->head;
+    if (!request) return NULL;
+    queue->head = request->next;
+    if (!queue->head) queue->tail = NULL;
+    request->next = NULL;
+    return request;
+}
+
+// Занять слот таблицы под запрос (под мьютексом):
+static AsyncIOHandle slot_acquire(AsyncIORequest *request) {
+    uint32_t index = g_AsyncIO.free_slot;
+    if (index != UINT32_MAX) {
+        g_AsyncIO.free_slot = g_AsyncIO.slots[index].next_free;
+    } else {
+        if (g_AsyncIO.slots_count == g_AsyncIO.slots_capacity) {
+            g_AsyncIO.slots_capacity = g_AsyncIO.slots_capacity ? g_AsyncIO.slots_capacity * 2 : 64;
+            g_AsyncIO.slots = (AsyncIOSlot*)mm_realloc(g_AsyncIO.slots, sizeof(AsyncIOSlot) * g_AsyncIO.slots_capacity);
+        }
+        index = g_AsyncIO.slots_count++;
+        g_AsyncIO.slots[index].generation = 1;
+    }
+    g_AsyncIO.slots[index].request = request;
+    g_AsyncIO.slots[index].next_free = UINT32_MAX;
+    return (AsyncIOHandle){ index, g_AsyncIO.slots[index].generation };
+}
+
+// Освободить слот таблицы (под мьютексом). Поколение растёт, старый дескриптор перестаёт действовать:
+static void slot_release(AsyncIOHandle handle) {
+    AsyncIOSlot *slot = &g_AsyncIO.slots[handle.index];
+    slot->request = NULL;
+    slot->generation++;
+    slot->next_free = g_AsyncIO.free_slot;
+    g_AsyncIO.free_slot = handle.index;
+}
+
+// Найти запрос по дескриптору (под мьютексом). NULL - запрос уже доставлен:
+static AsyncIORequest* slot_find(AsyncIOHandle handle) {
+    if (handle.index >= g_AsyncIO.slots_count) return NULL;
+    AsyncIOSlot *slot = &g_AsyncIO.slots[handle.index];
+    return slot->generation == handle.generation ? slot->request : NULL;
+}
+
+// Вызвать обратный вызов и освободить запрос:
+static void deliver(AsyncIORequest *request) {
+    AsyncIOResult result = {
+        .handle = request->handle,
+        .status = request->status,
+        .path = request->path,
+        .data = request->buffer,
+        .size = request->done,
+        .user = request->user,
+    };
+    if (request->callback) request->callback(&result);
+    else if (request->whole_file) mm_free(request->buffer);  // Результат никому не нужен.
+
+    // Сначала освобождаем слот (после этого AsyncIO_cancel запрос не найдёт), потом сам запрос:
+    mtx_lock(&g_AsyncIO.mutex);
+    slot_release(request->handle);
+    g_AsyncIO.pending--;
+    if (g_AsyncIO.pending == 0) cnd_broadcast(&g_AsyncIO.idle_cond);
+    mtx_unlock(&g_AsyncIO.mutex);
+
+    mm_free(request->path);
+    mm_free(request);
+}
+
+// Задача JobSystem для доставки завершения:
+static int deliver_job(void *args) {
+    deliver((AsyncIORequest*)args);
+    return 0;
+}
+
+// Закончить запрос и отправить завершение получателю:
+static void finish_request(AsyncIORequest *request, AsyncIOStatus status) {
+    #if ASYNCIO_HAS_URING
+        if (request->fd >= 0) close(request->fd);
+        request->fd = -1;
+    #endif
+    if (status == ASYNCIO_DONE && atomic_load(&request->canceled)) status = ASYNCIO_CANCELED;
+    request->status = status;
+
+    // Буфер целого файла при ошибке не нужен. Иначе дописываем '\0' (удобно для текстовых файлов):
+    if (request->whole_file) {
+        if (status != ASYNCIO_DONE) {
+            mm_free(request->buffer);
+            request->buffer = NULL;
+            request->done = 0;
+        } else request->buffer[request->done] = '\0';
+    }
+    if (status == ASYNCIO_DONE) COUNTER_ADD("io.bytes_read", request->done);
+
+    if (request->delivery == ASYNCIO_DELIVER_JOB) {
+        if (g_JobSystem.initialized) JobSystem_create_job(deliver_job, request);
+        else deliver(request);
+        return;
+    }
+    mtx_lock(&g_AsyncIO.mutex);
+    queue_push(&g_AsyncIO.completed, request);
+    cnd_broadcast(&g_AsyncIO.idle_cond);
+    mtx_unlock(&g_AsyncIO.mutex);
+}
+
+// Прочитать запрос из смонтированного пакета (копия или распаковка из памяти):
+static void read_packed(AsyncIORequest *request, const VFSFile *packed) {
+    bool ok = true;
+    if (request->whole_file) {
+        request->size = packed->raw_size;
+        request->buffer = (unsigned char*)mm_alloc(packed->raw_size + 1);
+        ok = VFS_read(packed, request->buffer);
+        request->done = ok ? packed->raw_size : 0;
+    } else {
+        size_t available = request->offset < packed->raw_size ? packed->raw_size - request->offset : 0;
+        request->done = request->size < available ? request->size : available;
+        if (!packed->compressed) {
+            memcpy(request->buffer, packed->data + request->offset, request->done);
+        } else if (request->done > 0) {
+            // Сжатый блок распаковывается только целиком:
+            unsigned char *raw = (unsigned char*)mm_alloc(packed->raw_size);
+            ok = VFS_read(packed, raw);
+            if (ok) memcpy(request->buffer, raw + request->offset, request->done);
+            mm_free(raw);
+        }
+    }
+    finish_request(request, ok ? ASYNCIO_DONE : ASYNCIO_FAILED);
+}
+
+// Прочитать запрос (или его остаток после done) в текущем потоке (пул потоков и запасной путь io_uring):
+static void read_sync(AsyncIORequest *request) {
+    if (atomic_load(&request->canceled)) { finish_request(request, ASYNCIO_CANCELED); return; }
+    VFSFile packed;
+    if (VFS_find(request->path, &packed)) { read_packed(request, &packed); return; }
+
+    FILE *f = fopen(request->path, "rb");
+    if (!f) { finish_request(request, ASYNCIO_FAILED); return; }
+
+    // Узнаём размер для целого файла (если io_uring уже выделил буфер, дочитываем в него):
+    if (request->whole_file && !request->buffer) {
+        int64_t size = ASYNCIO_FSEEK(f, 0, SEEK_END) == 0 ? ASYNCIO_FTELL(f) : -1;
+        if (size < 0) { fclose(f); finish_request(request, ASYNCIO_FAILED); return; }
+        request->size = (size_t)size;
+        request->buffer = (unsigned char*)mm_alloc(request->size + 1);
+    }
+
+    // Читаем с нужного смещения:
+    if (ASYNCIO_FSEEK(f, request->offset + request->done, SEEK_SET) != 0) {
+        fclose(f);
+        finish_request(request, ASYNCIO_FAILED);
+        return;
+    }
+    request->done += fread(request->buffer + request->done, 1, request->size - request->done, f);
+    bool failed = ferror(f) != 0;
+    fclose(f);
+    finish_request(request, failed ? ASYNCIO_FAILED : ASYNCIO_DONE);
+}
+
+// Поток пула (когда io_uring недоступен):
+static int pool_thread(void *args) {
+    (void)args;
+    while (true) {
+        mtx_lock(&g_AsyncIO.mutex);
+        while (g_AsyncIO.running && !g_AsyncIO.submit.head) cnd_wait(&g_AsyncIO.submit_cond, &g_AsyncIO.mutex);
+        AsyncIORequest *request = queue_pop(&g_AsyncIO.submit);
+        if (g_AsyncIO.submit.head) cnd_signal(&g_AsyncIO.submit_cond);  // Передаём работу следующему потоку.
+        mtx_unlock(&g_AsyncIO.mutex);
+        if (!request) break;  // Сервис остановлен и очередь пуста.
+        read_sync(request);
+    }
+    return 0;
+}
+
+
+// -------- io_uring: --------
+
+
+#if ASYNCIO_HAS_URING
+
+// Создать кольца io_uring:
+static bool ring_init(AsyncIORing *ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) return false;
+
+    // Отображаем кольца (в новых ядрах обе очереди в одном отображении):
+    ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) ring->sq_size = ring->cq_size = ring->sq_size > ring->cq_size ? ring->sq_size : ring->cq_size;
+
+    ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) { close(ring->fd); return false; }
+    ring->cq_ptr = single ? ring->sq_ptr : mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+                                                MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    if (ring->cq_ptr == MAP_FAILED) {
+        munmap(ring->sq_ptr, ring->sq_size);
+        close(ring->fd);
+        return false;
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (!single) munmap(ring->cq_ptr, ring->cq_size);
+        munmap(ring->sq_ptr, ring->sq_size);
+        close(ring->fd);
+        return false;
+    }
+
+    // Указатели на поля колец:
+    unsigned char *sq = (unsigned char*)ring->sq_ptr;
+    unsigned char *cq = (unsigned char*)ring->cq_ptr;
+    ring->sq_tail  = (atomic_uint*)(sq + params.sq_off.tail);
+    ring->sq_mask  = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head  = (atomic_uint*)(cq + params.cq_off.head);
+    ring->cq_tail  = (atomic_uint*)(cq + params.cq_off.tail);
+    ring->cq_mask  = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes     = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return true;
+}
+
+// Уничтожить кольца io_uring:
+static void ring_destroy(AsyncIORing *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ptr != ring->sq_ptr) munmap(ring->cq_ptr, ring->cq_size);
+    munmap(ring->sq_ptr, ring->sq_size);
+    close(ring->fd);
+}
+
+// Положить в очередь отправки чтение оставшейся части запроса:
+static void ring_push_read(AsyncIORing *ring, AsyncIORequest *request) {
+    unsigned tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed);
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = request->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(request->buffer + request->done);
+    sqe->len = (uint32_t)(request->size - request->done);
+    sqe->off = (uint64_t)(request->offset + request->done);
+    sqe->user_data = (uint64_t)(uintptr_t)request;
+    ring->sq_array[index] = index;
+    atomic_store_explicit(ring->sq_tail, tail + 1, memory_order_release);
+}
+
+// Открыть файл запроса и подготовить буфер. Возвращает false, если запрос уже закончен:
+static bool ring_open_request(AsyncIORequest *request) {
+    if (atomic_load(&request->canceled)) { finish_request(request, ASYNCIO_CANCELED); return false; }
+    VFSFile packed;
+    if (VFS_find(request->path, &packed)) { read_packed(request, &packed); return false; }
+    request->fd = open(request->path, O_RDONLY | O_CLOEXEC);
+    if (request->fd < 0) { finish_request(request, ASYNCIO_FAILED); return false; }
+    if (request->whole_file) {
+        struct stat st;
+        if (fstat(request->fd, &st) != 0) { finish_request(request, ASYNCIO_FAILED); return false; }
+        request->size = (size_t)st.st_size;
+        request->buffer = (unsigned char*)mm_alloc(request->size + 1);
+    }
+    if (request->size == 0) { finish_request(request, ASYNCIO_DONE); return false; }
+    return true;
+}
+
+// Разобрать готовые завершения. resubmit - повторы и дочитывание отправлять в кольцо и считать в to_submit
+// (иначе дочитываем обычным способом, to_submit не нужен):
+static void ring_reap(AsyncIORing *ring, unsigned *in_flight, unsigned *to_submit, bool resubmit) {
+    unsigned head = atomic_load_explicit(ring->cq_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(ring->cq_tail, memory_order_acquire);
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        AsyncIORequest *req = (AsyncIORequest*)(uintptr_t)cqe->user_data;
+        int res = cqe->res;
+        (*in_flight)--;
+
+        if (res == -EINTR || res == -EAGAIN) {
+            // Повторяем:
+            if (resubmit) {
+                ring_push_read(ring, req);
+                (*to_submit)++;
+            } else read_sync(req);
+        } else if (res == -EINVAL || res == -EOPNOTSUPP) {
+            read_sync(req);  // Ядро без IORING_OP_READ: дочитываем обычным способом в тот же буфер.
+        } else if (res < 0) {
+            finish_request(req, ASYNCIO_FAILED);
+        } else {
+            req->done += (size_t)res;
+            if (res > 0 && req->done < req->size && !atomic_load(&req->canceled)) {
+                // Короткое чтение - дочитываем остаток:
+                if (resubmit) {
+                    ring_push_read(ring, req);
+                    (*to_submit)++;
+                } else read_sync(req);
+            } else finish_request(req, ASYNCIO_DONE);  // Прочитали всё или дошли до конца файла.
+        }
+    }
+    atomic_store_explicit(ring->cq_head, head, memory_order_release);
+}
+
+// Отключить io_uring после постоянной ошибки: неотправленные чтения дочитать обычным способом, дождаться
+// отправленных, закрыть кольцо и запустить пул потоков (этот поток тоже становится потоком пула):
+static void ring_disable(AsyncIORing *ring, unsigned in_flight, unsigned to_submit) {
+    // Неотправленные SQE - последние to_submit в очереди отправки. Забираем их обратно:
+    unsigned tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed);
+    atomic_store_explicit(ring->sq_tail, tail - to_submit, memory_order_release);
+    for (unsigned i = to_submit; i > 0; i--) {
+        AsyncIORequest *req = (AsyncIORequest*)(uintptr_t)ring->sqes[(tail - i) & *ring->sq_mask].user_data;
+        read_sync(req);
+    }
+
+    // Отправленные чтения ядро закончит само, забираем их завершения:
+    while (in_flight > 0) {
+        ring_reap(ring, &in_flight, NULL, false);
+        if (in_flight > 0) thrd_yield();
+    }
+    ring_destroy(ring);
+
+    mtx_lock(&g_AsyncIO.mutex);
+    g_AsyncIO.uring = false;
+    while (g_AsyncIO.running && g_AsyncIO.thread_count < ASYNCIO_FALLBACK_THREADS) {
+        if (thrd_create(&g_AsyncIO.threads[g_AsyncIO.thread_count], pool_thread, NULL) != thrd_success) break;
+        g_AsyncIO.thread_count++;
+    }
+    mtx_unlock(&g_AsyncIO.mutex);
+}
+
+// Поток ввода-вывода на io_uring:
+static int ring_thread(void *args) {
+    (void)args;
+    AsyncIORing *ring = &g_AsyncIO.ring;
+    unsigned in_flight = 0;  // Отправлено и ещё не завершено.
+    unsigned to_submit = 0;  // Подготовлено, но ещё не отправлено ядру.
+
+    while (true) {
+        // Забираем пачку новых запросов (ждём только если ничего не летит):
+        AsyncIOQueue batch = { 0 };
+        mtx_lock(&g_AsyncIO.mutex);
+        while (g_AsyncIO.running && !g_AsyncIO.submit.head && in_flight + to_submit == 0) {
+            cnd_wait(&g_AsyncIO.submit_cond, &g_AsyncIO.mutex);
+        }
+        if (!g_AsyncIO.running && !g_AsyncIO.submit.head && in_flight + to_submit == 0) {
+            mtx_unlock(&g_AsyncIO.mutex);
+            break;
+        }
+        while (in_flight + to_submit < ASYNCIO_URING_ENTRIES && g_AsyncIO.submit.head) {
+            queue_push(&batch, queue_pop(&g_AsyncIO.submit));
+            to_submit++;
+        }
+        mtx_unlock(&g_AsyncIO.mutex);
+
+        // Открываем файлы и заполняем SQE:
+        AsyncIORequest *request;
+        while ((request = queue_pop(&batch))) {
+            if (ring_open_request(request)) ring_push_read(ring, request);
+            else to_submit--;
+        }
+
+        // Отправляем пачку и ждём хотя бы одно завершение, если новых запросов нет:
+        unsigned wait = (to_submit == 0 && in_flight > 0) ? 1 : 0;
+        if (to_submit + wait == 0) continue;
+        int ret = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, wait, wait ? IORING_ENTER_GETEVENTS : 0,
+                               NULL, 0);
+        if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            // Постоянная ошибка (повтор дал бы ту же ошибку в цикле). Дальше работаем без io_uring:
+            log_msg("[E] AsyncIO: io_uring_enter failed (errno %d), switching to the thread pool.\n", errno);
+            ring_disable(ring, in_flight, to_submit);
+            return pool_thread(NULL);
+        }
+        if (ret > 0) {
+            in_flight += (unsigned)ret;
+            to_submit -= (unsigned)ret;
+        }
+
+        // Разбираем завершения:
+        ring_reap(ring, &in_flight, &to_submit, true);
+    }
+    return 0;
+}
+
+#endif  // ASYNCIO_HAS_URING
+
+
+// Создать запрос и поставить его в очередь (завершение всегда приходит позже, не внутри этого вызова):
+static AsyncIOHandle submit_request(
+    const char *file_path, void *buffer, size_t offset, size_t size, bool whole_file,
+    AsyncIOCallback callback, void *user, AsyncIODelivery delivery
+) {
+    if (!g_AsyncIO.initialized) AsyncIO_init();
+
+    AsyncIORequest *request = (AsyncIORequest*)mm_alloc(sizeof(AsyncIORequest));
+    request->next = NULL;
+    request->path = mm_strdup(file_path);
+    request->buffer = (unsigned char*)buffer;
+    request->offset = offset;
+    request->size = size;
+    request->done = 0;
+    request->whole_file = whole_file;
+    request->fd = -1;
+    atomic_init(&request->canceled, false);
+    request->status = ASYNCIO_PENDING;
+    request->callback = callback;
+    request->user = user;
+    request->delivery = delivery;
+
+    // Будим поток только если очередь была пуста (иначе он и так её разбирает):
+    mtx_lock(&g_AsyncIO.mutex);
+    bool was_empty = g_AsyncIO.submit.head == NULL;
+    AsyncIOHandle handle = slot_acquire(request);
+    request->handle = handle;
+    g_AsyncIO.pending++;
+    queue_push(&g_AsyncIO.submit, request);
+    if (was_empty) cnd_signal(&g_AsyncIO.submit_cond);
+    mtx_unlock(&g_AsyncIO.mutex);
+    COUNTER_INC("io.requests");
+    return handle;
+}
+
+
+// -------- API асинхронного чтения: --------
+
+
+// Инициализация (запускает поток ввода-вывода):
+void AsyncIO_init(void) {
+    if (g_AsyncIO.initialized) return;
+    mtx_init(&g_AsyncIO.mutex, mtx_plain);
+    cnd_init(&g_AsyncIO.submit_cond);
+    cnd_init(&g_AsyncIO.idle_cond);
+    g_AsyncIO.submit = (AsyncIOQueue){ 0 };
+    g_AsyncIO.completed = (AsyncIOQueue){ 0 };
+    g_AsyncIO.pending = 0;
+    g_AsyncIO.slots = NULL;
+    g_AsyncIO.slots_count = 0;
+    g_AsyncIO.slots_capacity = 0;
+    g_AsyncIO.free_slot = UINT32_MAX;
+    g_AsyncIO.running = true;
+    g_AsyncIO.uring = false;
+    g_AsyncIO.thread_count = 0;
+    g_AsyncIO.initialized = true;
+
+    // Пробуем io_uring (один поток на всё кольцо):
+    #if ASYNCIO_HAS_URING
+        if (ring_init(&g_AsyncIO.ring, ASYNCIO_URING_ENTRIES)) {
+            if (thrd_create(&g_AsyncIO.threads[0], ring_thread, NULL) == thrd_success) {
+                g_AsyncIO.uring = true;
+                g_AsyncIO.thread_count = 1;
+                return;
+            }
+            ring_destroy(&g_AsyncIO.ring);
+        }
+    #endif
+
+    // Иначе пул потоков:
+    for (size_t i = 0; i < ASYNCIO_FALLBACK_THREADS; i++) {
+        if (thrd_create(&g_AsyncIO.threads[g_AsyncIO.thread_count], pool_thread, NULL) == thrd_success) {
+            g_AsyncIO.thread_count++;
+        }
+    }
+    if (g_AsyncIO.thread_count == 0) log_msg("[E] AsyncIO_init: Failed to create I/O threads.\n");
+}
+
+
+// Уничтожение (дожидается всех запросов и доставляет оставшиеся завершения):
+void AsyncIO_destroy(void) {
+    if (!g_AsyncIO.initialized) return;
+    AsyncIO_wait_all();
+
+    // Останавливаем потоки:
+    mtx_lock(&g_AsyncIO.mutex);
+    g_AsyncIO.running = false;
+    cnd_broadcast(&g_AsyncIO.submit_cond);
+    mtx_unlock(&g_AsyncIO.mutex);
+    for (size_t i = 0; i < g_AsyncIO.thread_count; i++) thrd_join(g_AsyncIO.threads[i], NULL);
+    #if ASYNCIO_HAS_URING
+        if (g_AsyncIO.uring) ring_destroy(&g_AsyncIO.ring);
+    #endif
+
+    cnd_destroy(&g_AsyncIO.idle_cond);
+    cnd_destroy(&g_AsyncIO.submit_cond);
+    mtx_destroy(&g_AsyncIO.mutex);
+    mm_free(g_AsyncIO.slots);
+    g_AsyncIO.slots = NULL;
+    g_AsyncIO.slots_count = 0;
+    g_AsyncIO.slots_capacity = 0;
+    g_AsyncIO.thread_count = 0;
+    g_AsyncIO.initialized = false;
+}
+
+
+// Прочитать часть файла в буфер вызывающего (buffer должен жить до обратного вызова):
+AsyncIOHandle AsyncIO_read(
+    const char *file_path, void *buffer, size_t offset, size_t size,
+    AsyncIOCallback callback, void *user, AsyncIODelivery delivery
+) {
+    if (!file_path || (!buffer && size > 0)) return ASYNCIO_HANDLE_NULL;
+    return submit_request(file_path, buffer, offset, size, false, callback, user, delivery);
+}
+
+
+// Прочитать файл целиком (буфер выделяется через mm_alloc, в конце добавляется '\0'):
+AsyncIOHandle AsyncIO_read_file(
+    const char *file_path, AsyncIOCallback callback, void *user, AsyncIODelivery delivery
+) {
+    if (!file_path) return ASYNCIO_HANDLE_NULL;
+    return submit_request(file_path, NULL, 0, 0, true, callback, user, delivery);
+}
+
+
+// Отменить запрос. Обратный вызов всё равно придёт, со статусом ASYNCIO_CANCELED (если чтение ещё не закончено).
+// Дескриптор уже доставленного запроса ничего не делает:
+void AsyncIO_cancel(AsyncIOHandle handle) {
+    if (!g_AsyncIO.initialized) return;
+    mtx_lock(&g_AsyncIO.mutex);  // Пока держим мьютекс, deliver не освободит запрос.
+    AsyncIORequest *request = slot_find(handle);
+    if (request) atomic_store(&request->canceled, true);
+    mtx_unlock(&g_AsyncIO.mutex);
+}
+
+
+// Ещё не доставлен ли запрос:
+bool AsyncIO_is_pending(AsyncIOHandle handle) {
+    if (!g_AsyncIO.initialized) return false;
+    mtx_lock(&g_AsyncIO.mutex);
+    bool pending = slot_find(handle) != NULL;
+    mtx_unlock(&g_AsyncIO.mutex);
+    return pending;
+}
+
+
+// Доставить завершения главного потока. Возвращает количество вызванных обратных вызовов:
+size_t AsyncIO_poll(void) {
+    if (!g_AsyncIO.initialized) return 0;
+
+    // Забираем всю очередь разом, чтобы обратные вызовы могли отправлять новые запросы:
+    mtx_lock(&g_AsyncIO.mutex);
+    AsyncIOQueue completed = g_AsyncIO.completed;
+    g_AsyncIO.completed = (AsyncIOQueue){ 0 };
+    mtx_unlock(&g_AsyncIO.mutex);
+
+    size_t count = 0;
+    AsyncIORequest *request;
+    while ((request = queue_pop(&completed))) {
+        deliver(request);
+        count++;
+    }
+    return count;
+}
+
+
+// Дождаться всех запросов (завершения главного потока доставляются здесь же):
+void AsyncIO_wait_all(void) {
+    if (!g_AsyncIO.initialized) return;
+    mtx_lock(&g_AsyncIO.mutex);
+    while (g_AsyncIO.pending > 0) {
+        if (g_AsyncIO.completed.head) {
+            mtx_unlock(&g_AsyncIO.mutex);
+            AsyncIO_poll();
+            mtx_lock(&g_AsyncIO.mutex);
+            continue;
+        }
+        cnd_wait(&g_AsyncIO.idle_cond, &g_AsyncIO.mutex);
+    }
+    mtx_unlock(&g_AsyncIO.mutex);
+}
+
+
+// Получить количество незавершённых запросов:
+size_t AsyncIO_get_pending_count(void) {
+    if (!g_AsyncIO.initialized) return 0;
+    mtx_lock(&g_AsyncIO.mutex);
+    size_t pending = g_AsyncIO.pending;
+    mtx_unlock(&g_AsyncIO.mutex);
+    return pending;
+}
+
+
+// Используется ли io_uring:
+bool AsyncIO_is_uring(void) {
+    return g_AsyncIO.uring;
+}
@@ -0,0 +1,116 @@
+//
+// asyncio.h - Асинхронное чтение файлов.
+//
+// Запросы на чтение кладутся в очередь и сразу возвращают управление. Отдельный поток ввода-вывода
+// забирает запросы пачками: на Linux отправляет чтения через io_uring одним системным вызовом на пачку,
+// а если io_uring недоступен (другая ОС, старое ядро, запрет в песочнице) - читает файлы небольшим
+// пулом своих потоков. Когда чтение закончено, вызывается обратный вызов:
+//   ASYNCIO_DELIVER_MAIN - в главном потоке из AsyncIO_poll (цикл окна вызывает его каждый кадр).
+//   ASYNCIO_DELIVER_JOB  - задачей JobSystem (или прямо в потоке ввода-вывода, если JobSystem не запущен).
+//
+// Файлы из смонтированных пакетов (vfs.h) поток ввода-вывода копирует из памяти (сжатые - распаковывает)
+// без системных вызовов. Обратный вызов никогда не вызывается внутри AsyncIO_read*.
+// Запрос освобождается после своего обратного вызова, поэтому вызывающий получает не указатель, а
+// дескриптор с поколением (как SceneHandle): дескриптор законченного запроса просто перестаёт действовать.
+//
+// define CGDF_ASYNCIO_NO_URING - Не использовать io_uring (всегда пул потоков).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+
+
+// Определения:
+#define ASYNCIO_URING_ENTRIES    256  // Размер очереди io_uring (сколько чтений в полёте одновременно).
+#define ASYNCIO_FALLBACK_THREADS 4    // Количество потоков запасного пула.
+
+
+// Состояние запроса:
+typedef enum AsyncIOStatus {
+    ASYNCIO_PENDING  = 0,  // Ещё выполняется.
+    ASYNCIO_DONE     = 1,  // Прочитан.
+    ASYNCIO_FAILED   = 2,  // Ошибка (файл не найден, ошибка чтения).
+    ASYNCIO_CANCELED = 3,  // Отменён.
+} AsyncIOStatus;
+
+
+// Куда доставлять завершение:
+typedef enum AsyncIODelivery {
+    ASYNCIO_DELIVER_MAIN = 0,  // В главный поток (AsyncIO_poll).
+    ASYNCIO_DELIVER_JOB  = 1,  // Задачей JobSystem.
+} AsyncIODelivery;
+
+
+// Объявление структур:
+typedef struct AsyncIORequest AsyncIORequest;  // Запрос на чтение (внутренняя структура).
+typedef struct AsyncIOHandle AsyncIOHandle;    // Дескриптор запроса.
+typedef struct AsyncIOResult AsyncIOResult;    // Результат чтения.
+
+
+// Дескриптор запроса:
+struct AsyncIOHandle {
+    uint32_t index;       // Индекс в таблице запросов.
+    uint32_t generation;  // Поколение слота (дескриптор законченного запроса не действует).
+};
+
+
+// Пустой дескриптор (запрос не создан):
+#define ASYNCIO_HANDLE_NULL ((AsyncIOHandle){UINT32_MAX, 0})
+
+
+// Результат чтения:
+struct AsyncIOResult {
+    AsyncIOHandle handle;     // Дескриптор запроса.
+    AsyncIOStatus status;     // Итог запроса.
+    const char *path;         // Путь к файлу.
+    unsigned char *data;      // Данные (для AsyncIO_read_file - буфер из mm_alloc, его освобождает получатель).
+    size_t size;              // Сколько байт прочитано.
+    void *user;               // Пользовательские данные запроса.
+};
+
+
+// Обратный вызов завершения:
+typedef void (*AsyncIOCallback)(const AsyncIOResult *result);
+
+
+// -------- API асинхронного чтения: --------
+
+
+// Инициализация (запускает поток ввода-вывода):
+void AsyncIO_init(void);
+
+// Уничтожение (дожидается всех запросов и доставляет оставшиеся завершения):
+void AsyncIO_destroy(void);
+
+// Прочитать часть файла в буфер вызывающего (buffer должен жить до обратного вызова):
+AsyncIOHandle AsyncIO_read(
+    const char *file_path, void *buffer, size_t offset, size_t size,
+    AsyncIOCallback callback, void *user, AsyncIODelivery delivery
+);
+
+// Прочитать файл целиком (буфер выделяется через mm_alloc, в конце добавляется '\0'):
+AsyncIOHandle AsyncIO_read_file(
+    const char *file_path, AsyncIOCallback callback, void *user, AsyncIODelivery delivery
+);
+
+// Отменить запрос. Обратный вызов всё равно придёт, со статусом ASYNCIO_CANCELED (если чтение ещё не закончено).
+// Дескриптор уже доставленного запроса ничего не делает:
+void AsyncIO_cancel(AsyncIOHandle handle);
+
+// Ещё не доставлен ли запрос:
+bool AsyncIO_is_pending(AsyncIOHandle handle);
+
+// Доставить завершения главного потока. Возвращает количество вызванных обратных вызовов:
+size_t AsyncIO_poll(void);
+
+// Дождаться всех запросов (завершения главного потока доставляются здесь же):
+void AsyncIO_wait_all(void);
+
+// Получить количество незавершённых запросов:
+size_t AsyncIO_get_pending_count(void);
+
+// Используется ли io_uring:
+bool AsyncIO_is_uring(void);
@@ -0,0 +1,1176 @@
+//
+// bcn.c - Реализация сжатия текстур в блочные форматы BCn.
+//
+// Все форматы устроены одинаково: блок хранит концы отрезка (или нескольких отрезков) в цветовом
+// пространстве и для каждого пикселя индекс точки на этом отрезке. Концы ищутся по главной оси
+// пикселей блока (PCA), затем индексы подбираются перебором палитры, а концы уточняются методом наименьших
+// квадратов по выбранным индексам. Палитра считается теми же целыми формулами что и в декодере, поэтому
+// ошибка подбора - это настоящая ошибка распакованного блока.
+// BC7 сжимается режимами 6 (один отрезок RGBA), 5 (RGB и альфа отдельными индексами, с поворотом каналов)
+// и 1 (два подмножества RGB для непрозрачных блоков). Декодер понимает все 8 режимов BC7.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "logger.h"
+#include "libs.h"
+#include "jobsystem.h"
+#include "bcn.h"
+
+#if !defined(CGDF_BCN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define BCN_HAS_SSE 1
+    #include <emmintrin.h>
+#else
+    #define BCN_HAS_SSE 0
+#endif
+
+#if !defined(CGDF_BCN_NO_SIMD) && !BCN_HAS_SSE && (defined(__aarch64__) || defined(_M_ARM64))
+    #define BCN_HAS_NEON 1
+    #include <arm_neon.h>
+#else
+    #define BCN_HAS_NEON 0
+#endif
+
+
+// Определения:
+#define BCN_MAX_ERROR       1e30f  // Ошибка "хуже любой".
+#define BCN_PCA_ITERATIONS  8      // Итераций поиска главной оси.
+#define BC7_PARTITION_TRIES 4      // Сколько лучших по оценке разбиений режима 1 сжимать полностью.
+
+
+// Блок 4x4 для подбора (каналы раздельно, значения 0..255):
+typedef struct BCBlock {
+    float ch[4][16];  // Каналы пикселей RGBA.
+    float mask[16];   // Вес пикселя в подборе (0 - пиксель не участвует).
+} BCBlock;
+
+
+// Описание режима BC7:
+typedef struct BC7Mode {
+    int subsets;         // Количество подмножеств.
+    int partition_bits;  // Бит на номер разбиения.
+    int rotation_bits;   // Бит на поворот каналов.
+    int selector_bits;   // Бит на выбор набора индексов.
+    int color_bits;      // Бит на канал цвета конца.
+    int alpha_bits;      // Бит на альфу конца (0 - альфа всегда 255).
+    int endpoint_pbits;  // P-бит у каждого конца.
+    int shared_pbits;    // P-бит на подмножество.
+    int index_bits;      // Бит на основной индекс.
+    int index_bits2;     // Бит на второй индекс (0 - его нет).
+} BC7Mode;
+
+
+// Параметры подбора одного отрезка BC7:
+typedef struct BC7Fit {
+    int channels;    // Сколько каналов подбирается.
+    int first;       // Первый канал блока.
+    int bits;        // Бит на канал конца (без p-бита).
+    int pbits;       // P-биты: 0 - нет, 1 - общий на оба конца, 2 - у каждого конца свой.
+    int index_bits;  // Бит на индекс.
+} BC7Fit;
+
+
+// Результат подбора одного отрезка BC7:
+typedef struct BC7Endpoints {
+    int q[2][4];      // Квантованные концы (bits бит на канал).
+    int p[2];         // P-биты концов.
+    uint8_t idx[16];  // Индексы пикселей.
+    float error;      // Сумма квадратов ошибок.
+} BC7Endpoints;
+
+
+// 128 бит блока (биты пишутся и читаются начиная с младшего):
+typedef struct BCBits {
+    uint64_t lo;  // Биты 0..63.
+    uint64_t hi;  // Биты 64..127.
+    int pos;      // Позиция следующего бита.
+} BCBits;
+
+
+// Сжатие картинки (общие данные потоков):
+typedef struct BCEncode {
+    const Pixmap *src;      // Исходная картинка.
+    BCImage *dst;           // Сжатая картинка.
+    BCQuality quality;      // Качество сжатия.
+    int blocks_x;           // Блоков по ширине.
+    int blocks_y;           // Блоков по высоте.
+} BCEncode;
+
+
+// Режимы BC7 (таблица из спецификации BPTC):
+static const BC7Mode g_BC7_modes[8] = {
+    { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+    { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+    { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+    { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+    { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+    { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+    { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+    { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+// Веса интерполяции BC7 (из 64) для индексов в 2, 3 и 4 бита:
+static const int g_BC7_weights2[4] = { 0, 21, 43, 64 };
+static const int g_BC7_weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const int g_BC7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Разбиения на 2 подмножества (бит i - подмножество пикселя i):
+static const uint16_t g_BC7_partition2[64] = {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+    0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+    0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+    0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+    0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+// Разбиения на 3 подмножества (биты 2i..2i+1 - подмножество пикселя i):
+static const uint32_t g_BC7_partition3[64] = {
+    0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+    0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+    0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+    0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+    0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+    0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+    0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+    0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+};
+
+// Опорные пиксели (старший бит индекса не хранится) второго подмножества при 2 подмножествах:
+static const uint8_t g_BC7_anchor2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+};
+
+// Опорные пиксели второго подмножества при 3 подмножествах:
+static const uint8_t g_BC7_anchor3a[64] = {
+     3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+     3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+     8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+     3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+};
+
+// Опорные пиксели третьего подмножества при 3 подмножествах:
+static const uint8_t g_BC7_anchor3b[64] = {
+    15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+    15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+    15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+    15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+};
+
+// Веса концов BC1 (доля второго конца) по коду индекса в режимах 4 и 3 цветов:
+static const float g_BC1_weights4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+static const float g_BC1_weights3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+// Таблицы концов BC1 для одноцветного блока (5 и 6 бит): пара, чья точка 1/3 ближе всего к значению:
+static once_flag g_BCn_once = ONCE_FLAG_INIT;
+static uint8_t g_BC1_match5[256][2];
+static uint8_t g_BC1_match6[256][2];
+
+// Векторный поиск ближайших цветов палитры включён:
+static atomic_bool g_BCn_simd = BCN_HAS_SSE || BCN_HAS_NEON;
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Растянуть значение на bits бит до 8 бит (повтором старших битов):
+static inline int expand_bits(int value, int bits) {
+    value <<= 8 - bits;
+    return value | (value >> bits);
+}
+
+// Заполнить таблицы одноцветных блоков BC1:
+static void init_tables(void) {
+    for (int v = 0; v < 256; v++) {
+        int best5 = 256, best6 = 256;
+        for (int a = 0; a < 64; a++) {
+            for (int b = 0; b < 64; b++) {
+                if (a < 32 && b < 32) {
+                    int err = abs((2 * expand_bits(a, 5) + expand_bits(b, 5)) / 3 - v);
+                    if (err < best5) { best5 = err; g_BC1_match5[v][0] = (uint8_t)a; g_BC1_match5[v][1] = (uint8_t)b; }
+                }
+                int err = abs((2 * expand_bits(a, 6) + expand_bits(b, 6)) / 3 - v);
+                if (err < best6) { best6 = err; g_BC1_match6[v][0] = (uint8_t)a; g_BC1_match6[v][1] = (uint8_t)b; }
+            }
+        }
+    }
+}
+
+// Ограничить значение 0..255:
+static inline float clamp255(float v) {
+    return v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v);
+}
+
+// Разложить 16 пикселей RGBA по каналам:
+static void load_block(const uint8_t rgba[64], BCBlock *block) {
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) block->ch[c][i] = (float)rgba[i * 4 + c];
+        block->mask[i] = 1.0f;
+    }
+}
+
+// Подобрать каждому пикселю ближайший цвет палитры (возвращает сумму квадратов ошибок с весами mask).
+// Ошибки суммируются по четырём дорожкам, как в векторных версиях, поэтому все версии выбирают одно и то же:
+static float assign_indices_scalar(
+    const float *const *ch, int channels, const float *mask, const float (*palette)[4], int count, uint8_t *indices
+) {
+    float lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++) {
+        float best = BCN_MAX_ERROR;
+        int best_idx = 0;
+        for (int j = 0; j < count; j++) {
+            float d = ch[0][i] - palette[j][0];
+            float err = d * d;
+            for (int c = 1; c < channels; c++) {
+                d = ch[c][i] - palette[j][c];
+                err += d * d;
+            }
+            if (err < best) { best = err; best_idx = j; }
+        }
+        lanes[i & 3] += best * mask[i];
+        indices[i] = (uint8_t)best_idx;
+    }
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+#if BCN_HAS_SSE
+static float assign_indices_simd(
+    const float *const *ch, int channels, const float *mask, const float (*palette)[4], int count, uint8_t *indices
+) {
+    __m128 total = _mm_setzero_ps();
+    for (int g = 0; g < 16; g += 4) {
+        __m128 px[4];
+        for (int c = 0; c < channels; c++) px[c] = _mm_loadu_ps(ch[c] + g);
+        __m128 best = _mm_set1_ps(BCN_MAX_ERROR);
+        __m128i best_idx = _mm_setzero_si128();
+        for (int j = 0; j < count; j++) {
+            __m128 d = _mm_sub_ps(px[0], _mm_set1_ps(palette[j][0]));
+            __m128 err = _mm_mul_ps(d, d);
+            for (int c = 1; c < channels; c++) {
+                d = _mm_sub_ps(px[c], _mm_set1_ps(palette[j][c]));
+                err = _mm_add_ps(err, _mm_mul_ps(d, d));
+            }
+            __m128i less = _mm_castps_si128(_mm_cmplt_ps(err, best));
+            best = _mm_min_ps(err, best);
+            best_idx = _mm_or_si128(_mm_and_si128(less, _mm_set1_epi32(j)), _mm_andnot_si128(less, best_idx));
+        }
+        total = _mm_add_ps(total, _mm_mul_ps(best, _mm_loadu_ps(mask + g)));
+        alignas(16) int32_t idx[4];
+        _mm_store_si128((__m128i*)idx, best_idx);
+        for (int k = 0; k < 4; k++) indices[g + k] = (uint8_t)idx[k];
+    }
+    alignas(16) float sum[4];
+    _mm_store_ps(sum, total);
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+#elif BCN_HAS_NEON
+static float assign_indices_simd(
+    const float *const *ch, int channels, const float *mask, const float (*palette)[4], int count, uint8_t *indices
+) {
+    float32x4_t total = vdupq_n_f32(0.0f);
+    for (int g = 0; g < 16; g += 4) {
+        float32x4_t px[4];
+        for (int c = 0; c < channels; c++) px[c] = vld1q_f32(ch[c] + g);
+        float32x4_t best = vdupq_n_f32(BCN_MAX_ERROR);
+        uint32x4_t best_idx = vdupq_n_u32(0);
+        for (int j = 0; j < count; j++) {
+            float32x4_t d = vsubq_f32(px[0], vdupq_n_f32(palette[j][0]));
+            float32x4_t err = vmulq_f32(d, d);
+            for (int c = 1; c < channels; c++) {
+                d = vsubq_f32(px[c], vdupq_n_f32(palette[j][c]));
+                err = vmlaq_f32(err, d, d);
+            }
+            uint32x4_t less = vcltq_f32(err, best);
+            best = vminq_f32(err, best);
+            best_idx = vbslq_u32(less, vdupq_n_u32((uint32_t)j), best_idx);
+        }
+        total = vmlaq_f32(total, best, vld1q_f32(mask + g));
+        uint32_t idx[4];
+        vst1q_u32(idx, best_idx);
+        for (int k = 0; k < 4; k++) indices[g + k] = (uint8_t)idx[k];
+    }
+    return vaddvq_f32(total);
+}
+#endif
+
+// Подобрать ближайшие цвета палитры (векторной версией, если она есть и не выключена):
+static inline float assign_indices(
+    const float *const *ch, int channels, const float *mask, const float (*palette)[4], int count, uint8_t *indices
+) {
+    #if BCN_HAS_SSE || BCN_HAS_NEON
+        if (atomic_load_explicit(&g_BCn_simd, memory_order_relaxed)) {
+            return assign_indices_simd(ch, channels, mask, palette, count, indices);
+        }
+    #endif
+    return assign_indices_scalar(ch, channels, mask, palette, count, indices);
+}
+
+// Найти главную ось пикселей с весами mask (итерации по матрице ковариации):
+static void principal_axis(const float *const *ch, int channels, const float *mask, float mean[4], float axis[4]) {
+    float total = 0.0f;
+    for (int c = 0; c < 4; c++) mean[c] = axis[c] = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        total += mask[i];
+        for (int c = 0; c < channels; c++) mean[c] += ch[c][i] * mask[i];
+    }
+    if (total <= 0.0f) return;
+    for (int c = 0; c < channels; c++) mean[c] /= total;
+
+    float cov[4][4] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        if (mask[i] <= 0.0f) continue;
+        float d[4];
+        for (int c = 0; c < channels; c++) d[c] = ch[c][i] - mean[c];
+        for (int a = 0; a < channels; a++) {
+            for (int b = a; b < channels; b++) cov[a][b] += d[a] * d[b] * mask[i];
+        }
+    }
+    for (int a = 0; a < channels; a++) for (int b = 0; b < a; b++) cov[a][b] = cov[b][a];
+
+    // Начинаем со строки канала с наибольшим разбросом (она точно не перпендикулярна оси):
+    int start = 0;
+    for (int c = 1; c < channels; c++) if (cov[c][c] > cov[start][start]) start = c;
+    float v[4] = { 0 };
+    for (int c = 0; c < channels; c++) v[c] = cov[start][c];
+    for (int it = 0; it < BCN_PCA_ITERATIONS; it++) {
+        float w[4] = { 0 }, norm = 0.0f;
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) w[a] += cov[a][b] * v[b];
+            if (fabsf(w[a]) > norm) norm = fabsf(w[a]);
+        }
+        if (norm < 1e-6f) break;
+        for (int c = 0; c < channels; c++) v[c] = w[c] / norm;
+    }
+    for (int c = 0; c < channels; c++) axis[c] = v[c];
+}
+
+// Концы отрезка: проекции крайних пикселей на главную ось:
+static void axis_endpoints(const float *const *ch, int channels, const float *mask, float e[2][4]) {
+    float mean[4], axis[4];
+    principal_axis(ch, channels, mask, mean, axis);
+    float len = 0.0f;
+    for (int c = 0; c < channels; c++) len += axis[c] * axis[c];
+    float t_min = 0.0f, t_max = 0.0f;
+    if (len > 1e-12f) {
+        t_min = BCN_MAX_ERROR;
+        t_max = -BCN_MAX_ERROR;
+        for (int i = 0; i < 16; i++) {
+            if (mask[i] <= 0.0f) continue;
+            float t = 0.0f;
+            for (int c = 0; c < channels; c++) t += (ch[c][i] - mean[c]) * axis[c];
+            t /= len;
+            if (t < t_min) t_min = t;
+            if (t > t_max) t_max = t;
+        }
+        if (t_min > t_max) t_min = t_max = 0.0f;
+    }
+    for (int c = 0; c < channels; c++) {
+        e[0][c] = clamp255(mean[c] + axis[c] * t_min);
+        e[1][c] = clamp255(mean[c] + axis[c] * t_max);
+    }
+}
+
+// Уточнить концы методом наименьших квадратов (weights - доля второго конца по индексу):
+static bool least_squares(
+    const float *const *ch, int channels, const float *mask, const uint8_t *indices, const float *weights, float e[2][4]
+) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f, ra[4] = { 0 }, rb[4] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        if (mask[i] <= 0.0f) continue;
+        float w = weights[indices[i]], s = 1.0f - w, m = mask[i];
+        aa += s * s * m;
+        ab += s * w * m;
+        bb += w * w * m;
+        for (int c = 0; c < channels; c++) {
+            ra[c] += s * ch[c][i] * m;
+            rb[c] += w * ch[c][i] * m;
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (fabsf(det) < 1e-6f) return false;
+    for (int c = 0; c < channels; c++) {
+        e[0][c] = clamp255((bb * ra[c] - ab * rb[c]) / det);
+        e[1][c] = clamp255((aa * rb[c] - ab * ra[c]) / det);
+    }
+    return true;
+}
+
+// Упаковать цвет в 565:
+static inline uint16_t pack565(const float c[3]) {
+    int r = (int)(c[0] * (31.0f / 255.0f) + 0.5f);
+    int g = (int)(c[1] * (63.0f / 255.0f) + 0.5f);
+    int b = (int)(c[2] * (31.0f / 255.0f) + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+// Распаковать цвет 565 в 8 бит на канал:
+static inline void unpack565(uint16_t v, int out[3]) {
+    out[0] = expand_bits((v >> 11) & 31, 5);
+    out[1] = expand_bits((v >> 5) & 63, 6);
+    out[2] = expand_bits(v & 31, 5);
+}
+
+// Палитра BC1 (как в декодере). four - режим 4 цветов, иначе 3 цвета и прозрачный:
+static void bc1_palette(uint16_t c0, uint16_t c1, bool four, int palette[4][4]) {
+    unpack565(c0, palette[0]);
+    unpack565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = 255;
+    for (int c = 0; c < 3; c++) {
+        int a = palette[0][c], b = palette[1][c];
+        palette[2][c] = four ? (2 * a + b) / 3 : (a + b) / 2;
+        palette[3][c] = four ? (a + 2 * b) / 3 : 0;
+    }
+    palette[2][3] = 255;
+    palette[3][3] = four ? 255 : 0;
+}
+
+// Записать блок BC1:
+static void bc1_write(uint16_t c0, uint16_t c1, uint32_t codes, uint8_t *out) {
+    out[0] = (uint8_t)c0; out[1] = (uint8_t)(c0 >> 8);
+    out[2] = (uint8_t)c1; out[3] = (uint8_t)(c1 >> 8);
+    for (int i = 0; i < 4; i++) out[4 + i] = (uint8_t)(codes >> (i * 8));
+}
+
+// Одноцветный блок BC1 по таблицам: все пиксели берут точку 1/3, она точнее самого цвета в 565:
+static void bc1_single_color(const BCBlock *block, int pixel, uint8_t *out) {
+    int r = (int)block->ch[0][pixel], g = (int)block->ch[1][pixel], b = (int)block->ch[2][pixel];
+    uint16_t c0 = (uint16_t)((g_BC1_match5[r][0] << 11) | (g_BC1_match6[g][0] << 5) | g_BC1_match5[b][0]);
+    uint16_t c1 = (uint16_t)((g_BC1_match5[r][1] << 11) | (g_BC1_match6[g][1] << 5) | g_BC1_match5[b][1]);
+    uint32_t code = 2;
+    if (c0 < c1) { uint16_t t = c0; c0 = c1; c1 = t; code = 3; }
+    if (c0 == c1) code = 0;
+    uint32_t codes = 0;
+    for (int i = 0; i < 16; i++) codes |= code << (i * 2);
+    bc1_write(c0, c1, codes, out);
+}
+
+// Сжать цвет блока в BC1. transparent - разрешить режим 3 цветов для пикселей с альфой меньше 128:
+static void encode_bc1(const BCBlock *block, BCQuality quality, bool transparent, uint8_t *out) {
+    float mask[16];
+    int opaque = 0, first = -1;
+    bool has_transparent = false, flat = true;
+    for (int i = 0; i < 16; i++) {
+        mask[i] = (transparent && block->ch[3][i] < 128.0f) ? 0.0f : 1.0f;
+        if (mask[i] <= 0.0f) { has_transparent = true; continue; }
+        if (first < 0) first = i;
+        else if (block->ch[0][i] != block->ch[0][first] || block->ch[1][i] != block->ch[1][first] ||
+                 block->ch[2][i] != block->ch[2][first]) flat = false;
+        opaque++;
+    }
+    if (opaque == 0) { bc1_write(0, 0, 0xFFFFFFFFu, out); return; }
+    if (flat && !has_transparent) { bc1_single_color(block, first, out); return; }
+
+    const float *ch[3] = { block->ch[0], block->ch[1], block->ch[2] };
+    float e[2][4];
+    axis_endpoints(ch, 3, mask, e);
+
+    // Быстрый режим берёт концы по оси, качественный ещё дважды уточняет их по выбранным индексам:
+    int iterations = quality == BC_QUALITY_HIGH ? 3 : 1;
+    float best_err = BCN_MAX_ERROR;
+    uint16_t best_c0 = 0, best_c1 = 0;
+    uint8_t best_idx[16] = { 0 };
+    for (int it = 0; it < iterations; it++) {
+        uint16_t c0 = pack565(e[0]), c1 = pack565(e[1]);
+
+        // В режиме 4 цветов первый конец больше второго, в режиме 3 цветов - не больше:
+        if ((!has_transparent && c0 < c1) || (has_transparent && c0 > c1)) { uint16_t t = c0; c0 = c1; c1 = t; }
+        bool four = c0 > c1;
+        int pal[4][4];
+        float palette[4][4];
+        bc1_palette(c0, c1, four, pal);
+        for (int j = 0; j < 4; j++) for (int c = 0; c < 4; c++) palette[j][c] = (float)pal[j][c];
+
+        uint8_t idx[16];
+        float err = assign_indices(ch, 3, mask, (const float (*)[4])palette, four ? 4 : 3, idx);
+        if (err < best_err) {
+            best_err = err;
+            best_c0 = c0;
+            best_c1 = c1;
+            memcpy(best_idx, idx, sizeof(idx));
+        }
+        if (err <= 0.0f || it + 1 == iterations) break;
+        if (!least_squares(ch, 3, mask, idx, four ? g_BC1_weights4 : g_BC1_weights3, e)) break;
+    }
+
+    uint32_t codes = 0;
+    for (int i = 0; i < 16; i++) {
+        uint32_t code = mask[i] > 0.0f ? best_idx[i] : 3u;
+        codes |= code << (i * 2);
+    }
+    bc1_write(best_c0, best_c1, codes, out);
+}
+
+// Палитра BC4 (как в декодере). e0 > e1 - 8 значений, иначе 6 значений и 0, 255:
+static void bc4_palette(int e0, int e1, float palette[8][4]) {
+    int p[8] = { e0, e1, 0, 0, 0, 0, 0, 255 };
+    if (e0 > e1) {
+        for (int i = 2; i < 8; i++) p[i] = ((8 - i) * e0 + (i - 1) * e1 + 3) / 7;
+    } else {
+        for (int i = 2; i < 6; i++) p[i] = ((6 - i) * e0 + (i - 1) * e1 + 2) / 5;
+    }
+    for (int i = 0; i < 8; i++) palette[i][0] = (float)p[i];
+}
+
+// Ошибка блока BC4 с концами e0, e1:
+static float bc4_evaluate(const float *values, const float *mask, int e0, int e1, uint8_t *indices) {
+    float palette[8][4];
+    bc4_palette(e0, e1, palette);
+    const float *ch[1] = { values };
+    return assign_indices(ch, 1, mask, (const float (*)[4])palette, 8, indices);
+}
+
+// Сжать один канал блока в BC4:
+static void encode_bc4(const float *values, BCQuality quality, uint8_t *out) {
+    static const float mask[16] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+    int lo = 255, hi = 0, lo6 = 255, hi6 = 0;
+    for (int i = 0; i < 16; i++) {
+        int v = (int)values[i];
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+        if (v > 0 && v < 255) {
+            if (v < lo6) lo6 = v;
+            if (v > hi6) hi6 = v;
+        }
+    }
+    int best_e0 = hi, best_e1 = lo;
+    uint8_t best_idx[16] = { 0 }, idx[16];
+    float best_err = lo == hi ? 0.0f : bc4_evaluate(values, mask, hi, lo, best_idx);
+
+    // Качественный режим двигает концы внутрь отрезка и пробует режим 6 значений с точными 0 и 255:
+    if (quality == BC_QUALITY_HIGH && best_err > 0.0f) {
+        for (int a = hi; a >= hi - 3 && a > lo; a--) {
+            for (int b = lo; b <= lo + 3 && b < a; b++) {
+                float err = bc4_evaluate(values, mask, a, b, idx);
+                if (err < best_err) { best_err = err; best_e0 = a; best_e1 = b; memcpy(best_idx, idx, sizeof(idx)); }
+            }
+        }
+        if (lo == 0 || hi == 255) {
+            if (lo6 > hi6) lo6 = hi6 = lo;
+            float err = bc4_evaluate(values, mask, lo6, hi6, idx);
+            if (err < best_err) { best_err = err; best_e0 = lo6; best_e1 = hi6; memcpy(best_idx, idx, sizeof(idx)); }
+        }
+    }
+
+    out[0] = (uint8_t)best_e0;
+    out[1] = (uint8_t)best_e1;
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++) bits |= (uint64_t)best_idx[i] << (i * 3);
+    for (int i = 0; i < 6; i++) out[2 + i] = (uint8_t)(bits >> (i * 8));
+}
+
+// Записать bits бит значения в блок:
+static void bits_put(BCBits *bits, uint32_t value, int count) {
+    if (count <= 0) return;
+    if (bits->pos < 64) {
+        bits->lo |= (uint64_t)value << bits->pos;
+        if (bits->pos + count > 64) bits->hi |= (uint64_t)value >> (64 - bits->pos);
+    } else {
+        bits->hi |= (uint64_t)value << (bits->pos - 64);
+    }
+    bits->pos += count;
+}
+
+// Прочитать count бит из блока:
+static int bits_get(BCBits *bits, int count) {
+    if (count <= 0) return 0;
+    uint64_t value;
+    if (bits->pos < 64) {
+        value = bits->lo >> bits->pos;
+        if (bits->pos + count > 64) value |= bits->hi << (64 - bits->pos);
+    } else {
+        value = bits->hi >> (bits->pos - 64);
+    }
+    bits->pos += count;
+    return (int)(value & ((1u << count) - 1));
+}
+
+// Загрузить 16 байт блока:
+static void bits_load(BCBits *bits, const uint8_t *block) {
+    bits->lo = bits->hi = 0;
+    bits->pos = 0;
+    for (int i = 0; i < 8; i++) {
+        bits->lo |= (uint64_t)block[i] << (i * 8);
+        bits->hi |= (uint64_t)block[8 + i] << (i * 8);
+    }
+}
+
+// Сохранить 16 байт блока:
+static void bits_store(const BCBits *bits, uint8_t *block) {
+    for (int i = 0; i < 8; i++) {
+        block[i] = (uint8_t)(bits->lo >> (i * 8));
+        block[8 + i] = (uint8_t)(bits->hi >> (i * 8));
+    }
+}
+
+// Веса BC7 для индексов в bits бит:
+static inline const int* bc7_weights(int bits) {
+    return bits == 2 ? g_BC7_weights2 : (bits == 3 ? g_BC7_weights3 : g_BC7_weights4);
+}
+
+// Подмножество пикселя:
+static inline int bc7_subset(int subsets, int partition, int pixel) {
+    if (subsets == 2) return (g_BC7_partition2[partition] >> pixel) & 1;
+    if (subsets == 3) return (int)(g_BC7_partition3[partition] >> (pixel * 2)) & 3;
+    return 0;
+}
+
+// Является ли пиксель опорным (его индекс хранится без старшего бита):
+static inline bool bc7_is_anchor(int subsets, int partition, int pixel) {
+    if (pixel == 0) return true;
+    if (subsets == 2) return pixel == g_BC7_anchor2[partition];
+    if (subsets == 3) return pixel == g_BC7_anchor3a[partition] || pixel == g_BC7_anchor3b[partition];
+    return false;
+}
+
+// Развернуть конец BC7 (значение и p-бит, p < 0 - без p-бита) до 8 бит:
+static inline int bc7_expand(int value, int bits, int p) {
+    if (p >= 0) { value = (value << 1) | p; bits++; }
+    return expand_bits(value, bits);
+}
+
+// Квантовать конец BC7 (p < 0 - без p-бита):
+static inline int bc7_quantize(float v, int bits, int p) {
+    int max = (1 << bits) - 1, q;
+    if (p < 0) q = (int)(v * (float)max / 255.0f + 0.5f);
+    else q = (int)(((v * (float)((1 << (bits + 1)) - 1) / 255.0f) - (float)p) * 0.5f + 0.5f);
+    return q < 0 ? 0 : (q > max ? max : q);
+}
+
+// Подобрать один отрезок BC7 для пикселей с весами mask:
+static void bc7_fit(const BCBlock *block, const float *mask, const BC7Fit *fit, int iterations, BC7Endpoints *best) {
+    const float *ch[4];
+    for (int c = 0; c < fit->channels; c++) ch[c] = block->ch[fit->first + c];
+    int count = 1 << fit->index_bits;
+    const int *weights = bc7_weights(fit->index_bits);
+    float ls_weights[16];
+    for (int j = 0; j < count; j++) ls_weights[j] = (float)weights[j] / 64.0f;
+
+    float e[2][4];
+    axis_endpoints(ch, fit->channels, mask, e);
+    *best = (BC7Endpoints){ .error = BCN_MAX_ERROR };
+    int combos = fit->pbits == 0 ? 1 : (fit->pbits == 1 ? 2 : 4);
+    for (int it = 0; it < iterations; it++) {
+        BC7Endpoints cur = { 0 };
+
+        // Перебираем p-биты: они сдвигают сетку квантования концов:
+        for (int combo = 0; combo < combos; combo++) {
+            int p0 = fit->pbits == 0 ? -1 : (combo & 1);
+            int p1 = fit->pbits == 2 ? (combo >> 1) : p0;
+            BC7Endpoints try_ep = { 0 };
+            float palette[16][4];
+            try_ep.p[0] = p0;
+            try_ep.p[1] = p1;
+            for (int c = 0; c < fit->channels; c++) {
+                try_ep.q[0][c] = bc7_quantize(e[0][c], fit->bits, p0);
+                try_ep.q[1][c] = bc7_quantize(e[1][c], fit->bits, p1);
+                int a = bc7_expand(try_ep.q[0][c], fit->bits, p0);
+                int b = bc7_expand(try_ep.q[1][c], fit->bits, p1);
+                for (int j = 0; j < count; j++) palette[j][c] = (float)(((64 - weights[j]) * a + weights[j] * b + 32) >> 6);
+            }
+            try_ep.error = assign_indices(ch, fit->channels, mask, (const float (*)[4])palette, count, try_ep.idx);
+            if (combo == 0 || try_ep.error < cur.error) cur = try_ep;  // Первый вариант - всегда (даже при NaN).
+        }
+        if (it == 0 || cur.error < best->error) *best = cur;
+        if (cur.error <= 0.0f || it + 1 == iterations) break;
+        if (!least_squares(ch, fit->channels, mask, cur.idx, ls_weights, e)) break;
+    }
+}
+
+// Сделать старший бит индекса опорного пикселя нулевым (меняем концы местами и отражаем индексы):
+static void bc7_fix_anchor(BC7Endpoints *ep, const float *mask, int anchor, int index_bits) {
+    int max = (1 << index_bits) - 1;
+    if (ep->idx[anchor] <= max >> 1) return;
+    for (int c = 0; c < 4; c++) { int t = ep->q[0][c]; ep->q[0][c] = ep->q[1][c]; ep->q[1][c] = t; }
+    int t = ep->p[0]; ep->p[0] = ep->p[1]; ep->p[1] = t;
+    for (int i = 0; i < 16; i++) if (mask[i] > 0.0f) ep->idx[i] = (uint8_t)(max - ep->idx[i]);
+}
+
+// Режим 6 BC7: один отрезок RGBA 7777 + p-бит на конец, индексы 4 бита:
+static float bc7_mode6(const BCBlock *block, int iterations, uint8_t *out) {
+    static const BC7Fit fit = { 4, 0, 7, 2, 4 };
+    BC7Endpoints ep;
+    bc7_fit(block, block->mask, &fit, iterations, &ep);
+    bc7_fix_anchor(&ep, block->mask, 0, 4);
+
+    BCBits bits = { 0 };
+    bits_put(&bits, 1u << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        bits_put(&bits, (uint32_t)ep.q[0][c], 7);
+        bits_put(&bits, (uint32_t)ep.q[1][c], 7);
+    }
+    bits_put(&bits, (uint32_t)ep.p[0], 1);
+    bits_put(&bits, (uint32_t)ep.p[1], 1);
+    for (int i = 0; i < 16; i++) bits_put(&bits, ep.idx[i], i == 0 ? 3 : 4);
+    bits_store(&bits, out);
+    return ep.error;
+}
+
+// Режим 5 BC7: RGB 777 и альфа 8 бит отдельными индексами по 2 бита, rotation меняет канал с альфой:
+static float bc7_mode5(const BCBlock *block, int rotation, int iterations, uint8_t *out) {
+    static const BC7Fit color_fit = { 3, 0, 7, 0, 2 };
+    static const BC7Fit alpha_fit = { 1, 3, 8, 0, 2 };
+    BCBlock rotated = *block;
+    if (rotation > 0) {
+        memcpy(rotated.ch[rotation - 1], block->ch[3], sizeof(block->ch[3]));
+        memcpy(rotated.ch[3], block->ch[rotation - 1], sizeof(block->ch[3]));
+    }
+    BC7Endpoints color, alpha;
+    bc7_fit(&rotated, rotated.mask, &color_fit, iterations, &color);
+    bc7_fit(&rotated, rotated.mask, &alpha_fit, iterations, &alpha);
+    bc7_fix_anchor(&color, rotated.mask, 0, 2);
+    bc7_fix_anchor(&alpha, rotated.mask, 0, 2);
+
+    BCBits bits = { 0 };
+    bits_put(&bits, 1u << 5, 6);
+    bits_put(&bits, (uint32_t)rotation, 2);
+    for (int c = 0; c < 3; c++) {
+        bits_put(&bits, (uint32_t)color.q[0][c], 7);
+        bits_put(&bits, (uint32_t)color.q[1][c], 7);
+    }
+    bits_put(&bits, (uint32_t)alpha.q[0][0], 8);
+    bits_put(&bits, (uint32_t)alpha.q[1][0], 8);
+    for (int i = 0; i < 16; i++) bits_put(&bits, color.idx[i], i == 0 ? 1 : 2);
+    for (int i = 0; i < 16; i++) bits_put(&bits, alpha.idx[i], i == 0 ? 1 : 2);
+    bits_store(&bits, out);
+    return color.error + alpha.error;
+}
+
+// Разброс пикселей поперёк главной оси по суммам (количество, сумма цвета, суммы попарных произведений):
+static float line_residual(float n, const float sum[3], const float sq[6]) {
+    if (n <= 0.0f) return 0.0f;
+    float cov[3][3];
+    cov[0][0] = sq[0] - sum[0] * sum[0] / n;
+    cov[0][1] = cov[1][0] = sq[1] - sum[0] * sum[1] / n;
+    cov[0][2] = cov[2][0] = sq[2] - sum[0] * sum[2] / n;
+    cov[1][1] = sq[3] - sum[1] * sum[1] / n;
+    cov[1][2] = cov[2][1] = sq[4] - sum[1] * sum[2] / n;
+    cov[2][2] = sq[5] - sum[2] * sum[2] / n;
+    float trace = cov[0][0] + cov[1][1] + cov[2][2];
+
+    // Наибольшее собственное число (отношение Рэлея после нескольких итераций):
+    int start = cov[1][1] > cov[0][0] ? 1 : 0;
+    if (cov[2][2] > cov[start][start]) start = 2;
+    float v[3] = { cov[start][0], cov[start][1], cov[start][2] };
+    float lambda = 0.0f;
+    for (int it = 0; it < 4; it++) {
+        float w[3], vv = 0.0f, vw = 0.0f, norm = 0.0f;
+        for (int a = 0; a < 3; a++) {
+            w[a] = cov[a][0] * v[0] + cov[a][1] * v[1] + cov[a][2] * v[2];
+            vv += v[a] * v[a];
+            vw += v[a] * w[a];
+            if (fabsf(w[a]) > norm) norm = fabsf(w[a]);
+        }
+        if (vv < 1e-12f || norm < 1e-6f) break;
+        lambda = vw / vv;
+        for (int a = 0; a < 3; a++) v[a] = w[a] / norm;
+    }
+    return trace - lambda;
+}
+
+// Оценка ошибки разбиения на 2 подмножества: разброс пикселей подмножеств поперёк их главных осей.
+// Суммы второго подмножества считаются по битам разбиения, суммы первого - вычитанием из всего блока:
+static float bc7_partition_estimate(const float px[16][9], const float total[9], int partition) {
+    float part[9] = { 0 }, rest[9];
+    float n = 0.0f;
+    uint16_t bits = g_BC7_partition2[partition];
+    for (int i = 0; i < 16; i++) {
+        if (!((bits >> i) & 1)) continue;
+        for (int k = 0; k < 9; k++) part[k] += px[i][k];
+        n += 1.0f;
+    }
+    for (int k = 0; k < 9; k++) rest[k] = total[k] - part[k];
+    return line_residual(n, part, part + 3) + line_residual(16.0f - n, rest, rest + 3);
+}
+
+// Режим 1 BC7: два подмножества RGB 666 + общий p-бит, индексы 3 бита (только непрозрачные блоки):
+static float bc7_mode1(const BCBlock *block, int iterations, uint8_t *out) {
+    static const BC7Fit fit = { 3, 0, 6, 1, 3 };
+
+    // Полностью сжимаем только несколько лучших по оценке разбиений:
+    int candidates[BC7_PARTITION_TRIES];
+    float estimates[BC7_PARTITION_TRIES];
+    float px[16][9], total[9] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        float r = block->ch[0][i], g = block->ch[1][i], b = block->ch[2][i];
+        float m[9] = { r, g, b, r * r, r * g, r * b, g * g, g * b, b * b };
+        for (int k = 0; k < 9; k++) { px[i][k] = m[k]; total[k] += m[k]; }
+    }
+    int found = 0;
+    for (int p = 0; p < 64; p++) {
+        float est = bc7_partition_estimate((const float (*)[9])px, total, p);
+        int pos = found < BC7_PARTITION_TRIES ? found++ : BC7_PARTITION_TRIES;
+        while (pos > 0 && estimates[pos - 1] > est) {
+            if (pos < BC7_PARTITION_TRIES) { estimates[pos] = estimates[pos - 1]; candidates[pos] = candidates[pos - 1]; }
+            pos--;
+        }
+        if (pos < BC7_PARTITION_TRIES) { estimates[pos] = est; candidates[pos] = p; }
+    }
+
+    float best_err = BCN_MAX_ERROR;
+    for (int k = 0; k < found; k++) {
+        int partition = candidates[k];
+        BC7Endpoints ep[2];
+        float masks[2][16];
+        float err = 0.0f;
+        for (int s = 0; s < 2; s++) {
+            for (int i = 0; i < 16; i++) masks[s][i] = bc7_subset(2, partition, i) == s ? 1.0f : 0.0f;
+            bc7_fit(block, masks[s], &fit, iterations, &ep[s]);
+            bc7_fix_anchor(&ep[s], masks[s], s == 0 ? 0 : g_BC7_anchor2[partition], 3);
+            err += ep[s].error;
+        }
+        if (err >= best_err) continue;
+        best_err = err;
+
+        BCBits bits = { 0 };
+        bits_put(&bits, 1u << 1, 2);
+        bits_put(&bits, (uint32_t)partition, 6);
+        for (int c = 0; c < 3; c++) {
+            for (int s = 0; s < 2; s++) {
+                bits_put(&bits, (uint32_t)ep[s].q[0][c], 6);
+                bits_put(&bits, (uint32_t)ep[s].q[1][c], 6);
+            }
+        }
+        bits_put(&bits, (uint32_t)ep[0].p[0], 1);
+        bits_put(&bits, (uint32_t)ep[1].p[0], 1);
+        for (int i = 0; i < 16; i++) {
+            int s = bc7_subset(2, partition, i);
+            bits_put(&bits, ep[s].idx[i], bc7_is_anchor(2, partition, i) ? 2 : 3);
+        }
+        bits_store(&bits, out);
+    }
+    return best_err;
+}
+
+// Сжать блок в BC7 (выбирается режим с наименьшей ошибкой):
+static void encode_bc7(const BCBlock *block, BCQuality quality, uint8_t *out) {
+    if (quality != BC_QUALITY_HIGH) { bc7_mode6(block, 1, out); return; }
+
+    float best = bc7_mode6(block, 3, out);
+    if (best <= 0.0f) return;
+    uint8_t candidate[16];
+    for (int rotation = 0; rotation < 4; rotation++) {
+        float err = bc7_mode5(block, rotation, 2, candidate);
+        if (err < best) { best = err; memcpy(out, candidate, 16); }
+    }
+    bool opaque = true;
+    for (int i = 0; i < 16 && opaque; i++) opaque = block->ch[3][i] >= 255.0f;
+    if (opaque) {
+        float err = bc7_mode1(block, 2, candidate);
+        if (err < best) memcpy(out, candidate, 16);
+    }
+}
+
+// Распаковать цвет BC1 (four - всегда 4 цвета, как в BC3):
+static void decode_bc1(const uint8_t *block, bool four, uint8_t rgba[64]) {
+    uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+    uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+    uint32_t codes = (uint32_t)block[4] | ((uint32_t)block[5] << 8) | ((uint32_t)block[6] << 16) | ((uint32_t)block[7] << 24);
+    int palette[4][4];
+    bc1_palette(c0, c1, four || c0 > c1, palette);
+    for (int i = 0; i < 16; i++) {
+        const int *p = palette[(codes >> (i * 2)) & 3];
+        for (int c = 0; c < 4; c++) rgba[i * 4 + c] = (uint8_t)p[c];
+    }
+}
+
+// Распаковать блок BC4 в канал (stride - шаг между пикселями):
+static void decode_bc4(const uint8_t *block, uint8_t *dst, int stride) {
+    float palette[8][4];
+    bc4_palette(block[0], block[1], palette);
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) bits |= (uint64_t)block[2 + i] << (i * 8);
+    for (int i = 0; i < 16; i++) dst[i * stride] = (uint8_t)palette[(bits >> (i * 3)) & 7][0];
+}
+
+// Распаковать блок BC7 (все режимы):
+static void decode_bc7(const uint8_t *block, uint8_t rgba[64]) {
+    BCBits bits;
+    bits_load(&bits, block);
+    int mode = 0;
+    while (mode < 8 && !bits_get(&bits, 1)) mode++;
+    if (mode == 8) { memset(rgba, 0, 64); return; }  // Запрещённый режим - прозрачный чёрный.
+
+    const BC7Mode *m = &g_BC7_modes[mode];
+    int partition = bits_get(&bits, m->partition_bits);
+    int rotation = bits_get(&bits, m->rotation_bits);
+    int selector = bits_get(&bits, m->selector_bits);
+    int count = m->subsets * 2;
+    int ep[6][4], p[6] = { -1, -1, -1, -1, -1, -1 };
+    for (int c = 0; c < 3; c++) for (int i = 0; i < count; i++) ep[i][c] = bits_get(&bits, m->color_bits);
+    for (int i = 0; i < count; i++) ep[i][3] = m->alpha_bits ? bits_get(&bits, m->alpha_bits) : 255;
+    if (m->endpoint_pbits) for (int i = 0; i < count; i++) p[i] = bits_get(&bits, 1);
+    if (m->shared_pbits) for (int s = 0; s < m->subsets; s++) p[s * 2] = p[s * 2 + 1] = bits_get(&bits, 1);
+    for (int i = 0; i < count; i++) {
+        for (int c = 0; c < 3; c++) ep[i][c] = bc7_expand(ep[i][c], m->color_bits, p[i]);
+        if (m->alpha_bits) ep[i][3] = bc7_expand(ep[i][3], m->alpha_bits, p[i]);
+    }
+
+    int idx[16], idx2[16] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        idx[i] = bits_get(&bits, m->index_bits - (bc7_is_anchor(m->subsets, partition, i) ? 1 : 0));
+    }
+    if (m->index_bits2) for (int i = 0; i < 16; i++) idx2[i] = bits_get(&bits, m->index_bits2 - (i == 0 ? 1 : 0));
+
+    for (int i = 0; i < 16; i++) {
+        int s = bc7_subset(m->subsets, partition, i);
+        int wc = bc7_weights(m->index_bits)[idx[i]], wa = wc;
+        if (m->index_bits2) {
+            int w2 = bc7_weights(m->index_bits2)[idx2[i]];
+            if (selector) { wa = wc; wc = w2; }
+            else wa = w2;
+        }
+        uint8_t *px = &rgba[i * 4];
+        for (int c = 0; c < 3; c++) px[c] = (uint8_t)(((64 - wc) * ep[s * 2][c] + wc * ep[s * 2 + 1][c] + 32) >> 6);
+        px[3] = (uint8_t)(((64 - wa) * ep[s * 2][3] + wa * ep[s * 2 + 1][3] + 32) >> 6);
+        if (rotation > 0) { uint8_t t = px[3]; px[3] = px[rotation - 1]; px[rotation - 1] = t; }
+    }
+}
+
+// Пиксель картинки в RGBA (R - серый, RG - без синего):
+static inline void expand_pixel(const uint8_t *src, int channels, uint8_t *dst) {
+    switch (channels) {
+        case 1:  { dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 255; break; }
+        case 2:  { dst[0] = src[0]; dst[1] = src[1]; dst[2] = 0; dst[3] = 255; break; }
+        case 3:  { dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255; break; }
+        default: { memcpy(dst, src, 4); break; }
+    }
+}
+
+// Собрать блок 4x4 из картинки (за краем повторяются крайние пиксели):
+static void gather_block(const Pixmap *pixmap, int bx, int by, uint8_t rgba[64]) {
+    const uint8_t *data = (const uint8_t*)pixmap->data;
+    for (int y = 0; y < 4; y++) {
+        int sy = by * 4 + y < pixmap->height ? by * 4 + y : pixmap->height - 1;
+        for (int x = 0; x < 4; x++) {
+            int sx = bx * 4 + x < pixmap->width ? bx * 4 + x : pixmap->width - 1;
+            size_t offset = ((size_t)sy * (size_t)pixmap->width + (size_t)sx) * (size_t)pixmap->channels;
+            expand_pixel(&data[offset], pixmap->channels, &rgba[(y * 4 + x) * 4]);
+        }
+    }
+}
+
+// Сколько каналов хранит формат (и сколько их у распакованной картинки):
+static int format_channels(BCFormat format) {
+    switch (format) {
+        case BC_FORMAT_BC4: return 1;
+        case BC_FORMAT_BC5: return 2;
+        default:            return 4;
+    }
+}
+
+// Сжать полосу блоков (полоса JobSystem_parallel_for):
+static void encode_band(void *args, size_t band, size_t worker) {
+    (void)worker;
+    BCEncode *encode = (BCEncode*)args;
+    size_t block_size = BC_get_block_size(encode->dst->format);
+    int y0 = (int)band * BCN_BAND_ROWS;
+    int y1 = y0 + BCN_BAND_ROWS < encode->blocks_y ? y0 + BCN_BAND_ROWS : encode->blocks_y;
+    uint8_t rgba[64];
+    for (int by = y0; by < y1; by++) {
+        uint8_t *out = (uint8_t*)encode->dst->data + (size_t)by * (size_t)encode->blocks_x * block_size;
+        for (int bx = 0; bx < encode->blocks_x; bx++) {
+            gather_block(encode->src, bx, by, rgba);
+            BC_encode_block(encode->dst->format, encode->quality, rgba, out + (size_t)bx * block_size);
+        }
+    }
+}
+
+
+// -------- API сжатия: --------
+
+
+// Сжать картинку (8 бит на канал, любое количество каналов). settings = NULL - BC7, качественно, все потоки:
+BCImage* BCImage_encode(const Pixmap *pixmap, const BCSettings *settings) {
+    if (!pixmap || !pixmap->data || pixmap->width <= 0 || pixmap->height <= 0) return NULL;
+    if (pixmap->is_hdr) {
+        log_msg("[E] BCImage_encode: HDR images are not supported (BC6H is not implemented).\n");
+        return NULL;
+    }
+    if (pixmap->channels < (int)PIXMAP_R || pixmap->channels > (int)PIXMAP_RGBA) {
+        log_msg("[E] BCImage_encode: Invalid channels count: %d.\n", pixmap->channels);
+        return NULL;
+    }
+    BCSettings opts = settings ? *settings : (BCSettings){ BC_FORMAT_BC7, BC_QUALITY_HIGH, 0 };
+    if ((int)opts.format < 0 || opts.format >= BC_FORMAT_COUNT) {
+        log_msg("[E] BCImage_encode: Invalid format: %d.\n", (int)opts.format);
+        return NULL;
+    }
+    call_once(&g_BCn_once, init_tables);
+    size_t workers = opts.workers ? opts.workers : JobSystem_get_max_workers_count();
+    if (workers == 0) workers = 1;
+
+    BCImage *image = (BCImage*)mm_alloc(sizeof(BCImage));
+    image->format = opts.format;
+    image->width = pixmap->width;
+    image->height = pixmap->height;
+    image->size = BC_get_size(opts.format, pixmap->width, pixmap->height);
+    image->data = mm_alloc(image->size);
+
+    BCEncode encode = { pixmap, image, opts.quality, (pixmap->width + 3) / 4, (pixmap->height + 3) / 4 };
+    size_t bands = (size_t)(encode.blocks_y + BCN_BAND_ROWS - 1) / BCN_BAND_ROWS;
+
+    // Маленькой картинке или без потоков параллельность не нужна:
+    size_t blocks = (size_t)encode.blocks_x * (size_t)encode.blocks_y;
+    if (blocks < BCN_PARALLEL_BLOCKS) workers = 1;
+    JobSystem_parallel_for(bands, workers, encode_band, &encode);
+    return image;
+}
+
+
+// Распаковать сжатую картинку (каналы: BC1, BC3, BC7 - RGBA, BC4 - R, BC5 - RG):
+Pixmap* BCImage_decode(const BCImage *self) {
+    if (!self || !self->data || self->width <= 0 || self->height <= 0) return NULL;
+    int channels = format_channels(self->format);
+    Pixmap *pixmap = Pixmap_create(self->width, self->height, channels);
+    size_t block_size = BC_get_block_size(self->format);
+    int blocks_x = (self->width + 3) / 4, blocks_y = (self->height + 3) / 4;
+    uint8_t *data = (uint8_t*)pixmap->data;
+    uint8_t rgba[64];
+    for (int by = 0; by < blocks_y; by++) {
+        for (int bx = 0; bx < blocks_x; bx++) {
+            const uint8_t *block = (const uint8_t*)self->data + ((size_t)by * (size_t)blocks_x + (size_t)bx) * block_size;
+            BC_decode_block(self->format, block, rgba);
+            for (int y = 0; y < 4 && by * 4 + y < self->height; y++) {
+                for (int x = 0; x < 4 && bx * 4 + x < self->width; x++) {
+                    size_t offset = ((size_t)(by * 4 + y) * (size_t)self->width + (size_t)(bx * 4 + x)) * (size_t)channels;
+                    memcpy(&data[offset], &rgba[(y * 4 + x) * 4], (size_t)channels);
+                }
+            }
+        }
+    }
+    return pixmap;
+}
+
+
+// Уничтожить сжатую картинку:
+void BCImage_destroy(BCImage **image) {
+    if (!image || !*image) return;
+    mm_free((*image)->data);
+    mm_free(*image);
+    *image = NULL;
+}
+
+
+// PSNR сжатой картинки относительно исходной в дБ (BC1 - по цвету непрозрачных пикселей). INFINITY - без потерь:
+float BCImage_get_psnr(const BCImage *self, const Pixmap *reference) {
+    if (!self || !reference || !reference->data || reference->is_hdr) return 0.0f;
+    if (reference->width != self->width || reference->height != self->height) {
+        log_msg("[E] BCImage_get_psnr: Size mismatch.\n");
+        return 0.0f;
+    }
+    Pixmap *decoded = BCImage_decode(self);
+    if (!decoded) return 0.0f;
+
+    // BC1 сравниваем только по цвету непрозрачных пикселей (альфа в нём - 1 бит для вырезов):
+    bool cutout = self->format == BC_FORMAT_BC1;
+    int channels = cutout ? 3 : decoded->channels;
+    const uint8_t *src = (const uint8_t*)reference->data;
+    const uint8_t *dst = (const uint8_t*)decoded->data;
+    size_t count = (size_t)self->width * (size_t)self->height, compared = 0;
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t ref[4];
+        expand_pixel(&src[i * (size_t)reference->channels], reference->channels, ref);
+        if (cutout && ref[3] < 128) continue;
+        compared++;
+        for (int c = 0; c < channels; c++) {
+            double d = (double)ref[c] - (double)dst[i * (size_t)decoded->channels + (size_t)c];
+            sum += d * d;
+        }
+    }
+    Pixmap_destroy(&decoded);
+    double mse = compared ? sum / ((double)compared * (double)channels) : 0.0;
+    if (mse <= 0.0) return INFINITY;
+    return (float)(10.0 * log10(255.0 * 255.0 / mse));
+}
+
+
+// Сжать один блок (rgba - 16 пикселей RGBA построчно):
+void BC_encode_block(BCFormat format, BCQuality quality, const uint8_t rgba[64], void *block) {
+    if (!rgba || !block) return;
+    call_once(&g_BCn_once, init_tables);
+    uint8_t *out = (uint8_t*)block;
+    BCBlock b;
+    load_block(rgba, &b);
+    switch (format) {
+        case BC_FORMAT_BC1: { encode_bc1(&b, quality, true, out); break; }
+        case BC_FORMAT_BC3: { encode_bc4(b.ch[3], quality, out); encode_bc1(&b, quality, false, out + 8); break; }
+        case BC_FORMAT_BC4: { encode_bc4(b.ch[0], quality, out); break; }
+        case BC_FORMAT_BC5: { encode_bc4(b.ch[0], quality, out); encode_bc4(b.ch[1], quality, out + 8); break; }
+        case BC_FORMAT_BC7: { encode_bc7(&b, quality, out); break; }
+        default: break;
+    }
+}
+
+
+// Распаковать один блок в 16 пикселей RGBA:
+void BC_decode_block(BCFormat format, const void *block, uint8_t rgba[64]) {
+    if (!block || !rgba) return;
+    const uint8_t *in = (const uint8_t*)block;
+    switch (format) {
+        case BC_FORMAT_BC1: { decode_bc1(in, false, rgba); break; }
+        case BC_FORMAT_BC3: { decode_bc1(in + 8, true, rgba); decode_bc4(in, rgba + 3, 4); break; }
+        case BC_FORMAT_BC4: {
+            memset(rgba, 0, 64);
+            decode_bc4(in, rgba, 4);
+            for (int i = 0; i < 16; i++) rgba[i * 4 + 3] = 255;
+            break;
+        }
+        case BC_FORMAT_BC5: {
+            memset(rgba, 0, 64);
+            decode_bc4(in, rgba, 4);
+            decode_bc4(in + 8, rgba + 1, 4);
+            for (int i = 0; i < 16; i++) rgba[i * 4 + 3] = 255;
+            break;
+        }
+        case BC_FORMAT_BC7: { decode_bc7(in, rgba); break; }
+        default: { memset(rgba, 0, 64); break; }
+    }
+}
+
+
+// Получить размер блока в байтах:
+size_t BC_get_block_size(BCFormat format) {
+    return format == BC_FORMAT_BC1 || format == BC_FORMAT_BC4 ? 8 : 16;
+}
+
+
+// Получить размер сжатой картинки в байтах:
+size_t BC_get_size(BCFormat format, int width, int height) {
+    if (width <= 0 || height <= 0) return 0;
+    return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * BC_get_block_size(format);
+}
+
+
+// Получить название формата:
+const char* BCFormat_get_name(BCFormat format) {
+    switch (format) {
+        case BC_FORMAT_BC1: return "BC1";
+        case BC_FORMAT_BC3: return "BC3";
+        case BC_FORMAT_BC4: return "BC4";
+        case BC_FORMAT_BC5: return "BC5";
+        case BC_FORMAT_BC7: return "BC7";
+        default:            return "unknown";
+    }
+}
+
+
+// Включить или выключить векторный поиск палитры (false - векторных функций нет):
+bool BC_set_simd(bool enabled) {
+    if (enabled && !(BCN_HAS_SSE || BCN_HAS_NEON)) return false;
+    atomic_store(&g_BCn_simd, enabled);
+    return true;
+}
+
+
+// Используется ли векторный поиск палитры:
+bool BC_is_simd(void) {
+    return atomic_load(&g_BCn_simd);
+}
@@ -0,0 +1,108 @@
+//
+// bcn.h - Сжатие текстур в блочные форматы BCn на процессоре.
+//
+// Видеокарта читает BCn напрямую, поэтому текстура занимает в VRAM в 4-8 раз меньше RGBA8 и во столько
+// же раз меньше нагружает шину при выборке. Картинка режется на блоки 4x4, каждый блок сжимается независимо:
+// BC1  - RGB (1 бит альфы для вырезов), 8 байт на блок.
+// BC3  - RGBA (цвет как BC1 + альфа как BC4), 16 байт на блок.
+// BC4  - один канал (маски, шероховатость), 8 байт на блок.
+// BC5  - два канала (карты нормалей XY), 16 байт на блок.
+// BC7  - RGBA высокого качества, 16 байт на блок.
+// Быстрый режим подбирает концы отрезка цветов по главной оси блока, качественный дополнительно уточняет
+// их методом наименьших квадратов, а для BC7 перебирает режимы и разбиения блока на подмножества.
+// Поиск ближайших цветов палитры векторный (SSE2 на x86-64, NEON на AArch64), большие картинки сжимаются
+// полосами блоков параллельно на потоках JobSystem. Декодер нужен для проверки качества (PSNR) и для
+// видеокарт без поддержки формата.
+//
+// define CGDF_BCN_NO_SIMD - Не использовать векторные функции SSE2/NEON (во время работы - BC_set_simd).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+#include "pixmap.h"
+
+
+// Определения:
+#define BCN_BAND_ROWS        4    // Строк блоков в одной полосе параллельного сжатия.
+#define BCN_PARALLEL_BLOCKS  256  // С какого количества блоков сжимать параллельно.
+
+
+// Блочный формат:
+typedef enum BCFormat {
+    BC_FORMAT_BC1,  // RGB + 1 бит альфы (DXT1).
+    BC_FORMAT_BC3,  // RGBA (DXT5).
+    BC_FORMAT_BC4,  // R (RGTC1).
+    BC_FORMAT_BC5,  // RG (RGTC2).
+    BC_FORMAT_BC7,  // RGBA высокого качества (BPTC).
+    BC_FORMAT_COUNT,
+} BCFormat;
+
+
+// Качество сжатия:
+typedef enum BCQuality {
+    BC_QUALITY_FAST,  // Концы по главной оси блока, без уточнения. BC7 - только режим 6.
+    BC_QUALITY_HIGH,  // Уточнение концов, перебор режимов и разбиений BC7 (в разы медленнее).
+} BCQuality;
+
+
+// Объявление структур:
+typedef struct BCSettings BCSettings;  // Настройки сжатия.
+typedef struct BCImage BCImage;        // Сжатая картинка.
+
+
+// Настройки сжатия:
+struct BCSettings {
+    BCFormat format;    // Блочный формат.
+    BCQuality quality;  // Качество сжатия.
+    size_t workers;     // Количество потоков (0 - все потоки JobSystem, 1 - только вызывающий).
+};
+
+
+// Сжатая картинка:
+struct BCImage {
+    BCFormat format;  // Блочный формат.
+    int width;        // Ширина в пикселях.
+    int height;       // Высота в пикселях.
+    size_t size;      // Размер данных в байтах.
+    void *data;       // Блоки построчно (слева направо, сверху вниз).
+};
+
+
+// -------- API сжатия: --------
+
+
+// Сжать картинку (8 бит на канал, любое количество каналов). settings = NULL - BC7, качественно, все потоки:
+BCImage* BCImage_encode(const Pixmap *pixmap, const BCSettings *settings);
+
+// Распаковать сжатую картинку (каналы: BC1, BC3, BC7 - RGBA, BC4 - R, BC5 - RG):
+Pixmap* BCImage_decode(const BCImage *self);
+
+// Уничтожить сжатую картинку:
+void BCImage_destroy(BCImage **image);
+
+// PSNR сжатой картинки относительно исходной в дБ (BC1 - по цвету непрозрачных пикселей). INFINITY - без потерь:
+float BCImage_get_psnr(const BCImage *self, const Pixmap *reference);
+
+// Сжать один блок (rgba - 16 пикселей RGBA построчно):
+void BC_encode_block(BCFormat format, BCQuality quality, const uint8_t rgba[64], void *block);
+
+// Распаковать один блок в 16 пикселей RGBA:
+void BC_decode_block(BCFormat format, const void *block, uint8_t rgba[64]);
+
+// Получить размер блока в байтах:
+size_t BC_get_block_size(BCFormat format);
+
+// Получить размер сжатой картинки в байтах:
+size_t BC_get_size(BCFormat format, int width, int height);
+
+// Получить название формата:
+const char* BCFormat_get_name(BCFormat format);
+
+// Включить или выключить векторный поиск палитры (результат не меняется, нужно для сверки). false - векторных функций нет:
+bool BC_set_simd(bool enabled);
+
+// Используется ли векторный поиск палитры:
+bool BC_is_simd(void);
@@ -10,3 +10,6 @@
 
 // Путь файла краха:
 #define LOG_FILE_PATH "data/last.log"
+
+// Путь файла двоичного лога (log_bin):
+#define LOG_BIN_FILE_PATH "data/last.binlog"
@@ -15,19 +15,33 @@ extern "C" {
 // Подключаем:
 #include "std.h"
 #include "array.h"
+#include "assetcache.h"
+#include "asyncio.h"
+#include "bcn.h"
 #include "constants.h"
+#include "counters.h"
 #include "files.h"
+#include "framepacer.h"
 #include "hashtable.h"
+#include "hotreload.h"
 #include "info.h"
 #include "jobsystem.h"
 #include "libs.h"
 #include "logger.h"
+#include "lz.h"
 #include "math.h"
+#include "mipmap.h"
 #include "mm.h"
 #include "node.h"
+#include "pixconv.h"
+#include "pixops.h"
 #include "pixmap.h"
 #include "platform.h"
+#include "profiler.h"
+#include "scenegraph.h"
+#include "texfile.h"
 #include "time.h"
+#include "vfs.h"
 
 
 // Инициализация ядра:
@@ -35,6 +49,9 @@ static inline bool core_init(void) {
     Time_init();
     Logger_init();
     JobSystem_init();
+    #ifdef CGDF_PROFILER
+        Profiler_init();
+    #endif
 
     // Инициализация генератора случайных чисел:
     srand((uint32_t)Time_now(NULL));
@@ -49,7 +66,16 @@ static inline bool core_init(void) {
 
 // Уничтожение ядра:
 static inline bool core_destroy(void) {
+    HotReload_destroy();  // Останавливаем наблюдение за файлами (импорты могут быть задачами JobSystem).
+    AsyncIO_destroy();    // Дожидаемся чтения файлов (завершения могут быть задачами JobSystem).
+    AssetCache_destroy(); // Выключаем кэш подготовленных ассетов.
+    VFS_unmount_all();    // Закрываем пакеты ассетов.
     JobSystem_destroy();  // Уничтожение работы с задачами (потоками).
+    #ifdef CGDF_PROFILER
+        Profiler_destroy();  // Уничтожение профилировщика.
+    #endif
+    Counters_csv_stop();  // Закрываем CSV счётчиков (если запись не остановили сами).
+    Logger_destroy();     // Дописываем очередь лога и закрываем лог-файл.
     return true;
 }
 
@@ -0,0 +1,145 @@
+//
+// counters.c - Реализация реестра счётчиков производительности.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "logger.h"
+#include "libs.h"
+#include "time.h"
+#include "counters.h"
+
+
+// Состояние реестра:
+typedef struct CountersState {
+    Counter items[COUNTERS_MAX];  // Счётчики (адреса не меняются, поэтому указатели можно хранить).
+    atomic_size_t count;          // Количество зарегистрированных счётчиков.
+    atomic_flag lock;             // Блокировка регистрации.
+    uint64_t frame;               // Номер последнего снимка.
+    uint64_t start_ns;            // Время первого снимка (для CSV).
+    FILE *csv;                    // Открытый CSV файл (или NULL).
+} CountersState;
+
+
+// Состояние реестра:
+static CountersState g_Counters = { .lock = ATOMIC_FLAG_INIT };
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Найти счётчик по имени без блокировки (счётчики только добавляются, поэтому это безопасно):
+static Counter* find_counter(const char *name) {
+    size_t count = atomic_load(&g_Counters.count);
+    for (size_t i = 0; i < count; i++) {
+        Counter *c = &g_Counters.items[i];
+        if (c->name == name || strcmp(c->name, name) == 0) return c;
+    }
+    return NULL;
+}
+
+
+// -------- API реестра счётчиков: --------
+
+
+// Зарегистрировать счётчик (если счётчик с таким именем уже есть, возвращается он):
+Counter* Counters_register(const char *name, CounterKind kind) {
+    if (!name) return NULL;
+    Counter *counter = find_counter(name);
+    if (counter) return counter;
+
+    while (atomic_flag_test_and_set(&g_Counters.lock)) thrd_yield();
+    counter = find_counter(name);  // Могли зарегистрировать пока ждали блокировку.
+    if (!counter) {
+        size_t index = atomic_load(&g_Counters.count);
+        if (index < COUNTERS_MAX) {
+            counter = &g_Counters.items[index];
+            counter->name = name;
+            counter->kind = kind;
+            atomic_init(&counter->value, 0);
+            counter->frame_value = 0;
+            counter->total = 0;
+            atomic_store(&g_Counters.count, index + 1);  // Публикуем уже заполненный счётчик.
+        } else log_msg("[W] Counters_register: Too many counters, \"%s\" is ignored.\n", name);
+    }
+    atomic_flag_clear(&g_Counters.lock);
+    return counter;
+}
+
+
+// Найти счётчик по имени (NULL если нет):
+Counter* Counters_find(const char *name) {
+    if (!name) return NULL;
+    return find_counter(name);
+}
+
+
+// Получить количество счётчиков:
+size_t Counters_count(void) {
+    return atomic_load(&g_Counters.count);
+}
+
+
+// Получить счётчик по индексу (в порядке регистрации):
+Counter* Counters_get(size_t index) {
+    if (index >= atomic_load(&g_Counters.count)) return NULL;
+    return &g_Counters.items[index];
+}
+
+
+// Закончить кадр: снять значения счётчиков, обнулить счётчики событий, дописать строку в CSV:
+void Counters_frame(void) {
+    // Показатели памяти публикуем здесь, чтобы не трогать горячий путь аллокатора:
+    GAUGE_SET("mm.used_bytes", mm_get_used_size());
+    GAUGE_SET("mm.allocated_blocks", mm_get_allocated_blocks());
+
+    uint64_t now = Time_get_ns();
+    if (g_Counters.frame == 0) g_Counters.start_ns = now;
+    g_Counters.frame++;
+
+    size_t count = atomic_load(&g_Counters.count);
+    for (size_t i = 0; i < count; i++) {
+        Counter *c = &g_Counters.items[i];
+        if (c->kind == COUNTER_KIND_COUNT) {
+            c->frame_value = atomic_exchange_explicit(&c->value, 0, memory_order_relaxed);
+            c->total += c->frame_value;
+        } else c->frame_value = atomic_load_explicit(&c->value, memory_order_relaxed);
+
+        if (g_Counters.csv) {
+            fprintf(
+                g_Counters.csv, "%llu,%.3f,%s,%lld\n", (unsigned long long)g_Counters.frame,
+                Time_ns_to_ms(now - g_Counters.start_ns), c->name, (long long)c->frame_value
+            );
+        }
+    }
+}
+
+
+// Получить номер последнего снятого кадра:
+uint64_t Counters_get_frame(void) {
+    return g_Counters.frame;
+}
+
+
+// Начать запись снимков в CSV файл (столбцы: frame, time_ms, counter, value):
+bool Counters_csv_start(const char *file_path) {
+    Counters_csv_stop();
+    if (!file_path) return false;
+    g_Counters.csv = fopen(file_path, "w");
+    if (!g_Counters.csv) {
+        log_msg("[E] Counters_csv_start: Failed to open file \"%s\".\n", file_path);
+        return false;
+    }
+    fprintf(g_Counters.csv, "frame,time_ms,counter,value\n");
+    return true;
+}
+
+
+// Остановить запись в CSV:
+void Counters_csv_stop(void) {
+    if (!g_Counters.csv) return;
+    fclose(g_Counters.csv);
+    g_Counters.csv = NULL;
+}
@@ -0,0 +1,100 @@
+//
+// counters.h - Общий реестр счётчиков производительности.
+//
+// Счётчик регистрируется один раз по имени и дальше обновляется одной атомарной операцией (relaxed).
+// Counters_frame (вызывается циклом окна в конце кадра) снимает значения: счётчики событий
+// (COUNTER_KIND_COUNT) обнуляются каждый кадр, а показатели (COUNTER_KIND_GAUGE) хранят текущее значение.
+// Снимок кадра можно писать в CSV (Counters_csv_start) и выводить поверх кадра через FontPixmap.
+//
+// define CGDF_DISABLE_COUNTERS - Чтобы макросы COUNTER_* ничего не делали.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+
+
+// Определения:
+#define COUNTERS_MAX 128  // Максимальное количество счётчиков.
+
+
+// Вид счётчика:
+typedef enum CounterKind {
+    COUNTER_KIND_COUNT = 0,  // Количество событий за кадр (обнуляется каждый кадр).
+    COUNTER_KIND_GAUGE = 1,  // Текущее значение (не обнуляется).
+} CounterKind;
+
+
+// Объявление структур:
+typedef struct Counter Counter;  // Счётчик.
+
+
+// Счётчик:
+struct Counter {
+    const char *name;       // Имя (строка должна жить всё время работы программы).
+    CounterKind kind;       // Вид счётчика.
+    _Atomic int64_t value;  // Текущее значение (обновляется из любых потоков).
+    int64_t frame_value;    // Значение в последнем снимке кадра.
+    int64_t total;          // Сумма по всем кадрам (для COUNTER_KIND_COUNT).
+};
+
+
+// -------- API реестра счётчиков: --------
+
+
+// Зарегистрировать счётчик (если счётчик с таким именем уже есть, возвращается он):
+Counter* Counters_register(const char *name, CounterKind kind);
+
+// Найти счётчик по имени (NULL если нет):
+Counter* Counters_find(const char *name);
+
+// Получить количество счётчиков:
+size_t Counters_count(void);
+
+// Получить счётчик по индексу (в порядке регистрации):
+Counter* Counters_get(size_t index);
+
+// Закончить кадр: снять значения счётчиков, обнулить счётчики событий, дописать строку в CSV:
+void Counters_frame(void);
+
+// Получить номер последнего снятого кадра:
+uint64_t Counters_get_frame(void);
+
+// Начать запись снимков в CSV файл (столбцы: frame, time_ms, counter, value):
+bool Counters_csv_start(const char *file_path);
+
+// Остановить запись в CSV:
+void Counters_csv_stop(void);
+
+// Прибавить к счётчику:
+static inline void Counter_add(Counter *self, int64_t value) {
+    if (self) atomic_fetch_add_explicit(&self->value, value, memory_order_relaxed);
+}
+
+// Установить значение счётчика (для показателей):
+static inline void Counter_set(Counter *self, int64_t value) {
+    if (self) atomic_store_explicit(&self->value, value, memory_order_relaxed);
+}
+
+
+// Макросы (счётчик регистрируется при первом вызове в этом месте кода):
+#ifndef CGDF_DISABLE_COUNTERS
+    #define COUNTER_UPDATE_(name, kind, func, value) do {                                         \
+        static _Atomic(Counter*) counter_ = NULL;                                                 \
+        Counter *c_ = atomic_load_explicit(&counter_, memory_order_acquire);                      \
+        if (!c_) {                                                                                \
+            c_ = Counters_register(name, kind);                                                   \
+            atomic_store_explicit(&counter_, c_, memory_order_release);                          \
+        }                                                                                         \
+        func(c_, (int64_t)(value));                                                               \
+    } while (0)
+    #define COUNTER_ADD(name, value) COUNTER_UPDATE_(name, COUNTER_KIND_COUNT, Counter_add, value)
+    #define COUNTER_INC(name)        COUNTER_ADD(name, 1)
+    #define GAUGE_SET(name, value)   COUNTER_UPDATE_(name, COUNTER_KIND_GAUGE, Counter_set, value)
+#else
+    #define COUNTER_ADD(name, value) ((void)0)
+    #define COUNTER_INC(name)        ((void)0)
+    #define GAUGE_SET(name, value)   ((void)0)
+#endif
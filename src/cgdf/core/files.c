@@ -7,12 +7,18 @@
 #include "std.h"
 #include "mm.h"
 #include "logger.h"
+#include "vfs.h"
+#include "lz.h"
 #include "files.h"
 #if defined(_WIN32)
     #include <direct.h>
+    #include <windows.h>
     #define getcwd_os _getcwd
 #else
     #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
     #define getcwd_os getcwd
 #endif
 
@@ -78,6 +84,27 @@ void Files_fix_apple_path(void) {
 #endif
 
 
+// Дочитать сжатый кадр из файла потоком (заголовок уже прочитан):
+static unsigned char* load_lz_frame(FILE* f, const unsigned char* header, size_t raw_size) {
+    unsigned char* buffer = (unsigned char*)mm_alloc(raw_size > 0 ? raw_size : 1);
+    LZStream* stream = LZStream_create(buffer, raw_size);
+    bool ok = LZStream_feed(stream, header, LZ_FRAME_HEADER_SIZE);
+
+    unsigned char chunk[64 * 1024];
+    size_t read_size;
+    while (ok && !LZStream_is_done(stream) && (read_size = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        ok = LZStream_feed(stream, chunk, read_size);
+    }
+    ok = ok && LZStream_is_done(stream);
+    LZStream_destroy(&stream);
+    if (!ok) {
+        mm_free(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+
 // Получить текущую директорию:
 char* Files_get_cwd(char *buf, size_t size) {
     if (buf != NULL && size == 0) return NULL;
@@ -142,8 +169,31 @@ char* Files_path_join(const char *dir, const char *path) {
 }
 
 
+// Существует ли файл (в смонтированных пакетах или на диске):
+bool Files_exists(const char* file_path) {
+    if (!file_path) return false;
+    if (VFS_find(file_path, NULL)) return true;
+    FILE* f = fopen(file_path, "rb");
+    if (!f) return false;
+    fclose(f);
+    return true;
+}
+
+
 // Загружаем файл в строку:
 char* Files_load(const char* file_path, const char* mode) {
+    // Сначала ищем в смонтированных пакетах:
+    VFSFile packed;
+    if (VFS_find(file_path, &packed)) {
+        char* buffer = (char*)mm_alloc(packed.raw_size + 1);
+        if (!VFS_read(&packed, buffer)) {
+            mm_free(buffer);
+            return NULL;
+        }
+        buffer[packed.raw_size] = '\0';
+        return buffer;
+    }
+
     FILE* f = fopen(file_path, mode);
     if (!f) return NULL;
 
@@ -181,6 +231,18 @@ bool Files_save(const char* file_path, const char* data, const char* mode) {
 
 // Загружаем файл в буфер бинарно:
 unsigned char* Files_load_bin(const char* file_path, const char* mode, size_t* out_size) {
+    // Сначала ищем в смонтированных пакетах:
+    VFSFile packed;
+    if (VFS_find(file_path, &packed)) {
+        unsigned char* buffer = (unsigned char*)mm_alloc(packed.raw_size > 0 ? packed.raw_size : 1);
+        if (!VFS_read(&packed, buffer)) {
+            mm_free(buffer);
+            return NULL;
+        }
+        if (out_size) *out_size = packed.raw_size;
+        return buffer;
+    }
+
     FILE* f = fopen(file_path, mode);
     if (!f) return NULL;
 
@@ -211,3 +273,143 @@ bool Files_save_bin(const char* file_path, const void* data, size_t size, const
     fclose(f);
     return true;
 }
+
+
+// Загружаем файл, сохранённый через Files_save_bin_lz, и распаковываем его:
+unsigned char* Files_load_bin_lz(const char* file_path, size_t* out_size) {
+    // Файл из пакета уже в памяти - распаковываем кадр целиком:
+    VFSFile packed;
+    if (VFS_find(file_path, &packed)) {
+        size_t frame_size = 0, raw_size = 0;
+        unsigned char* frame = Files_load_bin(file_path, "rb", &frame_size);
+        if (!frame) return NULL;
+        unsigned char* buffer = NULL;
+        if (LZ_frame_get_size(frame, frame_size, &raw_size)) {
+            buffer = (unsigned char*)mm_alloc(raw_size > 0 ? raw_size : 1);
+            if (LZ_frame_decompress(frame, frame_size, buffer, raw_size) != raw_size) {
+                mm_free(buffer);
+                buffer = NULL;
+            }
+        }
+        mm_free(frame);
+        if (buffer && out_size) *out_size = raw_size;
+        if (!buffer) log_msg("[E] Files_load_bin_lz: \"%s\" is not a valid compressed file.\n", file_path);
+        return buffer;
+    }
+
+    FILE* f = fopen(file_path, "rb");
+    if (!f) return NULL;
+
+    // Распаковываем потоком прямо при чтении:
+    unsigned char header[LZ_FRAME_HEADER_SIZE];
+    size_t raw_size;
+    unsigned char* buffer = NULL;
+    if (fread(header, 1, sizeof(header), f) == sizeof(header) && LZ_frame_get_size(header, sizeof(header), &raw_size)) {
+        buffer = load_lz_frame(f, header, raw_size);
+    }
+    fclose(f);
+    if (buffer && out_size) *out_size = raw_size;
+    if (!buffer) log_msg("[E] Files_load_bin_lz: \"%s\" is not a valid compressed file.\n", file_path);
+    return buffer;
+}
+
+
+// Сохраняем буфер в файл со сжатием (читается через Files_load_bin_lz):
+bool Files_save_bin_lz(const char* file_path, const void* data, size_t size) {
+    size_t bound = LZ_frame_bound(size);
+    unsigned char* frame = (unsigned char*)mm_alloc(bound);
+    size_t frame_size = LZ_frame_compress(data, size, frame, bound);
+    bool ok = frame_size > 0 && Files_save_bin(file_path, frame, frame_size, "wb");
+    mm_free(frame);
+    return ok;
+}
+
+
+// Отобразить файл в память только для чтения (если отображение недоступно, файл читается в кучу):
+FileMap Files_map(const char* file_path, FileMapAccess access) {
+    FileMap map = { 0 };
+    if (!file_path) return map;
+
+    // Файл из смонтированного пакета отдаём без копирования (сжатый распаковываем в кучу):
+    VFSFile packed;
+    if (VFS_find(file_path, &packed)) {
+        if (!packed.compressed) {
+            map.data = packed.data;
+            map.size = packed.size;
+            map.packed = true;
+            return map;
+        }
+        unsigned char* buffer = (unsigned char*)mm_alloc(packed.raw_size > 0 ? packed.raw_size : 1);
+        if (!VFS_read(&packed, buffer)) {
+            mm_free(buffer);
+            return map;
+        }
+        map.data = buffer;
+        map.size = packed.raw_size;
+        return map;
+    }
+
+    #if defined(_WIN32)
+        HANDLE file = CreateFileA(
+            file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+            access == FILE_MAP_SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN :
+            access == FILE_MAP_RANDOM ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL, NULL
+        );
+        if (file == INVALID_HANDLE_VALUE) return map;
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping) {
+                map.data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);  // Отображение держит объект само.
+            }
+            if (map.data) {
+                map.size = (size_t)size.QuadPart;
+                map.mapped = true;
+            }
+        }
+        CloseHandle(file);
+    #else
+        int fd = open(file_path, O_RDONLY);
+        if (fd < 0) return map;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                int advice = access == FILE_MAP_SEQUENTIAL ? MADV_SEQUENTIAL :
+                             access == FILE_MAP_RANDOM ? MADV_RANDOM : MADV_NORMAL;
+                if (advice != MADV_NORMAL) madvise(data, (size_t)st.st_size, advice);
+                map.data = (const unsigned char*)data;
+                map.size = (size_t)st.st_size;
+                map.mapped = true;
+            }
+        }
+        close(fd);  // Отображение остаётся действительным и после закрытия файла.
+    #endif
+
+    // Запасной путь (пустой файл, не обычный файл или отображение не удалось):
+    if (!map.data) {
+        map.data = Files_load_bin(file_path, "rb", &map.size);
+        map.mapped = false;
+    }
+    return map;
+}
+
+
+// Закрыть отображение файла:
+void Files_unmap(FileMap *map) {
+    if (!map || !map->data) return;
+    if (map->packed) {
+        // Данные принадлежат пакету.
+    } else if (map->mapped) {
+        #if defined(_WIN32)
+            UnmapViewOfFile((LPCVOID)map->data);
+        #else
+            munmap((void*)map->data, map->size);
+        #endif
+    } else mm_free((void*)map->data);
+    map->data = NULL;
+    map->size = 0;
+    map->mapped = false;
+    map->packed = false;
+}
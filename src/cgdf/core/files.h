@@ -9,6 +9,27 @@
 #include "std.h"
 
 
+// Подсказка ядру о порядке чтения отображённого файла:
+typedef enum FileMapAccess {
+    FILE_MAP_NORMAL     = 0,  // Без подсказки.
+    FILE_MAP_SEQUENTIAL = 1,  // Читаем от начала к концу (ядро читает наперёд и раньше выкидывает страницы).
+    FILE_MAP_RANDOM     = 2,  // Читаем вразброс (ядро не читает наперёд).
+} FileMapAccess;
+
+
+// Объявление структур:
+typedef struct FileMap FileMap;  // Отображённый в память файл.
+
+
+// Отображённый в память файл (только чтение):
+struct FileMap {
+    const unsigned char *data;  // Данные файла (NULL если не удалось открыть).
+    size_t size;                // Размер данных.
+    bool mapped;                // true - данные отображены (mmap), false - прочитаны в буфер в куче.
+    bool packed;                // Данные лежат в смонтированном пакете (VFS), освобождать нечего.
+};
+
+
 // Код для исправления путей для OS X:
 #ifdef __APPLE__
 void Files_fix_apple_path(void);
@@ -29,14 +50,30 @@ char* Files_dirname_dup(const char *filepath);
 // Склеить пути (требуется освободить память):
 char* Files_path_join(const char *dir, const char *path);
 
+// Существует ли файл (в смонтированных пакетах или на диске):
+bool Files_exists(const char* file_path);
+
 // Загружаем файл в строку:
 char* Files_load(const char* file_path, const char* mode);
 
 // Сохраняем строку в файл:
 bool Files_save(const char* file_path, const char* data, const char* mode);
 
-// Загружаем файл в буфер бинарно:
+// Загружаем файл в буфер бинарно (байты файла как есть, те же что отдаёт Files_map; сжатые файлы пакетов
+// распаковываются):
 unsigned char* Files_load_bin(const char* file_path, const char* mode, size_t* out_size);
 
+// Загружаем файл, сохранённый через Files_save_bin_lz, и распаковываем его (NULL - файл не сжат или повреждён):
+unsigned char* Files_load_bin_lz(const char* file_path, size_t* out_size);
+
 // Сохраняем буфер в файл бинарно:
 bool Files_save_bin(const char* file_path, const void* data, size_t size, const char* mode);
+
+// Сохраняем буфер в файл со сжатием (читается через Files_load_bin_lz):
+bool Files_save_bin_lz(const char* file_path, const void* data, size_t size);
+
+// Отобразить файл в память только для чтения (если отображение недоступно, файл читается в кучу):
+FileMap Files_map(const char* file_path, FileMapAccess access);
+
+// Закрыть отображение файла:
+void Files_unmap(FileMap *map);
@@ -0,0 +1,142 @@
+//
+// framepacer.c - Реализация точного ограничения частоты кадров.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "time.h"
+#include "framepacer.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+    #define FRAMEPACER_PAUSE() _mm_pause()
+#elif defined(__aarch64__)
+    #define FRAMEPACER_PAUSE() __asm__ volatile("yield")
+#else
+    #define FRAMEPACER_PAUSE() ((void)0)
+#endif
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Сравнение длительностей для сортировки:
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Дождаться срока: сон по абсолютному времени и активное ожидание на запасе:
+static void wait_deadline(FramePacer *self, uint64_t deadline) {
+    uint64_t now = Time_get_ns();
+    if (deadline <= now) return;
+
+    // Спим до срока минус запас, и смотрим насколько проснулись позже:
+    if (deadline - now > self->spin_ns) {
+        uint64_t wake_at = deadline - self->spin_ns;
+        Time_sleep_until_ns(wake_at);
+        uint64_t woke = Time_get_ns();
+        self->sleep_ns += woke - now;
+        double oversleep = woke > wake_at ? (double)(woke - wake_at) : 0.0;
+
+        // Запас = затухающий пик опоздания (быстро растёт, медленно убывает):
+        self->oversleep_peak = oversleep > self->oversleep_peak ? oversleep : self->oversleep_peak * 0.9;
+        uint64_t spin = (uint64_t)self->oversleep_peak + FRAMEPACER_MIN_SPIN_NS;
+        self->spin_ns = spin > FRAMEPACER_MAX_SPIN_NS ? FRAMEPACER_MAX_SPIN_NS : spin;
+        now = woke;
+    }
+
+    // Докручиваем остаток:
+    uint64_t spin_start = now;
+    while (now < deadline) {
+        FRAMEPACER_PAUSE();
+        now = Time_get_ns();
+    }
+    self->spin_ns_sum += now - spin_start;
+}
+
+
+// -------- API ограничителя кадров: --------
+
+
+// Создать ограничитель частоты кадров:
+FramePacer* FramePacer_create(void) {
+    FramePacer *pacer = (FramePacer*)mm_calloc(1, sizeof(FramePacer));
+    pacer->spin_ns = FRAMEPACER_MIN_SPIN_NS * 10;  // Начальный запас, пока опоздания не измерены.
+    pacer->last_frame_ns = Time_get_ns();
+    return pacer;
+}
+
+// Уничтожить ограничитель частоты кадров:
+void FramePacer_destroy(FramePacer **pacer) {
+    if (!pacer || !*pacer) return;
+    mm_free(*pacer);
+    *pacer = NULL;
+}
+
+// Закончить кадр: дождаться срока (fps <= 0 - не ждать) и записать время кадра:
+void FramePacer_frame(FramePacer *self, double fps) {
+    if (!self) return;
+    uint64_t period = fps > 0.0 ? (uint64_t)(1e9 / fps) : 0;
+    uint64_t now = Time_get_ns();
+
+    if (period > 0) {
+        // Новый срок от предыдущего срока. На первом кадре, после сброса и при смене частоты начинаем
+        // отсчёт заново от начала этого кадра (конца предыдущего), но не раньше текущего момента:
+        if (self->deadline_ns == 0 || period != self->period_ns) {
+            uint64_t deadline = self->last_frame_ns + period;
+            self->deadline_ns = deadline > now ? deadline : now;
+        } else self->deadline_ns += period;
+        self->period_ns = period;
+
+        if (now > self->deadline_ns) {
+            // Не уложились. Если отстали больше чем на кадр, не догоняем пачкой кадров, а сдвигаем срок:
+            self->missed++;
+            if (now - self->deadline_ns > period) self->deadline_ns = now;
+        } else wait_deadline(self, self->deadline_ns);
+        now = Time_get_ns();
+    } else {
+        self->period_ns = 0;
+        self->deadline_ns = 0;
+    }
+
+    // Записываем длительность кадра:
+    self->samples[self->samples_index] = now - self->last_frame_ns;
+    self->samples_index = (self->samples_index + 1) % FRAMEPACER_HISTORY;
+    if (self->samples_count < FRAMEPACER_HISTORY) self->samples_count++;
+    self->last_frame_ns = now;
+    self->frames++;
+}
+
+// Сбросить сроки (например после долгой загрузки, чтобы не считать её пропущенными кадрами):
+void FramePacer_reset(FramePacer *self) {
+    if (!self) return;
+    self->deadline_ns = 0;
+    self->last_frame_ns = Time_get_ns();
+}
+
+// Получить статистику кадров:
+void FramePacer_get_stats(FramePacer *self, FramePacerStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(FramePacerStats));
+    if (!self || self->samples_count == 0) return;
+
+    // Перцентили по отсортированной копии последних кадров:
+    size_t n = self->samples_count;
+    uint64_t sorted[FRAMEPACER_HISTORY];
+    memcpy(sorted, self->samples, n * sizeof(uint64_t));
+    qsort(sorted, n, sizeof(uint64_t), compare_u64);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += sorted[i];
+
+    stats->avg_ms = Time_ns_to_ms(sum) / (double)n;
+    stats->p50_ms = Time_ns_to_ms(sorted[(n - 1) / 2]);
+    stats->p99_ms = Time_ns_to_ms(sorted[(n - 1) * 99 / 100]);
+    stats->max_ms = Time_ns_to_ms(sorted[n - 1]);
+    stats->frames = self->frames;
+    stats->missed = self->missed;
+    stats->sleep_ms = Time_ns_to_ms(self->sleep_ns) / (double)self->frames;
+    stats->spin_ms = Time_ns_to_ms(self->spin_ns_sum) / (double)self->frames;
+}
@@ -0,0 +1,75 @@
+//
+// framepacer.h - Точное ограничение частоты кадров и статистика времени кадра.
+//
+// Срок следующего кадра считается от срока предыдущего (а не от начала кадра), поэтому ошибка не копится.
+// До срока поток спит по абсолютному времени, а последние микросекунды докручивает активным ожиданием.
+// Запас на докрутку подстраивается сам по тому, насколько система опаздывает с пробуждением.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+
+
+// Определения:
+#define FRAMEPACER_HISTORY      512        // Сколько последних кадров хранится для перцентилей.
+#define FRAMEPACER_MIN_SPIN_NS  20000ull   // Минимальный запас на активное ожидание (20 мкс).
+#define FRAMEPACER_MAX_SPIN_NS  4000000ull // Максимальный запас на активное ожидание (4 мс).
+
+
+// Объявление структур:
+typedef struct FramePacer FramePacer;            // Ограничитель частоты кадров.
+typedef struct FramePacerStats FramePacerStats;  // Статистика кадров.
+
+
+// Ограничитель частоты кадров:
+struct FramePacer {
+    uint64_t period_ns;      // Целевая длительность кадра (0 = без ограничения).
+    uint64_t deadline_ns;    // Срок текущего кадра (0 = ещё не задан).
+    uint64_t last_frame_ns;  // Конец предыдущего кадра.
+    uint64_t spin_ns;        // Текущий запас на активное ожидание.
+    double oversleep_peak;   // Пик опоздания пробуждения (затухает со временем).
+
+    uint64_t samples[FRAMEPACER_HISTORY];  // Длительности последних кадров.
+    size_t samples_count;                  // Сколько длительностей сохранено.
+    size_t samples_index;                  // Куда писать следующую.
+
+    uint64_t frames;       // Всего кадров.
+    uint64_t missed;       // Кадров, не уложившихся в срок.
+    uint64_t sleep_ns;     // Всего времени во сне.
+    uint64_t spin_ns_sum;  // Всего времени в активном ожидании (занятый процессор).
+};
+
+
+// Статистика кадров:
+struct FramePacerStats {
+    double avg_ms;           // Среднее время кадра.
+    double p50_ms;           // Медиана времени кадра.
+    double p99_ms;           // 99-й перцентиль времени кадра.
+    double max_ms;           // Самый долгий кадр.
+    uint64_t frames;         // Всего кадров.
+    uint64_t missed;         // Кадров, не уложившихся в срок.
+    double sleep_ms;         // Сон на кадр (в среднем).
+    double spin_ms;          // Активное ожидание на кадр (в среднем, это время процессора).
+};
+
+
+// -------- API ограничителя кадров: --------
+
+
+// Создать ограничитель частоты кадров:
+FramePacer* FramePacer_create(void);
+
+// Уничтожить ограничитель частоты кадров:
+void FramePacer_destroy(FramePacer **pacer);
+
+// Закончить кадр: дождаться срока (fps <= 0 - не ждать) и записать время кадра:
+void FramePacer_frame(FramePacer *self, double fps);
+
+// Сбросить сроки (например после долгой загрузки, чтобы не считать её пропущенными кадрами):
+void FramePacer_reset(FramePacer *self);
+
+// Получить статистику кадров:
+void FramePacer_get_stats(FramePacer *self, FramePacerStats *stats);
@@ -11,6 +11,7 @@
 // Подключаем:
 #include "std.h"
 #include "mm.h"
+#include "counters.h"
 #include "hashtable.h"
 
 
@@ -88,6 +89,7 @@ static inline void reset_probs(HashTable *table) {
 // Перераспределение хэш-таблицы:
 static inline void rehash(HashTable *table, size_t new_capacity) {
     if (!table || table->len <= 0 || table->capacity <= 0) return;
+    COUNTER_INC("hashtable.rehashes");
 
     // Подготавливаем данные:
     HashSlot *old_data = table->data;
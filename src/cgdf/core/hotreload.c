@@ -0,0 +1,529 @@
+//
+// hotreload.c - Реализация горячей перезагрузки ассетов.
+//
+// Путь изменения: поток наблюдения получает событие (inotify IN_CLOSE_WRITE/IN_MOVED_TO по папке или
+// изменившееся время файла при опросе) -> ждёт HOTRELOAD_DEBOUNCE_MS тишины, собирая пачку путей ->
+// на каждую пару (путь, обработчик) создаётся задача импорта -> импорт выполняется задачей JobSystem ->
+// готовая задача кладётся в очередь -> HotReload_poll в главном потоке применяет её ко всем ресурсам
+// этого файла и освобождает данные. Номер задачи не даёт устаревшему импорту перезаписать более новый.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "libs.h"
+#include "array.h"
+#include "logger.h"
+#include "time.h"
+#include "jobsystem.h"
+#include "counters.h"
+#include "vfs.h"
+#include "hotreload.h"
+#include <sys/stat.h>
+
+#if defined(__linux__) && !defined(CGDF_HOTRELOAD_NO_INOTIFY) && __has_include(<sys/inotify.h>)
+    #define HOTRELOAD_HAS_INOTIFY 1
+    #include <sys/inotify.h>
+    #include <poll.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#else
+    #define HOTRELOAD_HAS_INOTIFY 0
+#endif
+
+
+// Наблюдаемый ресурс:
+typedef struct HotReloadEntry {
+    char *path;                         // Нормализованный путь к файлу.
+    const HotReloadHandler *handler;    // Обработчик вида ресурса.
+    void *target;                       // Ресурс.
+    intptr_t tag;                       // Данные для apply.
+    uint64_t applied_seq;               // Номер последней применённой задачи.
+    int64_t mtime;                      // Время изменения в нс (для опроса без inotify).
+    int64_t size;                       // Размер файла (для опроса без inotify).
+} HotReloadEntry;
+
+
+// Наблюдаемая папка (inotify):
+typedef struct HotReloadDir {
+    int wd;      // Дескриптор наблюдения.
+    char *path;  // Путь к папке.
+} HotReloadDir;
+
+
+// Задача импорта:
+typedef struct HotReloadTask {
+    struct HotReloadTask *next;        // Следующая задача в очереди.
+    char *path;                        // Путь к файлу.
+    const HotReloadHandler *handler;   // Обработчик.
+    void *data;                        // Результат импорта.
+    uint64_t seq;                      // Номер задачи.
+    uint64_t changed_ns;               // Когда заметили изменение.
+} HotReloadTask;
+
+
+// Состояние сервиса:
+typedef struct HotReloadState {
+    bool initialized;        // Запущен ли сервис.
+    bool running;            // Поток наблюдения должен продолжать работу.
+    bool inotify;            // Используется inotify.
+    mtx_t mutex;             // Защищает всё ниже.
+    cnd_t wake_cond;         // Разбудить поток опроса.
+    cnd_t idle_cond;         // Импорт закончился.
+    Array *entries;          // Наблюдаемые ресурсы (HotReloadEntry).
+    Array *dirs;             // Наблюдаемые папки (HotReloadDir).
+    HotReloadTask *done_head, *done_tail;  // Готовые задачи для главного потока.
+    size_t in_flight;        // Сколько импортов выполняется.
+    uint64_t seq;            // Счётчик номеров задач.
+    thrd_t thread;           // Поток наблюдения.
+    #if HOTRELOAD_HAS_INOTIFY
+        int fd;              // Дескриптор inotify.
+        int wake_pipe[2];    // Канал для остановки потока.
+    #endif
+} HotReloadState;
+
+
+// Состояние сервиса:
+static HotReloadState g_HotReload;
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Прочитать время изменения и размер файла:
+static bool file_stat(const char *path, int64_t *out_mtime, int64_t *out_size) {
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+    #if defined(__APPLE__)
+        *out_mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+    #elif defined(__linux__)
+        *out_mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    #else
+        *out_mtime = (int64_t)st.st_mtime * 1000000000;  // Только секунды - спасает размер файла.
+    #endif
+    *out_size = (int64_t)st.st_size;
+    return true;
+}
+
+// Выполнить импорт (задача JobSystem или поток наблюдения):
+static int import_job(void *args) {
+    HotReloadTask *task = (HotReloadTask*)args;
+    task->data = task->handler->import(task->path);
+
+    mtx_lock(&g_HotReload.mutex);
+    task->next = NULL;
+    if (g_HotReload.done_tail) g_HotReload.done_tail->next = task;
+    else g_HotReload.done_head = task;
+    g_HotReload.done_tail = task;
+    g_HotReload.in_flight--;
+    cnd_broadcast(&g_HotReload.idle_cond);
+    mtx_unlock(&g_HotReload.mutex);
+    return 0;
+}
+
+// Запустить импорт изменившегося файла (по одной задаче на каждый вид ресурса с этим путём):
+static void dispatch_path(const char *path, uint64_t changed_ns) {
+    HotReloadTask *tasks = NULL;
+
+    mtx_lock(&g_HotReload.mutex);
+    for (size_t i = 0; i < Array_len(g_HotReload.entries); i++) {
+        HotReloadEntry *entry = (HotReloadEntry*)Array_get(g_HotReload.entries, i);
+        if (strcmp(entry->path, path) != 0) continue;
+
+        // Этот вид уже импортируется для этого пути:
+        bool found = false;
+        for (HotReloadTask *t = tasks; t; t = t->next) found = found || t->handler == entry->handler;
+        if (found) continue;
+
+        HotReloadTask *task = (HotReloadTask*)mm_calloc(1, sizeof(HotReloadTask));
+        task->path = mm_strdup(path);
+        task->handler = entry->handler;
+        task->seq = ++g_HotReload.seq;
+        task->changed_ns = changed_ns;
+        task->next = tasks;
+        tasks = task;
+        g_HotReload.in_flight++;
+    }
+    mtx_unlock(&g_HotReload.mutex);
+
+    // Импортируем задачами JobSystem (без неё - прямо в потоке наблюдения, он и так не главный):
+    while (tasks) {
+        HotReloadTask *task = tasks;
+        tasks = task->next;
+        if (g_JobSystem.initialized) JobSystem_create_job(import_job, task);
+        else import_job(task);
+    }
+}
+
+// Добавить путь в пачку изменений (без повторов):
+static void add_changed(Array *changed, const char *path) {
+    for (size_t i = 0; i < Array_len(changed); i++) {
+        if (strcmp((const char*)Array_get_ptr(changed, i), path) == 0) return;
+    }
+    char *copy = mm_strdup(path);
+    Array_push(changed, &copy);
+}
+
+// Запустить импорт всей пачки изменений:
+static void dispatch_changed(Array *changed, uint64_t changed_ns) {
+    for (size_t i = 0; i < Array_len(changed); i++) {
+        char *path = (char*)Array_get_ptr(changed, i);
+        dispatch_path(path, changed_ns);
+        mm_free(path);
+    }
+    Array_clear(changed, false);
+}
+
+// Поток опроса времени изменения файлов (без inotify):
+static int poll_thread(void *args) {
+    (void)args;  // Не используется.
+    Array *changed = Array_create(sizeof(char*), 16);
+
+    mtx_lock(&g_HotReload.mutex);
+    while (g_HotReload.running) {
+        struct timespec ts;
+        timespec_get(&ts, TIME_UTC);
+        ts.tv_nsec += HOTRELOAD_POLL_MS * 1000000L;
+        ts.tv_sec += ts.tv_nsec / 1000000000L;
+        ts.tv_nsec %= 1000000000L;
+        cnd_timedwait(&g_HotReload.wake_cond, &g_HotReload.mutex, &ts);
+        if (!g_HotReload.running) break;
+
+        // Ищем файлы с новым временем изменения или размером:
+        for (size_t i = 0; i < Array_len(g_HotReload.entries); i++) {
+            HotReloadEntry *entry = (HotReloadEntry*)Array_get(g_HotReload.entries, i);
+            int64_t mtime, size;
+            if (!file_stat(entry->path, &mtime, &size)) continue;
+            if (mtime == entry->mtime && size == entry->size) continue;
+            entry->mtime = mtime;
+            entry->size = size;
+            add_changed(changed, entry->path);
+        }
+        if (Array_len(changed) == 0) continue;
+
+        mtx_unlock(&g_HotReload.mutex);
+        dispatch_changed(changed, Time_get_ns());
+        mtx_lock(&g_HotReload.mutex);
+    }
+    mtx_unlock(&g_HotReload.mutex);
+
+    Array_destroy(&changed);
+    return 0;
+}
+
+#if HOTRELOAD_HAS_INOTIFY
+// Разобрать события inotify в пачку изменений:
+static void read_events(Array *changed) {
+    _Alignas(struct inotify_event) char buffer[16 * 1024];
+    ssize_t length;
+    while ((length = read(g_HotReload.fd, buffer, sizeof(buffer))) > 0) {
+        for (char *p = buffer; p < buffer + length; ) {
+            const struct inotify_event *event = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0) continue;
+
+            // Собираем путь к файлу из папки и имени:
+            char joined[VFS_MAX_PATH];
+            char path[VFS_MAX_PATH];
+            bool ok = false;
+            mtx_lock(&g_HotReload.mutex);
+            for (size_t i = 0; i < Array_len(g_HotReload.dirs); i++) {
+                HotReloadDir *dir = (HotReloadDir*)Array_get(g_HotReload.dirs, i);
+                if (dir->wd != event->wd) continue;
+                int n = snprintf(joined, sizeof(joined), "%s/%s", dir->path, event->name);
+                ok = n > 0 && (size_t)n < sizeof(joined);
+                break;
+            }
+            mtx_unlock(&g_HotReload.mutex);
+            if (ok && VFS_normalize_path(joined, path, sizeof(path))) add_changed(changed, path);
+        }
+    }
+}
+
+// Поток наблюдения через inotify:
+static int inotify_thread(void *args) {
+    (void)args;  // Не используется.
+    Array *changed = Array_create(sizeof(char*), 16);
+    uint64_t changed_ns = 0;
+
+    while (true) {
+        struct pollfd fds[2] = {
+            { .fd = g_HotReload.fd, .events = POLLIN },
+            { .fd = g_HotReload.wake_pipe[0], .events = POLLIN },
+        };
+
+        // Пока пачка не пуста, ждём тишины не дольше HOTRELOAD_DEBOUNCE_MS:
+        int timeout = Array_len(changed) > 0 ? HOTRELOAD_DEBOUNCE_MS : -1;
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0) continue;  // EINTR.
+        if (fds[1].revents) break;
+        if (ready == 0) {
+            dispatch_changed(changed, changed_ns);
+            continue;
+        }
+        if (Array_len(changed) == 0) changed_ns = Time_get_ns();
+        read_events(changed);
+    }
+
+    for (size_t i = 0; i < Array_len(changed); i++) mm_free(Array_get_ptr(changed, i));
+    Array_destroy(&changed);
+    return 0;
+}
+#endif
+
+// Следит ли ещё ресурс за файлом с этим обработчиком (вызывать под мьютексом):
+static bool is_watched(void *target, const HotReloadHandler *handler, const char *path) {
+    for (size_t i = 0; i < Array_len(g_HotReload.entries); i++) {
+        HotReloadEntry *entry = (HotReloadEntry*)Array_get(g_HotReload.entries, i);
+        if (entry->target == target && entry->handler == handler && strcmp(entry->path, path) == 0) return true;
+    }
+    return false;
+}
+
+// Папка файла (для наблюдения). Возвращает false если путь слишком длинный:
+static bool dir_of(const char *path, char *out, size_t out_size) {
+    const char *slash = strrchr(path, '/');
+    if (!slash) return snprintf(out, out_size, ".") > 0;
+    size_t len = slash == path ? 1 : (size_t)(slash - path);  // "/file" -> "/".
+    if (len + 1 > out_size) return false;
+    memcpy(out, path, len);
+    out[len] = '\0';
+    return true;
+}
+
+
+// -------- API горячей перезагрузки: --------
+
+
+// Инициализация (запускает поток наблюдения):
+void HotReload_init(void) {
+    if (g_HotReload.initialized) return;
+    mtx_init(&g_HotReload.mutex, mtx_plain);
+    cnd_init(&g_HotReload.wake_cond);
+    cnd_init(&g_HotReload.idle_cond);
+    g_HotReload.entries = Array_create(sizeof(HotReloadEntry), 64);
+    g_HotReload.dirs = Array_create(sizeof(HotReloadDir), 16);
+    g_HotReload.done_head = g_HotReload.done_tail = NULL;
+    g_HotReload.in_flight = 0;
+    g_HotReload.seq = 0;
+    g_HotReload.running = true;
+    g_HotReload.inotify = false;
+    g_HotReload.initialized = true;
+
+    // Пробуем inotify:
+    #if HOTRELOAD_HAS_INOTIFY
+        g_HotReload.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (g_HotReload.fd >= 0 && pipe(g_HotReload.wake_pipe) == 0) {
+            if (thrd_create(&g_HotReload.thread, inotify_thread, NULL) == thrd_success) {
+                g_HotReload.inotify = true;
+                return;
+            }
+            close(g_HotReload.wake_pipe[0]);
+            close(g_HotReload.wake_pipe[1]);
+        }
+        if (g_HotReload.fd >= 0) close(g_HotReload.fd);
+        g_HotReload.fd = -1;
+    #endif
+
+    // Иначе опрос файлов:
+    if (thrd_create(&g_HotReload.thread, poll_thread, NULL) != thrd_success) {
+        log_msg("[E] HotReload_init: Failed to create watcher thread.\n");
+        g_HotReload.running = false;
+    }
+}
+
+
+// Уничтожение (снимает все наблюдения, непримененные данные освобождаются):
+void HotReload_destroy(void) {
+    if (!g_HotReload.initialized) return;
+
+    // Останавливаем поток наблюдения и дожидаемся импортов:
+    bool had_thread = g_HotReload.running;
+    mtx_lock(&g_HotReload.mutex);
+    g_HotReload.running = false;
+    cnd_broadcast(&g_HotReload.wake_cond);
+    mtx_unlock(&g_HotReload.mutex);
+    #if HOTRELOAD_HAS_INOTIFY
+        if (g_HotReload.inotify) {
+            char byte = 0;
+            if (write(g_HotReload.wake_pipe[1], &byte, 1) < 0) {}
+        }
+    #endif
+    if (had_thread) thrd_join(g_HotReload.thread, NULL);
+    HotReload_wait_imports();
+
+    // Освобождаем готовые задачи:
+    while (g_HotReload.done_head) {
+        HotReloadTask *task = g_HotReload.done_head;
+        g_HotReload.done_head = task->next;
+        if (task->data) task->handler->release(task->data);
+        mm_free(task->path);
+        mm_free(task);
+    }
+    g_HotReload.done_tail = NULL;
+
+    // Освобождаем наблюдения:
+    for (size_t i = 0; i < Array_len(g_HotReload.entries); i++) {
+        mm_free(((HotReloadEntry*)Array_get(g_HotReload.entries, i))->path);
+    }
+    for (size_t i = 0; i < Array_len(g_HotReload.dirs); i++) {
+        mm_free(((HotReloadDir*)Array_get(g_HotReload.dirs, i))->path);
+    }
+    Array_destroy(&g_HotReload.entries);
+    Array_destroy(&g_HotReload.dirs);
+    #if HOTRELOAD_HAS_INOTIFY
+        if (g_HotReload.inotify) {
+            close(g_HotReload.wake_pipe[0]);
+            close(g_HotReload.wake_pipe[1]);
+            close(g_HotReload.fd);
+        }
+    #endif
+
+    cnd_destroy(&g_HotReload.idle_cond);
+    cnd_destroy(&g_HotReload.wake_cond);
+    mtx_destroy(&g_HotReload.mutex);
+    g_HotReload.inotify = false;
+    g_HotReload.initialized = false;
+}
+
+
+// Запущена ли горячая перезагрузка:
+bool HotReload_is_running(void) {
+    return g_HotReload.initialized && g_HotReload.running;
+}
+
+
+// Следить за файлом ресурса (tag передаётся в apply как есть):
+bool HotReload_watch(const char *file_path, const HotReloadHandler *handler, void *target, intptr_t tag) {
+    if (!HotReload_is_running() || !file_path || !handler || !target) return false;
+    char path[VFS_MAX_PATH];
+    char dir[VFS_MAX_PATH];
+    if (!VFS_normalize_path(file_path, path, sizeof(path)) || !dir_of(path, dir, sizeof(dir))) {
+        log_msg("[E] HotReload_watch: Bad path \"%s\".\n", file_path);
+        return false;
+    }
+
+    HotReloadEntry entry = {
+        .path = mm_strdup(path), .handler = handler, .target = target, .tag = tag, .applied_seq = 0,
+    };
+    if (!file_stat(path, &entry.mtime, &entry.size)) {
+        entry.mtime = 0;
+        entry.size = -1;  // Файла пока нет - первое появление тоже будет изменением.
+    }
+
+    mtx_lock(&g_HotReload.mutex);
+    entry.applied_seq = g_HotReload.seq;  // Уже начатые импорты старше этого ресурса.
+    Array_push(g_HotReload.entries, &entry);
+
+    // Ставим наблюдение на папку (inotify отдаёт тот же wd для уже наблюдаемой папки):
+    #if HOTRELOAD_HAS_INOTIFY
+        if (g_HotReload.inotify) {
+            int wd = inotify_add_watch(g_HotReload.fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+            bool known = wd < 0;
+            for (size_t i = 0; !known && i < Array_len(g_HotReload.dirs); i++) {
+                known = ((HotReloadDir*)Array_get(g_HotReload.dirs, i))->wd == wd;
+            }
+            if (wd < 0) log_msg("[W] HotReload_watch: Can't watch directory \"%s\".\n", dir);
+            if (!known) Array_push(g_HotReload.dirs, &(HotReloadDir){ .wd = wd, .path = mm_strdup(dir) });
+        }
+    #endif
+    mtx_unlock(&g_HotReload.mutex);
+    return true;
+}
+
+
+// Перестать следить за всеми файлами ресурса:
+void HotReload_unwatch(void *target) {
+    if (!g_HotReload.initialized || !target) return;
+    mtx_lock(&g_HotReload.mutex);
+    for (size_t i = Array_len(g_HotReload.entries); i-- > 0; ) {
+        HotReloadEntry *entry = (HotReloadEntry*)Array_get(g_HotReload.entries, i);
+        if (entry->target != target) continue;
+        mm_free(entry->path);
+        Array_remove(g_HotReload.entries, i, NULL);
+    }
+    mtx_unlock(&g_HotReload.mutex);
+}
+
+
+// Применить готовые перезагрузки (главный поток, граница кадра). Возвращает сколько ресурсов обновлено:
+size_t HotReload_poll(void) {
+    if (!g_HotReload.initialized) return 0;
+
+    // Забираем всю очередь разом:
+    mtx_lock(&g_HotReload.mutex);
+    HotReloadTask *task = g_HotReload.done_head;
+    g_HotReload.done_head = g_HotReload.done_tail = NULL;
+    mtx_unlock(&g_HotReload.mutex);
+
+    size_t total = 0;
+    Array *targets = task ? Array_create(sizeof(HotReloadEntry), 8) : NULL;  // Ресурсы файла (копии записей).
+    while (task) {
+        HotReloadTask *next = task->next;
+        if (!task->data) {
+            log_msg("[W] HotReload: Failed to import \"%s\" (%s).\n", task->path, task->handler->name);
+        } else {
+            // Под блокировкой собираем ресурсы этого файла, а применяем уже без неё (apply может вызывать
+            // watch и unwatch, поэтому перед каждым применением проверяем, что ресурс ещё наблюдается):
+            mtx_lock(&g_HotReload.mutex);
+            for (size_t i = 0; i < Array_len(g_HotReload.entries); i++) {
+                HotReloadEntry *entry = (HotReloadEntry*)Array_get(g_HotReload.entries, i);
+                if (entry->handler != task->handler || entry->applied_seq >= task->seq) continue;
+                if (strcmp(entry->path, task->path) != 0) continue;
+                entry->applied_seq = task->seq;
+                Array_push(targets, entry);
+            }
+            mtx_unlock(&g_HotReload.mutex);
+
+            size_t applied = 0;
+            for (size_t i = 0; i < Array_len(targets); i++) {
+                HotReloadEntry *entry = (HotReloadEntry*)Array_get(targets, i);
+                mtx_lock(&g_HotReload.mutex);
+                bool watched = is_watched(entry->target, task->handler, task->path);
+                mtx_unlock(&g_HotReload.mutex);
+                if (watched && task->handler->apply(entry->target, task->data, entry->tag)) applied++;
+            }
+            Array_clear(targets, false);
+            if (applied > 0) {
+                log_msg(
+                    "[I] HotReload: Reloaded \"%s\" (%s x%zu, %.2f ms after change).\n", task->path,
+                    task->handler->name, applied, Time_ns_to_ms(Time_get_ns() - task->changed_ns)
+                );
+            }
+            total += applied;
+            task->handler->release(task->data);
+        }
+        mm_free(task->path);
+        mm_free(task);
+        task = next;
+    }
+    if (targets) Array_destroy(&targets);
+    COUNTER_ADD("hotreload.applied", total);
+    return total;
+}
+
+
+// Дождаться пока все начатые импорты закончатся (не применяет их):
+void HotReload_wait_imports(void) {
+    if (!g_HotReload.initialized) return;
+    mtx_lock(&g_HotReload.mutex);
+    while (g_HotReload.in_flight > 0) cnd_wait(&g_HotReload.idle_cond, &g_HotReload.mutex);
+    mtx_unlock(&g_HotReload.mutex);
+}
+
+
+// Получить количество наблюдаемых ресурсов:
+size_t HotReload_get_watch_count(void) {
+    if (!g_HotReload.initialized) return 0;
+    mtx_lock(&g_HotReload.mutex);
+    size_t count = Array_len(g_HotReload.entries);
+    mtx_unlock(&g_HotReload.mutex);
+    return count;
+}
+
+
+// Используется ли inotify:
+bool HotReload_is_inotify(void) {
+    return g_HotReload.inotify;
+}
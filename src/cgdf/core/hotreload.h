@@ -0,0 +1,72 @@
+//
+// hotreload.h - Горячая перезагрузка ассетов при изменении файлов на диске.
+//
+// Ресурс регистрируется вместе с путём к файлу и обработчиком своего вида (текстура, шейдер, модель).
+// Поток наблюдения следит за папками зарегистрированных файлов (inotify на Linux, на других ОС - опрос
+// времени изменения файлов) и на каждое изменение запускает импорт файла в фоне (задачей JobSystem или
+// прямо в потоке наблюдения). Готовые данные применяются к ресурсам в главном потоке на границе кадра
+// (HotReload_poll, его вызывает цикл окна), поэтому рендерер видит уже подменённый ресурс.
+// Один и тот же файл одного вида импортируется один раз, даже если на него ссылается несколько ресурсов.
+//
+// Загрузчики (Texture_load, Shader_load, ObjLoader_load) сами регистрируют ресурсы, если наблюдение
+// запущено (HotReload_init до загрузки), а функции уничтожения снимают их с наблюдения.
+// Файлы из смонтированных пакетов (vfs.h) перекрывают файлы на диске, поэтому при разработке пакеты
+// лучше не монтировать.
+//
+// define CGDF_HOTRELOAD_NO_INOTIFY - Не использовать inotify (всегда опрос файлов).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+
+
+// Определения:
+#define HOTRELOAD_DEBOUNCE_MS 2    // Сколько ждать тишины после события, чтобы собрать пачку изменений.
+#define HOTRELOAD_POLL_MS     250  // Период опроса файлов без inotify.
+
+
+// Объявление структур:
+typedef struct HotReloadHandler HotReloadHandler;  // Обработчик вида ресурсов.
+
+
+// Обработчик вида ресурсов:
+struct HotReloadHandler {
+    const char *name;                                        // Название вида (для лога).
+    void* (*import)(const char *path);                       // Импорт файла (фоновый поток). NULL - ошибка.
+    bool  (*apply)(void *target, void *data, intptr_t tag);  // Применить данные к ресурсу (главный поток).
+    void  (*release)(void *data);                            // Освободить данные импорта.
+};
+
+
+// -------- API горячей перезагрузки: --------
+
+
+// Инициализация (запускает поток наблюдения):
+void HotReload_init(void);
+
+// Уничтожение (снимает все наблюдения, непримененные данные освобождаются):
+void HotReload_destroy(void);
+
+// Запущена ли горячая перезагрузка:
+bool HotReload_is_running(void);
+
+// Следить за файлом ресурса (tag передаётся в apply как есть):
+bool HotReload_watch(const char *file_path, const HotReloadHandler *handler, void *target, intptr_t tag);
+
+// Перестать следить за всеми файлами ресурса:
+void HotReload_unwatch(void *target);
+
+// Применить готовые перезагрузки (главный поток, граница кадра). Возвращает сколько ресурсов обновлено:
+size_t HotReload_poll(void);
+
+// Дождаться пока все начатые импорты закончатся (не применяет их):
+void HotReload_wait_imports(void);
+
+// Получить количество наблюдаемых ресурсов:
+size_t HotReload_get_watch_count(void);
+
+// Используется ли inotify:
+bool HotReload_is_inotify(void);
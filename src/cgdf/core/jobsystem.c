@@ -10,6 +10,8 @@
 #include "logger.h"
 #include "libs.h"
 #include "info.h"
+#include "profiler.h"
+#include "counters.h"
 #include "jobsystem.h"
 
 
@@ -17,6 +19,20 @@
 JobSystem g_JobSystem;
 
 
+// Общие данные JobSystem_parallel_for (освобождает последний владелец):
+typedef struct JobParallelFor {
+    JobBandFunction func;       // Функция полосы.
+    void *args;                 // Аргумент функции.
+    size_t bands;               // Количество полос.
+    atomic_size_t next_band;    // Следующая незанятая полоса.
+    atomic_size_t next_worker;  // Номер следующего помощника.
+    atomic_size_t refs;         // Владельцы: вызывающий поток и задачи-помощники.
+    size_t done;                // Сколько полос готово (под mutex).
+    mtx_t mutex;                // Мьютекс для done.
+    cnd_t finished;             // Сигнал, что все полосы готовы.
+} JobParallelFor;
+
+
 // Внутренняя функция потока, выполняющая задачи в цикле:
 static int _JobSystem_task_work_(void *args) {
     (void)args;  // Не используется.
@@ -30,7 +46,10 @@ static int _JobSystem_task_work_(void *args) {
             // Стек не пуст. Извлекаем самую старую задачу и удаляем из стека:
             Array_remove(g_JobSystem.stack, 0, &current_job);
             mtx_unlock(&g_JobSystem.mutex);
+            PROFILE_BEGIN(job_zone, "JobSystem job");
             int result = current_job.function(current_job.args);
+            PROFILE_END(job_zone);
+            COUNTER_INC("jobs.executed");
             if (result != 0) log_msg("[E] JobSystem: Task returned error: %d\n", result);
         } else {
             // Стек пуст. Этот поток больше не нужен. Завершаем и самоликвидируемся:
@@ -43,6 +62,41 @@ static int _JobSystem_task_work_(void *args) {
 }
 
 
+// Отпустить общие данные JobSystem_parallel_for (последний владелец их освобождает):
+static void parallel_for_release(JobParallelFor *ctx) {
+    if (atomic_fetch_sub(&ctx->refs, 1) != 1) return;
+    mtx_destroy(&ctx->mutex);
+    cnd_destroy(&ctx->finished);
+    mm_free(ctx);
+}
+
+
+// Забирать и выполнять полосы, пока они не закончатся:
+static void parallel_for_run(JobParallelFor *ctx, size_t worker) {
+    size_t finished = 0;
+    while (true) {
+        size_t band = atomic_fetch_add(&ctx->next_band, 1);
+        if (band >= ctx->bands) break;
+        ctx->func(ctx->args, band, worker);
+        finished++;
+    }
+    if (finished == 0) return;
+    mtx_lock(&ctx->mutex);
+    ctx->done += finished;
+    if (ctx->done == ctx->bands) cnd_signal(&ctx->finished);
+    mtx_unlock(&ctx->mutex);
+}
+
+
+// Задача-помощник JobSystem_parallel_for:
+static int parallel_for_job(void *args) {
+    JobParallelFor *ctx = (JobParallelFor*)args;
+    parallel_for_run(ctx, atomic_fetch_add(&ctx->next_worker, 1));
+    parallel_for_release(ctx);
+    return 0;
+}
+
+
 // Инициализация работы с задачами (потоками):
 void JobSystem_init(void) {
     if (g_JobSystem.initialized) return;
@@ -129,3 +183,37 @@ size_t JobSystem_get_max_workers_count(void) {
     if (!g_JobSystem.initialized) return 0;
     return g_JobSystem.max_workers_count;
 }
+
+
+// Выполнить func для полос 0..bands-1 на workers потоках (0 - все потоки JobSystem) и дождаться всех:
+void JobSystem_parallel_for(size_t bands, size_t workers, JobBandFunction func, void *args) {
+    if (bands == 0 || !func) return;
+    if (workers == 0) workers = JobSystem_get_max_workers_count();
+    if (!g_JobSystem.initialized || workers < 1) workers = 1;
+    if (workers > bands) workers = bands;
+    if (workers == 1) {  // Без помощников не нужны ни общие данные, ни ожидание:
+        for (size_t band = 0; band < bands; band++) func(args, band, 0);
+        return;
+    }
+
+    JobParallelFor *ctx = (JobParallelFor*)mm_alloc(sizeof(JobParallelFor));
+    ctx->func = func;
+    ctx->args = args;
+    ctx->bands = bands;
+    atomic_init(&ctx->next_band, 0);
+    atomic_init(&ctx->next_worker, 1);
+    atomic_init(&ctx->refs, workers);
+    ctx->done = 0;
+    mtx_init(&ctx->mutex, mtx_plain);
+    cnd_init(&ctx->finished);
+    for (size_t i = 1; i < workers; i++) JobSystem_create_job(parallel_for_job, ctx);
+
+    // Вызывающий поток тоже работает, а потом ждёт полосы, взятые помощниками. Поэтому вызов не зависит
+    // от того, начнут ли помощники (например, из задачи при занятых потоках), а опоздавшие помощники
+    // просто найдут пустую очередь и отпустят данные:
+    parallel_for_run(ctx, 0);
+    mtx_lock(&ctx->mutex);
+    while (ctx->done < ctx->bands) cnd_wait(&ctx->finished, &ctx->mutex);
+    mtx_unlock(&ctx->mutex);
+    parallel_for_release(ctx);
+}
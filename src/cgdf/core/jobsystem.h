@@ -20,6 +20,7 @@
 
 // Определения:
 typedef int (*JobFunction)(void *args);  // Указатель на функцию, которую мы будем выполнять.
+typedef void (*JobBandFunction)(void *args, size_t band, size_t worker);  // Функция полосы для JobSystem_parallel_for.
 
 
 // Объявление структур:
@@ -57,6 +58,11 @@ void JobSystem_destroy(void);
 // Создать задачу:
 void JobSystem_create_job(JobFunction func, void *args);
 
+// Выполнить func для полос 0..bands-1 на workers потоках (0 - все потоки JobSystem) и дождаться всех.
+// Вызывающий поток работает как worker 0, помощники получают номера 1..workers-1 (их бывает меньше,
+// чем просили). Полосы раздаются строго по возрастанию номера. Без JobSystem всё делает вызывающий поток:
+void JobSystem_parallel_for(size_t bands, size_t workers, JobBandFunction func, void *args);
+
 // Есть ли ещё работающие задачи:
 bool JobSystem_has_active_jobs(void);
 
@@ -10,12 +10,31 @@
 // [GL] - OpenGL.
 // [Тег отсутствует] - Message.
 //
+// Очередь сообщений - кольцевой буфер на много писателей и одного читателя. Каждая ячейка хранит номер
+// последовательности: писатель захватывает ячейку атомарным CAS, форматирует текст прямо в неё и
+// публикует номером. Фоновый поток забирает готовые ячейки по порядку и пишет их пачкой в открытый
+// файл и в консоль. Время берётся из монотонных часов, а в часы дня переводится уже фоновым потоком.
+// Если логгер не запущен (до Logger_init или после Logger_destroy), сообщения пишутся сразу.
+//
+// Двоичные записи идут через ту же очередь, но фоновый поток не форматирует их, а дописывает в
+// LOG_BIN_FILE_PATH байт в байт. Формат файла (little-endian):
+//   Заголовок: "CGDFBLOG", u32 версия, u64 base_ns, u64 base_day_ms (время дня на момент base_ns).
+//   Запись формата:    u8 1, u32 id, u16 длина, байты строки формата.
+//   Запись сообщения:  u8 2, u32 id, u64 time_ns, u8 argc, затем argc раз: u8 тип (LogArgType) и
+//                      значение (8 байт, а для строки u16 длина и байты строки).
+// Строки форматов хранятся в реестре логгера: сразу после заголовка (в том числе нового файла после
+// повторного Logger_init) пишутся все известные форматы, а формат, выданный при запущенном логгере,
+// ещё и попадает в очередь раньше первого сообщения с ним. Повтор описания в файле безвреден.
+// Двоичные записи без запущенного логгера отбрасываются.
+//
 
 
 // Подключаем:
 #include "constants.h"
 #include "std.h"
 #include "time.h"
+#include "mm.h"
+#include "libs.h"
 #include "logger.h"
 
 #ifdef _WIN32
@@ -25,6 +44,247 @@
 #endif
 
 
+// Определения:
+#define LOG_BIN_VERSION       1  // Версия формата двоичного лога.
+#define LOG_BIN_RECORD_FORMAT 1  // Запись с описанием строки формата.
+#define LOG_BIN_RECORD_MSG    2  // Запись сообщения.
+
+
+// Ячейка кольцевого буфера:
+typedef struct LoggerSlot {
+    atomic_size_t sequence;       // Номер последовательности (готовность ячейки).
+    bool binary;                  // Двоичная запись (пишется в двоичный лог как есть).
+    uint64_t time_ns;             // Время сообщения по монотонным часам.
+    size_t length;                // Длина текста.
+    char *heap;                   // Текст длинного сообщения (или NULL).
+    char text[LOGGER_MSG_SIZE];   // Текст сообщения.
+} LoggerSlot;
+
+
+// Состояние логгера:
+typedef struct LoggerState {
+    atomic_bool running;          // Работает ли фоновый поток.
+    atomic_bool sleeping;         // Фоновый поток ждёт новых сообщений.
+    atomic_flag busy;             // Кто-то сейчас разбирает очередь (фоновый поток или обработчик вылета).
+    thrd_t thread;                // Фоновый поток записи.
+    mtx_t mutex;                  // Мьютекс для ожидания сообщений.
+    cnd_t cond;                   // Сигнал о новых сообщениях.
+    FILE *file;                   // Открытый лог-файл.
+    FILE *bin_file;               // Открытый двоичный лог (открывается при первой двоичной записи).
+    bool bin_failed;              // Двоичный лог не удалось открыть.
+    atomic_flag formats_lock;     // Защита реестра форматов.
+    uint32_t formats_count;       // Последний выданный номер строки формата.
+    const char *formats[LOG_BIN_MAX_FORMATS];  // Реестр строк форматов (номер - индекс + 1).
+    uint64_t base_ns;             // Монотонное время при запуске.
+    uint64_t base_day_ms;         // Время дня при запуске (мс с полуночи, по местному времени).
+    atomic_size_t enqueue_pos;    // Следующая ячейка для записи.
+    atomic_size_t dequeue_pos;    // Следующая ячейка для чтения.
+    atomic_size_t written_pos;    // Сколько сообщений уже записано и сброшено на диск.
+    LoggerSlot ring[LOGGER_RING_SIZE];  // Кольцевой буфер.
+} LoggerState;
+
+
+// Текущий минимальный уровень во время работы:
+LogLevel g_LogLevel = LOG_LEVEL_INFO;
+
+// Состояние логгера:
+static LoggerState g_Logger = { .busy = ATOMIC_FLAG_INIT, .formats_lock = ATOMIC_FLAG_INIT };
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Записать строку в консоль и файл с префиксом времени:
+static void write_line(FILE *file, uint32_t day_ms, const char *text, size_t length) {
+    char prefix[24];
+    int n = snprintf(
+        prefix, sizeof(prefix), "[%02u:%02u:%02u.%03u]: ",
+        day_ms / 3600000, day_ms / 60000 % 60, day_ms / 1000 % 60, day_ms % 1000
+    );
+    fwrite(prefix, 1, (size_t)n, stdout);
+    fwrite(text, 1, length, stdout);
+    if (file) {
+        fwrite(prefix, 1, (size_t)n, file);
+        fwrite(text, 1, length, file);
+    }
+}
+
+// Заполнить запись формата (u8 тип, u32 id, u16 длина, строка). Возвращает размер записи (out = NULL - только размер):
+static size_t encode_format(char *out, uint32_t id, const char *fmt) {
+    size_t fmt_len = strlen(fmt);
+    if (fmt_len > UINT16_MAX) fmt_len = UINT16_MAX;
+    if (out) {
+        uint16_t len16 = (uint16_t)fmt_len;
+        out[0] = LOG_BIN_RECORD_FORMAT;
+        memcpy(out + 1, &id, sizeof(id));
+        memcpy(out + 5, &len16, sizeof(len16));
+        memcpy(out + 7, fmt, fmt_len);
+    }
+    return 1 + sizeof(uint32_t) + sizeof(uint16_t) + fmt_len;
+}
+
+// Записать в двоичный лог все строки форматов из реестра:
+static void write_formats(FILE *file) {
+    while (atomic_flag_test_and_set_explicit(&g_Logger.formats_lock, memory_order_acquire)) thrd_yield();
+    uint32_t count = g_Logger.formats_count < LOG_BIN_MAX_FORMATS ? g_Logger.formats_count : LOG_BIN_MAX_FORMATS;
+    for (uint32_t id = 1; id <= count; id++) {
+        char head[1 + sizeof(uint32_t) + sizeof(uint16_t)];
+        size_t size = encode_format(head, id, "");
+        size_t fmt_len = strlen(g_Logger.formats[id - 1]);
+        uint16_t len16 = (uint16_t)(fmt_len > UINT16_MAX ? UINT16_MAX : fmt_len);
+        memcpy(head + 5, &len16, sizeof(len16));
+        fwrite(head, 1, size, file);
+        fwrite(g_Logger.formats[id - 1], 1, len16, file);
+    }
+    atomic_flag_clear_explicit(&g_Logger.formats_lock, memory_order_release);
+}
+
+
+// Дописать двоичную запись в двоичный лог (файл открывается при первой записи):
+static void write_binary(const char *data, size_t length) {
+    #ifdef CGDF_DISABLE_LOG_FILE
+        (void)data; (void)length;
+        return;
+    #else
+        if (!g_Logger.bin_file) {
+            if (g_Logger.bin_failed) return;
+            g_Logger.bin_file = fopen(LOG_BIN_FILE_PATH, "wb");
+            if (!g_Logger.bin_file) { g_Logger.bin_failed = true; return; }
+            uint32_t version = LOG_BIN_VERSION;
+            fwrite("CGDFBLOG", 1, 8, g_Logger.bin_file);
+            fwrite(&version, sizeof(version), 1, g_Logger.bin_file);
+            fwrite(&g_Logger.base_ns, sizeof(uint64_t), 1, g_Logger.bin_file);
+            fwrite(&g_Logger.base_day_ms, sizeof(uint64_t), 1, g_Logger.bin_file);
+            write_formats(g_Logger.bin_file);
+        }
+        fwrite(data, 1, length, g_Logger.bin_file);
+    #endif
+}
+
+// Перевести монотонное время в миллисекунды текущего дня:
+static inline uint32_t day_ms_from_ns(uint64_t time_ns) {
+    uint64_t elapsed_ms = (time_ns - g_Logger.base_ns) / 1000000;
+    return (uint32_t)((g_Logger.base_day_ms + elapsed_ms) % 86400000);
+}
+
+// Забрать и записать все готовые сообщения. Возвращает количество записанных сообщений:
+static size_t drain(void) {
+    size_t count = 0;
+    size_t pos = atomic_load(&g_Logger.dequeue_pos);
+    while (true) {
+        LoggerSlot *slot = &g_Logger.ring[pos & (LOGGER_RING_SIZE - 1)];
+        if (atomic_load(&slot->sequence) != pos + 1) break;  // Ячейка ещё не опубликована.
+
+        // Записываем и освобождаем ячейку для писателей:
+        const char *text = slot->heap ? slot->heap : slot->text;
+        if (slot->binary) write_binary(text, slot->length);
+        else write_line(g_Logger.file, day_ms_from_ns(slot->time_ns), text, slot->length);
+        if (slot->heap) { mm_free(slot->heap); slot->heap = NULL; }
+        atomic_store(&slot->sequence, pos + LOGGER_RING_SIZE);
+        pos++;
+        count++;
+    }
+    atomic_store(&g_Logger.dequeue_pos, pos);
+
+    // Сбрасываем буферы один раз на всю пачку:
+    if (count > 0) {
+        fflush(stdout);
+        if (g_Logger.file) fflush(g_Logger.file);
+        if (g_Logger.bin_file) fflush(g_Logger.bin_file);
+        atomic_store(&g_Logger.written_pos, pos);
+    }
+    return count;
+}
+
+// Разбудить фоновый поток, если он ждёт:
+static inline void wake_writer(void) {
+    if (!atomic_load(&g_Logger.sleeping)) return;
+    mtx_lock(&g_Logger.mutex);
+    cnd_signal(&g_Logger.cond);
+    mtx_unlock(&g_Logger.mutex);
+}
+
+// Фоновый поток записи:
+static int writer_thread(void *args) {
+    (void)args;  // Не используется.
+    while (true) {
+        while (atomic_flag_test_and_set(&g_Logger.busy)) thrd_yield();
+        size_t count = drain();
+        atomic_flag_clear(&g_Logger.busy);
+        if (count > 0) continue;
+        if (!atomic_load(&g_Logger.running)) break;
+
+        // Очередь пуста. Засыпаем до сигнала (перепроверяем очередь уже после объявления о сне):
+        mtx_lock(&g_Logger.mutex);
+        atomic_store(&g_Logger.sleeping, true);
+        size_t pos = atomic_load(&g_Logger.dequeue_pos);
+        LoggerSlot *slot = &g_Logger.ring[pos & (LOGGER_RING_SIZE - 1)];
+        if (atomic_load(&slot->sequence) != pos + 1 && atomic_load(&g_Logger.running)) {
+            struct timespec ts;
+            timespec_get(&ts, TIME_UTC);
+            ts.tv_nsec += 50000000;  // Не дольше 50 мс.
+            if (ts.tv_nsec >= 1000000000) { ts.tv_sec++; ts.tv_nsec -= 1000000000; }
+            cnd_timedwait(&g_Logger.cond, &g_Logger.mutex, &ts);
+        }
+        atomic_store(&g_Logger.sleeping, false);
+        mtx_unlock(&g_Logger.mutex);
+    }
+    return 0;
+}
+
+// Захватить свободную ячейку (если очередь переполнена, ждём пока фоновый поток её разберёт):
+static LoggerSlot* claim_slot(size_t *out_pos) {
+    LoggerSlot *slot;
+    size_t pos = atomic_load(&g_Logger.enqueue_pos);
+    while (true) {
+        slot = &g_Logger.ring[pos & (LOGGER_RING_SIZE - 1)];
+        size_t seq = atomic_load(&slot->sequence);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak(&g_Logger.enqueue_pos, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            wake_writer();
+            thrd_yield();
+            pos = atomic_load(&g_Logger.enqueue_pos);
+        } else pos = atomic_load(&g_Logger.enqueue_pos);
+    }
+    *out_pos = pos;
+    return slot;
+}
+
+// Опубликовать заполненную ячейку:
+static inline void publish_slot(LoggerSlot *slot, size_t pos) {
+    atomic_store(&slot->sequence, pos + 1);
+    wake_writer();
+}
+
+// Синхронная запись сообщения (когда фоновый поток не запущен):
+static void write_sync(const char *fmt, va_list args) {
+    TimeCurrent tc = Time_get_current(true);
+    uint32_t day_ms = ((tc.hour * 60 + tc.min) * 60 + tc.sec) * 1000 + tc.ms;
+    char text[LOGGER_MSG_SIZE];
+    char *heap = NULL;
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int length = vsnprintf(text, sizeof(text), fmt, args);
+    if (length < 0) length = 0;
+    if ((size_t)length >= sizeof(text)) {
+        heap = (char*)mm_alloc((size_t)length + 1);
+        vsnprintf(heap, (size_t)length + 1, fmt, args_copy);
+    }
+    va_end(args_copy);
+
+    FILE *f = NULL;
+    #ifndef CGDF_DISABLE_LOG_FILE
+        f = fopen(LOG_FILE_PATH, "a");
+    #endif
+    write_line(f, day_ms, heap ? heap : text, (size_t)length);
+    fflush(stdout);
+    if (f) fclose(f);
+    if (heap) mm_free(heap);
+}
+
+
 // Преобразование кода сигнала в строку:
 static inline const char* code_to_string(int code) {
     switch(code) {
@@ -42,7 +302,14 @@ static inline const char* code_to_string(int code) {
 
 // Обработчик вылета:
 static inline void crash_handler(int sig) {
-    FILE *f = fopen(LOG_FILE_PATH, "a");
+    // Дописываем всё что успели отправить в лог. Если очередь занята дольше разумного, пишем поверх:
+    FILE *f = NULL;
+    if (atomic_load(&g_Logger.running)) {
+        for (int i = 0; i < 100000 && atomic_flag_test_and_set(&g_Logger.busy); i++) thrd_yield();
+        drain();
+        f = g_Logger.file;
+    }
+    if (!f) f = fopen(LOG_FILE_PATH, "a");
     if (!f) f = stderr;
 
     // Сообщение о сигнале:
@@ -56,24 +323,63 @@ static inline void crash_handler(int sig) {
     fflush(f);
     fflush(stderr);
 
-    if (f != stderr) fclose(f);
+    if (f != stderr && f != g_Logger.file) fclose(f);
     _exit(sig);
 }
 
 
-// Инициализация логгера:
+// -------- API логгера: --------
+
+
+// Инициализация логгера (запускает фоновый поток записи):
 void Logger_init(void) {
-    // Инициализируем лог-файл:
+    if (atomic_load(&g_Logger.running)) return;
+
+    // Запоминаем точку отсчёта времени (дальше время дня считается от монотонных часов):
+    TimeCurrent tc = Time_get_current(true);
+    g_Logger.base_ns = Time_get_ns();
+    g_Logger.base_day_ms = ((tc.hour * 60ull + tc.min) * 60ull + tc.sec) * 1000ull + tc.ms;
+
+    // Инициализируем лог-файл и оставляем его открытым:
+    g_Logger.file = NULL;
     #ifndef CGDF_DISABLE_LOG_FILE
-        TimeCurrent tc = Time_get_current(true);
-        int y = tc.year, m = tc.month, d = tc.day, h = tc.hour, mi = tc.min, s = tc.sec, ms = tc.ms;
-        FILE *f = fopen(LOG_FILE_PATH, "w");
-        if (f) {
-            fprintf(f, "[%02d:%02d:%02d.%03d]: Logger initialized: [%d.%02d.%02d]\n", h, mi, s, ms, y, m, d);
-            fclose(f);
+        g_Logger.file = fopen(LOG_FILE_PATH, "w");
+        if (g_Logger.file) {
+            fprintf(
+                g_Logger.file, "[%02d:%02d:%02d.%03d]: Logger initialized: [%d.%02d.%02d]\n",
+                tc.hour, tc.min, tc.sec, tc.ms, tc.year, tc.month, tc.day
+            );
+            fflush(g_Logger.file);
         }
     #endif
 
+    // Готовим очередь:
+    for (size_t i = 0; i < LOGGER_RING_SIZE; i++) {
+        atomic_init(&g_Logger.ring[i].sequence, i);
+        g_Logger.ring[i].heap = NULL;
+    }
+    atomic_store(&g_Logger.enqueue_pos, 0);
+    atomic_store(&g_Logger.dequeue_pos, 0);
+    atomic_store(&g_Logger.written_pos, 0);
+    atomic_store(&g_Logger.sleeping, false);
+    g_Logger.bin_file = NULL;
+    g_Logger.bin_failed = false;
+
+    // Запускаем фоновый поток:
+    mtx_init(&g_Logger.mutex, mtx_plain);
+    cnd_init(&g_Logger.cond);
+    atomic_store(&g_Logger.running, true);
+    if (thrd_create(&g_Logger.thread, writer_thread, NULL) != thrd_success) {
+        atomic_store(&g_Logger.running, false);
+        mtx_destroy(&g_Logger.mutex);
+        cnd_destroy(&g_Logger.cond);
+        if (g_Logger.file) { fclose(g_Logger.file); g_Logger.file = NULL; }
+        Logger_write("[W] Logger_init: Failed to start writer thread. Logging synchronously.\n");
+    } else {
+        static bool atexit_registered = false;  // Дописать очередь при обычном выходе из программы.
+        if (!atexit_registered) atexit_registered = (atexit(Logger_destroy) == 0);
+    }
+
     // Устанавливаем обработчик сигналов:
     signal(SIGSEGV, crash_handler);
     signal(SIGABRT, crash_handler);
@@ -85,32 +391,149 @@ void Logger_init(void) {
 }
 
 
-// Вывод сообщения в лог-файл и в консоль:
-void log_msg(const char *fmt, ...) {
-    va_list args, args_copy;
+// Остановить логгер (дописывает все сообщения и закрывает лог-файл):
+void Logger_destroy(void) {
+    if (!atomic_exchange(&g_Logger.running, false)) return;
+    mtx_lock(&g_Logger.mutex);
+    cnd_signal(&g_Logger.cond);
+    mtx_unlock(&g_Logger.mutex);
+    thrd_join(g_Logger.thread, NULL);
+    drain();  // Сообщения, отправленные пока поток завершался.
+    mtx_destroy(&g_Logger.mutex);
+    cnd_destroy(&g_Logger.cond);
+    if (g_Logger.file) { fclose(g_Logger.file); g_Logger.file = NULL; }
+    if (g_Logger.bin_file) { fclose(g_Logger.bin_file); g_Logger.bin_file = NULL; }
+}
 
-    // Получаем время:
-    TimeCurrent tc = Time_get_current(true);
-    int h = tc.hour, mi = tc.min, s = tc.sec, ms = tc.ms;
 
-    // Начинаем работу с аргументами:
+// Дождаться пока все отправленные сообщения будут записаны:
+void Logger_flush(void) {
+    if (!atomic_load(&g_Logger.running)) return;
+    size_t target = atomic_load(&g_Logger.enqueue_pos);
+    while (atomic_load(&g_Logger.written_pos) < target && atomic_load(&g_Logger.running)) {
+        mtx_lock(&g_Logger.mutex);
+        cnd_signal(&g_Logger.cond);
+        mtx_unlock(&g_Logger.mutex);
+        thrd_yield();
+    }
+}
+
+
+// Установить минимальный уровень сообщений во время работы:
+void Logger_set_level(LogLevel level) {
+    g_LogLevel = level;
+}
+
+
+// Получить минимальный уровень сообщений:
+LogLevel Logger_get_level(void) {
+    return g_LogLevel;
+}
+
+
+// Записать сообщение в очередь лога (без проверки уровня):
+void Logger_write(const char *fmt, ...) {
+    va_list args;
     va_start(args, fmt);
-    va_copy(args_copy, args);
 
-    // В консоль:
-    printf("[%02d:%02d:%02d.%03d]: ", h, mi, s, ms);
-    vprintf(fmt, args);
+    // Логгер не запущен. Пишем сразу:
+    if (!atomic_load(&g_Logger.running)) {
+        write_sync(fmt, args);
+        va_end(args);
+        return;
+    }
 
-    // В файл:
-    #ifndef CGDF_DISABLE_LOG_FILE
-        FILE *f = fopen(LOG_FILE_PATH, "a");
-        if (f) {
-            fprintf(f, "[%02d:%02d:%02d.%03d]: ", h, mi, s, ms);
-            vfprintf(f, fmt, args_copy);
-            fclose(f);
-        }
-    #endif
+    // Захватываем свободную ячейку:
+    size_t pos;
+    LoggerSlot *slot = claim_slot(&pos);
 
+    // Форматируем прямо в ячейку (длинное сообщение форматируем ещё раз в кучу):
+    va_list args_copy;
+    va_copy(args_copy, args);
+    slot->binary = false;
+    slot->time_ns = Time_get_ns();
+    int length = vsnprintf(slot->text, LOGGER_MSG_SIZE, fmt, args);
+    if (length < 0) length = 0;
+    slot->heap = NULL;
+    if ((size_t)length >= LOGGER_MSG_SIZE) {
+        slot->heap = (char*)mm_alloc((size_t)length + 1);
+        vsnprintf(slot->heap, (size_t)length + 1, fmt, args_copy);
+    }
+    slot->length = (size_t)length;
     va_end(args_copy);
     va_end(args);
+
+    // Публикуем ячейку:
+    publish_slot(slot, pos);
+}
+
+
+// -------- Двоичный лог: --------
+
+
+// Зарегистрировать строку формата и получить её номер (вызывается один раз на каждое место log_bin):
+uint32_t Logger_register_format(const char *fmt) {
+    if (!fmt) return 0;
+
+    // Сначала реестр: формат попадёт в любой файл, открытый после этого:
+    while (atomic_flag_test_and_set_explicit(&g_Logger.formats_lock, memory_order_acquire)) thrd_yield();
+    uint32_t id = ++g_Logger.formats_count;
+    if (id <= LOG_BIN_MAX_FORMATS) g_Logger.formats[id - 1] = fmt;
+    atomic_flag_clear_explicit(&g_Logger.formats_lock, memory_order_release);
+    if (id == LOG_BIN_MAX_FORMATS + 1) {
+        log_msg("[W] Logger_register_format: More than %d formats, new ones are not kept.\n", LOG_BIN_MAX_FORMATS);
+    }
+    if (!atomic_load(&g_Logger.running)) return id;
+
+    // Файл уже может быть открыт, поэтому описание идёт и через очередь:
+    size_t size = encode_format(NULL, id, fmt);
+    size_t pos;
+    LoggerSlot *slot = claim_slot(&pos);
+    slot->binary = true;
+    slot->heap = size > LOGGER_MSG_SIZE ? (char*)mm_alloc(size) : NULL;
+    encode_format(slot->heap ? slot->heap : slot->text, id, fmt);
+    slot->length = size;
+    publish_slot(slot, pos);
+    return id;
+}
+
+
+// Записать двоичную запись в очередь лога (без проверки уровня):
+void Logger_write_binary(uint32_t format_id, const LogArg *args, size_t count) {
+    if (!atomic_load(&g_Logger.running)) return;
+    if (count > LOG_BIN_MAX_ARGS) count = LOG_BIN_MAX_ARGS;
+
+    size_t pos;
+    LoggerSlot *slot = claim_slot(&pos);
+    slot->binary = true;
+    slot->heap = NULL;
+
+    // Заголовок записи (u8 тип, u32 id, u64 время, u8 количество аргументов):
+    char *out = slot->text;
+    uint64_t time_ns = Time_get_ns();
+    out[0] = LOG_BIN_RECORD_MSG;
+    memcpy(out + 1, &format_id, sizeof(format_id));
+    memcpy(out + 5, &time_ns, sizeof(time_ns));
+    out[13] = (char)count;
+    size_t size = 14;
+
+    // Аргументы (8 байт на число, строки копируются и обрезаются по месту в ячейке):
+    for (size_t i = 0; i < count; i++) {
+        out[size++] = (char)args[i].type;
+        if (args[i].type == LOG_ARG_STRING) {
+            const char *str = args[i].s ? args[i].s : "(null)";
+            size_t room = LOGGER_MSG_SIZE - size - sizeof(uint16_t) - (count - i - 1) * 9;
+            size_t len = strlen(str);
+            if (len > room) len = room;
+            uint16_t len16 = (uint16_t)len;
+            memcpy(out + size, &len16, sizeof(len16));
+            memcpy(out + size + sizeof(len16), str, len);
+            size += sizeof(len16) + len;
+        } else {
+            memcpy(out + size, &args[i].u, sizeof(uint64_t));
+            size += sizeof(uint64_t);
+        }
+    }
+    slot->length = size;
+    publish_slot(slot, pos);
 }
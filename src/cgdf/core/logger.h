@@ -1,12 +1,173 @@
 //
 // logger.h - Логгер событий.
 //
+// Логгер асинхронный: log_msg только форматирует сообщение в ячейку кольцевого буфера (без блокировок),
+// а запись в консоль и в лог-файл делает отдельный фоновый поток пачками.
+// Уровень сообщения определяется по тегу в начале строки формата ("[I]", "[W]", "[E]", "[GL]").
+// Сообщения без тега считаются информационными.
+//
+// Для частых событий (счётчики кадра, события задач) есть двоичный режим log_bin: вызов кладёт в очередь
+// только номер строки формата и сырые аргументы, а фоновый поток пишет эти записи в LOG_BIN_FILE_PATH
+// как есть. Текст из двоичного лога получается утилитой "build/tools/binlog.py".
+// Строки (char*) копируются в запись сразу, поэтому их можно передавать из временных буферов.
+//
+// define CGDF_LOG_LEVEL - Минимальный уровень сообщений при компиляции (LOG_LEVEL_*). Сообщения ниже
+//                         этого уровня вырезаются компилятором целиком, вместе с вычислением аргументов.
+//
 
 #pragma once
 
 
-// Инициализация логгера:
+// Подключаем:
+#include "std.h"
+
+
+// Определения:
+#define LOGGER_RING_SIZE    1024  // Количество ячеек кольцевого буфера сообщений (степень двойки).
+#define LOGGER_MSG_SIZE     240   // Размер текста в ячейке. Более длинные сообщения выделяются в куче.
+#define LOG_BIN_MAX_ARGS    8     // Максимум аргументов у log_bin.
+#define LOG_BIN_MAX_FORMATS 4096  // Строк формата в реестре логгера (пишутся в начало каждого двоичного лога).
+
+
+// Уровни логирования:
+typedef enum LogLevel {
+    LOG_LEVEL_INFO    = 0,  // [I] и сообщения без тега.
+    LOG_LEVEL_WARNING = 1,  // [W].
+    LOG_LEVEL_ERROR   = 2,  // [E] и [GL].
+    LOG_LEVEL_NONE    = 3,  // Всё отключено.
+} LogLevel;
+
+
+// Минимальный уровень при компиляции:
+#ifndef CGDF_LOG_LEVEL
+    #define CGDF_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+
+// Типы аргументов двоичной записи:
+typedef enum LogArgType {
+    LOG_ARG_INT    = 1,  // Знаковое целое (int64_t).
+    LOG_ARG_UINT   = 2,  // Беззнаковое целое (uint64_t).
+    LOG_ARG_FLOAT  = 3,  // Число с плавающей точкой (double).
+    LOG_ARG_STRING = 4,  // Строка (копируется в запись).
+    LOG_ARG_PTR    = 5,  // Указатель (пишется только адрес).
+} LogArgType;
+
+
+// Объявление структур:
+typedef struct LogArg LogArg;  // Аргумент двоичной записи.
+
+
+// Аргумент двоичной записи:
+struct LogArg {
+    LogArgType type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double f;
+        const char *s;
+        const void *p;
+    };
+};
+
+
+// Текущий минимальный уровень во время работы:
+extern LogLevel g_LogLevel;
+
+
+// Уровень сообщения по тегу строки формата (для строковых литералов вычисляется при компиляции):
+#define LOG_LEVEL_OF(fmt) (                                          \
+    (fmt)[0] != '[' ? LOG_LEVEL_INFO :                               \
+    ((fmt)[1] == 'E' || (fmt)[1] == 'G') ? LOG_LEVEL_ERROR :         \
+    (fmt)[1] == 'W' ? LOG_LEVEL_WARNING : LOG_LEVEL_INFO             \
+)
+#define LOG_FIRST_ARG_(first, ...) first
+#define LOG_FIRST_ARG(...) LOG_FIRST_ARG_(__VA_ARGS__, 0)
+
+// Формат log_msg/log_bin. Склейка с "" пропускает только строковый литерал (иначе ошибка компиляции),
+// поэтому повторная подстановка формата в макросах не вычисляет выражений и не бывает NULL:
+#define LOG_FORMAT(...) ("" LOG_FIRST_ARG(__VA_ARGS__))
+
+// Включен ли уровень (отключенный при компиляции уровень сворачивается в false):
+#define Logger_is_enabled(level) ((level) >= CGDF_LOG_LEVEL && (level) >= g_LogLevel)
+
+
+// Инициализация логгера (запускает фоновый поток записи):
 void Logger_init(void);
 
-// Вывод сообщения в лог-файл и в консоль:
-void log_msg(const char *fmt, ...);
+// Остановить логгер (дописывает все сообщения и закрывает лог-файл):
+void Logger_destroy(void);
+
+// Дождаться пока все отправленные сообщения будут записаны:
+void Logger_flush(void);
+
+// Установить минимальный уровень сообщений во время работы:
+void Logger_set_level(LogLevel level);
+
+// Получить минимальный уровень сообщений:
+LogLevel Logger_get_level(void);
+
+// Записать сообщение в очередь лога (без проверки уровня):
+void Logger_write(const char *fmt, ...);
+
+// Вывод сообщения в лог-файл и в консоль (формат - строковый литерал, для остальных строк Logger_write):
+#define log_msg(...) (Logger_is_enabled(LOG_LEVEL_OF(LOG_FORMAT(__VA_ARGS__))) ? \
+                      Logger_write(__VA_ARGS__) : (void)0)
+
+
+// -------- Двоичный лог: --------
+
+
+// Зарегистрировать строку формата и получить её номер (вызывается один раз на каждое место log_bin,
+// строка должна жить до конца программы - логгер хранит указатель):
+uint32_t Logger_register_format(const char *fmt);
+
+// Записать двоичную запись в очередь лога (без проверки уровня):
+void Logger_write_binary(uint32_t format_id, const LogArg *args, size_t count);
+
+// Упаковать аргументы в LogArg по их типу:
+static inline LogArg LogArg_int(int64_t v) { LogArg a; a.type = LOG_ARG_INT; a.i = v; return a; }
+static inline LogArg LogArg_uint(uint64_t v) { LogArg a; a.type = LOG_ARG_UINT; a.u = v; return a; }
+static inline LogArg LogArg_float(double v) { LogArg a; a.type = LOG_ARG_FLOAT; a.f = v; return a; }
+static inline LogArg LogArg_string(const char *v) { LogArg a; a.type = LOG_ARG_STRING; a.s = v; return a; }
+static inline LogArg LogArg_ptr(const void *v) { LogArg a; a.type = LOG_ARG_PTR; a.p = v; return a; }
+
+#define LOG_ARG(x) _Generic((x),                                                            \
+    _Bool: LogArg_uint, char: LogArg_int, signed char: LogArg_int, short: LogArg_int,       \
+    int: LogArg_int, long: LogArg_int, long long: LogArg_int,                               \
+    unsigned char: LogArg_uint, unsigned short: LogArg_uint, unsigned int: LogArg_uint,     \
+    unsigned long: LogArg_uint, unsigned long long: LogArg_uint,                            \
+    float: LogArg_float, double: LogArg_float,                                              \
+    char*: LogArg_string, const char*: LogArg_string,                                       \
+    default: LogArg_ptr                                                                     \
+)(x),
+
+// Подсчёт аргументов (вместе с форматом) и упаковка всех аргументов кроме формата:
+#define LOG_ARGS_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, N, ...) N
+#define LOG_ARGS_COUNT(...) LOG_ARGS_COUNT_(__VA_ARGS__, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_BIN_ARGS_1(f)
+#define LOG_BIN_ARGS_2(f, a) LOG_ARG(a)
+#define LOG_BIN_ARGS_3(f, a, ...) LOG_ARG(a) LOG_BIN_ARGS_2(f, __VA_ARGS__)
+#define LOG_BIN_ARGS_4(f, a, ...) LOG_ARG(a) LOG_BIN_ARGS_3(f, __VA_ARGS__)
+#define LOG_BIN_ARGS_5(f, a, ...) LOG_ARG(a) LOG_BIN_ARGS_4(f, __VA_ARGS__)
+#define LOG_BIN_ARGS_6(f, a, ...) LOG_ARG(a) LOG_BIN_ARGS_5(f, __VA_ARGS__)
+#define LOG_BIN_ARGS_7(f, a, ...) LOG_ARG(a) LOG_BIN_ARGS_6(f, __VA_ARGS__)
+#define LOG_BIN_ARGS_8(f, a, ...) LOG_ARG(a) LOG_BIN_ARGS_7(f, __VA_ARGS__)
+#define LOG_BIN_ARGS_9(f, a, ...) LOG_ARG(a) LOG_BIN_ARGS_8(f, __VA_ARGS__)
+#define LOG_CONCAT_(a, b) a##b
+#define LOG_CONCAT(a, b) LOG_CONCAT_(a, b)
+#define LOG_BIN_ARGS(...) LOG_CONCAT(LOG_BIN_ARGS_, LOG_ARGS_COUNT(__VA_ARGS__))(__VA_ARGS__)
+
+// Двоичная запись в лог (формат - строковый литерал, до LOG_BIN_MAX_ARGS аргументов):
+#define log_bin(...) do {                                                                       \
+    if (Logger_is_enabled(LOG_LEVEL_OF(LOG_FORMAT(__VA_ARGS__)))) {                             \
+        static atomic_uint log_bin_id_ = 0;                                                     \
+        uint32_t id_ = atomic_load_explicit(&log_bin_id_, memory_order_acquire);                \
+        if (!id_) {                                                                             \
+            id_ = Logger_register_format(LOG_FORMAT(__VA_ARGS__));                              \
+            atomic_store_explicit(&log_bin_id_, id_, memory_order_release);                     \
+        }                                                                                       \
+        LogArg args_[] = { LOG_BIN_ARGS(__VA_ARGS__) LogArg_int(0) };                           \
+        Logger_write_binary(id_, args_, LOG_ARGS_COUNT(__VA_ARGS__) - 1);                       \
+    }                                                                                           \
+} while (0)
@@ -0,0 +1,446 @@
+//
+// lz.c - Реализация быстрого сжатия без потерь (формат блоков LZ4).
+//
+// Блок - последовательности: байт-токен (старшие 4 бита - длина литералов, младшие - длина совпадения - 4),
+// продолжение длины литералов байтами по 255, литералы, смещение совпадения (u16 LE), продолжение длины
+// совпадения. Последняя последовательность состоит только из литералов. Как в LZ4: последние 5 байт
+// всегда литералы, а совпадение не начинается ближе 12 байт к концу.
+//
+// Кадр (little-endian): "CGLZ", u32 размер блока, u64 размер исходных данных, затем блоки:
+//   u32 заголовок блока (младшие 31 бит - размер данных блока, старший бит - блок хранится без сжатия),
+//   данные блока. Блоки независимы (совпадения не выходят за границу блока).
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "logger.h"
+#include "lz.h"
+
+
+// Определения:
+#define LZ_MIN_MATCH     4                  // Минимальная длина совпадения.
+#define LZ_LAST_LITERALS 5                  // Сколько байт в конце всегда литералы.
+#define LZ_MF_LIMIT      12                 // Совпадение не начинается ближе к концу.
+#define LZ_MAX_OFFSET    65535              // Максимальное смещение совпадения.
+#define LZ_HASH_LOG      14                 // Размер хэш-таблицы сжатия (2^14 позиций).
+#define LZ_SKIP_TRIGGER  6                  // Чем больше промахов подряд, тем больше шаг поиска.
+#define LZ_BLOCK_STORED  0x80000000u        // Флаг блока без сжатия.
+
+
+// Потоковая распаковка кадра:
+struct LZStream {
+    unsigned char *dst;        // Буфер назначения.
+    size_t dst_capacity;       // Его размер.
+    size_t raw_size;           // Размер исходных данных (из заголовка).
+    size_t written;            // Сколько распаковано.
+    uint32_t block_header;     // Заголовок текущего блока.
+    size_t need;               // Сколько байт нужно накопить для текущей части (заголовок или блок).
+    size_t have;               // Сколько уже накоплено в pending.
+    unsigned char *pending;    // Буфер для частей, разрезанных между кусками.
+    size_t pending_capacity;   // Его размер.
+    int state;                 // 0 - заголовок кадра, 1 - заголовок блока, 2 - данные блока, 3 - готово.
+    bool failed;               // Данные повреждены.
+};
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Прочитать 32 бита без выравнивания:
+static inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Прочитать 64 бита без выравнивания:
+static inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Записать 32 бита (little-endian):
+static inline void write32le(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+// Прочитать 32 бита (little-endian):
+static inline uint32_t read32le(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Хэш 4 байт для поиска совпадений:
+static inline uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_LOG);
+}
+
+// Длина общего префикса (не дальше limit):
+static inline size_t match_length(const unsigned char *a, const unsigned char *b, const unsigned char *limit) {
+    const unsigned char *start = a;
+    while (a + 8 <= limit) {
+        uint64_t diff = read64(a) ^ read64(b);
+        if (diff) return (size_t)(a - start) + (size_t)(__builtin_ctzll(diff) >> 3);
+        a += 8;
+        b += 8;
+    }
+    while (a < limit && *a == *b) { a++; b++; }
+    return (size_t)(a - start);
+}
+
+// Записать продолжение длины (байты по 255):
+static inline unsigned char* write_length(unsigned char *op, size_t length) {
+    while (length >= 255) { *op++ = 255; length -= 255; }
+    *op++ = (unsigned char)length;
+    return op;
+}
+
+// Записать последовательность (литералы + совпадение). Возвращает NULL если не хватает места:
+static unsigned char* write_sequence(
+    unsigned char *op, unsigned char *oend, const unsigned char *literals, size_t lit_len,
+    size_t offset, size_t match_len, bool last
+) {
+    size_t need = 1 + lit_len + lit_len / 255 + 1 + (last ? 0 : 2 + match_len / 255 + 1);
+    if (need > (size_t)(oend - op)) return NULL;
+
+    unsigned char *token = op++;
+    *token = (unsigned char)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15) op = write_length(op, lit_len - 15);
+    memcpy(op, literals, lit_len);
+    op += lit_len;
+    if (last) return op;
+
+    *op++ = (unsigned char)offset;
+    *op++ = (unsigned char)(offset >> 8);
+    size_t ml = match_len - LZ_MIN_MATCH;
+    *token |= (unsigned char)(ml >= 15 ? 15 : ml);
+    if (ml >= 15) op = write_length(op, ml - 15);
+    return op;
+}
+
+// Скопировать совпадение (области могут перекрываться при малом смещении). slack - сколько байт
+// после конца совпадения можно перезаписать (при slack >= 8 копируем по 8 байт с заходом за конец):
+static inline void copy_match(unsigned char *op, size_t offset, size_t length, size_t slack) {
+    const unsigned char *match = op - offset;
+    unsigned char *end = op + length;
+    if (length <= 16 && offset >= 16 && slack >= 16) {  // Короткое далёкое совпадение - одной копией.
+        memcpy(op, match, 16);
+        return;
+    }
+    if (slack < 8) {
+        while (op < end) *op++ = *match++;
+        return;
+    }
+
+    // Малое смещение - повтор короткого шаблона. Первые 8 байт побайтно, дальше отступаем назад
+    // на кратное смещению расстояние не меньше 8 (шаблон тот же), чтобы копировать по 8 байт:
+    if (offset < 8) {
+        for (int i = 0; i < 8; i++) op[i] = match[i];
+        op += 8;
+        match = op - offset * ((8 + offset - 1) / offset);
+    }
+    while (op < end) {
+        memcpy(op, match, 8);
+        op += 8;
+        match += 8;
+    }
+}
+
+// Распаковать данные одного блока кадра:
+static bool decode_block(uint32_t header, const unsigned char *data, unsigned char *dst, size_t dst_size) {
+    size_t size = header & ~LZ_BLOCK_STORED;
+    if (header & LZ_BLOCK_STORED) {
+        if (size != dst_size) return false;
+        memcpy(dst, data, size);
+        return true;
+    }
+    return LZ_decompress(data, size, dst, dst_size) == dst_size;
+}
+
+// Накопить байты в pending (если часть разрезана между кусками). Возвращает сколько взято:
+static size_t stream_gather(LZStream *self, const unsigned char *data, size_t size) {
+    size_t take = self->need - self->have;
+    if (take > size) take = size;
+    memcpy(self->pending + self->have, data, take);
+    self->have += take;
+    return take;
+}
+
+// Обработать готовую часть потока (заголовок кадра, заголовок блока или данные блока):
+static bool stream_consume(LZStream *self, const unsigned char *part) {
+    if (self->state == 0) {
+        if (!LZ_frame_get_size(part, LZ_FRAME_HEADER_SIZE, &self->raw_size)) return false;
+        if (self->raw_size > self->dst_capacity) return false;
+        self->state = self->raw_size > 0 ? 1 : 3;
+        self->need = 4;
+    } else if (self->state == 1) {
+        self->block_header = read32le(part);
+        size_t size = self->block_header & ~LZ_BLOCK_STORED;
+        if (size == 0 || size > LZ_compress_bound(LZ_BLOCK_SIZE)) return false;
+        self->state = 2;
+        self->need = size;
+    } else if (self->state == 2) {
+        size_t remaining = self->raw_size - self->written;
+        size_t block_raw = remaining < LZ_BLOCK_SIZE ? remaining : LZ_BLOCK_SIZE;
+        if (!decode_block(self->block_header, part, self->dst + self->written, block_raw)) return false;
+        self->written += block_raw;
+        self->state = self->written == self->raw_size ? 3 : 1;
+        self->need = 4;
+    }
+    self->have = 0;
+    return true;
+}
+
+
+// -------- API сжатия: --------
+
+
+// Максимальный размер сжатого блока для данных размера size:
+size_t LZ_compress_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+
+// Сжать блок. Возвращает размер сжатых данных или 0 если не хватило места:
+size_t LZ_compress(const void *src, size_t src_size, void *dst, size_t dst_capacity) {
+    if (!src || !dst || src_size > LZ_MAX_INPUT_SIZE) return 0;
+    const unsigned char *base = (const unsigned char*)src;
+    const unsigned char *ip = base;
+    const unsigned char *anchor = base;
+    const unsigned char *iend = base + src_size;
+    unsigned char *op = (unsigned char*)dst;
+    unsigned char *oend = op + dst_capacity;
+
+    if (src_size > LZ_MF_LIMIT) {
+        const unsigned char *mflimit = iend - LZ_MF_LIMIT;
+        const unsigned char *matchlimit = iend - LZ_LAST_LITERALS;
+        uint32_t *table = (uint32_t*)mm_calloc((size_t)1 << LZ_HASH_LOG, sizeof(uint32_t));
+        ip++;  // Первый байт всегда литерал.
+
+        while (ip < mflimit) {
+            // Ищем совпадение (шаг растёт на несжимаемых участках):
+            uint32_t h = hash4(read32(ip));
+            const unsigned char *ref = base + table[h];
+            table[h] = (uint32_t)(ip - base);
+            if (ref >= ip || (size_t)(ip - ref) > LZ_MAX_OFFSET || read32(ref) != read32(ip)) {
+                ip += 1 + ((size_t)(ip - anchor) >> LZ_SKIP_TRIGGER);
+                continue;
+            }
+
+            // Расширяем совпадение назад и вперёд:
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) { ip--; ref--; }
+            size_t len = LZ_MIN_MATCH + match_length(ip + LZ_MIN_MATCH, ref + LZ_MIN_MATCH, matchlimit);
+
+            op = write_sequence(op, oend, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), len, false);
+            if (!op) { mm_free(table); return 0; }
+            ip += len;
+            anchor = ip;
+
+            // Запоминаем позицию внутри совпадения, чтобы находить соседние повторы:
+            if (ip < mflimit) table[hash4(read32(ip - 2))] = (uint32_t)(ip - 2 - base);
+        }
+        mm_free(table);
+    }
+
+    // Последние литералы:
+    op = write_sequence(op, oend, anchor, (size_t)(iend - anchor), 0, 0, true);
+    if (!op) return 0;
+    return (size_t)(op - (unsigned char*)dst);
+}
+
+
+// Распаковать блок. Возвращает размер распакованных данных или 0 при повреждённых данных/нехватке места:
+size_t LZ_decompress(const void *src, size_t src_size, void *dst, size_t dst_capacity) {
+    if (!src || !dst) return 0;
+    const unsigned char *ip = (const unsigned char*)src;
+    const unsigned char *iend = ip + src_size;
+    unsigned char *op = (unsigned char*)dst;
+    unsigned char *oend = op + dst_capacity;
+
+    while (ip < iend) {
+        unsigned token = *ip++;
+
+        // Литералы:
+        size_t lit_len = token >> 4;
+        if (lit_len == 15) {
+            unsigned b;
+            do {
+                if (ip >= iend) return 0;
+                b = *ip++;
+                lit_len += b;
+            } while (b == 255);
+        }
+        if (lit_len > (size_t)(iend - ip) || lit_len > (size_t)(oend - op)) return 0;
+        if (lit_len <= 16 && iend - ip >= 16 && oend - op >= 16) memcpy(op, ip, 16);  // Короткие - одной копией.
+        else memcpy(op, ip, lit_len);
+        op += lit_len;
+        ip += lit_len;
+        if (ip == iend) break;  // Последняя последовательность без совпадения.
+
+        // Совпадение:
+        if (iend - ip < 2) return 0;
+        size_t offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - (unsigned char*)dst)) return 0;
+        size_t match_len = token & 15;
+        if (match_len == 15) {
+            unsigned b;
+            do {
+                if (ip >= iend) return 0;
+                b = *ip++;
+                match_len += b;
+            } while (b == 255);
+        }
+        match_len += LZ_MIN_MATCH;
+        if (match_len > (size_t)(oend - op)) return 0;
+        copy_match(op, offset, match_len, (size_t)(oend - op) - match_len);
+        op += match_len;
+    }
+    return (size_t)(op - (unsigned char*)dst);
+}
+
+
+// Максимальный размер кадра для данных размера size:
+size_t LZ_frame_bound(size_t size) {
+    size_t blocks = (size + LZ_BLOCK_SIZE - 1) / LZ_BLOCK_SIZE;
+    return LZ_FRAME_HEADER_SIZE + blocks * 4 + size;  // Несжимаемые блоки хранятся как есть.
+}
+
+
+// Сжать данные в кадр. Возвращает размер кадра или 0 если не хватило места:
+size_t LZ_frame_compress(const void *src, size_t src_size, void *dst, size_t dst_capacity) {
+    if (!src || !dst || dst_capacity < LZ_FRAME_HEADER_SIZE) return 0;
+    const unsigned char *ip = (const unsigned char*)src;
+    unsigned char *op = (unsigned char*)dst;
+    unsigned char *oend = op + dst_capacity;
+
+    // Заголовок:
+    memcpy(op, LZ_FRAME_MAGIC, 4);
+    write32le(op + 4, LZ_BLOCK_SIZE);
+    write32le(op + 8, (uint32_t)((uint64_t)src_size));
+    write32le(op + 12, (uint32_t)((uint64_t)src_size >> 32));
+    op += LZ_FRAME_HEADER_SIZE;
+
+    // Блоки (если сжатие не помогло, блок хранится как есть):
+    for (size_t pos = 0; pos < src_size; pos += LZ_BLOCK_SIZE) {
+        size_t block = src_size - pos < LZ_BLOCK_SIZE ? src_size - pos : LZ_BLOCK_SIZE;
+        if ((size_t)(oend - op) < 4) return 0;
+        size_t packed = LZ_compress(ip + pos, block, op + 4, (size_t)(oend - op) - 4);
+        if (packed == 0 || packed >= block) {
+            if ((size_t)(oend - op) < 4 + block) return 0;
+            memcpy(op + 4, ip + pos, block);
+            write32le(op, (uint32_t)block | LZ_BLOCK_STORED);
+            op += 4 + block;
+        } else {
+            write32le(op, (uint32_t)packed);
+            op += 4 + packed;
+        }
+    }
+    return (size_t)(op - (unsigned char*)dst);
+}
+
+
+// Является ли буфер кадром (и получить размер исходных данных):
+bool LZ_frame_get_size(const void *src, size_t src_size, size_t *out_raw_size) {
+    if (!src || src_size < LZ_FRAME_HEADER_SIZE) return false;
+    const unsigned char *p = (const unsigned char*)src;
+    if (memcmp(p, LZ_FRAME_MAGIC, 4) != 0 || read32le(p + 4) != LZ_BLOCK_SIZE) return false;
+    uint64_t raw = (uint64_t)read32le(p + 8) | (uint64_t)read32le(p + 12) << 32;
+    if (raw > SIZE_MAX) return false;
+    if (out_raw_size) *out_raw_size = (size_t)raw;
+    return true;
+}
+
+
+// Распаковать кадр целиком. Возвращает размер данных или 0 при ошибке:
+size_t LZ_frame_decompress(const void *src, size_t src_size, void *dst, size_t dst_capacity) {
+    LZStream stream = { .dst = (unsigned char*)dst, .dst_capacity = dst_capacity, .need = LZ_FRAME_HEADER_SIZE };
+    if (!LZStream_feed(&stream, src, src_size) || !LZStream_is_done(&stream)) {
+        mm_free(stream.pending);
+        return 0;
+    }
+    mm_free(stream.pending);
+    return stream.written;
+}
+
+
+// -------- API потоковой распаковки: --------
+
+
+// Создать потоковую распаковку кадра прямо в буфер назначения:
+LZStream* LZStream_create(void *dst, size_t dst_capacity) {
+    LZStream *stream = (LZStream*)mm_calloc(1, sizeof(LZStream));
+    stream->dst = (unsigned char*)dst;
+    stream->dst_capacity = dst ? dst_capacity : 0;
+    stream->need = LZ_FRAME_HEADER_SIZE;
+    return stream;
+}
+
+
+// Уничтожить потоковую распаковку:
+void LZStream_destroy(LZStream **stream) {
+    if (!stream || !*stream) return;
+    mm_free((*stream)->pending);
+    mm_free(*stream);
+    *stream = NULL;
+}
+
+
+// Подать следующий кусок кадра. Возвращает false при повреждённых данных или нехватке места:
+bool LZStream_feed(LZStream *self, const void *data, size_t size) {
+    if (!self || self->failed) return false;
+    const unsigned char *p = (const unsigned char*)data;
+
+    while (size > 0 && self->state != 3) {
+        const unsigned char *part;
+        if (self->have == 0 && size >= self->need) {
+            // Часть целиком в этом куске - разбираем без копирования:
+            part = p;
+            p += self->need;
+            size -= self->need;
+        } else {
+            // Часть разрезана между кусками - накапливаем:
+            if (self->pending_capacity < self->need) {
+                size_t capacity = LZ_compress_bound(LZ_BLOCK_SIZE);
+                unsigned char *pending = (unsigned char*)mm_alloc(capacity);
+                if (self->have) memcpy(pending, self->pending, self->have);
+                mm_free(self->pending);
+                self->pending = pending;
+                self->pending_capacity = capacity;
+            }
+            size_t taken = stream_gather(self, p, size);
+            p += taken;
+            size -= taken;
+            if (self->have < self->need) break;
+            part = self->pending;
+        }
+        if (!stream_consume(self, part)) {
+            self->failed = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Распакован ли кадр полностью:
+bool LZStream_is_done(LZStream *self) {
+    return self && self->state == 3;
+}
+
+
+// Получить размер исходных данных из заголовка (0 пока заголовок не прочитан):
+size_t LZStream_get_raw_size(LZStream *self) {
+    return self ? self->raw_size : 0;
+}
+
+
+// Получить сколько байт уже распаковано:
+size_t LZStream_get_size(LZStream *self) {
+    return self ? self->written : 0;
+}
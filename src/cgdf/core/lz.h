@@ -0,0 +1,72 @@
+//
+// lz.h - Быстрое сжатие без потерь (формат блоков LZ4).
+//
+// LZ_compress / LZ_decompress работают с одним блоком в формате LZ4 block (совместим с LZ4).
+// Для файлов есть кадр: заголовок "CGLZ" с размером исходных данных и независимые блоки по
+// LZ_BLOCK_SIZE байт. Кадр можно распаковывать потоком (LZStream): данные подаются кусками любого
+// размера, а распаковка идёт сразу в буфер назначения (например в данные Pixmap или массив вершин).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+
+
+// Определения:
+#define LZ_BLOCK_SIZE        (256 * 1024)  // Размер блока кадра.
+#define LZ_MAX_INPUT_SIZE    0x7E000000    // Максимальный размер блока при сжатии.
+#define LZ_FRAME_HEADER_SIZE 16            // Размер заголовка кадра.
+#define LZ_FRAME_MAGIC       "CGLZ"        // Сигнатура кадра.
+
+
+// Объявление структур:
+typedef struct LZStream LZStream;  // Потоковая распаковка кадра.
+
+
+// -------- API сжатия: --------
+
+
+// Максимальный размер сжатого блока для данных размера size:
+size_t LZ_compress_bound(size_t size);
+
+// Сжать блок. Возвращает размер сжатых данных или 0 если не хватило места:
+size_t LZ_compress(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+
+// Распаковать блок. Возвращает размер распакованных данных или 0 при повреждённых данных/нехватке места:
+size_t LZ_decompress(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+
+// Максимальный размер кадра для данных размера size:
+size_t LZ_frame_bound(size_t size);
+
+// Сжать данные в кадр. Возвращает размер кадра или 0 если не хватило места:
+size_t LZ_frame_compress(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+
+// Является ли буфер кадром (и получить размер исходных данных):
+bool LZ_frame_get_size(const void *src, size_t src_size, size_t *out_raw_size);
+
+// Распаковать кадр целиком. Возвращает размер данных или 0 при ошибке:
+size_t LZ_frame_decompress(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+
+
+// -------- API потоковой распаковки: --------
+
+
+// Создать потоковую распаковку кадра прямо в буфер назначения:
+LZStream* LZStream_create(void *dst, size_t dst_capacity);
+
+// Уничтожить потоковую распаковку:
+void LZStream_destroy(LZStream **stream);
+
+// Подать следующий кусок кадра. Возвращает false при повреждённых данных или нехватке места:
+bool LZStream_feed(LZStream *self, const void *data, size_t size);
+
+// Распакован ли кадр полностью:
+bool LZStream_is_done(LZStream *self);
+
+// Получить размер исходных данных из заголовка (0 пока заголовок не прочитан):
+size_t LZStream_get_raw_size(LZStream *self);
+
+// Получить сколько байт уже распаковано:
+size_t LZStream_get_size(LZStream *self);
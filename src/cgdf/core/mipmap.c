@@ -0,0 +1,564 @@
+//
+// mipmap.c - Реализация построения цепочки мипмапов на процессоре.
+//
+// Уровень считается построчно: для выходной строки исходные строки под фильтром складываются с весами
+// (вертикальный проход), затем полученная строка фильтруется по горизонтали и кодируется обратно.
+// Исходные 8-битные строки переводятся в линейный float один раз и живут в кольце из стольких строк,
+// сколько весов у вертикального фильтра, поэтому память расчёта - несколько строк, а не весь уровень во float.
+// Пиксели RGBA (4 float) складываются векторно: SSE2 на x86-64 и NEON на AArch64 есть всегда,
+// поэтому выбор набора инструкций при запуске здесь не нужен.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "logger.h"
+#include "libs.h"
+#include "jobsystem.h"
+#include "pixconv.h"
+#include "mipmap.h"
+
+#if !defined(CGDF_MIPMAP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define MIPMAP_HAS_SSE 1
+    #include <emmintrin.h>
+#else
+    #define MIPMAP_HAS_SSE 0
+#endif
+
+#if !defined(CGDF_MIPMAP_NO_SIMD) && !MIPMAP_HAS_SSE && (defined(__aarch64__) || defined(_M_ARM64))
+    #define MIPMAP_HAS_NEON 1
+    #include <arm_neon.h>
+#else
+    #define MIPMAP_HAS_NEON 0
+#endif
+
+
+// Определения:
+#define MIPMAP_PI           3.14159265358979f
+#define MIPMAP_LOBES        3.0f  // Ширина фильтров Кайзера и Ланцоша (в выходных пикселях).
+#define MIPMAP_KAISER_ALPHA 4.0f  // Параметр окна Кайзера.
+
+
+// Веса фильтра по одной оси (исходные пиксели выходного пикселя идут подряд с first):
+typedef struct MipAxis {
+    int *first;      // Первый исходный пиксель каждого выходного.
+    int *count;      // Количество весов каждого выходного пикселя.
+    int *offset;     // Смещение весов выходного пикселя в weights.
+    float *weights;  // Веса (у каждого выходного пикселя в сумме 1).
+    int max_taps;    // Максимум весов на выходной пиксель.
+} MipAxis;
+
+
+// Рабочие буферы потока:
+typedef struct MipScratch {
+    float *ring;     // Кольцо исходных строк в линейном float.
+    int *ring_rows;  // Какая строка лежит в каждой ячейке кольца.
+    float *acc;      // Сумма строк под вертикальным фильтром.
+    float *out;      // Выходная строка во float.
+} MipScratch;
+
+
+// Расчёт одного уровня (общие данные потоков):
+typedef struct MipLevel {
+    const Pixmap *src;       // Предыдущий уровень.
+    Pixmap *dst;             // Новый уровень.
+    MipAxis x_axis;          // Горизонтальный фильтр.
+    MipAxis y_axis;          // Вертикальный фильтр.
+    const float *to_linear;  // Перевод 8-битного цвета во float (sRGB или просто /255).
+    int alpha;               // Номер альфа канала (-1 - нет).
+    bool srgb;               // Кодировать цвет в sRGB.
+    size_t src_row;          // Значений в исходной строке.
+    size_t dst_row;          // Значений в выходной строке.
+    MipScratch *scratch;     // Буферы каждого потока (по номеру потока JobSystem_parallel_for).
+} MipLevel;
+
+
+// Таблицы перевода 8 бит во float:
+static once_flag g_Mipmap_once = ONCE_FLAG_INIT;
+static float g_Mipmap_srgb_lut[256];   // sRGB -> линейное.
+static float g_Mipmap_unorm_lut[256];  // Просто /255.
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Заполнить таблицы перевода:
+static void init_luts(void) {
+    for (int i = 0; i < 256; i++) {
+        float c = i / 255.0f;
+        g_Mipmap_unorm_lut[i] = c;
+        g_Mipmap_srgb_lut[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+}
+
+// Нормированный sinc:
+static float sinc(float x) {
+    if (fabsf(x) < 1e-6f) return 1.0f;
+    x *= MIPMAP_PI;
+    return sinf(x) / x;
+}
+
+// Модифицированная функция Бесселя нулевого порядка (ряд):
+static float bessel_i0(float x) {
+    float sum = 1.0f, term = 1.0f, q = x * x * 0.25f;
+    for (int k = 1; k < 32; k++) {
+        term *= q / (float)(k * k);
+        sum += term;
+        if (term < sum * 1e-8f) break;
+    }
+    return sum;
+}
+
+// Радиус фильтра в выходных пикселях:
+static float filter_radius(MipFilter filter) {
+    switch (filter) {
+        case MIP_FILTER_BOX:      return 0.5f;
+        case MIP_FILTER_BILINEAR: return 1.0f;
+        default:                  return MIPMAP_LOBES;
+    }
+}
+
+// Вес фильтра на расстоянии t выходных пикселей:
+static float filter_weight(MipFilter filter, float t) {
+    switch (filter) {
+        case MIP_FILTER_BOX: return (t >= -0.5f && t < 0.5f) ? 1.0f : 0.0f;
+        case MIP_FILTER_LANCZOS: return fabsf(t) < MIPMAP_LOBES ? sinc(t) * sinc(t / MIPMAP_LOBES) : 0.0f;
+        case MIP_FILTER_BILINEAR: return fabsf(t) < 1.0f ? 1.0f - fabsf(t) : 0.0f;
+        case MIP_FILTER_KAISER: {
+            if (fabsf(t) >= MIPMAP_LOBES) return 0.0f;
+            float r = t / MIPMAP_LOBES;
+            return sinc(t) * bessel_i0(MIPMAP_KAISER_ALPHA * sqrtf(1.0f - r * r)) / bessel_i0(MIPMAP_KAISER_ALPHA);
+        }
+        default: return 0.0f;
+    }
+}
+
+// Посчитать веса фильтра по оси (края повторяют крайний пиксель):
+static void build_axis(MipAxis *axis, MipFilter filter, int src_size, int dst_size) {
+    float scale = (float)src_size / (float)dst_size;
+    float stretch = scale > 1.0f ? scale : 1.0f;
+    float support = filter_radius(filter) * stretch;
+    int max_taps = (int)ceilf(support * 2.0f) + 2;
+
+    axis->first = (int*)mm_alloc(sizeof(int) * (size_t)dst_size);
+    axis->count = (int*)mm_alloc(sizeof(int) * (size_t)dst_size);
+    axis->offset = (int*)mm_alloc(sizeof(int) * (size_t)dst_size);
+    axis->weights = (float*)mm_alloc(sizeof(float) * (size_t)dst_size * (size_t)max_taps);
+    axis->max_taps = 1;
+
+    int offset = 0;
+    for (int d = 0; d < dst_size; d++) {
+        float center = ((float)d + 0.5f) * scale;
+        int left = (int)floorf(center - support);
+        int right = (int)ceilf(center + support);
+        float *w = axis->weights + offset;
+        int first = -1, count = 0;
+        float sum = 0.0f;
+
+        // Пиксели за краем прижимаются к краю, их веса складываются с весом крайнего:
+        for (int s = left; s < right; s++) {
+            float weight = filter_weight(filter, ((float)s + 0.5f - center) / stretch);
+            int index = s < 0 ? 0 : (s >= src_size ? src_size - 1 : s);
+            if (count > 0 && first + count - 1 == index) w[count - 1] += weight;
+            else if (count > 0 || weight != 0.0f) {
+                if (count == 0) first = index;
+                w[count++] = weight;
+            }
+            sum += weight;
+        }
+        while (count > 1 && w[count - 1] == 0.0f) count--;  // Нулевые веса в конце.
+        if (count == 0 || sum == 0.0f) {  // Не должно случаться, но пусть будет ближайший пиксель.
+            first = (int)center < src_size ? (int)center : src_size - 1;
+            w[0] = sum = 1.0f;
+            count = 1;
+        }
+        for (int k = 0; k < count; k++) w[k] /= sum;
+
+        axis->first[d] = first;
+        axis->count[d] = count;
+        axis->offset[d] = offset;
+        if (count > axis->max_taps) axis->max_taps = count;
+        offset += count;
+    }
+}
+
+// Освободить веса фильтра:
+static void free_axis(MipAxis *axis) {
+    mm_free(axis->first);
+    mm_free(axis->count);
+    mm_free(axis->offset);
+    mm_free(axis->weights);
+}
+
+// Прибавить строку с весом (acc += w * row):
+static void madd_row(float *acc, const float *row, float w, size_t n) {
+    size_t i = 0;
+    #if MIPMAP_HAS_SSE
+        __m128 vw = _mm_set1_ps(w);
+        for (; i + 8 <= n; i += 8) {
+            __m128 a0 = _mm_add_ps(_mm_loadu_ps(acc + i),     _mm_mul_ps(vw, _mm_loadu_ps(row + i)));
+            __m128 a1 = _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(vw, _mm_loadu_ps(row + i + 4)));
+            _mm_storeu_ps(acc + i, a0);
+            _mm_storeu_ps(acc + i + 4, a1);
+        }
+    #elif MIPMAP_HAS_NEON
+        for (; i + 8 <= n; i += 8) {
+            vst1q_f32(acc + i,     vfmaq_n_f32(vld1q_f32(acc + i),     vld1q_f32(row + i),     w));
+            vst1q_f32(acc + i + 4, vfmaq_n_f32(vld1q_f32(acc + i + 4), vld1q_f32(row + i + 4), w));
+        }
+    #endif
+    for (; i < n; i++) acc[i] += w * row[i];
+}
+
+// Горизонтальный фильтр строки RGBA:
+static void filter_row_rgba(const MipAxis *axis, int width, const float *src, float *out) {
+    for (int x = 0; x < width; x++) {
+        const float *w = axis->weights + axis->offset[x];
+        const float *p = src + (size_t)axis->first[x] * 4;
+        int count = axis->count[x];
+        #if MIPMAP_HAS_SSE
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < count; k++) sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(p + k * 4)));
+            _mm_storeu_ps(out + (size_t)x * 4, sum);
+        #elif MIPMAP_HAS_NEON
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            for (int k = 0; k < count; k++) sum = vfmaq_n_f32(sum, vld1q_f32(p + k * 4), w[k]);
+            vst1q_f32(out + (size_t)x * 4, sum);
+        #else
+            float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+            for (int k = 0; k < count; k++) {
+                r += w[k] * p[k*4+0];
+                g += w[k] * p[k*4+1];
+                b += w[k] * p[k*4+2];
+                a += w[k] * p[k*4+3];
+            }
+            out[x*4+0] = r;
+            out[x*4+1] = g;
+            out[x*4+2] = b;
+            out[x*4+3] = a;
+        #endif
+    }
+}
+
+// Горизонтальный фильтр строки с любым количеством каналов:
+static void filter_row(const MipAxis *axis, int width, int channels, const float *src, float *out) {
+    if (channels == 4) {
+        filter_row_rgba(axis, width, src, out);
+        return;
+    }
+    for (int x = 0; x < width; x++) {
+        const float *w = axis->weights + axis->offset[x];
+        const float *p = src + (size_t)axis->first[x] * channels;
+        float *o = out + (size_t)x * channels;
+        for (int c = 0; c < channels; c++) o[c] = 0.0f;
+        for (int k = 0; k < axis->count[x]; k++) {
+            for (int c = 0; c < channels; c++) o[c] += w[k] * p[k * channels + c];
+        }
+    }
+}
+
+// Получить исходную строку в линейном float (8-битные и half строки переводятся в кольцо):
+static const float* source_row(const MipLevel *level, MipScratch *scratch, int y) {
+    const Pixmap *src = level->src;
+    if (src->is_hdr && !src->is_half) return (const float*)src->data + (size_t)y * level->src_row;
+
+    int slot = y % level->y_axis.max_taps;
+    float *row = scratch->ring + (size_t)slot * level->src_row;
+    if (scratch->ring_rows[slot] == y) return row;
+    scratch->ring_rows[slot] = y;
+    if (src->is_hdr) {
+        PixConv_f16_to_f32((const uint16_t*)src->data + (size_t)y * level->src_row, row, level->src_row);
+        return row;
+    }
+
+    const uint8_t *bytes = (const uint8_t*)src->data + (size_t)y * level->src_row;
+    const float *lut = level->to_linear;
+    for (size_t i = 0; i < level->src_row; i++) row[i] = lut[bytes[i]];
+    if (level->alpha >= 0) {
+        for (size_t i = (size_t)level->alpha; i < level->src_row; i += (size_t)src->channels) {
+            row[i] = g_Mipmap_unorm_lut[bytes[i]];
+        }
+    }
+    return row;
+}
+
+// Перевести float 0..1 в байт:
+static inline uint8_t to_unorm8(float v) {
+    if (v <= 0.0f) return 0;
+    if (v >= 1.0f) return 255;
+    return (uint8_t)(v * 255.0f + 0.5f);
+}
+
+// Перевести строку float 0..1 в байты (векторно, результат как у to_unorm8):
+static void encode_unorm8(const float *src, uint8_t *dst, size_t n) {
+    size_t i = 0;
+    #if MIPMAP_HAS_SSE
+        __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f), half = _mm_set1_ps(0.5f);
+        for (; i + 16 <= n; i += 16) {
+            __m128i v[4];
+            for (int k = 0; k < 4; k++) {
+                __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + k * 4), zero), one);
+                v[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, scale), half));
+            }
+            __m128i lo = _mm_packs_epi32(v[0], v[1]), hi = _mm_packs_epi32(v[2], v[3]);
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+        }
+    #elif MIPMAP_HAS_NEON
+        float32x4_t zero = vdupq_n_f32(0.0f), one = vdupq_n_f32(1.0f), half = vdupq_n_f32(0.5f);
+        for (; i + 8 <= n; i += 8) {
+            float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(src + i), zero), one);
+            float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), zero), one);
+            uint32x4_t ua = vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(a, 255.0f), half));
+            uint32x4_t ub = vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(b, 255.0f), half));
+            vst1_u8(dst + i, vmovn_u16(vcombine_u16(vmovn_u32(ua), vmovn_u32(ub))));
+        }
+    #endif
+    for (; i < n; i++) dst[i] = to_unorm8(src[i]);
+}
+
+// Записать выходную строку в уровень:
+static void encode_row(const MipLevel *level, int y, float *out) {
+    Pixmap *dst = level->dst;
+    if (dst->is_hdr) {
+        for (size_t i = 0; i < level->dst_row; i++) out[i] = out[i] > 0.0f ? out[i] : 0.0f;  // Отрицательные лепестки.
+        if (dst->is_half) PixConv_f32_to_f16(out, (uint16_t*)dst->data + (size_t)y * level->dst_row, level->dst_row);
+        else memcpy((float*)dst->data + (size_t)y * level->dst_row, out, level->dst_row * sizeof(float));
+        return;
+    }
+
+    uint8_t *d = (uint8_t*)dst->data + (size_t)y * level->dst_row;
+    size_t channels = (size_t)dst->channels;
+    if (level->srgb) {
+        // Функция переводит все значения подряд, поэтому альфу кодируем до перевода и возвращаем точным значением:
+        if (level->alpha >= 0) {
+            for (size_t i = (size_t)level->alpha; i < level->dst_row; i += channels) d[i] = to_unorm8(out[i]);
+        }
+        PixConv_linear_to_srgb_f32(out, out, level->dst_row);
+        if (level->alpha >= 0) {
+            for (size_t i = (size_t)level->alpha; i < level->dst_row; i += channels) out[i] = (float)d[i] / 255.0f;
+        }
+    }
+    encode_unorm8(out, d, level->dst_row);
+}
+
+// Посчитать одну выходную строку:
+static void level_row(const MipLevel *level, MipScratch *scratch, int y) {
+    const MipAxis *ya = &level->y_axis;
+    const float *w = ya->weights + ya->offset[y];
+    memset(scratch->acc, 0, level->src_row * sizeof(float));
+    for (int k = 0; k < ya->count[y]; k++) {
+        madd_row(scratch->acc, source_row(level, scratch, ya->first[y] + k), w[k], level->src_row);
+    }
+    filter_row(&level->x_axis, level->dst->width, level->dst->channels, scratch->acc, scratch->out);
+    encode_row(level, y, scratch->out);
+}
+
+// Посчитать полосу строк (полоса JobSystem_parallel_for):
+static void level_band(void *args, size_t band, size_t worker) {
+    MipLevel *level = (MipLevel*)args;
+    MipScratch *scratch = &level->scratch[worker];
+
+    // Буферы потока выделяются при первой его полосе:
+    if (!scratch->acc) {
+        int ring = level->y_axis.max_taps;
+        if (!level->src->is_hdr || level->src->is_half) {
+            scratch->ring = (float*)mm_alloc(sizeof(float) * level->src_row * (size_t)ring);
+            scratch->ring_rows = (int*)mm_alloc(sizeof(int) * (size_t)ring);
+            for (int i = 0; i < ring; i++) scratch->ring_rows[i] = -1;
+        }
+        scratch->acc = (float*)mm_alloc(sizeof(float) * level->src_row);
+        scratch->out = (float*)mm_alloc(sizeof(float) * level->dst_row);
+    }
+    int y0 = (int)band * MIPMAP_BAND_ROWS;
+    int y1 = y0 + MIPMAP_BAND_ROWS < level->dst->height ? y0 + MIPMAP_BAND_ROWS : level->dst->height;
+    for (int y = y0; y < y1; y++) level_row(level, scratch, y);
+}
+
+// Создать пустой уровень:
+static Pixmap* create_level(int width, int height, int channels, bool is_hdr, bool is_half) {
+    Pixmap *pixmap = (Pixmap*)mm_alloc(sizeof(Pixmap));
+    pixmap->width = width;
+    pixmap->height = height;
+    pixmap->channels = channels;
+    pixmap->from_stbi = false;
+    pixmap->is_hdr = is_hdr;
+    pixmap->is_half = is_hdr && is_half;
+    pixmap->data = mm_alloc(Pixmap_get_size(pixmap));
+    return pixmap;
+}
+
+// Посчитать уровень dst из src:
+static void build_level(const Pixmap *src, Pixmap *dst, const MipSettings *settings, int alpha, size_t workers) {
+    MipLevel level = { 0 };
+    level.src = src;
+    level.dst = dst;
+    build_axis(&level.x_axis, settings->filter, src->width, dst->width);
+    build_axis(&level.y_axis, settings->filter, src->height, dst->height);
+    level.srgb = settings->srgb && !src->is_hdr;
+    level.to_linear = level.srgb ? g_Mipmap_srgb_lut : g_Mipmap_unorm_lut;
+    level.alpha = alpha;
+    level.src_row = (size_t)src->width * (size_t)src->channels;
+    level.dst_row = (size_t)dst->width * (size_t)dst->channels;
+    size_t bands = (size_t)(dst->height + MIPMAP_BAND_ROWS - 1) / MIPMAP_BAND_ROWS;
+
+    // Маленькому уровню или без потоков параллельность не нужна:
+    if (!g_JobSystem.initialized || (size_t)dst->width * (size_t)dst->height < MIPMAP_PARALLEL_PIXELS) workers = 1;
+    level.scratch = (MipScratch*)mm_calloc(workers, sizeof(MipScratch));
+    JobSystem_parallel_for(bands, workers, level_band, &level);
+
+    for (size_t i = 0; i < workers; i++) {
+        if (!level.scratch[i].acc) continue;
+        mm_free(level.scratch[i].ring);
+        mm_free(level.scratch[i].ring_rows);
+        mm_free(level.scratch[i].acc);
+        mm_free(level.scratch[i].out);
+    }
+    mm_free(level.scratch);
+    free_axis(&level.x_axis);
+    free_axis(&level.y_axis);
+}
+
+// Посчитать гистограмму альфы:
+static size_t alpha_histogram(const Pixmap *pixmap, int alpha, uint32_t hist[256]) {
+    memset(hist, 0, sizeof(uint32_t) * 256);
+    size_t count = (size_t)pixmap->width * (size_t)pixmap->height;
+    const uint8_t *data = (const uint8_t*)pixmap->data + alpha;
+    for (size_t i = 0; i < count; i++) hist[data[i * (size_t)pixmap->channels]]++;
+    return count;
+}
+
+// Масштабировать альфу (как при записи уровня):
+static inline int scale_alpha(int a, float scale) {
+    float v = (float)a * scale + 0.5f;
+    return v >= 255.0f ? 255 : (int)v;
+}
+
+// Доля пикселей, проходящих альфа-тест, если альфу масштабировать:
+static float alpha_coverage(const uint32_t hist[256], size_t count, float scale, float cutoff) {
+    size_t above = 0;
+    float threshold = cutoff * 255.0f;
+    for (int a = 0; a < 256; a++) if (hist[a] && (float)scale_alpha(a, scale) > threshold) above += hist[a];
+    return count ? (float)above / (float)count : 0.0f;
+}
+
+// Масштабировать альфу уровня так, чтобы покрытие было как у исходной картинки:
+static void preserve_coverage(Pixmap *pixmap, int alpha, float cutoff, float target) {
+    uint32_t hist[256];
+    size_t count = alpha_histogram(pixmap, alpha, hist);
+
+    // Покрытие растёт с масштабом - ищем наименьший масштаб, дающий нужное покрытие:
+    float lo = 0.0f, hi = 256.0f;
+    for (int i = 0; i < 24; i++) {
+        float mid = (lo + hi) * 0.5f;
+        if (alpha_coverage(hist, count, mid, cutoff) >= target) hi = mid;
+        else lo = mid;
+    }
+    // Покрытие меняется ступеньками - берём ближайшую к нужному из двух соседних ступенек:
+    float scale = hi;
+    if (target - alpha_coverage(hist, count, lo, cutoff) < alpha_coverage(hist, count, hi, cutoff) - target) scale = lo;
+    uint8_t table[256];
+    for (int a = 0; a < 256; a++) table[a] = (uint8_t)scale_alpha(a, scale);
+    uint8_t *data = (uint8_t*)pixmap->data + alpha;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *a = &data[i * (size_t)pixmap->channels];
+        *a = table[*a];
+    }
+}
+
+
+// -------- API мипмапов: --------
+
+
+// Построить цепочку мипмапов (settings = NULL - фильтр Кайзера, без sRGB и покрытия, все потоки):
+MipChain* Pixmap_generate_mips(const Pixmap *self, const MipSettings *settings) {
+    if (!self || !self->data || self->width <= 0 || self->height <= 0) return NULL;
+    if (self->channels < (int)PIXMAP_R || self->channels > (int)PIXMAP_RGBA) {
+        log_msg("[E] Pixmap_generate_mips: Invalid channels count: %d.\n", self->channels);
+        return NULL;
+    }
+    call_once(&g_Mipmap_once, init_luts);
+
+    MipSettings opts = settings ? *settings : (MipSettings){ MIP_FILTER_KAISER, false, 0.0f, 0, 0 };
+    int max_levels = opts.max_levels <= 0 || opts.max_levels > MIPMAP_MAX_LEVELS ? MIPMAP_MAX_LEVELS : opts.max_levels;
+    size_t workers = opts.workers ? opts.workers : JobSystem_get_max_workers_count();
+    if (workers == 0) workers = 1;
+
+    int channels = self->channels;
+    int alpha = channels == (int)PIXMAP_RG ? 1 : (channels == (int)PIXMAP_RGBA ? 3 : -1);
+    bool coverage = opts.alpha_cutoff > 0.0f && alpha >= 0 && !self->is_hdr;
+    float target = 0.0f;
+    if (coverage) {
+        uint32_t hist[256];
+        size_t count = alpha_histogram(self, alpha, hist);
+        target = alpha_coverage(hist, count, 1.0f, opts.alpha_cutoff);
+    }
+
+    MipChain *chain = (MipChain*)mm_calloc(1, sizeof(MipChain));
+    chain->levels[0] = Pixmap_copy(self);
+    chain->count = 1;
+    while (chain->count < max_levels) {
+        const Pixmap *prev = chain->levels[chain->count - 1];
+        if (prev->width == 1 && prev->height == 1) break;
+        int width = prev->width > 1 ? prev->width / 2 : 1;
+        int height = prev->height > 1 ? prev->height / 2 : 1;
+        Pixmap *level = create_level(width, height, channels, self->is_hdr, self->is_half);
+        build_level(prev, level, &opts, alpha, workers);
+        if (coverage) preserve_coverage(level, alpha, opts.alpha_cutoff, target);
+        chain->levels[chain->count++] = level;
+    }
+    return chain;
+}
+
+
+// Пересчитать картинку в размер картинки dst тем же фильтром, что и уровни (форматы должны совпадать):
+bool Pixmap_resample(const Pixmap *self, Pixmap *dst, MipFilter filter, bool srgb, size_t workers) {
+    if (!self || !dst || !self->data || !dst->data || self->width <= 0 || self->height <= 0) return false;
+    if (dst->width <= 0 || dst->height <= 0) return false;
+    if (self->channels != dst->channels || self->is_hdr != dst->is_hdr || self->is_half != dst->is_half) {
+        log_msg("[E] Pixmap_resample: Formats of the pixmaps differ.\n");
+        return false;
+    }
+    if (self->channels < (int)PIXMAP_R || self->channels > (int)PIXMAP_RGBA) {
+        log_msg("[E] Pixmap_resample: Invalid channels count: %d.\n", self->channels);
+        return false;
+    }
+    call_once(&g_Mipmap_once, init_luts);
+
+    MipSettings opts = { filter, srgb, 0.0f, 0, workers };
+    if (workers == 0) workers = JobSystem_get_max_workers_count();
+    if (workers == 0) workers = 1;
+    int alpha = self->channels == (int)PIXMAP_RG ? 1 : (self->channels == (int)PIXMAP_RGBA ? 3 : -1);
+    build_level(self, dst, &opts, alpha, workers);
+    return true;
+}
+
+
+// Уничтожить цепочку мипмапов:
+void MipChain_destroy(MipChain **chain) {
+    if (!chain || !*chain) return;
+    for (int i = 0; i < (*chain)->count; i++) Pixmap_destroy(&(*chain)->levels[i]);
+    mm_free(*chain);
+    *chain = NULL;
+}
+
+
+// Получить размер всех уровней в байтах:
+size_t MipChain_get_size(const MipChain *chain) {
+    if (!chain) return 0;
+    size_t size = 0;
+    for (int i = 0; i < chain->count; i++) size += Pixmap_get_size(chain->levels[i]);
+    return size;
+}
+
+
+// Получить название фильтра:
+const char* MipFilter_get_name(MipFilter filter) {
+    switch (filter) {
+        case MIP_FILTER_BOX:      return "box";
+        case MIP_FILTER_KAISER:   return "kaiser";
+        case MIP_FILTER_LANCZOS:  return "lanczos";
+        case MIP_FILTER_BILINEAR: return "bilinear";
+        default:                  return "unknown";
+    }
+}
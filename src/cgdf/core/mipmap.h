@@ -0,0 +1,76 @@
+//
+// mipmap.h - Построение цепочки мипмапов на процессоре.
+//
+// В отличие от glGenerateMipmap, результат не зависит от драйвера и его можно сохранить (кэш ассетов,
+// пакеты). Каждый уровень получается из предыдущего разделимым фильтром (коробка, Кайзер или Ланцош).
+// Цвет sRGB усредняется в линейном пространстве. Для текстур с альфа-тестом (листва, решётки) можно
+// сохранять покрытие: альфа каждого уровня масштабируется так, чтобы доля пикселей выше порога была
+// как у исходной картинки, иначе такие объекты "тают" вдали.
+// Большие уровни считаются полосами строк параллельно на потоках JobSystem.
+//
+// define CGDF_MIPMAP_NO_SIMD - Не использовать векторные функции SSE2/NEON.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+#include "pixmap.h"
+
+
+// Определения:
+#define MIPMAP_MAX_LEVELS       16         // Максимум уровней (исходная картинка до 32768x32768).
+#define MIPMAP_PARALLEL_PIXELS  (256*256)  // С какого размера уровня считать его параллельно.
+#define MIPMAP_BAND_ROWS        16         // Строк в одной полосе параллельного расчёта.
+
+
+// Фильтр уменьшения:
+typedef enum MipFilter {
+    MIP_FILTER_BOX,       // Среднее 2x2 (быстро, немного мыльно).
+    MIP_FILTER_KAISER,    // Sinc с окном Кайзера (ширина 3, alpha 4). Чётко, почти без звона.
+    MIP_FILTER_LANCZOS,   // Lanczos3 (самый чёткий, на контрастных краях возможен звон).
+    MIP_FILTER_BILINEAR,  // Треугольный фильтр (при увеличении - билинейная интерполяция).
+} MipFilter;
+
+
+// Объявление структур:
+typedef struct MipSettings MipSettings;  // Настройки построения мипмапов.
+typedef struct MipChain MipChain;        // Цепочка мипмапов.
+
+
+// Настройки построения мипмапов:
+struct MipSettings {
+    MipFilter filter;    // Фильтр уменьшения.
+    bool srgb;           // Цвет в sRGB (усреднять в линейном пространстве). Для HDR не используется.
+    float alpha_cutoff;  // Порог альфа-теста (0..1) для сохранения покрытия. 0 - не сохранять.
+    int max_levels;      // Максимум уровней вместе с исходным. 0 - до 1x1.
+    size_t workers;      // Количество потоков (0 - все потоки JobSystem, 1 - только вызывающий).
+};
+
+
+// Цепочка мипмапов:
+struct MipChain {
+    int count;                          // Количество уровней.
+    Pixmap *levels[MIPMAP_MAX_LEVELS];  // Уровни (0 - копия исходной картинки).
+};
+
+
+// -------- API мипмапов: --------
+
+
+// Построить цепочку мипмапов (settings = NULL - фильтр Кайзера, без sRGB и покрытия, все потоки):
+MipChain* Pixmap_generate_mips(const Pixmap *self, const MipSettings *settings);
+
+// Пересчитать картинку в размер картинки dst тем же фильтром, что и уровни (форматы должны совпадать).
+// srgb - усреднять цвет в линейном пространстве, workers = 0 - все потоки JobSystem:
+bool Pixmap_resample(const Pixmap *self, Pixmap *dst, MipFilter filter, bool srgb, size_t workers);
+
+// Уничтожить цепочку мипмапов:
+void MipChain_destroy(MipChain **chain);
+
+// Получить размер всех уровней в байтах:
+size_t MipChain_get_size(const MipChain *chain);
+
+// Получить название фильтра:
+const char* MipFilter_get_name(MipFilter filter);
@@ -1,6 +1,11 @@
 //
 // node.c - Реализует функционал системы дерева из узлов. Работает на основе ленивого дерева.
 //
+// Любое изменение в дереве увеличивает эпоху этого дерева (она хранится в корне). Узел, проверенный
+// в текущей эпохе своего дерева, отдаёт свою матрицу сразу. Иначе он проверяет родителя и сравнивает
+// версию его матрицы со своей parent_version, поэтому сеттерам не нужно обходить поддерево.
+// Изменения в других деревьях эпоху не трогают.
+//
 
 
 // Подключаем:
@@ -12,6 +17,23 @@
 #include "node.h"
 
 
+// Пометить что локальная трансформация узла изменилась:
+static inline void mark_changed(Node *self) {
+    self->changed = true;
+    self->root->tree_epoch++;
+}
+
+
+// Перенести поддерево в дерево с корнем root (проверки в старом дереве для нового недействительны):
+static void set_root(Node *self, Node *root) {
+    self->root = root;
+    self->valid_epoch = 0;
+    for (size_t i = 0; i < Array_len(self->children); i++) {
+        set_root((Node*)Array_get_ptr(self->children, i), root);
+    }
+}
+
+
 // Создать нод:
 Node* Node_create(Node *parent) {
     Node *node = (Node*)mm_alloc(sizeof(Node));
@@ -29,6 +51,11 @@ Node* Node_create(Node *parent) {
     node->scale = (Vec3d){1.0, 1.0, 1.0};
     glm_mat4_identity(node->transform);
     glm_mat4_identity(node->result_transform);
+    node->world_version = 0;
+    node->parent_version = 0;
+    node->valid_epoch = 0;
+    node->tree_epoch = 1;  // Эпохи начинаются с 1, поэтому непроверенный узел (0) никогда не актуален.
+    node->root = parent ? parent->root : node;
     node->changed = false;
     node->parent_changed = parent ? true : false;  // Если есть родитель, то пересчитать итоговую матрицу.
     return node;
@@ -67,24 +94,21 @@ Array* Node_get_children(Node *self) {
 void Node_set_position(Node *self, Vec3d position) {
     if (!self) return;
     self->position = position;
-    self->changed = true;          // Флаг о изменении нода.
-    Node_invalidate_parent(self);  // Проход потомков в глубину и установка флага parent_changed.
+    mark_changed(self);  // Флаг о изменении нода. Потомки заметят изменение по версии матрицы.
 }
 
 // Установить поворот:
 void Node_set_quaternion(Node *self, versor quaternion) {
     if (!self) return;
     glm_quat_copy(quaternion, self->quaternion);
-    self->changed = true;          // Флаг о изменении нода.
-    Node_invalidate_parent(self);  // Проход потомков в глубину и установка флага parent_changed.
+    mark_changed(self);  // Флаг о изменении нода. Потомки заметят изменение по версии матрицы.
 }
 
 // Установить масштаб:
 void Node_set_scale(Node *self, Vec3d scale) {
     if (!self) return;
     self->scale = scale;
-    self->changed = true;          // Флаг о изменении нода.
-    Node_invalidate_parent(self);  // Проход потомков в глубину и установка флага parent_changed.
+    mark_changed(self);  // Флаг о изменении нода. Потомки заметят изменение по версии матрицы.
 }
 
 // Вращать узел:
@@ -93,8 +117,7 @@ void Node_rotate(Node *self, Vec3d axis, float angle) {
     versor step;
     glm_quat(step, radians(angle), axis.x, axis.y, axis.z);
     glm_quat_mul(self->quaternion, step, self->quaternion);
-    self->changed = true;          // Флаг о изменении нода.
-    Node_invalidate_parent(self);  // Проход потомков в глубину и установка флага parent_changed.
+    mark_changed(self);  // Флаг о изменении нода. Потомки заметят изменение по версии матрицы.
 }
 
 // Получить матрицу трансформации:
@@ -158,6 +181,8 @@ Node* Node_copy(Node *self, Node *parent) {
     copy->parent = parent;
     copy->children = Array_create(sizeof(Node*), Array_capacity(self->children));  // Это обязательно!
     copy->parent_changed = true;
+    copy->valid_epoch = 0;  // Копия ещё ни разу не проверялась.
+    copy->root = parent->root;
 
     // Копируем потомков оригинала, передавая им "себя" как родителя:
     for (size_t i = 0; i < Array_len(self->children); i++) {
@@ -179,8 +204,9 @@ void Node_remove_child(Node *self, Node *child) {
     // Если нашли, удаляем его:
     if (index) {
         child->parent = NULL;           // Удаляем родителя у потомка.
-        child->parent_changed = true;   // Теперь он сам по себе, матрицы надо пересчитать.
-        Node_invalidate_parent(child);  // Помечаем все потомки что родитель изменился.
+        child->tree_epoch = 1;
+        set_root(child, child);         // Теперь он корень своего дерева.
+        Node_invalidate_parent(child);  // Теперь он сам по себе, матрицы надо пересчитать.
         Array_remove(self->children, index-1, NULL);  // index-1 потому что в find счет не с нуля.
     }
 }
@@ -207,13 +233,13 @@ void Node_set_parent(Node *self, Node *parent) {
     // Устанавливаем нового родителя:
     self->parent = parent;
 
-    // Если новый родитель существует, добавляемся к нему в список:
+    // Если новый родитель существует, добавляемся к нему в список и переходим в его дерево:
     if (parent) {
         Array_push(parent->children, &self);
+        set_root(self, parent->root);
     }
 
-    // Инвалидация (сброс) матриц для всей ветки вниз:
-    self->parent_changed = true;
+    // Инвалидация итоговой матрицы (потомки пересчитаются по версии):
     Node_invalidate_parent(self);
 }
 
@@ -227,6 +253,9 @@ Node* Node_get_parent(Node *self) {
 void Node_recalculate_matrix(Node *self) {
     if (!self) return;
 
+    // Если в этой эпохе узел уже проверялся и с тех пор ничего не менялось, матрица актуальна:
+    if (self->valid_epoch == self->root->tree_epoch) return;
+
     // Если было изменение по векторам позиции, поворота и масштаба, то пересчитываем матрицу трансформации:
     if (self->changed) {
         glm_mat4_identity(self->transform);  // Сбрасываем трансформацию.
@@ -236,32 +265,33 @@ void Node_recalculate_matrix(Node *self) {
     }
 
     // Если собственная или родительская матрицы менялись, необходимо пересчитать итоговую матрицу:
-    if (self->changed || self->parent_changed) {
-        if (self->parent) {  // Если есть родитель:
-            mat4 matrix;
-            Node_get_transform(self->parent, matrix);  // Матрица трансформации родителя.
-            glm_mat4_mul(matrix, self->transform, self->result_transform);
-        } else {  // Если нет родителя:
-            glm_mat4_copy(self->transform, self->result_transform);
+    bool recalc = self->changed || self->parent_changed;
+    if (self->parent) {  // Если есть родитель:
+        Node_recalculate_matrix(self->parent);  // Гарантируем актуальность матрицы родителя.
+        if (self->parent_version != self->parent->world_version) recalc = true;
+        if (recalc) {
+            glm_mat4_mul(self->parent->result_transform, self->transform, self->result_transform);
+            self->parent_version = self->parent->world_version;
         }
+    } else if (recalc) {  // Если нет родителя:
+        glm_mat4_copy(self->transform, self->result_transform);
+    }
+
+    if (recalc) {
+        self->world_version++;  // Потомки увидят новую версию и пересчитаются.
         self->changed = self->parent_changed = false;  // Изменения применены.
     }
+    self->valid_epoch = self->root->tree_epoch;
 }
 
-// Проход потомков в глубину с изменением флага parent_changed:
+// Пометить итоговую матрицу узла на пересчет (потомки заметят это по версии матрицы):
 void Node_invalidate_parent(Node *self) {
     if (!self) return;
-
-    // Цикл по потомкам:
-    for (size_t i = 0; i < Array_len(self->children); i++) {
-        Node *child = (Node*)Array_get_ptr(self->children, i);
-        if (!child->parent_changed) {       // Если еще не помечен.
-            child->parent_changed = true;   // Флаг о изменении родителя.
-            Node_invalidate_parent(child);  // Рекурсивный вызов для потомков выбранного потомка.
-        }
-    }
+    self->parent_changed = true;
+    self->root->tree_epoch++;
 }
 
+
 // Получить количество узлов в узле:
 size_t Node_count_nodes(Node *self) {
     if (!self) return 0;
@@ -1,6 +1,14 @@
 //
 // node.h - Определяет функционал системы дерева из узлов. Работает на основе ленивого дерева.
 //
+// Сеттеры работают за O(1): они только помечают сам узел. Актуальность итоговой матрицы потомков
+// проверяется при запросе, сравнением версии матрицы родителя с той, от которой потомок считался.
+// Смена родителя обходит перенесённое поддерево (у узлов меняется корень).
+//
+// Потоки: у каждого дерева своя эпоха (в корне), поэтому разные деревья можно менять и читать из разных
+// потоков одновременно. Одно дерево (включая чтение матриц, которое их пересчитывает) - только из одного
+// потока за раз.
+//
 
 #pragma once
 
@@ -28,8 +36,13 @@ struct Node {
     Vec3d scale;            // Масштаб узла.
     mat4 transform;         // Матрица локальной трансформации узла.
     mat4 result_transform;  // Итоговая матрица с учетом родительской трансформации.
+    uint64_t world_version;   // Версия итоговой матрицы (увеличивается при каждом пересчёте).
+    uint64_t parent_version;  // Версия итоговой матрицы родителя, от которой посчитана наша.
+    uint64_t valid_epoch;     // Эпоха дерева, в которой итоговая матрица последний раз проверялась.
+    uint64_t tree_epoch;      // Эпоха дерева (используется только у корня).
+    Node *root;               // Корень дерева, в котором хранится эпоха.
     bool changed;           // Флаг необходимости пересчета матрицы трансформации.
-    bool parent_changed;    // Флаг указывающий на изменения в родительском узле.
+    bool parent_changed;    // Флаг необходимости пересчета итоговой матрицы (смена родителя и т.п.).
 };
 
 
@@ -84,7 +97,7 @@ Node* Node_get_parent(Node *self);
 // Пересчитать матрицу трансформации:
 void Node_recalculate_matrix(Node *self);
 
-// Проход потомков в глубину с изменением флага parent_changed:
+// Пометить итоговую матрицу узла на пересчет (потомки заметят это по версии матрицы):
 void Node_invalidate_parent(Node *self);
 
 // Получить количество узлов в узле:
@@ -0,0 +1,1205 @@
+//
+// pixconv.c - Реализация преобразований форматов пикселей.
+//
+// Векторные функции обрабатывают основную часть буфера целыми блоками, а остаток (меньше блока)
+// отдают скалярной функции. Функции x86 собираются с атрибутом target, поэтому весь файл можно
+// собирать без -mavx2: векторный путь вызывается только если процессор его поддерживает.
+// Таблицы sRGB (8 бит) одинаковы для всех наборов: табличный поиск и так стоит одну загрузку на байт,
+// а выборка gather на x86 медленнее скалярного цикла.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "libs.h"
+#include "pixconv.h"
+
+#if !defined(CGDF_PIXCONV_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+    #define PIXCONV_HAS_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define PIXCONV_TARGET(isa)
+    #else
+        #define PIXCONV_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#else
+    #define PIXCONV_HAS_X86 0
+#endif
+
+#if !defined(CGDF_PIXCONV_NO_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+    #define PIXCONV_HAS_NEON 1
+    #include <arm_neon.h>
+#else
+    #define PIXCONV_HAS_NEON 0
+#endif
+
+
+// Набор функций одного набора инструкций:
+typedef struct PixConvKernels {
+    void (*r_to_rgba)(const uint8_t *src, uint8_t *dst, size_t count);
+    void (*a_to_rgba)(const uint8_t *src, uint8_t *dst, size_t count);
+    void (*rgb_to_rgba)(const uint8_t *src, uint8_t *dst, size_t count);
+    void (*rgba_to_rgb)(const uint8_t *src, uint8_t *dst, size_t count);
+    void (*swizzle_bgra)(const uint8_t *src, uint8_t *dst, size_t count);
+    void (*premultiply)(const uint8_t *src, uint8_t *dst, size_t count);
+    void (*unpremultiply)(const uint8_t *src, uint8_t *dst, size_t count);
+    void (*extract_rgba)(const uint8_t *src, int channel, uint8_t *dst, size_t count);
+    void (*srgb_to_linear_f32)(const float *src, float *dst, size_t count);
+    void (*linear_to_srgb_f32)(const float *src, float *dst, size_t count);
+    void (*f32_to_f16)(const float *src, uint16_t *dst, size_t count);
+    void (*f16_to_f32)(const uint16_t *src, float *dst, size_t count);
+} PixConvKernels;
+
+
+// Состояние модуля:
+static once_flag g_PixConv_once = ONCE_FLAG_INIT;
+static _Atomic(const PixConvKernels*) g_PixConv_kernels;  // Выбранный набор функций.
+static atomic_int g_PixConv_backend;                      // Выбранный набор инструкций.
+static uint8_t g_PixConv_srgb_to_linear[256];             // Таблица sRGB -> линейное (8 бит).
+static uint8_t g_PixConv_linear_to_srgb[256];             // Таблица линейное -> sRGB (8 бит).
+
+
+// Коэффициенты приближения log2 (ряд atanh) и exp2 (ряд Тейлора):
+#define LOG2_C1 2.8853900817779268f  // 2 / ln(2).
+#define LOG2_C3 0.9617966939259756f  // 2 / (3 ln(2)).
+#define LOG2_C5 0.5770780163555854f  // 2 / (5 ln(2)).
+#define LOG2_C7 0.4121985831111324f  // 2 / (7 ln(2)).
+#define EXP2_C1 0.6931471805599453f  // ln(2).
+#define EXP2_C2 0.2402265069591007f  // ln(2)^2 / 2!.
+#define EXP2_C3 0.0555041086648216f  // ln(2)^3 / 3!.
+#define EXP2_C4 0.0096181291076285f  // ln(2)^4 / 4!.
+#define EXP2_C5 0.0013333558146428f  // ln(2)^5 / 5!.
+#define EXP2_C6 0.0001540353039338f  // ln(2)^6 / 6!.
+
+
+// -------- Скалярные функции (эталон): --------
+
+
+// sRGB в линейное пространство (одно значение):
+static inline float srgb_to_linear(float c) {
+    return c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+}
+
+// Линейное пространство в sRGB (одно значение):
+static inline float linear_to_srgb(float c) {
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+}
+
+// float в half float (округление к ближайшему чётному, NaN остаётся NaN с верхними битами мантиссы):
+static inline uint16_t float_to_half(float f) {
+    uint32_t x, sign;
+    memcpy(&x, &f, sizeof(x));
+    sign = (x >> 16) & 0x8000u;
+    x &= 0x7FFFFFFFu;
+    if (x > 0x7F800000u) return (uint16_t)(sign | 0x7E00u | ((x >> 13) & 0x3FFu));  // NaN (тихий).
+    if (x >= 0x47800000u) return (uint16_t)(sign | 0x7C00u);  // Больше максимума half - бесконечность.
+    if (x < 0x38800000u) {
+        // Денормализованный half: сложение с магическим числом сдвигает мантиссу с округлением FPU:
+        const uint32_t magic_bits = 0x3F000000u;  // 0.5f: (127 - 15 + 23 - 10 + 1) << 23.
+        float v, magic;
+        memcpy(&v, &x, sizeof(v));
+        memcpy(&magic, &magic_bits, sizeof(magic));
+        v += magic;
+        memcpy(&x, &v, sizeof(x));
+        return (uint16_t)(sign | (x - magic_bits));
+    }
+    uint32_t odd = (x >> 13) & 1u;
+    x += 0xC8000FFFu + odd;  // Смещение экспоненты (15 - 127) << 23 и округление к чётному.
+    return (uint16_t)(sign | (x >> 13));
+}
+
+// half float в float (точно, сигнальный NaN становится тихим):
+static inline float half_to_float(uint16_t h) {
+    uint32_t x = (uint32_t)(h & 0x7FFFu) << 13, exp = x & 0x0F800000u;
+    if (exp == 0x0F800000u) {
+        x += 0x70000000u;  // Бесконечность и NaN: экспонента 255.
+        if (x & 0x007FFFFFu) x |= 0x00400000u;
+    } else if (exp == 0) {
+        // Ноль и денормализованные: нормализуем вычитанием магического числа:
+        const uint32_t magic_bits = 0x38800000u;  // 2^-14.
+        float v, magic;
+        x += magic_bits;
+        memcpy(&v, &x, sizeof(v));
+        memcpy(&magic, &magic_bits, sizeof(magic));
+        v -= magic;
+        memcpy(&x, &v, sizeof(x));
+    } else {
+        x += 0x38000000u;  // Смещение экспоненты (127 - 15) << 23.
+    }
+    x |= (uint32_t)(h & 0x8000u) << 16;
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+// Деление на 255 с округлением к ближайшему (x <= 255 * 255):
+static inline uint8_t div255(uint32_t x) {
+    x += 128;
+    return (uint8_t)((x + (x >> 8)) >> 8);
+}
+
+static void scalar_r_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i*4+0] = src[i];
+        dst[i*4+1] = src[i];
+        dst[i*4+2] = src[i];
+        dst[i*4+3] = 255;
+    }
+}
+
+static void scalar_a_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i*4+0] = 255;
+        dst[i*4+1] = 255;
+        dst[i*4+2] = 255;
+        dst[i*4+3] = src[i];
+    }
+}
+
+static void scalar_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i*4+0] = src[i*3+0];
+        dst[i*4+1] = src[i*3+1];
+        dst[i*4+2] = src[i*3+2];
+        dst[i*4+3] = 255;
+    }
+}
+
+static void scalar_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i*3+0] = src[i*4+0];
+        dst[i*3+1] = src[i*4+1];
+        dst[i*3+2] = src[i*4+2];
+    }
+}
+
+static void scalar_swizzle_bgra(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint8_t r = src[i*4+0], g = src[i*4+1], b = src[i*4+2], a = src[i*4+3];
+        dst[i*4+0] = b;
+        dst[i*4+1] = g;
+        dst[i*4+2] = r;
+        dst[i*4+3] = a;
+    }
+}
+
+static void scalar_premultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = src[i*4+3];
+        dst[i*4+0] = div255(src[i*4+0] * a);
+        dst[i*4+1] = div255(src[i*4+1] * a);
+        dst[i*4+2] = div255(src[i*4+2] * a);
+        dst[i*4+3] = (uint8_t)a;
+    }
+}
+
+static void scalar_unpremultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = src[i*4+3];
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = a ? (src[i*4+c] * 255u + a / 2) / a : 0;
+            dst[i*4+c] = (uint8_t)(v > 255 ? 255 : v);
+        }
+        dst[i*4+3] = (uint8_t)a;
+    }
+}
+
+static void scalar_extract_rgba(const uint8_t *src, int channel, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = src[i*4+channel];
+}
+
+static void scalar_srgb_to_linear_f32(const float *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = srgb_to_linear(src[i]);
+}
+
+static void scalar_linear_to_srgb_f32(const float *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = linear_to_srgb(src[i]);
+}
+
+static void scalar_f32_to_f16(const float *src, uint16_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = float_to_half(src[i]);
+}
+
+static void scalar_f16_to_f32(const uint16_t *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = half_to_float(src[i]);
+}
+
+static const PixConvKernels g_PixConv_scalar = {
+    scalar_r_to_rgba, scalar_a_to_rgba, scalar_rgb_to_rgba, scalar_rgba_to_rgb, scalar_swizzle_bgra,
+    scalar_premultiply, scalar_unpremultiply, scalar_extract_rgba,
+    scalar_srgb_to_linear_f32, scalar_linear_to_srgb_f32,
+    scalar_f32_to_f16, scalar_f16_to_f32,
+};
+
+
+// -------- Функции SSSE3 (128 бит, x86): --------
+
+
+#if PIXCONV_HAS_X86
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_r_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = _mm_unpacklo_epi8(v, v);
+        __m128i hi = _mm_unpackhi_epi8(v, v);
+        _mm_storeu_si128((__m128i*)(dst + i*4 + 0),  _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+        _mm_storeu_si128((__m128i*)(dst + i*4 + 16), _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+        _mm_storeu_si128((__m128i*)(dst + i*4 + 32), _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+        _mm_storeu_si128((__m128i*)(dst + i*4 + 48), _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+    }
+    scalar_r_to_rgba(src + i, dst + i*4, count - i);
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_a_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m128i white = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = _mm_unpacklo_epi8(zero, v);  // a << 8.
+        __m128i hi = _mm_unpackhi_epi8(zero, v);
+        _mm_storeu_si128((__m128i*)(dst + i*4 + 0),  _mm_or_si128(_mm_unpacklo_epi16(zero, lo), white));
+        _mm_storeu_si128((__m128i*)(dst + i*4 + 16), _mm_or_si128(_mm_unpackhi_epi16(zero, lo), white));
+        _mm_storeu_si128((__m128i*)(dst + i*4 + 32), _mm_or_si128(_mm_unpacklo_epi16(zero, hi), white));
+        _mm_storeu_si128((__m128i*)(dst + i*4 + 48), _mm_or_si128(_mm_unpackhi_epi16(zero, hi), white));
+    }
+    scalar_a_to_rgba(src + i, dst + i*4, count - i);
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8_t *s = src + i*3;
+        __m128i a = _mm_loadu_si128((const __m128i*)(s + 0));
+        __m128i b = _mm_loadu_si128((const __m128i*)(s + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(s + 32));
+        uint8_t *d = dst + i*4;
+        _mm_storeu_si128((__m128i*)(d + 0),  _mm_or_si128(_mm_shuffle_epi8(a, mask), alpha));
+        _mm_storeu_si128((__m128i*)(d + 16), _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), mask), alpha));
+        _mm_storeu_si128((__m128i*)(d + 32), _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), mask), alpha));
+        _mm_storeu_si128((__m128i*)(d + 48), _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), mask), alpha));
+    }
+    scalar_rgb_to_rgba(src + i*3, dst + i*4, count - i);
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8_t *s = src + i*4;
+        __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + 0)), mask);
+        __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + 16)), mask);
+        __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + 32)), mask);
+        __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + 48)), mask);
+        uint8_t *d = dst + i*3;
+        _mm_storeu_si128((__m128i*)(d + 0),  _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+        _mm_storeu_si128((__m128i*)(d + 16), _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+        _mm_storeu_si128((__m128i*)(d + 32), _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+    }
+    scalar_rgba_to_rgb(src + i*4, dst + i*3, count - i);
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_swizzle_bgra(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i*4));
+        _mm_storeu_si128((__m128i*)(dst + i*4), _mm_shuffle_epi8(v, mask));
+    }
+    scalar_swizzle_bgra(src + i*4, dst + i*4, count - i);
+}
+
+// Умножить 16-битные каналы на альфу своего пикселя с делением на 255 (альфа остаётся):
+PIXCONV_TARGET("ssse3")
+static inline __m128i sse_premultiply16(__m128i v) {
+    const __m128i rgb_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alpha255 = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+    a = _mm_or_si128(_mm_and_si128(a, rgb_mask), alpha255);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(v, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_premultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i*4));
+        __m128i lo = sse_premultiply16(_mm_unpacklo_epi8(v, zero));
+        __m128i hi = sse_premultiply16(_mm_unpackhi_epi8(v, zero));
+        _mm_storeu_si128((__m128i*)(dst + i*4), _mm_packus_epi16(lo, hi));
+    }
+    scalar_premultiply(src + i*4, dst + i*4, count - i);
+}
+
+// Разделить каналы одного пикселя (32 бита на канал) на его альфу:
+PIXCONV_TARGET("ssse3")
+static inline __m128i sse_unpremultiply32(__m128i p) {
+    const __m128i alpha_lane = _mm_setr_epi32(0, 0, 0, -1);
+    __m128i ai = _mm_shuffle_epi32(p, 0xFF);
+    __m128 a = _mm_cvtepi32_ps(ai);
+    __m128 n = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(p), _mm_set1_ps(255.0f)), _mm_cvtepi32_ps(_mm_srli_epi32(ai, 1)));
+    __m128 q = _mm_min_ps(_mm_div_ps(n, a), _mm_set1_ps(255.0f));  // Частное точное до целой части.
+    q = _mm_andnot_ps(_mm_cmpeq_ps(a, _mm_setzero_ps()), q);         // Альфа 0 - цвет 0.
+    __m128i r = _mm_cvttps_epi32(q);
+    return _mm_or_si128(_mm_andnot_si128(alpha_lane, r), _mm_and_si128(alpha_lane, p));
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_unpremultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i*4));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i p0 = sse_unpremultiply32(_mm_unpacklo_epi16(lo, zero));
+        __m128i p1 = sse_unpremultiply32(_mm_unpackhi_epi16(lo, zero));
+        __m128i p2 = sse_unpremultiply32(_mm_unpacklo_epi16(hi, zero));
+        __m128i p3 = sse_unpremultiply32(_mm_unpackhi_epi16(hi, zero));
+        __m128i out = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+        _mm_storeu_si128((__m128i*)(dst + i*4), out);
+    }
+    scalar_unpremultiply(src + i*4, dst + i*4, count - i);
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_extract_rgba(const uint8_t *src, int channel, uint8_t *dst, size_t count) {
+    const char c = (char)channel;
+    const __m128i mask = _mm_setr_epi8(c, c + 4, c + 8, c + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8_t *s = src + i*4;
+        __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + 0)), mask);
+        __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + 16)), mask);
+        __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + 32)), mask);
+        __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + 48)), mask);
+        __m128i out = _mm_or_si128(_mm_or_si128(p0, _mm_slli_si128(p1, 4)), _mm_or_si128(_mm_slli_si128(p2, 8), _mm_slli_si128(p3, 12)));
+        _mm_storeu_si128((__m128i*)(dst + i), out);
+    }
+    scalar_extract_rgba(src + i*4, channel, dst + i, count - i);
+}
+
+// Приближение log2 (x > 0):
+PIXCONV_TARGET("ssse3")
+static inline __m128 sse_log2(__m128 x) {
+    __m128i bits = _mm_castps_si128(x);
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x7FFFFF)), _mm_set1_epi32(0x3F800000)));
+    __m128 big = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));  // Мантисса в [sqrt(2)/2, sqrt(2)).
+    m = _mm_or_ps(_mm_andnot_ps(big, m), _mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))));
+    __m128 ef = _mm_add_ps(_mm_cvtepi32_ps(e), _mm_and_ps(big, _mm_set1_ps(1.0f)));
+    __m128 t = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 p = _mm_add_ps(_mm_set1_ps(LOG2_C5), _mm_mul_ps(t2, _mm_set1_ps(LOG2_C7)));
+    p = _mm_add_ps(_mm_set1_ps(LOG2_C3), _mm_mul_ps(t2, p));
+    p = _mm_add_ps(_mm_set1_ps(LOG2_C1), _mm_mul_ps(t2, p));
+    return _mm_add_ps(ef, _mm_mul_ps(t, p));
+}
+
+// Приближение exp2:
+PIXCONV_TARGET("ssse3")
+static inline __m128 sse_exp2(__m128 y) {
+    y = _mm_max_ps(_mm_min_ps(y, _mm_set1_ps(127.0f)), _mm_set1_ps(-126.0f));
+    __m128i i = _mm_cvtps_epi32(y);  // Округление к ближайшему: f в [-0.5, 0.5].
+    __m128 f = _mm_sub_ps(y, _mm_cvtepi32_ps(i));
+    __m128 p = _mm_add_ps(_mm_set1_ps(EXP2_C5), _mm_mul_ps(f, _mm_set1_ps(EXP2_C6)));
+    p = _mm_add_ps(_mm_set1_ps(EXP2_C4), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(EXP2_C3), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(EXP2_C2), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(EXP2_C1), _mm_mul_ps(f, p));
+    p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(f, p));
+    return _mm_mul_ps(p, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23)));
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_srgb_to_linear_f32(const float *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 c = _mm_loadu_ps(src + i);
+        __m128 low = _mm_div_ps(c, _mm_set1_ps(12.92f));
+        __m128 x = _mm_div_ps(_mm_add_ps(c, _mm_set1_ps(0.055f)), _mm_set1_ps(1.055f));
+        x = _mm_max_ps(x, _mm_set1_ps(1e-30f));  // Ветка pow не нужна для таких значений, но log2 должен быть конечным.
+        __m128 high = sse_exp2(_mm_mul_ps(sse_log2(x), _mm_set1_ps(2.4f)));
+        __m128 is_low = _mm_cmple_ps(c, _mm_set1_ps(0.04045f));
+        _mm_storeu_ps(dst + i, _mm_or_ps(_mm_and_ps(is_low, low), _mm_andnot_ps(is_low, high)));
+    }
+    scalar_srgb_to_linear_f32(src + i, dst + i, count - i);
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_linear_to_srgb_f32(const float *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 c = _mm_loadu_ps(src + i);
+        __m128 low = _mm_mul_ps(c, _mm_set1_ps(12.92f));
+        __m128 x = _mm_max_ps(c, _mm_set1_ps(1e-30f));
+        __m128 high = sse_exp2(_mm_mul_ps(sse_log2(x), _mm_set1_ps(1.0f / 2.4f)));
+        high = _mm_sub_ps(_mm_mul_ps(high, _mm_set1_ps(1.055f)), _mm_set1_ps(0.055f));
+        __m128 is_low = _mm_cmple_ps(c, _mm_set1_ps(0.0031308f));
+        _mm_storeu_ps(dst + i, _mm_or_ps(_mm_and_ps(is_low, low), _mm_andnot_ps(is_low, high)));
+    }
+    scalar_linear_to_srgb_f32(src + i, dst + i, count - i);
+}
+
+// Без F16C half считается целочисленно, тем же способом что и в скалярной функции:
+PIXCONV_TARGET("ssse3")
+static void ssse3_f32_to_f16(const float *src, uint16_t *dst, size_t count) {
+    const __m128i abs_mask = _mm_set1_epi32(0x7FFFFFFF), f32_inf = _mm_set1_epi32(0x7F800000);
+    const __m128i f16_max = _mm_set1_epi32(0x47800000), min_normal = _mm_set1_epi32(0x38800000);
+    const __m128i magic = _mm_set1_epi32(0x3F000000), bias = _mm_set1_epi32((int)0xC8000FFF);
+    const __m128i one = _mm_set1_epi32(1), inf16 = _mm_set1_epi32(0x7C00), nan16 = _mm_set1_epi32(0x7E00);
+    const __m128i mant16 = _mm_set1_epi32(0x3FF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i out[2];
+        for (int k = 0; k < 2; k++) {
+            __m128i x = _mm_castps_si128(_mm_loadu_ps(src + i + (size_t)k * 4));
+            __m128i sign = _mm_srai_epi32(_mm_andnot_si128(abs_mask, x), 16);  // 0xFFFF8000 у отрицательных.
+            x = _mm_and_si128(x, abs_mask);
+            __m128i denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(magic))), magic);
+            __m128i normal = _mm_add_epi32(_mm_add_epi32(x, bias), _mm_and_si128(_mm_srli_epi32(x, 13), one));
+            normal = _mm_srli_epi32(normal, 13);
+            __m128i is_denorm = _mm_cmpgt_epi32(min_normal, x);
+            __m128i v = _mm_or_si128(_mm_and_si128(is_denorm, denorm), _mm_andnot_si128(is_denorm, normal));
+            __m128i is_nan = _mm_cmpgt_epi32(x, f32_inf);
+            __m128i special = _mm_or_si128(
+                _mm_andnot_si128(is_nan, inf16),
+                _mm_and_si128(is_nan, _mm_or_si128(nan16, _mm_and_si128(_mm_srli_epi32(x, 13), mant16)))
+            );
+            __m128i is_big = _mm_cmpgt_epi32(f16_max, x);  // Обычное значение (не переполнение и не NaN).
+            v = _mm_or_si128(_mm_and_si128(is_big, v), _mm_andnot_si128(is_big, special));
+            out[k] = _mm_or_si128(v, sign);
+        }
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(out[0], out[1]));
+    }
+    scalar_f32_to_f16(src + i, dst + i, count - i);
+}
+
+PIXCONV_TARGET("ssse3")
+static void ssse3_f16_to_f32(const uint16_t *src, float *dst, size_t count) {
+    const __m128i abs_mask = _mm_set1_epi32(0x7FFF), inf16 = _mm_set1_epi32(0x7C00), min_normal = _mm_set1_epi32(0x0400);
+    const __m128i bias = _mm_set1_epi32(0x38000000), inf_bias = _mm_set1_epi32(0x38000000);
+    const __m128i magic = _mm_set1_epi32(0x38800000), quiet = _mm_set1_epi32(0x00400000);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h8 = _mm_loadu_si128((const __m128i*)(src + i));
+        for (int k = 0; k < 2; k++) {
+            __m128i h = k == 0 ? _mm_unpacklo_epi16(h8, _mm_setzero_si128()) : _mm_unpackhi_epi16(h8, _mm_setzero_si128());
+            __m128i em = _mm_and_si128(h, abs_mask);
+            __m128i shifted = _mm_slli_epi32(em, 13);
+            __m128i is_special = _mm_cmpgt_epi32(em, _mm_sub_epi32(inf16, _mm_set1_epi32(1)));  // em >= 0x7C00.
+            __m128i is_nan = _mm_cmpgt_epi32(em, inf16);
+            __m128i is_denorm = _mm_cmpgt_epi32(min_normal, em);
+            __m128i normal = _mm_add_epi32(_mm_add_epi32(shifted, bias), _mm_and_si128(is_special, inf_bias));
+            normal = _mm_or_si128(normal, _mm_and_si128(is_nan, quiet));
+            __m128i denorm = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(shifted, magic)), _mm_castsi128_ps(magic)));
+            __m128i v = _mm_or_si128(_mm_and_si128(is_denorm, denorm), _mm_andnot_si128(is_denorm, normal));
+            v = _mm_or_si128(v, _mm_slli_epi32(_mm_andnot_si128(abs_mask, h), 16));
+            _mm_storeu_si128((__m128i*)(dst + i + (size_t)k * 4), v);
+        }
+    }
+    scalar_f16_to_f32(src + i, dst + i, count - i);
+}
+
+static const PixConvKernels g_PixConv_ssse3 = {
+    ssse3_r_to_rgba, ssse3_a_to_rgba, ssse3_rgb_to_rgba, ssse3_rgba_to_rgb, ssse3_swizzle_bgra,
+    ssse3_premultiply, ssse3_unpremultiply, ssse3_extract_rgba,
+    ssse3_srgb_to_linear_f32, ssse3_linear_to_srgb_f32,
+    ssse3_f32_to_f16, ssse3_f16_to_f32,
+};
+
+
+// -------- Функции AVX2 (256 бит, x86): --------
+
+
+PIXCONV_TARGET("avx2")
+static void avx2_r_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+    const __m256i spread = _mm256_set1_epi32(0x010101);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+        __m256i hi = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i + 8)));
+        _mm256_storeu_si256((__m256i*)(dst + i*4),      _mm256_or_si256(_mm256_mullo_epi32(lo, spread), alpha));
+        _mm256_storeu_si256((__m256i*)(dst + i*4 + 32), _mm256_or_si256(_mm256_mullo_epi32(hi, spread), alpha));
+    }
+    ssse3_r_to_rgba(src + i, dst + i*4, count - i);
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_a_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m256i white = _mm256_set1_epi32(0x00FFFFFF);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+        __m256i hi = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i + 8)));
+        _mm256_storeu_si256((__m256i*)(dst + i*4),      _mm256_or_si256(_mm256_slli_epi32(lo, 24), white));
+        _mm256_storeu_si256((__m256i*)(dst + i*4 + 32), _mm256_or_si256(_mm256_slli_epi32(hi, 24), white));
+    }
+    ssse3_a_to_rgba(src + i, dst + i*4, count - i);
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m256i mask = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+    );
+    const __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);  // Байты 0..11 в нижнюю половину, 12..23 в верхнюю.
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+    for (; i + 11 <= count; i += 8) {  // Читаем 32 байта, используем 24.
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i*3));
+        v = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(v, spread), mask);
+        _mm256_storeu_si256((__m256i*)(dst + i*4), _mm256_or_si256(v, alpha));
+    }
+    ssse3_rgb_to_rgba(src + i*3, dst + i*4, count - i);
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m256i mask = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+    );
+    const __m256i pack = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);  // 12 байт из каждой половины подряд.
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i*4));
+        v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, mask), pack);
+        _mm_storeu_si128((__m128i*)(dst + i*3), _mm256_castsi256_si128(v));
+        _mm_storel_epi64((__m128i*)(dst + i*3 + 16), _mm256_extracti128_si256(v, 1));
+    }
+    ssse3_rgba_to_rgb(src + i*4, dst + i*3, count - i);
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_swizzle_bgra(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m256i mask = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+    );
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i*4));
+        _mm256_storeu_si256((__m256i*)(dst + i*4), _mm256_shuffle_epi8(v, mask));
+    }
+    ssse3_swizzle_bgra(src + i*4, dst + i*4, count - i);
+}
+
+// Умножить 16-битные каналы на альфу своего пикселя с делением на 255 (альфа остаётся):
+PIXCONV_TARGET("avx2")
+static inline __m256i avx2_premultiply16(__m256i v) {
+    const __m256i rgb_mask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+    const __m256i alpha255 = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xFF), 0xFF);
+    a = _mm256_or_si256(_mm256_and_si256(a, rgb_mask), alpha255);
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(v, a), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_premultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i*4));
+        __m256i lo = avx2_premultiply16(_mm256_unpacklo_epi8(v, zero));
+        __m256i hi = avx2_premultiply16(_mm256_unpackhi_epi8(v, zero));
+        _mm256_storeu_si256((__m256i*)(dst + i*4), _mm256_packus_epi16(lo, hi));
+    }
+    ssse3_premultiply(src + i*4, dst + i*4, count - i);
+}
+
+// Разделить каналы двух пикселей (32 бита на канал, по пикселю в половине) на их альфу:
+PIXCONV_TARGET("avx2")
+static inline __m256i avx2_unpremultiply32(__m256i p) {
+    const __m256i alpha_lane = _mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1);
+    __m256i ai = _mm256_shuffle_epi32(p, 0xFF);
+    __m256 a = _mm256_cvtepi32_ps(ai);
+    __m256 n = _mm256_add_ps(
+        _mm256_mul_ps(_mm256_cvtepi32_ps(p), _mm256_set1_ps(255.0f)), _mm256_cvtepi32_ps(_mm256_srli_epi32(ai, 1))
+    );
+    __m256 q = _mm256_min_ps(_mm256_div_ps(n, a), _mm256_set1_ps(255.0f));
+    q = _mm256_andnot_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_EQ_OQ), q);
+    __m256i r = _mm256_cvttps_epi32(q);
+    return _mm256_blendv_epi8(r, p, alpha_lane);
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_unpremultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint8_t *s = src + i*4;
+        __m256i p0 = avx2_unpremultiply32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + 0))));
+        __m256i p1 = avx2_unpremultiply32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + 8))));
+        __m256i p2 = avx2_unpremultiply32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + 16))));
+        __m256i p3 = avx2_unpremultiply32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + 24))));
+        // Упаковка идёт по половинам, поэтому после неё пиксели переставлены - возвращаем порядок:
+        __m256i out = _mm256_packus_epi16(_mm256_packs_epi32(p0, p1), _mm256_packs_epi32(p2, p3));
+        out = _mm256_permutevar8x32_epi32(out, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        _mm256_storeu_si256((__m256i*)(dst + i*4), out);
+    }
+    ssse3_unpremultiply(src + i*4, dst + i*4, count - i);
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_extract_rgba(const uint8_t *src, int channel, uint8_t *dst, size_t count) {
+    const char c = (char)channel;
+    const __m256i mask = _mm256_setr_epi8(
+        c, c + 4, c + 8, c + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        c, c + 4, c + 8, c + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+    );
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const uint8_t *s = src + i*4;
+        __m256i p0 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(s + 0)), mask);
+        __m256i p1 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(s + 32)), mask);
+        __m256i p2 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(s + 64)), mask);
+        __m256i p3 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(s + 96)), mask);
+        __m256i v = _mm256_unpacklo_epi64(_mm256_unpacklo_epi32(p0, p1), _mm256_unpacklo_epi32(p2, p3));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permutevar8x32_epi32(v, order));
+    }
+    ssse3_extract_rgba(src + i*4, channel, dst + i, count - i);
+}
+
+// Приближение log2 (x > 0):
+PIXCONV_TARGET("avx2")
+static inline __m256 avx2_log2(__m256 x) {
+    __m256i bits = _mm256_castps_si256(x);
+    __m256i e = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+    __m256 m = _mm256_castsi256_ps(
+        _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFF)), _mm256_set1_epi32(0x3F800000))
+    );
+    __m256 big = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+    m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), big);
+    __m256 ef = _mm256_add_ps(_mm256_cvtepi32_ps(e), _mm256_and_ps(big, _mm256_set1_ps(1.0f)));
+    __m256 t = _mm256_div_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_add_ps(m, _mm256_set1_ps(1.0f)));
+    __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 p = _mm256_add_ps(_mm256_set1_ps(LOG2_C5), _mm256_mul_ps(t2, _mm256_set1_ps(LOG2_C7)));
+    p = _mm256_add_ps(_mm256_set1_ps(LOG2_C3), _mm256_mul_ps(t2, p));
+    p = _mm256_add_ps(_mm256_set1_ps(LOG2_C1), _mm256_mul_ps(t2, p));
+    return _mm256_add_ps(ef, _mm256_mul_ps(t, p));
+}
+
+// Приближение exp2:
+PIXCONV_TARGET("avx2")
+static inline __m256 avx2_exp2(__m256 y) {
+    y = _mm256_max_ps(_mm256_min_ps(y, _mm256_set1_ps(127.0f)), _mm256_set1_ps(-126.0f));
+    __m256i i = _mm256_cvtps_epi32(y);
+    __m256 f = _mm256_sub_ps(y, _mm256_cvtepi32_ps(i));
+    __m256 p = _mm256_add_ps(_mm256_set1_ps(EXP2_C5), _mm256_mul_ps(f, _mm256_set1_ps(EXP2_C6)));
+    p = _mm256_add_ps(_mm256_set1_ps(EXP2_C4), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(EXP2_C3), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(EXP2_C2), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(EXP2_C1), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(f, p));
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(i, _mm256_set1_epi32(127)), 23)));
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_srgb_to_linear_f32(const float *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 c = _mm256_loadu_ps(src + i);
+        __m256 low = _mm256_div_ps(c, _mm256_set1_ps(12.92f));
+        __m256 x = _mm256_div_ps(_mm256_add_ps(c, _mm256_set1_ps(0.055f)), _mm256_set1_ps(1.055f));
+        x = _mm256_max_ps(x, _mm256_set1_ps(1e-30f));
+        __m256 high = avx2_exp2(_mm256_mul_ps(avx2_log2(x), _mm256_set1_ps(2.4f)));
+        __m256 is_low = _mm256_cmp_ps(c, _mm256_set1_ps(0.04045f), _CMP_LE_OQ);
+        _mm256_storeu_ps(dst + i, _mm256_blendv_ps(high, low, is_low));
+    }
+    ssse3_srgb_to_linear_f32(src + i, dst + i, count - i);
+}
+
+PIXCONV_TARGET("avx2")
+static void avx2_linear_to_srgb_f32(const float *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 c = _mm256_loadu_ps(src + i);
+        __m256 low = _mm256_mul_ps(c, _mm256_set1_ps(12.92f));
+        __m256 x = _mm256_max_ps(c, _mm256_set1_ps(1e-30f));
+        __m256 high = avx2_exp2(_mm256_mul_ps(avx2_log2(x), _mm256_set1_ps(1.0f / 2.4f)));
+        high = _mm256_sub_ps(_mm256_mul_ps(high, _mm256_set1_ps(1.055f)), _mm256_set1_ps(0.055f));
+        __m256 is_low = _mm256_cmp_ps(c, _mm256_set1_ps(0.0031308f), _CMP_LE_OQ);
+        _mm256_storeu_ps(dst + i, _mm256_blendv_ps(high, low, is_low));
+    }
+    ssse3_linear_to_srgb_f32(src + i, dst + i, count - i);
+}
+
+PIXCONV_TARGET("avx2,f16c")
+static void avx2_f32_to_f16(const float *src, uint16_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        __m128i b = _mm256_cvtps_ph(_mm256_loadu_ps(src + i + 8), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(dst + i), a);
+        _mm_storeu_si128((__m128i*)(dst + i + 8), b);
+    }
+    scalar_f32_to_f16(src + i, dst + i, count - i);
+}
+
+PIXCONV_TARGET("avx2,f16c")
+static void avx2_f16_to_f32(const uint16_t *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+        _mm256_storeu_ps(dst + i + 8, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i + 8))));
+    }
+    scalar_f16_to_f32(src + i, dst + i, count - i);
+}
+
+static const PixConvKernels g_PixConv_avx2 = {
+    avx2_r_to_rgba, avx2_a_to_rgba, avx2_rgb_to_rgba, avx2_rgba_to_rgb, avx2_swizzle_bgra,
+    avx2_premultiply, avx2_unpremultiply, avx2_extract_rgba,
+    avx2_srgb_to_linear_f32, avx2_linear_to_srgb_f32,
+    avx2_f32_to_f16, avx2_f16_to_f32,
+};
+
+#endif  // PIXCONV_HAS_X86
+
+
+// -------- Функции NEON (128 бит, AArch64): --------
+
+
+#if PIXCONV_HAS_NEON
+
+static void neon_r_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t v = vld1q_u8(src + i);
+        uint8x16x4_t out = { { v, v, v, vdupq_n_u8(255) } };
+        vst4q_u8(dst + i*4, out);
+    }
+    scalar_r_to_rgba(src + i, dst + i*4, count - i);
+}
+
+static void neon_a_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    const uint8x16_t white = vdupq_n_u8(255);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t out = { { white, white, white, vld1q_u8(src + i) } };
+        vst4q_u8(dst + i*4, out);
+    }
+    scalar_a_to_rgba(src + i, dst + i*4, count - i);
+}
+
+static void neon_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t v = vld3q_u8(src + i*3);
+        uint8x16x4_t out = { { v.val[0], v.val[1], v.val[2], vdupq_n_u8(255) } };
+        vst4q_u8(dst + i*4, out);
+    }
+    scalar_rgb_to_rgba(src + i*3, dst + i*4, count - i);
+}
+
+static void neon_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i*4);
+        uint8x16x3_t out = { { v.val[0], v.val[1], v.val[2] } };
+        vst3q_u8(dst + i*3, out);
+    }
+    scalar_rgba_to_rgb(src + i*4, dst + i*3, count - i);
+}
+
+static void neon_swizzle_bgra(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i*4);
+        uint8x16_t r = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = r;
+        vst4q_u8(dst + i*4, v);
+    }
+    scalar_swizzle_bgra(src + i*4, dst + i*4, count - i);
+}
+
+// Умножить канал на альфу с делением на 255 (округление как у div255):
+static inline uint8x16_t neon_mul_div255(uint8x16_t c, uint8x16_t a) {
+    uint16x8_t lo = vmull_u8(vget_low_u8(c), vget_low_u8(a));
+    uint16x8_t hi = vmull_high_u8(c, a);
+    lo = vrsraq_n_u16(lo, lo, 8);  // t + ((t + 128) >> 8).
+    hi = vrsraq_n_u16(hi, hi, 8);
+    return vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8));
+}
+
+static void neon_premultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i*4);
+        v.val[0] = neon_mul_div255(v.val[0], v.val[3]);
+        v.val[1] = neon_mul_div255(v.val[1], v.val[3]);
+        v.val[2] = neon_mul_div255(v.val[2], v.val[3]);
+        vst4q_u8(dst + i*4, v);
+    }
+    scalar_premultiply(src + i*4, dst + i*4, count - i);
+}
+
+// Разделить 4 значения канала на альфу:
+static inline uint32x4_t neon_unpremultiply4(uint32x4_t c, uint32x4_t a) {
+    float32x4_t af = vcvtq_f32_u32(a);
+    float32x4_t n = vaddq_f32(vmulq_f32(vcvtq_f32_u32(c), vdupq_n_f32(255.0f)), vcvtq_f32_u32(vshrq_n_u32(a, 1)));
+    float32x4_t q = vminq_f32(vdivq_f32(n, af), vdupq_n_f32(255.0f));
+    return vandq_u32(vcvtq_u32_f32(q), vcgtq_u32(a, vdupq_n_u32(0)));
+}
+
+// Разделить 16 значений канала на альфу:
+static inline uint8x16_t neon_unpremultiply16(uint8x16_t c, uint8x16_t a) {
+    uint16x8_t c_lo = vmovl_u8(vget_low_u8(c)), c_hi = vmovl_high_u8(c);
+    uint16x8_t a_lo = vmovl_u8(vget_low_u8(a)), a_hi = vmovl_high_u8(a);
+    uint32x4_t r0 = neon_unpremultiply4(vmovl_u16(vget_low_u16(c_lo)), vmovl_u16(vget_low_u16(a_lo)));
+    uint32x4_t r1 = neon_unpremultiply4(vmovl_high_u16(c_lo), vmovl_high_u16(a_lo));
+    uint32x4_t r2 = neon_unpremultiply4(vmovl_u16(vget_low_u16(c_hi)), vmovl_u16(vget_low_u16(a_hi)));
+    uint32x4_t r3 = neon_unpremultiply4(vmovl_high_u16(c_hi), vmovl_high_u16(a_hi));
+    uint16x8_t lo = vcombine_u16(vmovn_u32(r0), vmovn_u32(r1));
+    uint16x8_t hi = vcombine_u16(vmovn_u32(r2), vmovn_u32(r3));
+    return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+}
+
+static void neon_unpremultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i*4);
+        v.val[0] = neon_unpremultiply16(v.val[0], v.val[3]);
+        v.val[1] = neon_unpremultiply16(v.val[1], v.val[3]);
+        v.val[2] = neon_unpremultiply16(v.val[2], v.val[3]);
+        vst4q_u8(dst + i*4, v);
+    }
+    scalar_unpremultiply(src + i*4, dst + i*4, count - i);
+}
+
+static void neon_extract_rgba(const uint8_t *src, int channel, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + i*4);
+        vst1q_u8(dst + i, v.val[channel]);
+    }
+    scalar_extract_rgba(src + i*4, channel, dst + i, count - i);
+}
+
+// Приближение log2 (x > 0):
+static inline float32x4_t neon_log2(float32x4_t x) {
+    uint32x4_t bits = vreinterpretq_u32_f32(x);
+    int32x4_t e = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127));
+    float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x7FFFFF)), vdupq_n_u32(0x3F800000)));
+    uint32x4_t big = vcgtq_f32(m, vdupq_n_f32(1.41421356f));
+    m = vbslq_f32(big, vmulq_f32(m, vdupq_n_f32(0.5f)), m);
+    float32x4_t ef = vaddq_f32(vcvtq_f32_s32(e), vreinterpretq_f32_u32(vandq_u32(big, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+    float32x4_t t = vdivq_f32(vsubq_f32(m, vdupq_n_f32(1.0f)), vaddq_f32(m, vdupq_n_f32(1.0f)));
+    float32x4_t t2 = vmulq_f32(t, t);
+    float32x4_t p = vaddq_f32(vdupq_n_f32(LOG2_C5), vmulq_f32(t2, vdupq_n_f32(LOG2_C7)));
+    p = vaddq_f32(vdupq_n_f32(LOG2_C3), vmulq_f32(t2, p));
+    p = vaddq_f32(vdupq_n_f32(LOG2_C1), vmulq_f32(t2, p));
+    return vaddq_f32(ef, vmulq_f32(t, p));
+}
+
+// Приближение exp2:
+static inline float32x4_t neon_exp2(float32x4_t y) {
+    y = vmaxq_f32(vminq_f32(y, vdupq_n_f32(127.0f)), vdupq_n_f32(-126.0f));
+    int32x4_t i = vcvtnq_s32_f32(y);
+    float32x4_t f = vsubq_f32(y, vcvtq_f32_s32(i));
+    float32x4_t p = vaddq_f32(vdupq_n_f32(EXP2_C5), vmulq_f32(f, vdupq_n_f32(EXP2_C6)));
+    p = vaddq_f32(vdupq_n_f32(EXP2_C4), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(EXP2_C3), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(EXP2_C2), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(EXP2_C1), vmulq_f32(f, p));
+    p = vaddq_f32(vdupq_n_f32(1.0f), vmulq_f32(f, p));
+    return vmulq_f32(p, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(i, vdupq_n_s32(127)), 23)));
+}
+
+static void neon_srgb_to_linear_f32(const float *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t c = vld1q_f32(src + i);
+        float32x4_t low = vdivq_f32(c, vdupq_n_f32(12.92f));
+        float32x4_t x = vdivq_f32(vaddq_f32(c, vdupq_n_f32(0.055f)), vdupq_n_f32(1.055f));
+        x = vmaxq_f32(x, vdupq_n_f32(1e-30f));
+        float32x4_t high = neon_exp2(vmulq_f32(neon_log2(x), vdupq_n_f32(2.4f)));
+        vst1q_f32(dst + i, vbslq_f32(vcleq_f32(c, vdupq_n_f32(0.04045f)), low, high));
+    }
+    scalar_srgb_to_linear_f32(src + i, dst + i, count - i);
+}
+
+static void neon_linear_to_srgb_f32(const float *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t c = vld1q_f32(src + i);
+        float32x4_t low = vmulq_f32(c, vdupq_n_f32(12.92f));
+        float32x4_t x = vmaxq_f32(c, vdupq_n_f32(1e-30f));
+        float32x4_t high = neon_exp2(vmulq_f32(neon_log2(x), vdupq_n_f32(1.0f / 2.4f)));
+        high = vsubq_f32(vmulq_f32(high, vdupq_n_f32(1.055f)), vdupq_n_f32(0.055f));
+        vst1q_f32(dst + i, vbslq_f32(vcleq_f32(c, vdupq_n_f32(0.0031308f)), low, high));
+    }
+    scalar_linear_to_srgb_f32(src + i, dst + i, count - i);
+}
+
+static void neon_f32_to_f16(const float *src, uint16_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float16x4_t a = vcvt_f16_f32(vld1q_f32(src + i));
+        float16x4_t b = vcvt_f16_f32(vld1q_f32(src + i + 4));
+        vst1q_u16(dst + i, vcombine_u16(vreinterpret_u16_f16(a), vreinterpret_u16_f16(b)));
+    }
+    scalar_f32_to_f16(src + i, dst + i, count - i);
+}
+
+static void neon_f16_to_f32(const uint16_t *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t h = vld1q_u16(src + i);
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(h))));
+        vst1q_f32(dst + i + 4, vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(h))));
+    }
+    scalar_f16_to_f32(src + i, dst + i, count - i);
+}
+
+static const PixConvKernels g_PixConv_neon = {
+    neon_r_to_rgba, neon_a_to_rgba, neon_rgb_to_rgba, neon_rgba_to_rgb, neon_swizzle_bgra,
+    neon_premultiply, neon_unpremultiply, neon_extract_rgba,
+    neon_srgb_to_linear_f32, neon_linear_to_srgb_f32,
+    neon_f32_to_f16, neon_f16_to_f32,
+};
+
+#endif  // PIXCONV_HAS_NEON
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Получить набор функций для набора инструкций:
+static const PixConvKernels* kernels_for(PixConvBackend backend) {
+    switch (backend) {
+        #if PIXCONV_HAS_X86
+            case PIXCONV_SSSE3: return &g_PixConv_ssse3;
+            case PIXCONV_AVX2:  return &g_PixConv_avx2;
+        #endif
+        #if PIXCONV_HAS_NEON
+            case PIXCONV_NEON:  return &g_PixConv_neon;
+        #endif
+        default: return &g_PixConv_scalar;
+    }
+}
+
+// Выбрать лучший набор инструкций и заполнить таблицы sRGB (один раз):
+static void pixconv_init(void) {
+    for (int i = 0; i < 256; i++) {
+        g_PixConv_srgb_to_linear[i] = (uint8_t)(srgb_to_linear(i / 255.0f) * 255.0f + 0.5f);
+        g_PixConv_linear_to_srgb[i] = (uint8_t)(linear_to_srgb(i / 255.0f) * 255.0f + 0.5f);
+    }
+    PixConvBackend best = PIXCONV_SCALAR;
+    if (PixConv_is_supported(PIXCONV_NEON)) best = PIXCONV_NEON;
+    if (PixConv_is_supported(PIXCONV_SSSE3)) best = PIXCONV_SSSE3;
+    if (PixConv_is_supported(PIXCONV_AVX2)) best = PIXCONV_AVX2;
+    atomic_store(&g_PixConv_backend, (int)best);
+    atomic_store(&g_PixConv_kernels, kernels_for(best));
+}
+
+// Получить текущий набор функций:
+static inline const PixConvKernels* kernels(void) {
+    call_once(&g_PixConv_once, pixconv_init);
+    return atomic_load_explicit(&g_PixConv_kernels, memory_order_relaxed);
+}
+
+// Преобразовать по таблице (у 2- и 4-канальных пикселей альфа не меняется):
+static void apply_table(const uint8_t *table, const uint8_t *src, uint8_t *dst, size_t count, int channels) {
+    if (channels == 4) {
+        for (size_t i = 0; i < count; i++) {
+            dst[i*4+0] = table[src[i*4+0]];
+            dst[i*4+1] = table[src[i*4+1]];
+            dst[i*4+2] = table[src[i*4+2]];
+            dst[i*4+3] = src[i*4+3];
+        }
+        return;
+    }
+    if (channels == 2) {
+        for (size_t i = 0; i < count; i++) {
+            dst[i*2+0] = table[src[i*2+0]];
+            dst[i*2+1] = src[i*2+1];
+        }
+        return;
+    }
+    size_t size = count * (size_t)channels;
+    for (size_t i = 0; i < size; i++) dst[i] = table[src[i]];
+}
+
+
+// -------- API выбора набора инструкций: --------
+
+
+// Получить используемый набор инструкций:
+PixConvBackend PixConv_get_backend(void) {
+    kernels();
+    return (PixConvBackend)atomic_load(&g_PixConv_backend);
+}
+
+
+// Выбрать набор инструкций (false если процессор его не поддерживает):
+bool PixConv_set_backend(PixConvBackend backend) {
+    kernels();
+    if (!PixConv_is_supported(backend)) return false;
+    atomic_store(&g_PixConv_backend, (int)backend);
+    atomic_store(&g_PixConv_kernels, kernels_for(backend));
+    return true;
+}
+
+
+// Поддерживает ли процессор набор инструкций:
+bool PixConv_is_supported(PixConvBackend backend) {
+    switch (backend) {
+        case PIXCONV_SCALAR: return true;
+        #if PIXCONV_HAS_X86
+            #if defined(_MSC_VER) && !defined(__clang__)
+                case PIXCONV_SSSE3: {
+                    int info[4];
+                    __cpuid(info, 1);
+                    return (info[2] & (1 << 9)) != 0;
+                }
+                case PIXCONV_AVX2: {
+                    int info[4];
+                    __cpuid(info, 1);
+                    bool os_avx = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;  // ОС сохраняет YMM регистры.
+                    bool f16c = (info[2] & (1 << 29)) != 0;
+                    __cpuidex(info, 7, 0);
+                    return os_avx && f16c && (info[1] & (1 << 5)) != 0;
+                }
+            #else
+                case PIXCONV_SSSE3: __builtin_cpu_init(); return __builtin_cpu_supports("ssse3");
+                case PIXCONV_AVX2: {
+                    __builtin_cpu_init();
+                    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+                }
+            #endif
+        #endif
+        #if PIXCONV_HAS_NEON
+            case PIXCONV_NEON: return true;  // NEON обязателен на AArch64.
+        #endif
+        default: return false;
+    }
+}
+
+
+// Получить название набора инструкций:
+const char* PixConv_get_backend_name(PixConvBackend backend) {
+    switch (backend) {
+        case PIXCONV_SCALAR: return "scalar";
+        case PIXCONV_SSSE3:  return "ssse3";
+        case PIXCONV_AVX2:   return "avx2";
+        case PIXCONV_NEON:   return "neon";
+        default:             return "unknown";
+    }
+}
+
+
+// -------- API преобразований (8 бит на канал): --------
+
+
+// Яркость в RGBA (r, r, r, 255):
+void PixConv_r_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    kernels()->r_to_rgba(src, dst, count);
+}
+
+
+// Покрытие в RGBA (255, 255, 255, a). Растры глифов:
+void PixConv_a_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    kernels()->a_to_rgba(src, dst, count);
+}
+
+
+// RGB в RGBA (альфа 255):
+void PixConv_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count) {
+    kernels()->rgb_to_rgba(src, dst, count);
+}
+
+
+// RGBA в RGB (альфа отбрасывается):
+void PixConv_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count) {
+    kernels()->rgba_to_rgb(src, dst, count);
+}
+
+
+// Поменять местами R и B (RGBA <-> BGRA):
+void PixConv_swizzle_bgra(const uint8_t *src, uint8_t *dst, size_t count) {
+    kernels()->swizzle_bgra(src, dst, count);
+}
+
+
+// Умножить цвет на альфу (RGBA, округление к ближайшему):
+void PixConv_premultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    kernels()->premultiply(src, dst, count);
+}
+
+
+// Разделить цвет на альфу (RGBA, при альфе 0 цвет обнуляется):
+void PixConv_unpremultiply(const uint8_t *src, uint8_t *dst, size_t count) {
+    kernels()->unpremultiply(src, dst, count);
+}
+
+
+// Извлечь один канал из пикселей с channels каналами:
+void PixConv_extract_channel(const uint8_t *src, int channels, int channel, uint8_t *dst, size_t count) {
+    if (channels <= 0 || channel < 0 || channel >= channels) return;
+    if (channels == 4) {
+        kernels()->extract_rgba(src, channel, dst, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) dst[i] = src[i * (size_t)channels + (size_t)channel];
+}
+
+
+// sRGB в линейное пространство по таблице (у 2- и 4-канальных пикселей альфа не меняется):
+void PixConv_srgb_to_linear8(const uint8_t *src, uint8_t *dst, size_t count, int channels) {
+    kernels();
+    apply_table(g_PixConv_srgb_to_linear, src, dst, count, channels);
+}
+
+
+// Линейное пространство в sRGB по таблице (у 2- и 4-канальных пикселей альфа не меняется):
+void PixConv_linear_to_srgb8(const uint8_t *src, uint8_t *dst, size_t count, int channels) {
+    kernels();
+    apply_table(g_PixConv_linear_to_srgb, src, dst, count, channels);
+}
+
+
+// -------- API преобразований (float): --------
+
+
+// sRGB в линейное пространство (каждое значение, альфу передавать не нужно):
+void PixConv_srgb_to_linear_f32(const float *src, float *dst, size_t count) {
+    kernels()->srgb_to_linear_f32(src, dst, count);
+}
+
+
+// Линейное пространство в sRGB (каждое значение, значения больше 1 допустимы):
+void PixConv_linear_to_srgb_f32(const float *src, float *dst, size_t count) {
+    kernels()->linear_to_srgb_f32(src, dst, count);
+}
+
+
+// -------- API преобразований (half float): --------
+
+
+// float в half float (округление к ближайшему чётному, больше 65504 - бесконечность):
+void PixConv_f32_to_f16(const float *src, uint16_t *dst, size_t count) {
+    kernels()->f32_to_f16(src, dst, count);
+}
+
+
+// half float в float (точно):
+void PixConv_f16_to_f32(const uint16_t *src, float *dst, size_t count) {
+    kernels()->f16_to_f32(src, dst, count);
+}
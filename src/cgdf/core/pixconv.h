@@ -0,0 +1,102 @@
+//
+// pixconv.h - Преобразование форматов пикселей (SIMD с выбором набора инструкций при запуске).
+//
+// Каждое преобразование есть в скалярном виде (эталон) и в векторных: SSSE3 и AVX2 (вместе с F16C) на x86,
+// NEON на AArch64. Лучший доступный набор выбирается при первом вызове по возможностям процессора, его можно
+// сменить через PixConv_set_backend (например, чтобы сравнить результат с эталоном).
+// Целочисленные преобразования дают в точности тот же результат что и эталон, float sRGB в векторных
+// путях считается приближением pow (ошибка меньше 1e-5 от значения, в 8 бит это не видно).
+// Half float (16 бит) во всех наборах совпадает с эталоном бит в бит: AVX2 и NEON используют инструкции
+// преобразования процессора, SSSE3 считает то же целочисленно.
+//
+// count - количество пикселей (для float функций - количество значений). src и dst могут совпадать у
+// преобразований, где размер пикселя не меняется, иначе буферы не должны пересекаться.
+//
+// define CGDF_PIXCONV_NO_SIMD - Всегда использовать скалярный путь.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+
+
+// Набор инструкций:
+typedef enum PixConvBackend {
+    PIXCONV_SCALAR = 0,  // Скалярный код (эталон).
+    PIXCONV_SSSE3,       // 128 бит, x86.
+    PIXCONV_AVX2,        // 256 бит, x86 (с F16C для half float).
+    PIXCONV_NEON,        // 128 бит, AArch64.
+    PIXCONV_BACKEND_COUNT,
+} PixConvBackend;
+
+
+// -------- API выбора набора инструкций: --------
+
+
+// Получить используемый набор инструкций:
+PixConvBackend PixConv_get_backend(void);
+
+// Выбрать набор инструкций (false если процессор его не поддерживает):
+bool PixConv_set_backend(PixConvBackend backend);
+
+// Поддерживает ли процессор набор инструкций:
+bool PixConv_is_supported(PixConvBackend backend);
+
+// Получить название набора инструкций:
+const char* PixConv_get_backend_name(PixConvBackend backend);
+
+
+// -------- API преобразований (8 бит на канал): --------
+
+
+// Яркость в RGBA (r, r, r, 255):
+void PixConv_r_to_rgba(const uint8_t *src, uint8_t *dst, size_t count);
+
+// Покрытие в RGBA (255, 255, 255, a). Растры глифов:
+void PixConv_a_to_rgba(const uint8_t *src, uint8_t *dst, size_t count);
+
+// RGB в RGBA (альфа 255):
+void PixConv_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count);
+
+// RGBA в RGB (альфа отбрасывается):
+void PixConv_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count);
+
+// Поменять местами R и B (RGBA <-> BGRA):
+void PixConv_swizzle_bgra(const uint8_t *src, uint8_t *dst, size_t count);
+
+// Умножить цвет на альфу (RGBA, округление к ближайшему):
+void PixConv_premultiply(const uint8_t *src, uint8_t *dst, size_t count);
+
+// Разделить цвет на альфу (RGBA, при альфе 0 цвет обнуляется):
+void PixConv_unpremultiply(const uint8_t *src, uint8_t *dst, size_t count);
+
+// Извлечь один канал из пикселей с channels каналами:
+void PixConv_extract_channel(const uint8_t *src, int channels, int channel, uint8_t *dst, size_t count);
+
+// sRGB в линейное пространство по таблице (у 2- и 4-канальных пикселей альфа не меняется):
+void PixConv_srgb_to_linear8(const uint8_t *src, uint8_t *dst, size_t count, int channels);
+
+// Линейное пространство в sRGB по таблице (у 2- и 4-канальных пикселей альфа не меняется):
+void PixConv_linear_to_srgb8(const uint8_t *src, uint8_t *dst, size_t count, int channels);
+
+
+// -------- API преобразований (float): --------
+
+
+// sRGB в линейное пространство (каждое значение, альфу передавать не нужно):
+void PixConv_srgb_to_linear_f32(const float *src, float *dst, size_t count);
+
+// Линейное пространство в sRGB (каждое значение, значения больше 1 допустимы):
+void PixConv_linear_to_srgb_f32(const float *src, float *dst, size_t count);
+
+
+// -------- API преобразований (half float): --------
+
+
+// float в half float (округление к ближайшему чётному, больше 65504 - бесконечность):
+void PixConv_f32_to_f16(const float *src, uint16_t *dst, size_t count);
+
+// half float в float (точно):
+void PixConv_f16_to_f32(const uint16_t *src, float *dst, size_t count);
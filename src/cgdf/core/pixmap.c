@@ -8,9 +8,208 @@
 #include "mm.h"
 #include "logger.h"
 #include "libs.h"
+#include "files.h"
+#include "jobsystem.h"
+#include "assetcache.h"
+#include "pixconv.h"
 #include "pixmap.h"
 
 
+// Заголовок подготовленной картинки в кэше (за ним идут пиксели):
+typedef struct CookedPixmap {
+    int32_t width, height;  // Размер картинки.
+    int32_t channels;       // Количество каналов.
+    int32_t is_hdr;         // Пиксели во float.
+} CookedPixmap;
+
+
+// Сколько значений half float преобразовывать за раз через буфер на стеке:
+#define HALF_CHUNK 1024
+
+
+// Общие данные пакетной загрузки:
+typedef struct LoadBatch {
+    PixmapLoadRequest *requests;  // Запросы.
+    PixmapLoadCallback callback;  // Обработчик готовой картинки (может быть NULL).
+    void *user;                   // Данные обработчика.
+} LoadBatch;
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Взять декодированную картинку из кэша ассетов:
+static bool load_cooked(Pixmap *pixmap, uint64_t key) {
+    CookedAsset cooked;
+    if (!AssetCache_load("pixmap", key, &cooked)) return false;
+
+    CookedPixmap header;
+    bool valid = cooked.size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, cooked.data, sizeof(header));
+        pixmap->width = header.width;
+        pixmap->height = header.height;
+        pixmap->channels = header.channels;
+        pixmap->is_hdr = header.is_hdr != 0;
+        pixmap->is_half = false;
+        valid = header.width > 0 && header.height > 0 && cooked.size == sizeof(header) + Pixmap_get_size(pixmap);
+    }
+    if (valid) {
+        size_t size = cooked.size - sizeof(header);
+        pixmap->data = mm_alloc(size);
+        memcpy(pixmap->data, cooked.data + sizeof(header), size);
+        pixmap->from_stbi = false;
+    } else pixmap->is_hdr = pixmap->is_half = false;
+    AssetCache_release(&cooked);
+    return valid;
+}
+
+// Сохранить декодированную картинку в кэш ассетов:
+static void store_cooked(Pixmap *pixmap, uint64_t key) {
+    CookedPixmap header = { pixmap->width, pixmap->height, pixmap->channels, pixmap->is_hdr };
+    CookedPart parts[2] = {
+        { &header, sizeof(header) },
+        { pixmap->data, Pixmap_get_size(pixmap) },
+    };
+    AssetCache_store("pixmap", key, parts, 2);
+}
+
+// Яркость цвета (как в stb_image):
+static inline uint8_t luminance(const uint8_t *rgb) {
+    return (uint8_t)((rgb[0] * 77 + rgb[1] * 150 + rgb[2] * 29) >> 8);
+}
+
+// Преобразовать количество каналов попиксельно (пары без векторного пути):
+static void convert_generic(const uint8_t *src, int src_channels, uint8_t *dst, int dst_channels, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *s = src + i * (size_t)src_channels;
+        uint8_t *d = dst + i * (size_t)dst_channels;
+        uint8_t r, g, b, a = src_channels == 2 ? s[1] : src_channels == 4 ? s[3] : 255;
+        if (src_channels <= 2) r = g = b = s[0];
+        else { r = s[0]; g = s[1]; b = s[2]; }
+        if (dst_channels <= 2) {
+            d[0] = src_channels <= 2 ? r : luminance(s);
+            if (dst_channels == 2) d[1] = a;
+        } else {
+            d[0] = r; d[1] = g; d[2] = b;
+            if (dst_channels == 4) d[3] = a;
+        }
+    }
+}
+
+// Применить float sRGB преобразование к цвету пикселей (альфа не меняется):
+static void convert_float_color(float *data, size_t count, int channels, void (*func)(const float*, float*, size_t)) {
+    if (channels == 1 || channels == 3) {
+        func(data, data, count * (size_t)channels);
+        return;
+    }
+    size_t color = (size_t)channels - 1;
+    for (size_t i = 0; i < count; i++) func(data + i * (size_t)channels, data + i * (size_t)channels, color);
+}
+
+// Применить float sRGB преобразование к цвету HDR картинки (half - кусками через float буфер):
+static void convert_hdr_color(Pixmap *self, void (*func)(const float*, float*, size_t)) {
+    size_t count = (size_t)self->width * (size_t)self->height;
+    if (!self->is_half) {
+        convert_float_color((float*)self->data, count, self->channels, func);
+        return;
+    }
+    float buffer[HALF_CHUNK];
+    uint16_t *data = (uint16_t*)self->data;
+    size_t step = HALF_CHUNK / (size_t)self->channels;
+    for (size_t i = 0; i < count; i += step) {
+        size_t pixels = count - i < step ? count - i : step;
+        uint16_t *chunk = data + i * (size_t)self->channels;
+        PixConv_f16_to_f32(chunk, buffer, pixels * (size_t)self->channels);
+        convert_float_color(buffer, pixels, self->channels, func);
+        PixConv_f32_to_f16(buffer, chunk, pixels * (size_t)self->channels);
+    }
+}
+
+// Заменить блок данных картинки (старый освобождается так же, как в Pixmap_destroy):
+static void replace_data(Pixmap *self, void *data, int channels, bool is_half) {
+    if (self->from_stbi) {
+        stbi_image_free(self->data);
+        mm_used_size_sub(Pixmap_get_size(self));
+    } else mm_free(self->data);
+    self->data = data;
+    self->channels = channels;
+    self->is_half = is_half;
+    self->from_stbi = false;
+}
+
+// Декодировать файл картинки в pixmap (false - файл не найден или не декодирован):
+static bool load_file(Pixmap *pixmap, const char *filepath, int channels) {
+    if (channels <= 0) channels = (int)PIXMAP_RGBA;
+    pixmap->is_hdr = pixmap->is_half = false;
+    pixmap->data = NULL;
+
+    // Файл берём через Files_map (он может лежать в смонтированном пакете) и декодируем из памяти:
+    FileMap file = Files_map(filepath, FILE_MAP_SEQUENTIAL);
+
+    // Картинка уже декодирована в кэше ассетов (ключ - байты файла и запрошенные каналы):
+    bool cache = file.data && AssetCache_is_enabled();
+    uint64_t key = 0;
+    if (cache) {
+        int32_t settings = channels;
+        key = AssetCache_key("pixmap", file.data, file.size, &settings, sizeof(settings));
+        if (load_cooked(pixmap, key)) {
+            Files_unmap(&file);
+            return true;
+        }
+    }
+
+    if (file.data && file.size <= INT_MAX) {
+        // Загружаем как float (32 бита на канал), если это HDR картинка:
+        if (stbi_is_hdr_from_memory(file.data, (int)file.size)) {
+            if (channels >= (int)PIXMAP_RGBA) channels = (int)PIXMAP_RGB;  // Ограничиваем максимум 3 каналами.
+            pixmap->data = stbi_loadf_from_memory(
+                file.data, (int)file.size, &pixmap->width, &pixmap->height, NULL, channels
+            );
+            pixmap->is_hdr = true;
+        }
+        // Загружаем как обычную картинку (8 бит на канал):
+        else {
+            pixmap->data = stbi_load_from_memory(
+                file.data, (int)file.size, &pixmap->width, &pixmap->height, NULL, channels
+            );
+        }
+    }
+    Files_unmap(&file);
+
+    pixmap->channels = channels;
+    if (pixmap->data == NULL) return false;
+    pixmap->from_stbi = true;
+    mm_used_size_add(Pixmap_get_size(pixmap));
+    if (cache) store_cooked(pixmap, key);
+    return true;
+}
+
+
+// Декодировать один файл пакета (полоса JobSystem_parallel_for):
+static void load_batch_file(void *args, size_t index, size_t worker) {
+    (void)worker;
+    LoadBatch *batch = (LoadBatch*)args;
+    PixmapLoadRequest *request = &batch->requests[index];
+    request->pixmap = NULL;
+    request->loaded = false;
+    if (request->path) {
+        Pixmap *pixmap = (Pixmap*)mm_alloc(sizeof(Pixmap));
+        request->loaded = load_file(pixmap, request->path, request->channels);
+        if (request->loaded) request->pixmap = pixmap;
+        else {
+            log_msg("[E] Pixmap_load_many: file \"%s\" not found/loaded.\n", request->path);
+            mm_free(pixmap);
+        }
+    }
+    if (!request->pixmap) request->pixmap = Pixmap_create_default();
+    if (batch->callback) batch->callback(request, index, batch->user);
+}
+
+
+// -------- API картинки: --------
+
+
 // Создать картинку:
 Pixmap* Pixmap_create(int width, int height, int channels) {
     Pixmap *pixmap = (Pixmap*)mm_alloc(sizeof(Pixmap));
@@ -22,6 +221,7 @@ Pixmap* Pixmap_create(int width, int height, int channels) {
     pixmap->channels = channels;
     pixmap->from_stbi = false;
     pixmap->is_hdr = false;
+    pixmap->is_half = false;
     return pixmap;
 }
 
@@ -45,29 +245,22 @@ Pixmap* Pixmap_load(const char *filepath, int channels) {
     if (filepath == NULL) return Pixmap_create_default();
 
     Pixmap *pixmap = (Pixmap*)mm_alloc(sizeof(Pixmap));
-    if (channels <= 0) channels = (int)PIXMAP_RGBA;
-    pixmap->is_hdr = false;
+    if (load_file(pixmap, filepath, channels)) return pixmap;
+    log_msg("[E] Pixmap_load: file \"%s\" not found/loaded.\n", filepath);
+    mm_free(pixmap);
+    return Pixmap_create_default();
+}
 
-    // Загружаем как float (32 бита на канал), если это HDR картинка:
-    if (stbi_is_hdr(filepath)) {
-        if (channels >= (int)PIXMAP_RGBA) channels = (int)PIXMAP_RGB;  // Ограничиваем максимум 3 каналами.
-        pixmap->data = stbi_loadf(filepath, &pixmap->width, &pixmap->height, NULL, channels);
-        pixmap->is_hdr = true;
-    }
-    // Загружаем как обычную картинку (8 бит на канал):
-    else {
-        pixmap->data = stbi_load(filepath, &pixmap->width, &pixmap->height, NULL, channels);
-    }
 
-    pixmap->channels = channels;
-    if (pixmap->data == NULL) {
-        log_msg("[E] Pixmap_load: file \"%s\" not found/loaded.\n", filepath);
-        mm_free(pixmap);
-        return Pixmap_create_default();
-    }
-    pixmap->from_stbi = true;
-    mm_used_size_add(Pixmap_get_size(pixmap));
-    return pixmap;
+// Загрузить несколько картинок параллельно (workers = 0 - все потоки JobSystem). Возвращает сколько загружено:
+size_t Pixmap_load_many(PixmapLoadRequest *requests, size_t count, size_t workers, PixmapLoadCallback callback, void *user) {
+    if (!requests || count == 0) return 0;
+    LoadBatch batch = { requests, callback, user };
+    JobSystem_parallel_for(count, workers, load_batch_file, &batch);
+
+    size_t loaded = 0;
+    for (size_t i = 0; i < count; i++) loaded += requests[i].loaded;
+    return loaded;
 }
 
 
@@ -82,7 +275,13 @@ bool Pixmap_save(Pixmap *self, const char *filepath, const char *format) {
             log_msg("[E] Pixmap_save: Cannot save LDR pixmap as HDR without conversion.\n");
             return false;
         }
-        success = stbi_write_hdr(filepath, self->width, self->height, self->channels, (const float*)self->data);
+        if (self->is_half) {
+            size_t count = (size_t)self->width * (size_t)self->height * (size_t)self->channels;
+            float *data = (float*)mm_alloc(count * sizeof(float));
+            PixConv_f16_to_f32((const uint16_t*)self->data, data, count);
+            success = stbi_write_hdr(filepath, self->width, self->height, self->channels, data);
+            mm_free(data);
+        } else success = stbi_write_hdr(filepath, self->width, self->height, self->channels, (const float*)self->data);
     } else if (strcmp(format, "png") == 0) {
         if (self->is_hdr) {
             log_msg("[E] Pixmap_save: Cannot save HDR pixmap as PNG directly.\n");
@@ -127,6 +326,7 @@ Pixmap* Pixmap_copy(const Pixmap *source) {
     copy->channels = source->channels;
     copy->from_stbi = false;
     copy->is_hdr = source->is_hdr;
+    copy->is_half = source->is_half;
 
     // Вычисляем размер буфера:
     size_t size = Pixmap_get_size((Pixmap*)source);
@@ -162,6 +362,7 @@ Pixmap* Pixmap_create_default(void) {
     pixmap->channels = PIXMAP_RGBA;
     pixmap->from_stbi = false;
     pixmap->is_hdr = false;
+    pixmap->is_half = false;
 
     return pixmap;
 }
@@ -171,7 +372,134 @@ Pixmap* Pixmap_create_default(void) {
 size_t Pixmap_get_size(Pixmap *self) {
     if (!self) return 0;
     size_t size = self->width * self->height * self->channels;
-    return self->is_hdr ? (size * sizeof(float)) : (size * sizeof(unsigned char));
+    if (self->is_hdr) return size * (self->is_half ? sizeof(uint16_t) : sizeof(float));
+    return size * sizeof(unsigned char);
+}
+
+
+// Преобразовать картинку в другое количество каналов (8 бит на канал, новая картинка):
+Pixmap* Pixmap_convert(const Pixmap *self, int channels) {
+    if (!self || !self->data) return NULL;
+    if (self->is_hdr) {
+        log_msg("[E] Pixmap_convert: HDR pixmaps are not supported.\n");
+        return NULL;
+    }
+    if (channels < (int)PIXMAP_R || channels > (int)PIXMAP_RGBA || self->channels < (int)PIXMAP_R || self->channels > (int)PIXMAP_RGBA) {
+        log_msg("[E] Pixmap_convert: Invalid channels count (%d -> %d).\n", self->channels, channels);
+        return NULL;
+    }
+    if (channels == self->channels) return Pixmap_copy(self);
+
+    Pixmap *pixmap = Pixmap_create(self->width, self->height, channels);
+    const uint8_t *src = (const uint8_t*)self->data;
+    uint8_t *dst = (uint8_t*)pixmap->data;
+    size_t count = (size_t)self->width * (size_t)self->height;
+    if (self->channels == 1 && channels == 4) PixConv_r_to_rgba(src, dst, count);
+    else if (self->channels == 3 && channels == 4) PixConv_rgb_to_rgba(src, dst, count);
+    else if (self->channels == 4 && channels == 3) PixConv_rgba_to_rgb(src, dst, count);
+    else convert_generic(src, self->channels, dst, channels, count);
+    return pixmap;
+}
+
+
+// Умножить цвет на альфу (RGBA, на месте):
+bool Pixmap_premultiply(Pixmap *self) {
+    if (!self || !self->data || self->is_hdr || self->channels != (int)PIXMAP_RGBA) return false;
+    PixConv_premultiply(self->data, self->data, (size_t)self->width * (size_t)self->height);
+    return true;
+}
+
+
+// Разделить цвет на альфу (RGBA, на месте):
+bool Pixmap_unpremultiply(Pixmap *self) {
+    if (!self || !self->data || self->is_hdr || self->channels != (int)PIXMAP_RGBA) return false;
+    PixConv_unpremultiply(self->data, self->data, (size_t)self->width * (size_t)self->height);
+    return true;
+}
+
+
+// Перевести цвет из sRGB в линейное пространство (на месте, альфа не меняется):
+bool Pixmap_srgb_to_linear(Pixmap *self) {
+    if (!self || !self->data) return false;
+    if (self->is_hdr) convert_hdr_color(self, PixConv_srgb_to_linear_f32);
+    else PixConv_srgb_to_linear8(self->data, self->data, (size_t)self->width * (size_t)self->height, self->channels);
+    return true;
+}
+
+
+// Перевести цвет из линейного пространства в sRGB (на месте, альфа не меняется):
+bool Pixmap_linear_to_srgb(Pixmap *self) {
+    if (!self || !self->data) return false;
+    if (self->is_hdr) convert_hdr_color(self, PixConv_linear_to_srgb_f32);
+    else PixConv_linear_to_srgb8(self->data, self->data, (size_t)self->width * (size_t)self->height, self->channels);
+    return true;
+}
+
+
+// Перевести HDR картинку в half float (channels = 0 - не менять каналы, 4 у RGB - добавить альфу 1.0):
+bool Pixmap_to_half(Pixmap *self, int channels) {
+    if (!self || !self->data) return false;
+    if (!self->is_hdr) {
+        log_msg("[E] Pixmap_to_half: LDR pixmaps are not supported.\n");
+        return false;
+    }
+    if (channels <= 0) channels = self->channels;
+    if (channels != self->channels && !(channels == (int)PIXMAP_RGBA && self->channels == (int)PIXMAP_RGB)) {
+        log_msg("[E] Pixmap_to_half: Invalid channels count (%d -> %d).\n", self->channels, channels);
+        return false;
+    }
+    if (self->is_half && channels == self->channels) return true;
+
+    // Half не больше float, поэтому блок stbi переводим на месте: кусок уходит в буфер на стеке раньше, чем
+    // на его место пишется результат, а потом realloc отдаёт хвост блока без копирования. Блоку mm_alloc
+    // ужаться без копии нельзя, поэтому для него (и для растущего half RGB в RGBA) пишем сразу в новый блок:
+    size_t count = (size_t)self->width * (size_t)self->height;
+    size_t old_size = Pixmap_get_size(self), new_size = count * (size_t)channels * sizeof(uint16_t);
+    bool in_place = self->from_stbi && !self->is_half;
+    uint16_t *data = in_place ? (uint16_t*)self->data : (uint16_t*)mm_alloc(new_size);
+    uint16_t buffer[HALF_CHUNK * 4];
+    for (size_t i = 0; i < count; i += HALF_CHUNK) {
+        size_t pixels = count - i < HALF_CHUNK ? count - i : HALF_CHUNK;
+        size_t values = pixels * (size_t)self->channels;
+        uint16_t *dst = data + i * (size_t)channels;
+        if (self->is_half) memcpy(buffer, (const uint16_t*)self->data + i * (size_t)self->channels, values * sizeof(uint16_t));
+        else PixConv_f32_to_f16((const float*)self->data + i * (size_t)self->channels, buffer, values);
+        if (channels == self->channels) {
+            memcpy(dst, buffer, values * sizeof(uint16_t));
+            continue;
+        }
+        for (size_t j = 0; j < pixels; j++) {  // RGB в RGBA с альфой 1.0 (0x3C00).
+            dst[j * 4 + 0] = buffer[j * 3 + 0];
+            dst[j * 4 + 1] = buffer[j * 3 + 1];
+            dst[j * 4 + 2] = buffer[j * 3 + 2];
+            dst[j * 4 + 3] = 0x3C00;
+        }
+    }
+    if (!in_place) {
+        replace_data(self, data, channels, true);
+        return true;
+    }
+
+    // Ужимаем блок stbi (он выделен через malloc) до нового размера:
+    void *shrunk = realloc(self->data, new_size);
+    if (shrunk) self->data = shrunk;
+    mm_used_size_sub(old_size);
+    mm_used_size_add(shrunk ? new_size : old_size);
+    self->channels = channels;
+    self->is_half = true;
+    return true;
+}
+
+
+// Перевести half float картинку обратно во float:
+bool Pixmap_to_float(Pixmap *self) {
+    if (!self || !self->data || !self->is_hdr) return false;
+    if (!self->is_half) return true;
+    size_t count = (size_t)self->width * (size_t)self->height * (size_t)self->channels;
+    float *data = (float*)mm_alloc(count * sizeof(float));
+    PixConv_f16_to_f32((const uint16_t*)self->data, data, count);
+    replace_data(self, data, self->channels, false);
+    return true;
 }
 
 
@@ -1,6 +1,9 @@
 //
 // pixmap.h - Код для работы с растровыми картинками.
 //
+// Пиксели хранятся 8 бит на канал, а у HDR картинок - float (32 бита) или half float (16 бит, is_half) на
+// канал. Half вдвое экономит память и грузится в видеокарту как есть (RGBA16F) без преобразования драйвером.
+//
 
 #pragma once
 
@@ -26,7 +29,8 @@ extern const int g_Pixmap_default_icon_height;
 
 
 // Объявление структур:
-typedef struct Pixmap Pixmap;  // Картинка.
+typedef struct Pixmap Pixmap;                        // Картинка.
+typedef struct PixmapLoadRequest PixmapLoadRequest;  // Запрос пакетной загрузки картинки.
 
 
 // Структура картинки:
@@ -36,10 +40,24 @@ struct Pixmap {
     int channels;    // Количество байт на пиксель.
     bool from_stbi;  // Флаг, что картинка загружена с помощью stbi.
     bool is_hdr;     // Флаг, что картинка HDR.
-    void *data;      // Указатель на блок данных (либо unsigned char* либо float*).
+    bool is_half;    // Флаг, что HDR картинка хранится в half float (вместе с is_hdr).
+    void *data;      // Указатель на блок данных (unsigned char*, float* или uint16_t* у half).
+};
+
+
+// Запрос пакетной загрузки картинки:
+struct PixmapLoadRequest {
+    const char *path;  // Путь к файлу.
+    int channels;      // Нужное количество каналов (0 - RGBA).
+    Pixmap *pixmap;    // Результат (при ошибке - стандартная картинка, как у Pixmap_load).
+    bool loaded;       // Удалось ли загрузить файл.
 };
 
 
+// Обработчик готовой картинки пакетной загрузки (вызывается в потоке, который её декодировал):
+typedef void (*PixmapLoadCallback)(PixmapLoadRequest *request, size_t index, void *user);
+
+
 // Создать картинку:
 Pixmap* Pixmap_create(int width, int height, int channels);
 
@@ -49,6 +67,9 @@ void Pixmap_destroy(Pixmap **pixmap);
 // Загрузить картинку:
 Pixmap* Pixmap_load(const char *filepath, int channels);
 
+// Загрузить несколько картинок параллельно (workers = 0 - все потоки JobSystem). Возвращает сколько загружено:
+size_t Pixmap_load_many(PixmapLoadRequest *requests, size_t count, size_t workers, PixmapLoadCallback callback, void *user);
+
 // Сохранить картинку:
 bool Pixmap_save(Pixmap *self, const char *filepath, const char *format);
 
@@ -60,3 +81,24 @@ Pixmap* Pixmap_create_default(void);
 
 // Получить размер картинки в байтах:
 size_t Pixmap_get_size(Pixmap *self);
+
+// Преобразовать картинку в другое количество каналов (8 бит на канал, новая картинка):
+Pixmap* Pixmap_convert(const Pixmap *self, int channels);
+
+// Умножить цвет на альфу (RGBA, на месте):
+bool Pixmap_premultiply(Pixmap *self);
+
+// Разделить цвет на альфу (RGBA, на месте):
+bool Pixmap_unpremultiply(Pixmap *self);
+
+// Перевести цвет из sRGB в линейное пространство (на месте, альфа не меняется):
+bool Pixmap_srgb_to_linear(Pixmap *self);
+
+// Перевести цвет из линейного пространства в sRGB (на месте, альфа не меняется):
+bool Pixmap_linear_to_srgb(Pixmap *self);
+
+// Перевести HDR картинку в half float (channels = 0 - не менять каналы, 4 у RGB - добавить альфу 1.0):
+bool Pixmap_to_half(Pixmap *self, int channels);
+
+// Перевести half float картинку обратно во float:
+bool Pixmap_to_float(Pixmap *self);
@@ -0,0 +1,230 @@
+//
+// pixops.c - Реализация операций над картинками.
+//
+// Копирование и заливка идут строками через memcpy (он уже векторный), заливка собирает одну строку
+// и размножает её. Ближайший пиксель при масштабировании берётся по заранее посчитанной таблице
+// смещений столбцов, а одинаковые подряд выходные строки (увеличение) копируются целиком.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "logger.h"
+#include "jobsystem.h"
+#include "pixconv.h"
+#include "mipmap.h"
+#include "pixops.h"
+
+
+// Масштабирование ближайшим пикселем (общие данные потоков):
+typedef struct PixNearest {
+    const Pixmap *src;  // Исходная картинка.
+    Pixmap *dst;        // Новая картинка.
+    size_t pixel;       // Байт на пиксель.
+    size_t *columns;    // Смещение исходного пикселя в строке для каждого выходного столбца.
+} PixNearest;
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Создать пустую картинку в формате картинки format:
+static Pixmap* create_pixmap(int width, int height, const Pixmap *format) {
+    Pixmap *pixmap = (Pixmap*)mm_alloc(sizeof(Pixmap));
+    pixmap->width = width;
+    pixmap->height = height;
+    pixmap->channels = format->channels;
+    pixmap->from_stbi = false;
+    pixmap->is_hdr = format->is_hdr;
+    pixmap->is_half = format->is_hdr && format->is_half;
+    pixmap->data = mm_alloc(Pixmap_get_size(pixmap));
+    return pixmap;
+}
+
+// Байт на пиксель:
+static inline size_t pixel_size(const Pixmap *pixmap) {
+    if (pixmap->is_hdr) return (size_t)pixmap->channels * (pixmap->is_half ? sizeof(uint16_t) : sizeof(float));
+    return (size_t)pixmap->channels;
+}
+
+// Обрезать прямоугольник по картинке. false - от него ничего не осталось:
+static bool clip_rect(const Pixmap *pixmap, int *x, int *y, int *width, int *height) {
+    if (*x < 0) { *width += *x; *x = 0; }
+    if (*y < 0) { *height += *y; *y = 0; }
+    if (*x + *width > pixmap->width) *width = pixmap->width - *x;
+    if (*y + *height > pixmap->height) *height = pixmap->height - *y;
+    return *width > 0 && *height > 0;
+}
+
+// Перевести float 0..1 в байт:
+static inline uint8_t to_unorm8(float v) {
+    if (!(v > 0.0f)) return 0;
+    if (v >= 1.0f) return 255;
+    return (uint8_t)(v * 255.0f + 0.5f);
+}
+
+// Заполнить строку повторением пикселя (копируем уже заполненную часть удваивая её):
+static void fill_row(uint8_t *row, const uint8_t *pixel, size_t size, size_t count) {
+    size_t total = size * count, filled = size;
+    memcpy(row, pixel, size);
+    while (filled < total) {
+        size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(row + filled, row, chunk);
+        filled += chunk;
+    }
+}
+
+// Исходный индекс ближайшего пикселя для выходного (по центрам пикселей):
+static inline int nearest_index(int d, int src_size, int dst_size) {
+    int s = (int)(((int64_t)d * 2 + 1) * src_size / ((int64_t)dst_size * 2));
+    return s < src_size ? s : src_size - 1;
+}
+
+// Скопировать строку ближайшими пикселями:
+static void nearest_row(const PixNearest *job, const uint8_t *src, uint8_t *dst) {
+    int width = job->dst->width;
+    const size_t *columns = job->columns;
+    switch (job->pixel) {
+        case 1: for (int x = 0; x < width; x++) dst[x] = src[columns[x]]; break;
+        case 2: for (int x = 0; x < width; x++) memcpy(dst + (size_t)x * 2, src + columns[x], 2); break;
+        case 3: for (int x = 0; x < width; x++) memcpy(dst + (size_t)x * 3, src + columns[x], 3); break;
+        case 4: for (int x = 0; x < width; x++) memcpy(dst + (size_t)x * 4, src + columns[x], 4); break;
+        case 8: for (int x = 0; x < width; x++) memcpy(dst + (size_t)x * 8, src + columns[x], 8); break;
+        case 16: for (int x = 0; x < width; x++) memcpy(dst + (size_t)x * 16, src + columns[x], 16); break;
+        default: for (int x = 0; x < width; x++) memcpy(dst + (size_t)x * job->pixel, src + columns[x], job->pixel); break;
+    }
+}
+
+// Посчитать полосу строк (полоса JobSystem_parallel_for):
+static void nearest_band(void *args, size_t band, size_t worker) {
+    (void)worker;
+    PixNearest *job = (PixNearest*)args;
+    const Pixmap *src = job->src;
+    Pixmap *dst = job->dst;
+    size_t src_row = (size_t)src->width * job->pixel;
+    size_t dst_row = (size_t)dst->width * job->pixel;
+    int y0 = (int)band * PIXOPS_BAND_ROWS;
+    int y1 = y0 + PIXOPS_BAND_ROWS < dst->height ? y0 + PIXOPS_BAND_ROWS : dst->height;
+    int prev = -1;
+    for (int y = y0; y < y1; y++) {
+        int sy = nearest_index(y, src->height, dst->height);
+        uint8_t *out = (uint8_t*)dst->data + (size_t)y * dst_row;
+        if (sy == prev) memcpy(out, out - dst_row, dst_row);  // Та же исходная строка (увеличение).
+        else nearest_row(job, (const uint8_t*)src->data + (size_t)sy * src_row, out);
+        prev = sy;
+    }
+}
+
+// Масштабировать ближайшим пикселем:
+static void resize_nearest(const Pixmap *src, Pixmap *dst) {
+    PixNearest job = { src, dst, pixel_size(src), NULL };
+    job.columns = (size_t*)mm_alloc(sizeof(size_t) * (size_t)dst->width);
+    for (int x = 0; x < dst->width; x++) job.columns[x] = (size_t)nearest_index(x, src->width, dst->width) * job.pixel;
+    size_t bands = (size_t)(dst->height + PIXOPS_BAND_ROWS - 1) / PIXOPS_BAND_ROWS;
+
+    // Маленькой картинке параллельность не нужна (0 - все потоки JobSystem):
+    size_t workers = (size_t)dst->width * (size_t)dst->height < PIXOPS_PARALLEL_PIXELS ? 1 : 0;
+    JobSystem_parallel_for(bands, workers, nearest_band, &job);
+    mm_free(job.columns);
+}
+
+
+// -------- API операций над картинками: --------
+
+
+// Скопировать область src (width, height <= 0 - вся картинка) в точку (x, y). Форматы должны совпадать:
+bool Pixmap_blit(Pixmap *self, int x, int y, const Pixmap *src, int src_x, int src_y, int width, int height) {
+    if (!self || !src || !self->data || !src->data) return false;
+    if (self->channels != src->channels || self->is_hdr != src->is_hdr || self->is_half != src->is_half) {
+        log_msg("[E] Pixmap_blit: Formats of the pixmaps differ.\n");
+        return false;
+    }
+    if (width <= 0 || height <= 0) {
+        width = src->width - src_x;
+        height = src->height - src_y;
+    }
+
+    // Обрезаем область по исходной картинке, затем по целевой (сдвигая обе стороны вместе):
+    int sx = src_x, sy = src_y;
+    if (!clip_rect(src, &sx, &sy, &width, &height)) return true;
+    x += sx - src_x;
+    y += sy - src_y;
+    int dx = x, dy = y;
+    if (!clip_rect(self, &dx, &dy, &width, &height)) return true;
+    sx += dx - x;
+    sy += dy - y;
+
+    size_t pixel = pixel_size(self);
+    size_t src_row = (size_t)src->width * pixel, dst_row = (size_t)self->width * pixel;
+    const uint8_t *from = (const uint8_t*)src->data + (size_t)sy * src_row + (size_t)sx * pixel;
+    uint8_t *to = (uint8_t*)self->data + (size_t)dy * dst_row + (size_t)dx * pixel;
+    size_t bytes = (size_t)width * pixel;
+    for (int row = 0; row < height; row++) {
+        memmove(to, from, bytes);  // Копирование внутри одной картинки может перекрываться.
+        from += src_row;
+        to += dst_row;
+    }
+    return true;
+}
+
+
+// Вырезать область в новую картинку (NULL если область вне картинки):
+Pixmap* Pixmap_crop(const Pixmap *self, int x, int y, int width, int height) {
+    if (!self || !self->data) return NULL;
+    if (!clip_rect(self, &x, &y, &width, &height)) return NULL;
+    Pixmap *pixmap = create_pixmap(width, height, self);
+    Pixmap_blit(pixmap, 0, 0, self, x, y, width, height);
+    return pixmap;
+}
+
+
+// Залить область цветом (color - значения каналов 0..1, у HDR - любые):
+bool Pixmap_fill_rect(Pixmap *self, int x, int y, int width, int height, const float color[4]) {
+    if (!self || !self->data || !color || self->channels < 1 || self->channels > 4) return false;
+    if (!clip_rect(self, &x, &y, &width, &height)) return true;
+
+    // Собираем пиксель в формате картинки:
+    uint8_t pixel[4 * sizeof(float)];
+    size_t size = pixel_size(self);
+    if (self->is_hdr && self->is_half) PixConv_f32_to_f16(color, (uint16_t*)pixel, (size_t)self->channels);
+    else if (self->is_hdr) memcpy(pixel, color, size);
+    else for (int c = 0; c < self->channels; c++) pixel[c] = to_unorm8(color[c]);
+
+    // Заполняем первую строку области и копируем её в остальные:
+    size_t row = (size_t)self->width * size, bytes = (size_t)width * size;
+    uint8_t *first = (uint8_t*)self->data + (size_t)y * row + (size_t)x * size;
+    fill_row(first, pixel, size, (size_t)width);
+    for (int i = 1; i < height; i++) memcpy(first + (size_t)i * row, first, bytes);
+    return true;
+}
+
+
+// Масштабировать картинку в новую картинку:
+Pixmap* Pixmap_resize(const Pixmap *self, int width, int height, PixmapFilter filter) {
+    if (!self || !self->data || self->width <= 0 || self->height <= 0) return NULL;
+    if (width <= 0 || height <= 0 || self->channels < (int)PIXMAP_R || self->channels > (int)PIXMAP_RGBA) {
+        log_msg("[E] Pixmap_resize: Invalid size %dx%d or channels count %d.\n", width, height, self->channels);
+        return NULL;
+    }
+    if (width == self->width && height == self->height) return Pixmap_copy(self);
+
+    Pixmap *pixmap = create_pixmap(width, height, self);
+    switch (filter) {
+        case PIXMAP_FILTER_BILINEAR: Pixmap_resample(self, pixmap, MIP_FILTER_BILINEAR, false, 0); break;
+        case PIXMAP_FILTER_LANCZOS:  Pixmap_resample(self, pixmap, MIP_FILTER_LANCZOS, false, 0); break;
+        default:                     resize_nearest(self, pixmap); break;
+    }
+    return pixmap;
+}
+
+
+// Получить название фильтра:
+const char* PixmapFilter_get_name(PixmapFilter filter) {
+    switch (filter) {
+        case PIXMAP_FILTER_NEAREST:  return "nearest";
+        case PIXMAP_FILTER_BILINEAR: return "bilinear";
+        case PIXMAP_FILTER_LANCZOS:  return "lanczos";
+        default:                     return "unknown";
+    }
+}
@@ -0,0 +1,49 @@
+//
+// pixops.h - Операции над картинками: копирование областей, обрезка, заливка и масштабирование.
+//
+// Строительные блоки для сборки атласов, миниатюр и уменьшенных копий на процессоре. Работают с 8-битными
+// и HDR (float и half float) картинками с любым количеством каналов. Прямоугольники обрезаются по краям картинок,
+// поэтому могут частично выходить за них. Билинейное масштабирование и Ланцош считаются разделимым
+// фильтром мипмапов (Pixmap_resample): векторно и полосами строк на потоках JobSystem. При уменьшении
+// фильтр растягивается на весь исходный след пикселя, поэтому уменьшенная картинка не рябит.
+// Ближайший пиксель просто копируется, большие картинки тоже полосами на потоках.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+#include "pixmap.h"
+
+
+// Определения:
+#define PIXOPS_PARALLEL_PIXELS  (512*512)  // С какого размера масштабировать ближайшим пикселем параллельно.
+#define PIXOPS_BAND_ROWS        32         // Строк в одной полосе параллельного масштабирования.
+
+
+// Фильтр масштабирования:
+typedef enum PixmapFilter {
+    PIXMAP_FILTER_NEAREST,   // Ближайший пиксель (пиксель-арт, маски с точными значениями).
+    PIXMAP_FILTER_BILINEAR,  // Билинейный (при уменьшении - треугольный по следу пикселя).
+    PIXMAP_FILTER_LANCZOS,   // Lanczos3 (самый чёткий, на контрастных краях возможен звон).
+} PixmapFilter;
+
+
+// -------- API операций над картинками: --------
+
+
+// Скопировать область src (width, height <= 0 - вся картинка) в точку (x, y). Форматы должны совпадать:
+bool Pixmap_blit(Pixmap *self, int x, int y, const Pixmap *src, int src_x, int src_y, int width, int height);
+
+// Вырезать область в новую картинку (NULL если область вне картинки):
+Pixmap* Pixmap_crop(const Pixmap *self, int x, int y, int width, int height);
+
+// Залить область цветом (color - значения каналов 0..1, у HDR - любые):
+bool Pixmap_fill_rect(Pixmap *self, int x, int y, int width, int height, const float color[4]);
+
+// Масштабировать картинку в новую картинку:
+Pixmap* Pixmap_resize(const Pixmap *self, int width, int height, PixmapFilter filter);
+
+// Получить название фильтра:
+const char* PixmapFilter_get_name(PixmapFilter filter);
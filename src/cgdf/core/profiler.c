@@ -0,0 +1,459 @@
+//
+// profiler.c - Реализация иерархического профилировщика процессорного времени.
+//
+// У каждого потока свой кольцевой буфер событий на одного писателя и одного читателя: поток пишет
+// закрытые зоны (имя, начало, конец, глубина), а Profiler_frame забирает их из всех буферов.
+// События одного потока приходят в порядке закрытия (вложенные раньше внешних), поэтому собственное
+// время считается по ходу: у каждой глубины копится время уже закрытых дочерних зон.
+// Метки времени - такты процессора (Time_get_cycles), в наносекунды переводятся только при выводе.
+// Буфер завершившегося потока (например потока JobSystem) достаётся следующему новому потоку.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "array.h"
+#include "logger.h"
+#include "libs.h"
+#include "time.h"
+#include "profiler.h"
+
+
+#ifdef CGDF_PROFILER
+
+
+// Закрытая зона:
+typedef struct ProfilerEvent {
+    const char *name;  // Имя зоны.
+    uint64_t start;    // Начало (такты).
+    uint64_t end;      // Конец (такты).
+    uint32_t depth;    // Глубина вложенности.
+    uint32_t thread;   // Номер буфера потока.
+} ProfilerEvent;
+
+
+// Буфер событий потока:
+typedef struct ProfilerThread {
+    atomic_bool in_use;                    // Буфер занят живым потоком.
+    uint32_t id;                           // Номер буфера (tid в трассировке).
+    uint32_t depth;                        // Текущая глубина зон (пишет только поток-владелец).
+    atomic_size_t head;                    // Сколько событий записано (пишет поток-владелец).
+    atomic_size_t tail;                    // Сколько событий прочитано (пишет сборщик).
+    atomic_size_t dropped;                 // Сколько событий потеряно из-за переполнения.
+    uint64_t child[PROFILER_MAX_DEPTH + 1];  // Время закрытых дочерних зон по глубинам (для сборщика).
+    ProfilerEvent events[PROFILER_THREAD_EVENTS];  // Кольцевой буфер событий.
+} ProfilerThread;
+
+
+// Статистика зоны по кадрам (кольцо из PROFILER_HISTORY + 1 кадров, последний - текущий):
+typedef struct ProfilerZone {
+    const char *name;
+    uint64_t total[PROFILER_HISTORY + 1];  // Общее время (такты).
+    uint64_t self[PROFILER_HISTORY + 1];   // Собственное время (такты).
+    uint32_t calls[PROFILER_HISTORY + 1];  // Вызовы.
+} ProfilerZone;
+
+
+// Состояние профилировщика:
+typedef struct ProfilerState {
+    atomic_bool initialized;   // Инициализирован ли профилировщик.
+    tss_t thread_key;          // Ключ потока (для освобождения буфера при завершении потока).
+    mtx_t mutex;               // Защита статистики и захвата.
+
+    _Atomic(ProfilerThread*) threads[PROFILER_MAX_THREADS];  // Буферы потоков.
+    atomic_size_t threads_count;                            // Сколько буферов создано.
+
+    ProfilerZone *zones[PROFILER_MAX_ZONES];  // Таблица зон (открытая адресация по хэшу имени).
+    size_t frame_index;                       // Текущий кадр в кольце статистики.
+    size_t frames_count;                      // Сколько кадров уже завершено (не больше PROFILER_HISTORY).
+    uint64_t frame_ns[PROFILER_HISTORY + 1];  // Длительность кадров.
+    uint64_t frame_start_ns;                  // Начало текущего кадра.
+
+    bool capturing;            // Идёт захват событий.
+    size_t capture_frames;     // Сколько кадров ещё захватить (0 = без ограничения).
+    uint64_t base_cycles;      // Точка отсчёта времени трассировки.
+    Array *capture_events;     // Захваченные события (ProfilerEvent).
+    Array *capture_frames_at;  // Начала захваченных кадров (такты).
+} ProfilerState;
+
+
+// Состояние профилировщика:
+static ProfilerState g_Profiler;
+
+// Буфер текущего потока:
+static _Thread_local ProfilerThread *t_ProfilerThread = NULL;
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Освободить буфер при завершении потока (следующий новый поток его переиспользует):
+static void release_thread(void *args) {
+    ProfilerThread *thread = (ProfilerThread*)args;
+    if (!thread) return;
+    thread->depth = 0;
+    atomic_store(&thread->in_use, false);
+}
+
+// Получить буфер текущего потока (при первом вызове занимаем свободный или создаём новый):
+static ProfilerThread* get_thread(void) {
+    if (t_ProfilerThread) return t_ProfilerThread;
+    ProfilerThread *thread = NULL;
+
+    // Ищем свободный буфер завершившегося потока:
+    size_t count = atomic_load(&g_Profiler.threads_count);
+    if (count > PROFILER_MAX_THREADS) count = PROFILER_MAX_THREADS;
+    for (size_t i = 0; i < count && !thread; i++) {
+        ProfilerThread *t = atomic_load(&g_Profiler.threads[i]);
+        bool expected = false;
+        if (t && atomic_compare_exchange_strong(&t->in_use, &expected, true)) thread = t;
+    }
+
+    // Создаём новый:
+    if (!thread) {
+        size_t index = atomic_fetch_add(&g_Profiler.threads_count, 1);
+        if (index >= PROFILER_MAX_THREADS) return NULL;  // Потоков слишком много, зоны не пишем.
+        thread = (ProfilerThread*)mm_calloc(1, sizeof(ProfilerThread));
+        thread->id = (uint32_t)index;
+        atomic_init(&thread->in_use, true);
+        atomic_store(&g_Profiler.threads[index], thread);
+    }
+    t_ProfilerThread = thread;
+    tss_set(g_Profiler.thread_key, thread);
+    return thread;
+}
+
+// Хэш имени зоны (FNV-1a):
+static inline uint32_t hash_name(const char *name) {
+    uint32_t h = 2166136261u;
+    for (; *name; name++) h = (h ^ (uint8_t)*name) * 16777619u;
+    return h;
+}
+
+// Найти или создать статистику зоны:
+static ProfilerZone* get_zone(const char *name) {
+    uint32_t mask = PROFILER_MAX_ZONES - 1;
+    for (uint32_t i = hash_name(name) & mask, n = 0; n < PROFILER_MAX_ZONES; i = (i + 1) & mask, n++) {
+        ProfilerZone *zone = g_Profiler.zones[i];
+        if (!zone) {
+            zone = (ProfilerZone*)mm_calloc(1, sizeof(ProfilerZone));
+            zone->name = name;
+            g_Profiler.zones[i] = zone;
+            return zone;
+        }
+        if (zone->name == name || strcmp(zone->name, name) == 0) return zone;
+    }
+    return NULL;  // Таблица зон заполнена.
+}
+
+// Забрать события всех потоков в статистику текущего кадра:
+static void collect_events(void) {
+    size_t frame = g_Profiler.frame_index;
+    size_t count = atomic_load(&g_Profiler.threads_count);
+    if (count > PROFILER_MAX_THREADS) count = PROFILER_MAX_THREADS;
+
+    for (size_t t = 0; t < count; t++) {
+        ProfilerThread *thread = atomic_load(&g_Profiler.threads[t]);
+        if (!thread) continue;
+        size_t head = atomic_load_explicit(&thread->head, memory_order_acquire);
+        size_t tail = atomic_load_explicit(&thread->tail, memory_order_relaxed);
+
+        for (; tail != head; tail++) {
+            ProfilerEvent *event = &thread->events[tail & (PROFILER_THREAD_EVENTS - 1)];
+            uint64_t duration = event->end - event->start;
+            uint32_t depth = event->depth < PROFILER_MAX_DEPTH ? event->depth : PROFILER_MAX_DEPTH - 1;
+
+            // Собственное время = общее минус закрытые дочерние зоны:
+            uint64_t children = thread->child[depth + 1];
+            thread->child[depth + 1] = 0;
+            thread->child[depth] += duration;
+
+            ProfilerZone *zone = get_zone(event->name);
+            if (zone) {
+                zone->total[frame] += duration;
+                zone->self[frame] += duration > children ? duration - children : 0;
+                zone->calls[frame]++;
+            }
+            if (g_Profiler.capturing) Array_push(g_Profiler.capture_events, event);
+        }
+        atomic_store_explicit(&thread->tail, tail, memory_order_release);
+    }
+}
+
+// Сравнение зон по собственному времени (по убыванию):
+static int compare_summary(const void *a, const void *b) {
+    double sa = ((const ProfilerZoneSummary*)a)->self_ms;
+    double sb = ((const ProfilerZoneSummary*)b)->self_ms;
+    return (sa < sb) - (sa > sb);
+}
+
+// Записать строку в JSON с экранированием:
+static void write_json_string(FILE *file, const char *str) {
+    fputc('"', file);
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') fputc('\\', file);
+        if ((unsigned char)*str >= 0x20) fputc(*str, file);
+    }
+    fputc('"', file);
+}
+
+
+// -------- API профилировщика: --------
+
+
+// Инициализация профилировщика:
+void Profiler_init(void) {
+    if (atomic_load(&g_Profiler.initialized)) return;
+    tss_create(&g_Profiler.thread_key, release_thread);
+    mtx_init(&g_Profiler.mutex, mtx_plain);
+    g_Profiler.frame_index = 0;
+    g_Profiler.frames_count = 0;
+    g_Profiler.frame_start_ns = Time_get_ns();
+    g_Profiler.base_cycles = Time_get_cycles();
+    g_Profiler.capture_events = Array_create(sizeof(ProfilerEvent), 0);
+    g_Profiler.capture_frames_at = Array_create(sizeof(uint64_t), 0);
+    Time_cycles_to_ns(0);  // Калибруем счётчик тактов заранее, а не посреди кадра.
+    atomic_store(&g_Profiler.initialized, true);
+}
+
+
+// Уничтожение профилировщика:
+void Profiler_destroy(void) {
+    if (!atomic_exchange(&g_Profiler.initialized, false)) return;
+    size_t count = atomic_load(&g_Profiler.threads_count);
+    if (count > PROFILER_MAX_THREADS) count = PROFILER_MAX_THREADS;
+    for (size_t i = 0; i < count; i++) {
+        ProfilerThread *thread = atomic_exchange(&g_Profiler.threads[i], NULL);
+        if (thread) mm_free(thread);
+    }
+    atomic_store(&g_Profiler.threads_count, 0);
+    t_ProfilerThread = NULL;
+    for (size_t i = 0; i < PROFILER_MAX_ZONES; i++) {
+        if (g_Profiler.zones[i]) { mm_free(g_Profiler.zones[i]); g_Profiler.zones[i] = NULL; }
+    }
+    Array_destroy(&g_Profiler.capture_events);
+    Array_destroy(&g_Profiler.capture_frames_at);
+    tss_delete(g_Profiler.thread_key);
+    mtx_destroy(&g_Profiler.mutex);
+}
+
+
+// Начать зону (используйте макросы PROFILE_*):
+ProfilerScope Profiler_zone_begin(const char *name) {
+    ProfilerScope scope = { NULL, 0 };
+    if (!atomic_load_explicit(&g_Profiler.initialized, memory_order_relaxed)) return scope;
+    ProfilerThread *thread = get_thread();
+    if (!thread) return scope;
+    thread->depth++;
+    scope.name = name;
+    scope.start = Time_get_cycles();
+    return scope;
+}
+
+
+// Закончить зону (используйте макросы PROFILE_*):
+void Profiler_zone_end(ProfilerScope *scope) {
+    if (!scope->name) return;
+    uint64_t end = Time_get_cycles();
+    ProfilerThread *thread = t_ProfilerThread;
+    if (!thread) return;
+    uint32_t depth = --thread->depth;
+
+    // Кладём событие в буфер потока (если сборщик не успевает, событие теряется):
+    size_t head = atomic_load_explicit(&thread->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&thread->tail, memory_order_acquire);
+    if (head - tail >= PROFILER_THREAD_EVENTS) {
+        atomic_fetch_add_explicit(&thread->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    ProfilerEvent *event = &thread->events[head & (PROFILER_THREAD_EVENTS - 1)];
+    event->name = scope->name;
+    event->start = scope->start;
+    event->end = end;
+    event->depth = depth;
+    event->thread = thread->id;
+    atomic_store_explicit(&thread->head, head + 1, memory_order_release);
+}
+
+
+// Закончить кадр: собрать события всех потоков и обновить статистику:
+void Profiler_frame(void) {
+    if (!atomic_load(&g_Profiler.initialized)) return;
+    mtx_lock(&g_Profiler.mutex);
+    collect_events();
+
+    // Закрываем кадр:
+    uint64_t now = Time_get_ns();
+    g_Profiler.frame_ns[g_Profiler.frame_index] = now - g_Profiler.frame_start_ns;
+    g_Profiler.frame_start_ns = now;
+    if (g_Profiler.frames_count < PROFILER_HISTORY) g_Profiler.frames_count++;
+    g_Profiler.frame_index = (g_Profiler.frame_index + 1) % (PROFILER_HISTORY + 1);
+
+    // Очищаем ячейку нового кадра у всех зон:
+    size_t frame = g_Profiler.frame_index;
+    for (size_t i = 0; i < PROFILER_MAX_ZONES; i++) {
+        ProfilerZone *zone = g_Profiler.zones[i];
+        if (!zone) continue;
+        zone->total[frame] = 0;
+        zone->self[frame] = 0;
+        zone->calls[frame] = 0;
+    }
+
+    // Захват кадров для трассировки:
+    if (g_Profiler.capturing) {
+        uint64_t at = Time_get_cycles();
+        Array_push(g_Profiler.capture_frames_at, &at);
+        if (g_Profiler.capture_frames > 0 && --g_Profiler.capture_frames == 0) g_Profiler.capturing = false;
+    }
+    mtx_unlock(&g_Profiler.mutex);
+}
+
+
+// Получить статистику зон за последние кадры, отсортированную по собственному времени. Возвращает количество:
+size_t Profiler_get_summary(ProfilerZoneSummary *out, size_t max_count) {
+    if (!atomic_load(&g_Profiler.initialized) || !out || max_count == 0) return 0;
+    mtx_lock(&g_Profiler.mutex);
+    size_t frames = g_Profiler.frames_count;
+    if (frames == 0) { mtx_unlock(&g_Profiler.mutex); return 0; }
+
+    // Собираем все зоны (завершённые кадры - все ячейки кольца кроме текущей):
+    ProfilerZoneSummary *all = (ProfilerZoneSummary*)mm_alloc(PROFILER_MAX_ZONES * sizeof(ProfilerZoneSummary));
+    size_t count = 0;
+    for (size_t i = 0; i < PROFILER_MAX_ZONES; i++) {
+        ProfilerZone *zone = g_Profiler.zones[i];
+        if (!zone) continue;
+        uint64_t total = 0, self = 0, max = 0, calls = 0;
+        for (size_t f = 0; f <= PROFILER_HISTORY; f++) {
+            if (f == g_Profiler.frame_index) continue;
+            total += zone->total[f];
+            self += zone->self[f];
+            calls += zone->calls[f];
+            if (zone->total[f] > max) max = zone->total[f];
+        }
+        if (calls == 0) continue;
+        all[count].name = zone->name;
+        all[count].total_ms = Time_cycles_to_ns(total) / 1e6 / (double)frames;
+        all[count].self_ms = Time_cycles_to_ns(self) / 1e6 / (double)frames;
+        all[count].max_ms = Time_cycles_to_ns(max) / 1e6;
+        all[count].calls = (double)calls / (double)frames;
+        count++;
+    }
+    mtx_unlock(&g_Profiler.mutex);
+
+    qsort(all, count, sizeof(ProfilerZoneSummary), compare_summary);
+    if (count > max_count) count = max_count;
+    memcpy(out, all, count * sizeof(ProfilerZoneSummary));
+    mm_free(all);
+    return count;
+}
+
+
+// Вывести в лог top зон по собственному времени:
+void Profiler_log_summary(size_t top) {
+    if (top == 0) top = 16;
+    ProfilerZoneSummary *zones = (ProfilerZoneSummary*)mm_alloc(top * sizeof(ProfilerZoneSummary));
+    size_t count = Profiler_get_summary(zones, top);
+    log_msg("[I] Profiler: Average frame %.3f ms over %zu frames.\n", Profiler_get_frame_ms(), g_Profiler.frames_count);
+    for (size_t i = 0; i < count; i++) {
+        log_msg(
+            "[I] Profiler: %-32s self %8.3f ms  total %8.3f ms  max %8.3f ms  calls %.1f\n",
+            zones[i].name, zones[i].self_ms, zones[i].total_ms, zones[i].max_ms, zones[i].calls
+        );
+    }
+    mm_free(zones);
+}
+
+
+// Получить среднее время кадра за последние кадры (в мс):
+double Profiler_get_frame_ms(void) {
+    if (!atomic_load(&g_Profiler.initialized)) return 0.0;
+    mtx_lock(&g_Profiler.mutex);
+    uint64_t sum = 0;
+    for (size_t f = 0; f <= PROFILER_HISTORY; f++) {
+        if (f != g_Profiler.frame_index) sum += g_Profiler.frame_ns[f];
+    }
+    size_t frames = g_Profiler.frames_count;
+    mtx_unlock(&g_Profiler.mutex);
+    return frames ? (double)sum / 1e6 / (double)frames : 0.0;
+}
+
+
+// Начать захват событий для трассировки (frames - сколько кадров захватить, 0 = до остановки):
+void Profiler_start_capture(size_t frames) {
+    if (!atomic_load(&g_Profiler.initialized)) return;
+    mtx_lock(&g_Profiler.mutex);
+    collect_events();  // События до начала захвата в трассировку не попадают.
+    Array_clear(g_Profiler.capture_events, false);
+    Array_clear(g_Profiler.capture_frames_at, false);
+    uint64_t at = Time_get_cycles();
+    Array_push(g_Profiler.capture_frames_at, &at);
+    g_Profiler.capture_frames = frames;
+    g_Profiler.capturing = true;
+    mtx_unlock(&g_Profiler.mutex);
+}
+
+
+// Остановить захват событий:
+void Profiler_stop_capture(void) {
+    if (!atomic_load(&g_Profiler.initialized)) return;
+    mtx_lock(&g_Profiler.mutex);
+    g_Profiler.capturing = false;
+    mtx_unlock(&g_Profiler.mutex);
+}
+
+
+// Сохранить захваченные события в файл формата Chrome trace (JSON):
+bool Profiler_save_trace(const char *file_path) {
+    if (!atomic_load(&g_Profiler.initialized) || !file_path) return false;
+    FILE *file = fopen(file_path, "w");
+    if (!file) {
+        log_msg("[E] Profiler_save_trace: Failed to open file \"%s\".\n", file_path);
+        return false;
+    }
+
+    mtx_lock(&g_Profiler.mutex);
+    uint64_t base = g_Profiler.base_cycles;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    // Имена потоков:
+    size_t threads = atomic_load(&g_Profiler.threads_count);
+    if (threads > PROFILER_MAX_THREADS) threads = PROFILER_MAX_THREADS;
+    for (size_t i = 0; i < threads; i++) {
+        fprintf(
+            file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"Thread %zu\"}},\n",
+            i, i
+        );
+    }
+
+    // Кадры:
+    size_t frames = Array_len(g_Profiler.capture_frames_at);
+    for (size_t i = 0; i < frames; i++) {
+        uint64_t at = *(uint64_t*)Array_get(g_Profiler.capture_frames_at, i);
+        fprintf(
+            file, "{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f},\n",
+            Time_cycles_to_ns(at - base) / 1e3
+        );
+    }
+
+    // Зоны:
+    size_t events = Array_len(g_Profiler.capture_events);
+    for (size_t i = 0; i < events; i++) {
+        ProfilerEvent *event = (ProfilerEvent*)Array_get(g_Profiler.capture_events, i);
+        fprintf(file, "{\"name\":");
+        write_json_string(file, event->name);
+        fprintf(
+            file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+            event->thread, Time_cycles_to_ns(event->start - base) / 1e3,
+            Time_cycles_to_ns(event->end - event->start) / 1e3, i + 1 < events ? "," : ""
+        );
+    }
+    if (events == 0) fprintf(file, "{\"name\":\"Empty\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":0}\n");
+    fprintf(file, "]}\n");
+    mtx_unlock(&g_Profiler.mutex);
+    fclose(file);
+    return true;
+}
+
+
+#endif  // CGDF_PROFILER
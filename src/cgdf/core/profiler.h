@@ -0,0 +1,121 @@
+//
+// profiler.h - Иерархический профилировщик процессорного времени кадра.
+//
+// Зоны отмечаются макросами PROFILE_ZONE(name) / PROFILE_FUNC() - замер длится до конца текущего блока.
+// Каждый поток пишет события в свой кольцевой буфер без блокировок, а Profiler_frame (его вызывает
+// цикл окна в конце кадра) собирает события всех потоков: считает общее и собственное время зон за
+// последние PROFILER_HISTORY кадров и, если включён захват, копит события для Chrome trace
+// (открывается в chrome://tracing или ui.perfetto.dev).
+//
+// define CGDF_PROFILER - Включить профилировщик. Без него все макросы PROFILE_* раскрываются в ничто,
+//                        а profiler.c компилируется в пустой файл.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+
+
+// Определения:
+#define PROFILER_THREAD_EVENTS 16384  // Размер буфера событий одного потока (степень двойки).
+#define PROFILER_MAX_THREADS   64     // Максимум одновременно работающих потоков с зонами.
+#define PROFILER_MAX_ZONES     512    // Максимум разных зон в статистике (степень двойки).
+#define PROFILER_MAX_DEPTH     64     // Максимальная вложенность зон.
+#define PROFILER_HISTORY       120    // Сколько последних кадров учитывается в статистике.
+
+
+#ifdef CGDF_PROFILER
+
+
+// Объявление структур:
+typedef struct ProfilerScope ProfilerScope;              // Открытая зона (живёт на стеке).
+typedef struct ProfilerZoneSummary ProfilerZoneSummary;  // Итоговая статистика зоны.
+
+
+// Открытая зона:
+struct ProfilerScope {
+    const char *name;  // Имя зоны (строка должна жить всё время работы программы).
+    uint64_t start;    // Начало зоны (такты процессора).
+};
+
+
+// Итоговая статистика зоны (средние значения на кадр):
+struct ProfilerZoneSummary {
+    const char *name;  // Имя зоны.
+    double total_ms;   // Общее время (вместе с вложенными зонами).
+    double self_ms;    // Собственное время (без вложенных зон).
+    double max_ms;     // Самый долгий кадр этой зоны (общее время).
+    double calls;      // Вызовов за кадр.
+};
+
+
+// -------- API профилировщика: --------
+
+
+// Инициализация профилировщика:
+void Profiler_init(void);
+
+// Уничтожение профилировщика:
+void Profiler_destroy(void);
+
+// Начать зону (используйте макросы PROFILE_*):
+ProfilerScope Profiler_zone_begin(const char *name);
+
+// Закончить зону (используйте макросы PROFILE_*):
+void Profiler_zone_end(ProfilerScope *scope);
+
+// Закончить кадр: собрать события всех потоков и обновить статистику:
+void Profiler_frame(void);
+
+// Получить статистику зон за последние кадры, отсортированную по собственному времени. Возвращает количество:
+size_t Profiler_get_summary(ProfilerZoneSummary *out, size_t max_count);
+
+// Вывести в лог top зон по собственному времени:
+void Profiler_log_summary(size_t top);
+
+// Получить среднее время кадра за последние кадры (в мс):
+double Profiler_get_frame_ms(void);
+
+// Начать захват событий для трассировки (frames - сколько кадров захватить, 0 = до остановки):
+void Profiler_start_capture(size_t frames);
+
+// Остановить захват событий:
+void Profiler_stop_capture(void);
+
+// Сохранить захваченные события в файл формата Chrome trace (JSON):
+bool Profiler_save_trace(const char *file_path);
+
+
+// Макросы:
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+// Замер до конца текущего блока:
+#define PROFILE_ZONE(name) \
+    ProfilerScope PROFILE_CONCAT(profile_scope_, __LINE__) \
+    __attribute__((cleanup(Profiler_zone_end))) = Profiler_zone_begin(name)
+
+// Замер функции целиком:
+#define PROFILE_FUNC() PROFILE_ZONE(__func__)
+
+// Ручное начало и конец зоны (пара в одном блоке):
+#define PROFILE_BEGIN(var, name) ProfilerScope var = Profiler_zone_begin(name)
+#define PROFILE_END(var) Profiler_zone_end(&(var))
+
+// Граница кадра:
+#define PROFILE_FRAME() Profiler_frame()
+
+
+#else  // CGDF_PROFILER
+
+
+#define PROFILE_ZONE(name)       ((void)0)
+#define PROFILE_FUNC()           ((void)0)
+#define PROFILE_BEGIN(var, name) ((void)0)
+#define PROFILE_END(var)         ((void)0)
+#define PROFILE_FRAME()          ((void)0)
+
+
+#endif  // CGDF_PROFILER
@@ -0,0 +1,566 @@
+//
+// scenegraph.c - Реализует плоский граф сцены на основе SoA массивов.
+//
+// Структурные изменения (удаление узлов, смена родителя) не применяются сразу, а копятся
+// и выполняются пачкой при следующем SceneGraph_update. Так же и пересчёт матриц.
+//
+// Параллельный пересчёт делит отсортированные по глубине массивы на куски. Куски одного уровня
+// независимы друг от друга, а следующий уровень ждёт пока будет готов предыдущий. Мелкие уровни
+// подряд склеиваются в один последовательный кусок, чтобы не платить за синхронизацию.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "math.h"
+#include "array.h"
+#include "logger.h"
+#include "node.h"
+#include "jobsystem.h"
+#include "profiler.h"
+#include "scenegraph.h"
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Получить плотный индекс узла по дескриптору (-1 = нет такого узла):
+static inline int64_t get_dense(SceneGraph *self, SceneHandle handle) {
+    if (handle.index >= self->handles_count) return -1;
+    if (self->generations[handle.index] != handle.generation) return -1;
+    uint32_t dense = self->handle_to_dense[handle.index];
+    if (dense == UINT32_MAX || (self->flags[dense] & SCENE_NODE_REMOVED)) return -1;
+    return (int64_t)dense;
+}
+
+// Расширить плотные массивы:
+static void grow_dense(SceneGraph *self, size_t new_capacity) {
+    if (new_capacity <= self->capacity) return;
+    self->parent          = (int32_t*)mm_realloc(self->parent, new_capacity * sizeof(int32_t));
+    self->position        = (vec3*)mm_realloc(self->position, new_capacity * sizeof(vec3));
+    self->quaternion      = (versor*)mm_realloc(self->quaternion, new_capacity * sizeof(versor));
+    self->scale           = (vec3*)mm_realloc(self->scale, new_capacity * sizeof(vec3));
+    self->local           = (mat4*)mm_realloc(self->local, new_capacity * sizeof(mat4));
+    self->world           = (mat4*)mm_realloc(self->world, new_capacity * sizeof(mat4));
+    self->flags           = (uint8_t*)mm_realloc(self->flags, new_capacity * sizeof(uint8_t));
+    self->dense_to_handle = (uint32_t*)mm_realloc(self->dense_to_handle, new_capacity * sizeof(uint32_t));
+    self->capacity = new_capacity;
+}
+
+// Расширить таблицу дескрипторов:
+static void grow_handles(SceneGraph *self, size_t new_capacity) {
+    if (new_capacity <= self->handles_capacity) return;
+    self->handle_to_dense = (uint32_t*)mm_realloc(self->handle_to_dense, new_capacity * sizeof(uint32_t));
+    self->generations = (uint32_t*)mm_realloc(self->generations, new_capacity * sizeof(uint32_t));
+    self->handles_capacity = new_capacity;
+}
+
+// Переставить плотные массивы согласно порядку order (order[новый] = старый, new_count <= count):
+static void apply_order(SceneGraph *self, const uint32_t *order, size_t new_count) {
+    size_t n = self->count;
+    size_t cap = self->capacity;
+
+    // Карта старых индексов в новые:
+    uint32_t *old_to_new = (uint32_t*)mm_alloc(n * sizeof(uint32_t));
+    for (size_t i = 0; i < n; i++) old_to_new[i] = UINT32_MAX;
+    for (size_t i = 0; i < new_count; i++) old_to_new[order[i]] = (uint32_t)i;
+
+    // Новые массивы:
+    int32_t  *parent     = (int32_t*)mm_alloc(cap * sizeof(int32_t));
+    vec3     *position   = (vec3*)mm_alloc(cap * sizeof(vec3));
+    versor   *quaternion = (versor*)mm_alloc(cap * sizeof(versor));
+    vec3     *scale      = (vec3*)mm_alloc(cap * sizeof(vec3));
+    mat4     *local      = (mat4*)mm_alloc(cap * sizeof(mat4));
+    mat4     *world      = (mat4*)mm_alloc(cap * sizeof(mat4));
+    uint8_t  *flags      = (uint8_t*)mm_alloc(cap * sizeof(uint8_t));
+    uint32_t *d2h        = (uint32_t*)mm_alloc(cap * sizeof(uint32_t));
+
+    // Переносим данные:
+    for (size_t i = 0; i < new_count; i++) {
+        uint32_t old = order[i];
+        int32_t old_parent = self->parent[old];
+        parent[i] = old_parent < 0 ? -1 : (int32_t)old_to_new[old_parent];
+        glm_vec3_copy(self->position[old], position[i]);
+        glm_vec4_copy(self->quaternion[old], quaternion[i]);
+        glm_vec3_copy(self->scale[old], scale[i]);
+        glm_mat4_copy(self->local[old], local[i]);
+        glm_mat4_copy(self->world[old], world[i]);
+        flags[i] = self->flags[old];
+        d2h[i] = self->dense_to_handle[old];
+        self->handle_to_dense[d2h[i]] = (uint32_t)i;
+    }
+
+    // Меняем массивы:
+    mm_free(self->parent);     self->parent = parent;
+    mm_free(self->position);   self->position = position;
+    mm_free(self->quaternion); self->quaternion = quaternion;
+    mm_free(self->scale);      self->scale = scale;
+    mm_free(self->local);      self->local = local;
+    mm_free(self->world);      self->world = world;
+    mm_free(self->flags);      self->flags = flags;
+    mm_free(self->dense_to_handle); self->dense_to_handle = d2h;
+    mm_free(old_to_new);
+    self->count = new_count;
+}
+
+// Восстановить порядок "родитель раньше потомка" (стабильная сортировка узлов по глубине):
+static void reorder(SceneGraph *self) {
+    size_t n = self->count;
+    if (n == 0) {
+        self->levels_count = 0;
+        self->needs_reorder = false;
+        self->needs_levels = false;
+        return;
+    }
+    int32_t  *depth = (int32_t*)mm_alloc(n * sizeof(int32_t));
+    uint32_t *chain = (uint32_t*)mm_alloc(n * sizeof(uint32_t));
+    for (size_t i = 0; i < n; i++) depth[i] = -1;
+
+    // Вычисляем глубину каждого узла (каждый узел посещается один раз):
+    int32_t max_depth = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (depth[i] >= 0) continue;
+        size_t len = 0;
+        int32_t j = (int32_t)i;
+        while (j >= 0 && depth[j] < 0) {
+            chain[len++] = (uint32_t)j;
+            j = self->parent[j];
+        }
+        int32_t d = j < 0 ? -1 : depth[j];
+        while (len > 0) depth[chain[--len]] = ++d;
+        if (d > max_depth) max_depth = d;
+    }
+
+    // Сортировка подсчётом по глубине (стабильная):
+    size_t *offsets = (size_t*)mm_calloc((size_t)max_depth + 2, sizeof(size_t));
+    for (size_t i = 0; i < n; i++) offsets[depth[i] + 1]++;
+    for (int32_t d = 0; d <= max_depth; d++) offsets[d + 1] += offsets[d];
+
+    // Запоминаем границы уровней (после сортировки они станут известны заранее):
+    self->levels_count = (size_t)max_depth + 1;
+    self->levels = (size_t*)mm_realloc(self->levels, (self->levels_count + 1) * sizeof(size_t));
+    memcpy(self->levels, offsets, (self->levels_count + 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < n; i++) chain[offsets[depth[i]]++] = (uint32_t)i;
+
+    apply_order(self, chain, n);
+    mm_free(offsets);
+    mm_free(chain);
+    mm_free(depth);
+    self->needs_reorder = false;
+    self->needs_levels = false;
+}
+
+// Удалить помеченные узлы (и их потомков) из плотных массивов:
+static void compact(SceneGraph *self) {
+    size_t n = self->count;
+    uint32_t *order = (uint32_t*)mm_alloc((n ? n : 1) * sizeof(uint32_t));
+    size_t kept = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        int32_t p = self->parent[i];
+        // Родитель стоит раньше, поэтому флаг удаления уже распространён на него:
+        if (p >= 0 && (self->flags[p] & SCENE_NODE_REMOVED)) self->flags[i] |= SCENE_NODE_REMOVED;
+
+        if (self->flags[i] & SCENE_NODE_REMOVED) {
+            // Освобождаем дескриптор:
+            uint32_t h = self->dense_to_handle[i];
+            self->handle_to_dense[h] = UINT32_MAX;
+            self->generations[h]++;
+            Array_push(self->free_handles, &h);
+        } else order[kept++] = (uint32_t)i;
+    }
+
+    if (kept != n) {
+        apply_order(self, order, kept);
+        self->needs_levels = true;  // Порядок по глубине сохранился, но границы уровней сдвинулись.
+    }
+    mm_free(order);
+    self->needs_compact = false;
+}
+
+// Применить отложенные структурные изменения:
+static void apply_structure(SceneGraph *self) {
+    if (self->needs_reorder) reorder(self);
+    if (self->needs_compact) compact(self);
+}
+
+// Собрать локальную матрицу узла (T * R * S):
+static inline void compose_local(SceneGraph *self, size_t i) {
+    mat4 *m = &self->local[i];
+    const float *s = self->scale[i];
+    const float *p = self->position[i];
+    glm_quat_mat4(self->quaternion[i], *m);
+    glm_vec4_scale((*m)[0], s[0], (*m)[0]);
+    glm_vec4_scale((*m)[1], s[1], (*m)[1]);
+    glm_vec4_scale((*m)[2], s[2], (*m)[2]);
+    (*m)[3][0] = p[0];
+    (*m)[3][1] = p[1];
+    (*m)[3][2] = p[2];
+    (*m)[3][3] = 1.0f;
+}
+
+// Пересчитать узлы в диапазоне [start, end). Родители диапазона должны быть уже пересчитаны:
+static void update_range(SceneGraph *self, size_t start, size_t end) {
+    const int32_t *parent = self->parent;
+    uint8_t *flags = self->flags;
+    mat4 *local = self->local;
+    mat4 *world = self->world;
+
+    for (size_t i = start; i < end; i++) {
+        uint8_t f = flags[i];
+        int32_t p = parent[i];
+        if (f & SCENE_NODE_LOCAL_DIRTY) compose_local(self, i);
+
+        // Пересчитываем, если изменился сам узел, либо родитель был пересчитан в этом проходе:
+        bool recalc = (f & (SCENE_NODE_LOCAL_DIRTY | SCENE_NODE_WORLD_DIRTY)) ||
+                      (p >= 0 && (flags[p] & SCENE_NODE_UPDATED));
+        if (recalc) {
+            if (p >= 0) glm_mat4_mul(world[p], local[i], world[i]);
+            else glm_mat4_copy(local[i], world[i]);
+            flags[i] = SCENE_NODE_UPDATED;
+        } else flags[i] = 0;
+    }
+}
+
+// Общие данные параллельного пересчёта:
+typedef struct ParallelUpdate {
+    SceneGraph *graph;         // Граф который пересчитываем.
+    size_t chunks_count;       // Количество кусков.
+    size_t *chunk_start;       // Начало каждого куска (chunks_count + 1 значений).
+    size_t *chunk_group;       // Группа к которой относится кусок.
+    size_t *group_chunks;      // Сколько кусков в каждой группе.
+    atomic_size_t *group_done; // Сколько кусков каждой группы уже готово.
+} ParallelUpdate;
+
+// Разбить уровни на куски и группы. Куски одной группы независимы, группы идут строго по порядку:
+static ParallelUpdate* parallel_update_create(SceneGraph *self, size_t grain) {
+    size_t max_chunks = self->count / grain + self->levels_count + 1;
+    ParallelUpdate *ctx = (ParallelUpdate*)mm_calloc(1, sizeof(ParallelUpdate));
+    ctx->graph = self;
+    ctx->chunk_start = (size_t*)mm_alloc((max_chunks + 1) * sizeof(size_t));
+    ctx->chunk_group = (size_t*)mm_alloc(max_chunks * sizeof(size_t));
+    ctx->group_chunks = (size_t*)mm_alloc(max_chunks * sizeof(size_t));
+    ctx->group_done = (atomic_size_t*)mm_alloc(max_chunks * sizeof(atomic_size_t));
+
+    size_t chunks = 0, groups = 0;
+    bool serial_group = false;  // Последняя группа - склейка мелких уровней.
+    for (size_t l = 0; l < self->levels_count; l++) {
+        size_t start = self->levels[l], end = self->levels[l + 1];
+        size_t size = end - start;
+
+        // Мелкий уровень дописываем в последовательный кусок (он идёт после всех предыдущих):
+        if (size < grain) {
+            if (!serial_group) {
+                ctx->chunk_start[chunks] = start;
+                ctx->chunk_group[chunks++] = groups;
+                ctx->group_chunks[groups++] = 1;
+                serial_group = true;
+            }
+            continue;
+        }
+
+        // Крупный уровень делим на независимые куски:
+        size_t parts = (size + grain - 1) / grain;
+        for (size_t k = 0; k < parts; k++) {
+            ctx->chunk_start[chunks] = start + size * k / parts;
+            ctx->chunk_group[chunks++] = groups;
+        }
+        ctx->group_chunks[groups++] = parts;
+        serial_group = false;
+    }
+    ctx->chunk_start[chunks] = self->count;
+    ctx->chunks_count = chunks;
+    for (size_t g = 0; g < groups; g++) atomic_init(&ctx->group_done[g], 0);
+    return ctx;
+}
+
+// Освободить общие данные:
+static void parallel_update_destroy(ParallelUpdate *ctx) {
+    mm_free(ctx->chunk_start);
+    mm_free(ctx->chunk_group);
+    mm_free(ctx->group_chunks);
+    mm_free(ctx->group_done);
+    mm_free(ctx);
+}
+
+// Выполнить кусок (полоса JobSystem_parallel_for):
+static void parallel_update_chunk(void *args, size_t k, size_t worker) {
+    (void)worker;
+    ParallelUpdate *ctx = (ParallelUpdate*)args;
+    size_t g = ctx->chunk_group[k];
+
+    // Ждём предыдущую группу. Куски раздаются по порядку, поэтому её куски уже разобраны работающими
+    // потоками, и ждать недолго:
+    if (g > 0) {
+        while (atomic_load(&ctx->group_done[g - 1]) < ctx->group_chunks[g - 1]) thrd_yield();
+    }
+    update_range(ctx->graph, ctx->chunk_start[k], ctx->chunk_start[k + 1]);
+    atomic_fetch_add(&ctx->group_done[g], 1);
+}
+
+// Импорт узла Node и его потомков (рекурсивно):
+static SceneHandle import_node(SceneGraph *self, Node *node, SceneHandle parent) {
+    SceneHandle handle = SceneGraph_add(self, parent);
+    SceneGraph_set_position(self, handle, node->position);
+    SceneGraph_set_quaternion(self, handle, node->quaternion);
+    SceneGraph_set_scale(self, handle, node->scale);
+    for (size_t i = 0; i < Array_len(node->children); i++) {
+        import_node(self, (Node*)Array_get_ptr(node->children, i), handle);
+    }
+    return handle;
+}
+
+
+// -------- API графа сцены: --------
+
+
+// Создать граф сцены:
+SceneGraph* SceneGraph_create(size_t capacity) {
+    if (capacity == 0) capacity = SCENEGRAPH_DEFAULT_CAPACITY;
+    SceneGraph *graph = (SceneGraph*)mm_calloc(1, sizeof(SceneGraph));
+    grow_dense(graph, capacity);
+    grow_handles(graph, capacity);
+    graph->free_handles = Array_create(sizeof(uint32_t), 0);
+    return graph;
+}
+
+// Уничтожить граф сцены:
+void SceneGraph_destroy(SceneGraph **graph) {
+    if (!graph || !*graph) return;
+    SceneGraph *g = *graph;
+    mm_free(g->parent);
+    mm_free(g->position);
+    mm_free(g->quaternion);
+    mm_free(g->scale);
+    mm_free(g->local);
+    mm_free(g->world);
+    mm_free(g->flags);
+    mm_free(g->dense_to_handle);
+    mm_free(g->handle_to_dense);
+    mm_free(g->generations);
+    mm_free(g->levels);
+    Array_destroy(&g->free_handles);
+    mm_free(g);
+    *graph = NULL;
+}
+
+// Добавить узел (parent может быть SCENE_HANDLE_NULL):
+SceneHandle SceneGraph_add(SceneGraph *self, SceneHandle parent) {
+    if (!self) return SCENE_HANDLE_NULL;
+
+    // Ищем родителя:
+    int64_t p = -1;
+    if (parent.index != UINT32_MAX) {
+        p = get_dense(self, parent);
+        if (p < 0) {
+            log_msg("[W] SceneGraph_add: Invalid parent handle.\n");
+            return SCENE_HANDLE_NULL;
+        }
+    }
+
+    // Выделяем дескриптор:
+    uint32_t h;
+    if (Array_len(self->free_handles) > 0) Array_pop(self->free_handles, &h);
+    else {
+        if (self->handles_count >= self->handles_capacity) {
+            grow_handles(self, self->handles_capacity * SCENEGRAPH_GROWTH_FACTOR);
+        }
+        h = (uint32_t)self->handles_count++;
+        self->generations[h] = 0;
+    }
+
+    // Новый узел всегда в конце, а родитель уже стоит раньше, поэтому порядок не нарушается:
+    if (self->count >= self->capacity) grow_dense(self, self->capacity * SCENEGRAPH_GROWTH_FACTOR);
+    size_t i = self->count++;
+    self->parent[i] = (int32_t)p;
+    glm_vec3_zero(self->position[i]);
+    glm_quat_identity(self->quaternion[i]);
+    glm_vec3_one(self->scale[i]);
+    glm_mat4_identity(self->local[i]);
+    glm_mat4_identity(self->world[i]);
+    self->flags[i] = SCENE_NODE_LOCAL_DIRTY | SCENE_NODE_WORLD_DIRTY;
+    self->dense_to_handle[i] = h;
+    self->handle_to_dense[h] = (uint32_t)i;
+    self->dirty = true;
+    self->needs_levels = true;
+    return (SceneHandle){h, self->generations[h]};
+}
+
+// Удалить узел вместе со всеми потомками:
+void SceneGraph_remove(SceneGraph *self, SceneHandle handle) {
+    if (!self) return;
+    int64_t i = get_dense(self, handle);
+    if (i < 0) return;
+    self->flags[i] |= SCENE_NODE_REMOVED;  // Потомки будут удалены при сжатии массивов.
+    self->needs_compact = true;
+    self->dirty = true;
+}
+
+// Проверить что дескриптор указывает на живой узел:
+bool SceneGraph_is_valid(SceneGraph *self, SceneHandle handle) {
+    if (!self) return false;
+    apply_structure(self);  // Удаление потомков применяется отложенно.
+    return get_dense(self, handle) >= 0;
+}
+
+// Получить количество узлов в графе:
+size_t SceneGraph_count(SceneGraph *self) {
+    if (!self) return 0;
+    apply_structure(self);
+    return self->count;
+}
+
+// Установить позицию:
+void SceneGraph_set_position(SceneGraph *self, SceneHandle handle, Vec3d position) {
+    if (!self) return;
+    int64_t i = get_dense(self, handle);
+    if (i < 0) return;
+    self->position[i][0] = (float)position.x;
+    self->position[i][1] = (float)position.y;
+    self->position[i][2] = (float)position.z;
+    self->flags[i] |= SCENE_NODE_LOCAL_DIRTY;
+    self->dirty = true;
+}
+
+// Установить поворот:
+void SceneGraph_set_quaternion(SceneGraph *self, SceneHandle handle, versor quaternion) {
+    if (!self) return;
+    int64_t i = get_dense(self, handle);
+    if (i < 0) return;
+    glm_quat_copy(quaternion, self->quaternion[i]);
+    self->flags[i] |= SCENE_NODE_LOCAL_DIRTY;
+    self->dirty = true;
+}
+
+// Установить масштаб:
+void SceneGraph_set_scale(SceneGraph *self, SceneHandle handle, Vec3d scale) {
+    if (!self) return;
+    int64_t i = get_dense(self, handle);
+    if (i < 0) return;
+    self->scale[i][0] = (float)scale.x;
+    self->scale[i][1] = (float)scale.y;
+    self->scale[i][2] = (float)scale.z;
+    self->flags[i] |= SCENE_NODE_LOCAL_DIRTY;
+    self->dirty = true;
+}
+
+// Вращать узел:
+void SceneGraph_rotate(SceneGraph *self, SceneHandle handle, Vec3d axis, float angle) {
+    if (!self) return;
+    int64_t i = get_dense(self, handle);
+    if (i < 0) return;
+    versor step;
+    glm_quat(step, radians(angle), axis.x, axis.y, axis.z);
+    glm_quat_mul(self->quaternion[i], step, self->quaternion[i]);
+    self->flags[i] |= SCENE_NODE_LOCAL_DIRTY;
+    self->dirty = true;
+}
+
+// Установить родителя:
+void SceneGraph_set_parent(SceneGraph *self, SceneHandle handle, SceneHandle parent) {
+    if (!self) return;
+    int64_t i = get_dense(self, handle);
+    if (i < 0) return;
+
+    int64_t p = -1;
+    if (parent.index != UINT32_MAX) {
+        p = get_dense(self, parent);
+        if (p < 0) return;
+    }
+    if (self->parent[i] == (int32_t)p) return;
+
+    // Проверка на зацикливание (чтобы не стать родителем самому себе или предкам):
+    for (int64_t tmp = p; tmp >= 0; tmp = self->parent[tmp]) {
+        if (tmp == i) {  // Ошибка! Попытка создать петлю в иерархии:
+            log_msg("[E] SceneGraph_set_parent: Cycle detected!\n");
+            return;
+        }
+    }
+
+    // Если родитель оказался позже узла, то порядок надо будет восстановить:
+    self->parent[i] = (int32_t)p;
+    if (p > i) self->needs_reorder = true;
+    self->needs_levels = true;
+    self->flags[i] |= SCENE_NODE_WORLD_DIRTY;
+    self->dirty = true;
+}
+
+// Получить родителя:
+SceneHandle SceneGraph_get_parent(SceneGraph *self, SceneHandle handle) {
+    if (!self) return SCENE_HANDLE_NULL;
+    int64_t i = get_dense(self, handle);
+    if (i < 0 || self->parent[i] < 0) return SCENE_HANDLE_NULL;
+    uint32_t h = self->dense_to_handle[self->parent[i]];
+    return (SceneHandle){h, self->generations[h]};
+}
+
+// Пересчитать все изменённые мировые матрицы одним линейным проходом:
+void SceneGraph_update(SceneGraph *self) {
+    if (!self || !self->dirty) return;
+    PROFILE_FUNC();
+    apply_structure(self);
+    update_range(self, 0, self->count);
+    self->dirty = false;
+}
+
+// Пересчитать все изменённые мировые матрицы параллельно (workers = 0 - все потоки JobSystem):
+void SceneGraph_update_parallel(SceneGraph *self, size_t workers) {
+    if (!self || !self->dirty) return;
+    PROFILE_FUNC();
+    if (workers == 0) workers = JobSystem_get_max_workers_count();
+
+    // Маленькому графу или без потоков параллельность не нужна:
+    if (!g_JobSystem.initialized || workers <= 1 || self->count < SCENEGRAPH_PARALLEL_GRAIN * 2) {
+        SceneGraph_update(self);
+        return;
+    }
+    apply_structure(self);
+    if (self->needs_levels) reorder(self);  // Сортируем по глубине (только после смены структуры).
+
+    ParallelUpdate *ctx = parallel_update_create(self, SCENEGRAPH_PARALLEL_GRAIN);
+    JobSystem_parallel_for(ctx->chunks_count, workers, parallel_update_chunk, ctx);
+    parallel_update_destroy(ctx);
+    self->dirty = false;
+}
+
+// Получить матрицу трансформации (если есть изменения, сначала вызывается SceneGraph_update):
+void SceneGraph_get_transform(SceneGraph *self, SceneHandle handle, mat4 dest) {
+    if (!self) { glm_mat4_identity(dest); return; }
+    SceneGraph_update(self);
+    int64_t i = get_dense(self, handle);
+    if (i < 0) { glm_mat4_identity(dest); return; }
+    glm_mat4_copy(self->world[i], dest);
+}
+
+// Получить позицию в мире:
+Vec3d SceneGraph_get_world_position(SceneGraph *self, SceneHandle handle) {
+    mat4 m;
+    SceneGraph_get_transform(self, handle, m);
+    return (Vec3d){m[3][0], m[3][1], m[3][2]};
+}
+
+// Получить поворот в мире:
+void SceneGraph_get_world_quaternion(SceneGraph *self, SceneHandle handle, versor dest) {
+    mat4 pure_rot;
+    SceneGraph_get_transform(self, handle, pure_rot);
+    // Убираем масштаб из матрицы, чтобы осталось только вращение:
+    glm_vec3_normalize(pure_rot[0]);
+    glm_vec3_normalize(pure_rot[1]);
+    glm_vec3_normalize(pure_rot[2]);
+    glm_mat4_quat(pure_rot, dest);
+}
+
+// Получить масштаб в мире:
+Vec3d SceneGraph_get_world_scale(SceneGraph *self, SceneHandle handle) {
+    mat4 m;
+    SceneGraph_get_transform(self, handle, m);
+    return (Vec3d){glm_vec3_norm(m[0]), glm_vec3_norm(m[1]), glm_vec3_norm(m[2])};
+}
+
+// Импортировать дерево из узлов Node (вместе с потомками). Возвращает дескриптор корня импорта:
+SceneHandle SceneGraph_import_node(SceneGraph *self, Node *node, SceneHandle parent) {
+    if (!self || !node) return SCENE_HANDLE_NULL;
+    return import_node(self, node, parent);
+}
@@ -0,0 +1,147 @@
+//
+// scenegraph.h - Плоский граф сцены. Трансформации хранятся в SoA массивах (структура массивов).
+//
+// В отличие от Node, узлы не являются отдельными объектами в куче. Все данные лежат в плотных
+// массивах, отсортированных так, что родитель всегда стоит раньше своих потомков. Благодаря этому
+// все изменённые мировые матрицы пересчитываются одним линейным проходом без рекурсии и без
+// прыжков по указателям. Доступ к узлам идёт через дескрипторы (SceneHandle), API повторяет Node.
+//
+// Для больших сцен есть SceneGraph_update_parallel: массивы сортируются по глубине, и узлы одного
+// уровня глубины пересчитываются параллельно потоками JobSystem. Результат бит-в-бит совпадает
+// с последовательным SceneGraph_update.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+#include "math.h"
+#include "array.h"
+#include "node.h"
+#include "jobsystem.h"
+
+
+// Определения:
+#define SCENEGRAPH_DEFAULT_CAPACITY 1024  // Вместимость графа по умолчанию (в узлах).
+#define SCENEGRAPH_GROWTH_FACTOR    2     // Коэффициент расширения массивов графа.
+#define SCENEGRAPH_PARALLEL_GRAIN   4096  // Сколько узлов одного уровня берёт поток за раз.
+
+
+// Флаги узла графа:
+typedef enum SceneNodeFlags {
+    SCENE_NODE_LOCAL_DIRTY = 1 << 0,  // Изменились позиция, поворот или масштаб.
+    SCENE_NODE_WORLD_DIRTY = 1 << 1,  // Надо пересчитать мировую матрицу (например сменился родитель).
+    SCENE_NODE_UPDATED     = 1 << 2,  // Мировая матрица была пересчитана в текущем проходе.
+    SCENE_NODE_REMOVED     = 1 << 3,  // Узел помечен на удаление.
+} SceneNodeFlags;
+
+
+// Объявление структур:
+typedef struct SceneHandle SceneHandle;  // Дескриптор узла графа.
+typedef struct SceneGraph SceneGraph;    // Плоский граф сцены.
+
+
+// Дескриптор узла графа:
+struct SceneHandle {
+    uint32_t index;       // Индекс в таблице дескрипторов.
+    uint32_t generation;  // Поколение слота (защита от использования удалённых узлов).
+};
+
+
+// Пустой дескриптор (нет узла / нет родителя):
+#define SCENE_HANDLE_NULL ((SceneHandle){UINT32_MAX, 0})
+
+
+// Плоский граф сцены:
+struct SceneGraph {
+    size_t count;     // Количество узлов в плотных массивах.
+    size_t capacity;  // Вместимость плотных массивов.
+
+    // Плотные массивы (родитель всегда раньше потомка):
+    int32_t  *parent;           // Плотный индекс родителя (-1 = корень).
+    vec3     *position;         // Локальная позиция.
+    versor   *quaternion;       // Локальный поворот.
+    vec3     *scale;            // Локальный масштаб.
+    mat4     *local;            // Локальные матрицы трансформации.
+    mat4     *world;            // Мировые (итоговые) матрицы трансформации.
+    uint8_t  *flags;            // Флаги узлов (SceneNodeFlags).
+    uint32_t *dense_to_handle;  // Обратная связь: плотный индекс -> индекс дескриптора.
+
+    // Таблица дескрипторов:
+    uint32_t *handle_to_dense;  // Индекс дескриптора -> плотный индекс (UINT32_MAX = свободен).
+    uint32_t *generations;      // Поколения слотов дескрипторов.
+    size_t   handles_count;     // Сколько слотов дескрипторов использовано.
+    size_t   handles_capacity;  // Вместимость таблицы дескрипторов.
+    Array    *free_handles;     // Свободные слоты дескрипторов (uint32_t).
+
+    // Уровни глубины (заполняются при сортировке по глубине):
+    size_t *levels;        // Начало каждого уровня в плотных массивах (levels_count + 1 значений).
+    size_t levels_count;   // Количество уровней.
+
+    bool dirty;          // В графе есть изменения, которые ещё не применены.
+    bool needs_reorder;  // Порядок "родитель раньше потомка" нарушен (после смены родителя).
+    bool needs_compact;  // Есть узлы помеченные на удаление.
+    bool needs_levels;   // Массивы не отсортированы по глубине (уровни устарели).
+};
+
+
+// -------- API графа сцены: --------
+
+
+// Создать граф сцены:
+SceneGraph* SceneGraph_create(size_t capacity);
+
+// Уничтожить граф сцены:
+void SceneGraph_destroy(SceneGraph **graph);
+
+// Добавить узел (parent может быть SCENE_HANDLE_NULL):
+SceneHandle SceneGraph_add(SceneGraph *self, SceneHandle parent);
+
+// Удалить узел вместе со всеми потомками:
+void SceneGraph_remove(SceneGraph *self, SceneHandle handle);
+
+// Проверить что дескриптор указывает на живой узел:
+bool SceneGraph_is_valid(SceneGraph *self, SceneHandle handle);
+
+// Получить количество узлов в графе:
+size_t SceneGraph_count(SceneGraph *self);
+
+// Установить позицию:
+void SceneGraph_set_position(SceneGraph *self, SceneHandle handle, Vec3d position);
+
+// Установить поворот:
+void SceneGraph_set_quaternion(SceneGraph *self, SceneHandle handle, versor quaternion);
+
+// Установить масштаб:
+void SceneGraph_set_scale(SceneGraph *self, SceneHandle handle, Vec3d scale);
+
+// Вращать узел:
+void SceneGraph_rotate(SceneGraph *self, SceneHandle handle, Vec3d axis, float angle);
+
+// Установить родителя:
+void SceneGraph_set_parent(SceneGraph *self, SceneHandle handle, SceneHandle parent);
+
+// Получить родителя:
+SceneHandle SceneGraph_get_parent(SceneGraph *self, SceneHandle handle);
+
+// Пересчитать все изменённые мировые матрицы одним линейным проходом:
+void SceneGraph_update(SceneGraph *self);
+
+// Пересчитать все изменённые мировые матрицы параллельно (workers = 0 - все потоки JobSystem):
+void SceneGraph_update_parallel(SceneGraph *self, size_t workers);
+
+// Получить матрицу трансформации (если есть изменения, сначала вызывается SceneGraph_update):
+void SceneGraph_get_transform(SceneGraph *self, SceneHandle handle, mat4 dest);
+
+// Получить позицию в мире:
+Vec3d SceneGraph_get_world_position(SceneGraph *self, SceneHandle handle);
+
+// Получить поворот в мире:
+void SceneGraph_get_world_quaternion(SceneGraph *self, SceneHandle handle, versor dest);
+
+// Получить масштаб в мире:
+Vec3d SceneGraph_get_world_scale(SceneGraph *self, SceneHandle handle);
+
+// Импортировать дерево из узлов Node (вместе с потомками). Возвращает дескриптор корня импорта:
+SceneHandle SceneGraph_import_node(SceneGraph *self, Node *node, SceneHandle parent);
@@ -0,0 +1,408 @@
+//
+// texfile.c - Реализация файла готовой к загрузке текстуры.
+//
+// Устройство файла: заголовок TexFileHeader, сразу за ним таблица из count записей TexFileEntry
+// (смещение и размер уровня), затем данные уровней от большего к меньшему. Каждый уровень начинается
+// со смещения кратного TEXFILE_ALIGN, промежутки заполнены нулями. Размер каждого уровня однозначно
+// следует из формата и размеров, поэтому при открытии таблица проверяется целиком и дальше указателям
+// на уровни можно доверять без проверок. Файл пишется во временный и переименовывается, как записи
+// кэша ассетов, поэтому открытый другим процессом файл никогда не бывает недописанным.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "logger.h"
+#include "files.h"
+#include "texfile.h"
+#if defined(_WIN32)
+    #include <process.h>
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+
+// Флаги файла:
+#define TEXFILE_FLAG_SRGB  1  // Цвет хранится в sRGB.
+
+
+// Заголовок файла:
+typedef struct TexFileHeader {
+    char magic[4];      // TEXFILE_MAGIC.
+    uint32_t version;   // TEXFILE_VERSION.
+    uint32_t format;    // TexFileFormat.
+    uint32_t flags;     // TEXFILE_FLAG_*.
+    uint32_t width;     // Ширина нулевого уровня.
+    uint32_t height;    // Высота нулевого уровня.
+    uint32_t count;     // Количество уровней.
+    uint32_t reserved;  // Ноль.
+} TexFileHeader;
+
+
+// Запись таблицы уровней:
+typedef struct TexFileEntry {
+    uint64_t offset;  // Смещение данных уровня от начала файла.
+    uint64_t size;    // Размер данных уровня.
+} TexFileEntry;
+
+
+// Описание формата:
+typedef struct TexFileFormatInfo {
+    const char *name;  // Название.
+    int channels;      // Каналов (у сжатых - после распаковки).
+    size_t bytes;      // Байт на пиксель (0 - сжатый формат).
+    BCFormat bc;       // Блочный формат сжатого формата.
+} TexFileFormatInfo;
+
+
+// Описания форматов (в порядке TexFileFormat):
+static const TexFileFormatInfo g_TexFile_formats[TEXFILE_FORMAT_COUNT] = {
+    { "R8",      1,  1, BC_FORMAT_COUNT },
+    { "RG8",     2,  2, BC_FORMAT_COUNT },
+    { "RGB8",    3,  3, BC_FORMAT_COUNT },
+    { "RGBA8",   4,  4, BC_FORMAT_COUNT },
+    { "R32F",    1,  4, BC_FORMAT_COUNT },
+    { "RG32F",   2,  8, BC_FORMAT_COUNT },
+    { "RGB32F",  3, 12, BC_FORMAT_COUNT },
+    { "RGBA32F", 4, 16, BC_FORMAT_COUNT },
+    { "BC1",     4,  0, BC_FORMAT_BC1 },
+    { "BC3",     4,  0, BC_FORMAT_BC3 },
+    { "BC4",     1,  0, BC_FORMAT_BC4 },
+    { "BC5",     2,  0, BC_FORMAT_BC5 },
+    { "BC7",     4,  0, BC_FORMAT_BC7 },
+    { "R16F",    1,  2, BC_FORMAT_COUNT },
+    { "RG16F",   2,  4, BC_FORMAT_COUNT },
+    { "RGB16F",  3,  6, BC_FORMAT_COUNT },
+    { "RGBA16F", 4,  8, BC_FORMAT_COUNT },
+};
+
+
+// Счётчик имён временных файлов:
+static atomic_uint g_TexFile_tmp_count;
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Корректный ли формат:
+static inline bool is_valid_format(TexFileFormat format) {
+    return (int)format >= 0 && format < TEXFILE_FORMAT_COUNT;
+}
+
+// Размер уровня по размеру нулевого уровня:
+static inline int level_dim(int size, int level) {
+    int dim = size >> level;
+    return dim > 0 ? dim : 1;
+}
+
+// Максимум уровней для размера (до 1x1):
+static int max_levels(int width, int height) {
+    int count = 1;
+    while ((width > 1 || height > 1) && count < MIPMAP_MAX_LEVELS) {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        count++;
+    }
+    return count;
+}
+
+// Выровнять смещение вверх на TEXFILE_ALIGN:
+static inline uint64_t align_offset(uint64_t offset) {
+    return (offset + TEXFILE_ALIGN - 1) & ~(uint64_t)(TEXFILE_ALIGN - 1);
+}
+
+// Формат файла для несжатой картинки:
+static TexFileFormat get_pixmap_format(const Pixmap *pixmap) {
+    int channels = pixmap->channels < 1 ? 1 : (pixmap->channels > 4 ? 4 : pixmap->channels);
+    TexFileFormat first = TEXFILE_FORMAT_R8;
+    if (pixmap->is_hdr) first = pixmap->is_half ? TEXFILE_FORMAT_R16F : TEXFILE_FORMAT_R32F;
+    return (TexFileFormat)(first + channels - 1);
+}
+
+// Формат файла для блочного формата:
+static TexFileFormat get_bc_format(BCFormat format) {
+    for (int i = 0; i < TEXFILE_FORMAT_COUNT; i++) {
+        if (g_TexFile_formats[i].bytes == 0 && g_TexFile_formats[i].bc == format) return (TexFileFormat)i;
+    }
+    return TEXFILE_FORMAT_COUNT;
+}
+
+// Проверить заголовок и таблицу уровней и заполнить описание открытого файла:
+static bool parse_file(const FileMap *map, TexFile *file) {
+    TexFileHeader header;
+    if (map->size < sizeof(header)) return false;
+    memcpy(&header, map->data, sizeof(header));
+    if (memcmp(header.magic, TEXFILE_MAGIC, 4) != 0 || header.version != TEXFILE_VERSION) return false;
+    if (header.format >= TEXFILE_FORMAT_COUNT || header.count < 1 || header.count > MIPMAP_MAX_LEVELS) return false;
+    int max_size = 1 << (MIPMAP_MAX_LEVELS - 1);
+    if (header.width < 1 || header.height < 1 || header.width > (uint32_t)max_size || header.height > (uint32_t)max_size) {
+        return false;
+    }
+    if ((int)header.count > max_levels((int)header.width, (int)header.height)) return false;
+    size_t table_end = sizeof(header) + (size_t)header.count * sizeof(TexFileEntry);
+    if (map->size < table_end) return false;
+
+    file->format = (TexFileFormat)header.format;
+    file->srgb = (header.flags & TEXFILE_FLAG_SRGB) != 0;
+    file->width = (int)header.width;
+    file->height = (int)header.height;
+    file->count = (int)header.count;
+    for (int i = 0; i < file->count; i++) {
+        TexFileEntry entry;
+        memcpy(&entry, map->data + sizeof(header) + (size_t)i * sizeof(entry), sizeof(entry));
+        int width = level_dim(file->width, i), height = level_dim(file->height, i);
+        size_t size = TexFileFormat_get_size(file->format, width, height);
+        if (entry.size != size || entry.offset < table_end || entry.offset > map->size || size > map->size - entry.offset) {
+            return false;
+        }
+        file->levels[i] = (TexFileLevel){ width, height, size, map->data + entry.offset };
+    }
+    return true;
+}
+
+// Записать файл текстуры (уровни уже проверены):
+static bool write_file(FILE *f, const TexFileHeader *header, const TexFileEntry *entries, const TexFileLevel *levels) {
+    static const unsigned char zeros[TEXFILE_ALIGN] = { 0 };
+    bool ok = fwrite(header, sizeof(*header), 1, f) == 1;
+    ok = ok && fwrite(entries, sizeof(*entries), header->count, f) == header->count;
+    uint64_t offset = sizeof(*header) + (uint64_t)header->count * sizeof(*entries);
+    for (uint32_t i = 0; ok && i < header->count; i++) {
+        size_t padding = (size_t)(entries[i].offset - offset);
+        ok = (padding == 0 || fwrite(zeros, 1, padding, f) == padding);
+        ok = ok && fwrite(levels[i].data, 1, levels[i].size, f) == levels[i].size;
+        offset = entries[i].offset + entries[i].size;
+    }
+    return ok;
+}
+
+
+// -------- API файла текстуры: --------
+
+
+// Открыть файл текстуры (отображает в память и проверяет заголовок и таблицу уровней):
+bool TexFile_open(const char *path, TexFile *out_file) {
+    if (!path || !out_file) return false;
+    *out_file = (TexFile){ 0 };
+    FileMap map = Files_map(path, FILE_MAP_SEQUENTIAL);
+    if (!map.data) {
+        log_msg("[E] TexFile_open: Cannot open \"%s\".\n", path);
+        return false;
+    }
+    if (!parse_file(&map, out_file)) {
+        log_msg("[E] TexFile_open: \"%s\" is not a valid texture file.\n", path);
+        Files_unmap(&map);
+        *out_file = (TexFile){ 0 };
+        return false;
+    }
+    out_file->file = map;
+    return true;
+}
+
+
+// Закрыть файл текстуры (указатели на данные уровней становятся недействительными):
+void TexFile_close(TexFile *file) {
+    if (!file) return;
+    Files_unmap(&file->file);
+    *file = (TexFile){ 0 };
+}
+
+
+// Сохранить уровни в файл текстуры. Запись атомарная - читатели видят либо старый файл, либо новый:
+bool TexFile_save(const char *path, TexFileFormat format, bool srgb, const TexFileLevel *levels, int count) {
+    if (!path || !levels || count < 1 || count > MIPMAP_MAX_LEVELS || !is_valid_format(format)) {
+        log_msg("[E] TexFile_save: Invalid arguments.\n");
+        return false;
+    }
+
+    if (count > max_levels(levels[0].width, levels[0].height)) {
+        log_msg("[E] TexFile_save: Too many levels (%d) for %dx%d.\n", count, levels[0].width, levels[0].height);
+        return false;
+    }
+
+    // Уровни должны идти цепочкой мипмапов (каждый вдвое меньше предыдущего) и быть нужного размера:
+    TexFileEntry entries[MIPMAP_MAX_LEVELS];
+    uint64_t offset = align_offset(sizeof(TexFileHeader) + (uint64_t)count * sizeof(TexFileEntry));
+    for (int i = 0; i < count; i++) {
+        size_t size = TexFileFormat_get_size(format, levels[i].width, levels[i].height);
+        bool valid = levels[i].data && levels[i].width > 0 && levels[i].height > 0 && levels[i].size >= size;
+        valid = valid && (i == 0 || (
+            levels[i].width == level_dim(levels[0].width, i) && levels[i].height == level_dim(levels[0].height, i)
+        ));
+        if (!valid) {
+            log_msg("[E] TexFile_save: Level %d of \"%s\" has a wrong size or no data.\n", i, path);
+            return false;
+        }
+        entries[i] = (TexFileEntry){ offset, size };
+        offset = align_offset(offset + size);
+    }
+    TexFileLevel sized[MIPMAP_MAX_LEVELS];
+    for (int i = 0; i < count; i++) {
+        sized[i] = levels[i];
+        sized[i].size = (size_t)entries[i].size;
+    }
+    TexFileHeader header = {
+        .version = TEXFILE_VERSION,
+        .format = (uint32_t)format,
+        .flags = srgb ? TEXFILE_FLAG_SRGB : 0,
+        .width = (uint32_t)levels[0].width,
+        .height = (uint32_t)levels[0].height,
+        .count = (uint32_t)count,
+    };
+    memcpy(header.magic, TEXFILE_MAGIC, 4);
+
+    // Пишем во временный файл и подменяем файл переименованием:
+    char tmp_path[1100];
+    #if defined(_WIN32)
+        int pid = _getpid();
+    #else
+        int pid = (int)getpid();
+    #endif
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d.%u.tmp", path, pid, atomic_fetch_add(&g_TexFile_tmp_count, 1));
+    FILE *f = fopen(tmp_path, "wb");
+    bool ok = f != NULL;
+    if (f) {
+        ok = write_file(f, &header, entries, sized);
+        ok = fclose(f) == 0 && ok;
+    }
+    #if defined(_WIN32)
+        ok = ok && MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING);
+    #else
+        ok = ok && rename(tmp_path, path) == 0;
+    #endif
+    if (!ok) {
+        remove(tmp_path);
+        log_msg("[E] TexFile_save: Cannot write \"%s\".\n", path);
+        return false;
+    }
+    return true;
+}
+
+
+// Сохранить цепочку мипмапов без сжатия:
+bool TexFile_save_mips(const char *path, const MipChain *chain, bool srgb) {
+    if (!chain || chain->count < 1) return false;
+    TexFileFormat format = get_pixmap_format(chain->levels[0]);
+    TexFileLevel levels[MIPMAP_MAX_LEVELS];
+    for (int i = 0; i < chain->count; i++) {
+        const Pixmap *level = chain->levels[i];
+        const Pixmap *base = chain->levels[0];
+        if (level->channels != base->channels || level->is_hdr != base->is_hdr || level->is_half != base->is_half) {
+            log_msg("[E] TexFile_save_mips: Levels have different formats.\n");
+            return false;
+        }
+        levels[i] = (TexFileLevel){ level->width, level->height, Pixmap_get_size((Pixmap*)level), level->data };
+    }
+    return TexFile_save(path, format, srgb && !chain->levels[0]->is_hdr, levels, chain->count);
+}
+
+
+// Сохранить цепочку мипмапов, сжав каждый уровень в BCn (settings = NULL - BC7, качественно, все потоки):
+bool TexFile_save_compressed(const char *path, const MipChain *chain, const BCSettings *settings, bool srgb) {
+    if (!chain || chain->count < 1) return false;
+    if (chain->levels[0]->is_hdr) {
+        log_msg("[E] TexFile_save_compressed: HDR levels cannot be compressed to BCn.\n");
+        return false;
+    }
+    BCSettings opts = settings ? *settings : (BCSettings){ BC_FORMAT_BC7, BC_QUALITY_HIGH, 0 };
+    TexFileFormat format = get_bc_format(opts.format);
+    if (!is_valid_format(format)) {
+        log_msg("[E] TexFile_save_compressed: Unknown block format %d.\n", (int)opts.format);
+        return false;
+    }
+
+    // Сжимаем все уровни и пишем их одним файлом:
+    BCImage *images[MIPMAP_MAX_LEVELS] = { 0 };
+    TexFileLevel levels[MIPMAP_MAX_LEVELS];
+    bool ok = true;
+    for (int i = 0; ok && i < chain->count; i++) {
+        images[i] = BCImage_encode(chain->levels[i], &opts);
+        ok = images[i] != NULL;
+        if (ok) levels[i] = (TexFileLevel){ images[i]->width, images[i]->height, images[i]->size, images[i]->data };
+    }
+    ok = ok && TexFile_save(path, format, srgb, levels, chain->count);
+    for (int i = 0; i < chain->count; i++) BCImage_destroy(&images[i]);
+    return ok;
+}
+
+
+// Получить уровень открытого файла картинкой (копия, сжатые уровни распаковываются):
+Pixmap* TexFile_get_pixmap(const TexFile *self, int level) {
+    if (!self || level < 0 || level >= self->count || !self->levels[level].data) return NULL;
+    const TexFileLevel *src = &self->levels[level];
+    if (TexFileFormat_is_compressed(self->format)) {
+        BCImage image = {
+            TexFileFormat_get_bc(self->format), src->width, src->height, src->size, (void*)src->data
+        };
+        return BCImage_decode(&image);
+    }
+    Pixmap *pixmap = (Pixmap*)mm_alloc(sizeof(Pixmap));
+    pixmap->width = src->width;
+    pixmap->height = src->height;
+    pixmap->channels = TexFileFormat_get_channels(self->format);
+    pixmap->from_stbi = false;
+    pixmap->is_hdr = TexFileFormat_is_hdr(self->format);
+    pixmap->is_half = TexFileFormat_is_half(self->format);
+    pixmap->data = mm_alloc(src->size);
+    memcpy(pixmap->data, src->data, src->size);
+    return pixmap;
+}
+
+
+// Загрузить уровень файла текстуры картинкой (NULL при ошибке):
+Pixmap* Pixmap_load_texfile(const char *path, int level) {
+    TexFile file;
+    if (!TexFile_open(path, &file)) return NULL;
+    Pixmap *pixmap = TexFile_get_pixmap(&file, level);
+    if (!pixmap) log_msg("[E] Pixmap_load_texfile: \"%s\" has no level %d.\n", path, level);
+    TexFile_close(&file);
+    return pixmap;
+}
+
+
+// Сжатый ли формат:
+bool TexFileFormat_is_compressed(TexFileFormat format) {
+    return is_valid_format(format) && g_TexFile_formats[format].bytes == 0;
+}
+
+
+// HDR ли формат (float или half float на канал):
+bool TexFileFormat_is_hdr(TexFileFormat format) {
+    if (!is_valid_format(format) || g_TexFile_formats[format].bytes == 0) return false;
+    return g_TexFile_formats[format].bytes > (size_t)g_TexFile_formats[format].channels;
+}
+
+
+// Half float ли формат:
+bool TexFileFormat_is_half(TexFileFormat format) {
+    if (!is_valid_format(format)) return false;
+    return g_TexFile_formats[format].bytes == (size_t)g_TexFile_formats[format].channels * sizeof(uint16_t);
+}
+
+
+// Получить блочный формат сжатого формата:
+BCFormat TexFileFormat_get_bc(TexFileFormat format) {
+    return is_valid_format(format) ? g_TexFile_formats[format].bc : BC_FORMAT_COUNT;
+}
+
+
+// Получить количество каналов формата (у сжатых - после распаковки):
+int TexFileFormat_get_channels(TexFileFormat format) {
+    return is_valid_format(format) ? g_TexFile_formats[format].channels : 0;
+}
+
+
+// Получить размер уровня в байтах:
+size_t TexFileFormat_get_size(TexFileFormat format, int width, int height) {
+    if (!is_valid_format(format) || width <= 0 || height <= 0) return 0;
+    const TexFileFormatInfo *info = &g_TexFile_formats[format];
+    if (info->bytes == 0) return BC_get_size(info->bc, width, height);
+    return (size_t)width * (size_t)height * info->bytes;
+}
+
+
+// Получить название формата:
+const char* TexFileFormat_get_name(TexFileFormat format) {
+    return is_valid_format(format) ? g_TexFile_formats[format].name : "unknown";
+}
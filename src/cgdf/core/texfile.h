@@ -0,0 +1,122 @@
+//
+// texfile.h - Файл готовой к загрузке текстуры (.ctex).
+//
+// PNG и JPG приходится распаковывать при каждой загрузке, а мипмапы и сжатие BCn считать заново.
+// Файл текстуры хранит уже готовые уровни: заголовок (формат, размер, количество уровней), таблицу уровней
+// (смещение и размер каждого) и сами данные, каждый уровень выровнен на TEXFILE_ALIGN байт. Файл
+// отображается в память (Files_map), и уровни отдаются в видеокарту прямо из отображения без копий
+// и распаковки. Данные уровней - 8 бит, half float или float на канал либо блоки BCn (см. bcn.h).
+// Числа в файле хранятся в порядке байт little-endian.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+#include "files.h"
+#include "pixmap.h"
+#include "mipmap.h"
+#include "bcn.h"
+
+
+// Определения:
+#define TEXFILE_MAGIC      "CGTX"  // Сигнатура файла.
+#define TEXFILE_VERSION    1       // Версия формата.
+#define TEXFILE_ALIGN      64      // Выравнивание данных уровней в файле.
+#define TEXFILE_EXTENSION  ".ctex" // Расширение файла.
+
+
+// Формат данных уровней:
+typedef enum TexFileFormat {
+    TEXFILE_FORMAT_R8,
+    TEXFILE_FORMAT_RG8,
+    TEXFILE_FORMAT_RGB8,
+    TEXFILE_FORMAT_RGBA8,
+    TEXFILE_FORMAT_R32F,
+    TEXFILE_FORMAT_RG32F,
+    TEXFILE_FORMAT_RGB32F,
+    TEXFILE_FORMAT_RGBA32F,
+    TEXFILE_FORMAT_BC1,  // Сжатые форматы (блоки 4x4, см. bcn.h).
+    TEXFILE_FORMAT_BC3,
+    TEXFILE_FORMAT_BC4,
+    TEXFILE_FORMAT_BC5,
+    TEXFILE_FORMAT_BC7,
+    TEXFILE_FORMAT_R16F,  // Half float (добавлены после сжатых, чтобы не менять номера в старых файлах).
+    TEXFILE_FORMAT_RG16F,
+    TEXFILE_FORMAT_RGB16F,
+    TEXFILE_FORMAT_RGBA16F,
+    TEXFILE_FORMAT_COUNT,
+} TexFileFormat;
+
+
+// Объявление структур:
+typedef struct TexFileLevel TexFileLevel;  // Уровень текстуры.
+typedef struct TexFile TexFile;            // Открытый файл текстуры.
+
+
+// Уровень текстуры:
+struct TexFileLevel {
+    int width;         // Ширина в пикселях.
+    int height;        // Высота в пикселях.
+    size_t size;       // Размер данных в байтах.
+    const void *data;  // Данные (у открытого файла - указатель в отображение).
+};
+
+
+// Открытый файл текстуры:
+struct TexFile {
+    TexFileFormat format;                     // Формат данных уровней.
+    bool srgb;                                // Цвет хранится в sRGB.
+    int width;                                // Ширина нулевого уровня.
+    int height;                               // Высота нулевого уровня.
+    int count;                                // Количество уровней.
+    TexFileLevel levels[MIPMAP_MAX_LEVELS];  // Уровни (0 - самый большой).
+    FileMap file;                             // Отображение файла (держит данные уровней).
+};
+
+
+// -------- API файла текстуры: --------
+
+
+// Открыть файл текстуры (отображает в память и проверяет заголовок и таблицу уровней):
+bool TexFile_open(const char *path, TexFile *out_file);
+
+// Закрыть файл текстуры (указатели на данные уровней становятся недействительными):
+void TexFile_close(TexFile *file);
+
+// Сохранить уровни в файл текстуры. Запись атомарная - читатели видят либо старый файл, либо новый:
+bool TexFile_save(const char *path, TexFileFormat format, bool srgb, const TexFileLevel *levels, int count);
+
+// Сохранить цепочку мипмапов без сжатия:
+bool TexFile_save_mips(const char *path, const MipChain *chain, bool srgb);
+
+// Сохранить цепочку мипмапов, сжав каждый уровень в BCn (settings = NULL - BC7, качественно, все потоки):
+bool TexFile_save_compressed(const char *path, const MipChain *chain, const BCSettings *settings, bool srgb);
+
+// Получить уровень открытого файла картинкой (копия, сжатые уровни распаковываются):
+Pixmap* TexFile_get_pixmap(const TexFile *self, int level);
+
+// Загрузить уровень файла текстуры картинкой (NULL при ошибке):
+Pixmap* Pixmap_load_texfile(const char *path, int level);
+
+// Сжатый ли формат:
+bool TexFileFormat_is_compressed(TexFileFormat format);
+
+// HDR ли формат (float или half float на канал):
+bool TexFileFormat_is_hdr(TexFileFormat format);
+
+// Half float ли формат:
+bool TexFileFormat_is_half(TexFileFormat format);
+
+// Получить блочный формат сжатого формата:
+BCFormat TexFileFormat_get_bc(TexFileFormat format);
+
+// Получить количество каналов формата (у сжатых - после распаковки):
+int TexFileFormat_get_channels(TexFileFormat format);
+
+// Получить размер уровня в байтах:
+size_t TexFileFormat_get_size(TexFileFormat format, int width, int height);
+
+// Получить название формата:
+const char* TexFileFormat_get_name(TexFileFormat format);
@@ -0,0 +1,46 @@
+//
+// time.c - Реализация калибровки счётчика тактов процессора.
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "libs.h"
+#include "time.h"
+
+
+// Сколько тактов процессора приходится на наносекунду (0 = ещё не откалибровано):
+_Atomic double g_TimeCyclesPerNs = 0.0;
+
+// Первая калибровка по требованию:
+static once_flag g_TimeCalibrateOnce = ONCE_FLAG_INIT;
+
+
+// Откалибровать счётчик тактов по монотонным часам (seconds - длительность замера):
+void Time_calibrate_cycles(double seconds) {
+    if (seconds <= 0.0) seconds = TIME_CALIBRATE_SEC;
+    uint64_t wait_ns = Time_sec_to_ns(seconds);
+
+    // Крутимся без сна, чтобы поток не вытеснили посреди замера:
+    uint64_t start_ns = Time_get_ns();
+    uint64_t start_cycles = Time_get_cycles();
+    uint64_t now_ns;
+    do { now_ns = Time_get_ns(); } while (now_ns - start_ns < wait_ns);
+    uint64_t end_cycles = Time_get_cycles();
+
+    double ratio = (double)(end_cycles - start_cycles) / (double)(now_ns - start_ns);
+    atomic_store(&g_TimeCyclesPerNs, ratio > 0.0 ? ratio : 1.0);
+}
+
+
+// Калибровка по умолчанию (для call_once):
+static void calibrate_default(void) {
+    if (atomic_load(&g_TimeCyclesPerNs) <= 0.0) Time_calibrate_cycles(TIME_CALIBRATE_SEC);
+}
+
+
+// Тактов на наносекунду (первый вызов из любого потока один раз калибрует счётчик, остальные ждут):
+double Time_get_cycles_per_ns(void) {
+    call_once(&g_TimeCalibrateOnce, calibrate_default);
+    return atomic_load(&g_TimeCyclesPerNs);
+}
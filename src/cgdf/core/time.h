@@ -1,6 +1,11 @@
 //
 // time.h - Заголовок с полезными кроссплатформенными способами работы с временем.
 //
+// Time_now - это время по настенным часам (может прыгать при синхронизации времени системой).
+// Для замеров, кадров и профилирования используйте монотонные часы Time_get_ns (наносекунды),
+// либо счётчик тактов процессора Time_get_cycles (ещё дешевле, переводится в наносекунды после
+// калибровки Time_calibrate_cycles).
+//
 
 #pragma once
 
@@ -12,15 +17,27 @@
 
 #if defined(_WIN32) || defined(_WIN64)
     #include <windows.h>
+    #include <intrin.h>
 #else
     #include <sys/time.h>
     #include <unistd.h>
+    #if defined(__x86_64__) || defined(__i386__)
+        #include <x86intrin.h>
+    #endif
 #endif
 
 
+// Определения:
+#define TIME_NS_PER_SEC     1000000000ull  // Наносекунд в секунде.
+#define TIME_AVERAGE_MAX    256            // Максимальное окно скользящего среднего.
+#define TIME_CALIBRATE_SEC  0.01           // Длительность калибровки счётчика тактов по умолчанию.
+
+
 // Объявление структур:
 typedef struct TimeCurrent TimeCurrent;      // Текущее время.
 typedef struct TimeOffsetUTC TimeOffsetUTC;  // Смещение пояса UTC.
+typedef struct TimeStopwatch TimeStopwatch;  // Секундомер.
+typedef struct TimeAverage TimeAverage;      // Скользящее среднее.
 
 
 // Текущее время:
@@ -44,6 +61,92 @@ struct TimeOffsetUTC {
 };
 
 
+// Секундомер (на монотонных часах):
+struct TimeStopwatch {
+    uint64_t start_ns;    // Когда был запущен (0 = остановлен).
+    uint64_t elapsed_ns;  // Накопленное время до последней остановки.
+};
+
+
+// Скользящее среднее по последним значениям:
+struct TimeAverage {
+    double samples[TIME_AVERAGE_MAX];  // Кольцевой буфер значений.
+    size_t size;   // Размер окна.
+    size_t count;  // Сколько значений уже есть.
+    size_t index;  // Куда писать следующее значение.
+    double sum;    // Сумма значений в окне.
+};
+
+
+// Сколько тактов процессора приходится на наносекунду (0 = ещё не откалибровано):
+extern _Atomic double g_TimeCyclesPerNs;
+
+
+// Монотонное время в наносекундах (не прыгает при смене системного времени):
+static inline uint64_t Time_get_ns(void) {
+    #if defined(_WIN32) || defined(_WIN64)
+        static LARGE_INTEGER freq = {0};
+        LARGE_INTEGER counter;
+        if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&counter);
+        uint64_t c = (uint64_t)counter.QuadPart, f = (uint64_t)freq.QuadPart;
+        return (c / f) * TIME_NS_PER_SEC + (c % f) * TIME_NS_PER_SEC / f;  // Без переполнения.
+    #elif defined(__APPLE__)
+        return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    #else
+        struct timespec ts;
+        #ifdef CLOCK_MONOTONIC_RAW
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts);  // Без подстройки частоты через NTP.
+        #else
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+        #endif
+        return (uint64_t)ts.tv_sec * TIME_NS_PER_SEC + (uint64_t)ts.tv_nsec;
+    #endif
+}
+
+
+// Монотонное время в секундах:
+static inline double Time_get_seconds(void) {
+    return (double)Time_get_ns() / 1e9;
+}
+
+
+// Перевод единиц времени:
+static inline double Time_ns_to_sec(uint64_t ns) { return (double)ns / 1e9; }
+static inline double Time_ns_to_ms(uint64_t ns) { return (double)ns / 1e6; }
+static inline double Time_ns_to_us(uint64_t ns) { return (double)ns / 1e3; }
+static inline uint64_t Time_sec_to_ns(double seconds) { return seconds <= 0.0 ? 0 : (uint64_t)(seconds * 1e9); }
+
+
+// Счётчик тактов процессора (самый дешёвый способ взять метку времени, но в своих единицах):
+static inline uint64_t Time_get_cycles(void) {
+    #if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        return __rdtsc();
+    #elif defined(__aarch64__)
+        uint64_t value;
+        __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+    #else
+        return Time_get_ns();  // Нет счётчика тактов, используем монотонные часы.
+    #endif
+}
+
+
+// Откалибровать счётчик тактов по монотонным часам (seconds - длительность замера):
+void Time_calibrate_cycles(double seconds);
+
+// Тактов на наносекунду (первый вызов из любого потока один раз калибрует счётчик, остальные ждут):
+double Time_get_cycles_per_ns(void);
+
+
+// Перевести такты процессора в наносекунды (при первом вызове калибрует счётчик):
+static inline double Time_cycles_to_ns(uint64_t cycles) {
+    double per_ns = atomic_load_explicit(&g_TimeCyclesPerNs, memory_order_relaxed);
+    if (per_ns <= 0.0) per_ns = Time_get_cycles_per_ns();
+    return (double)cycles / per_ns;
+}
+
+
 // Возвращает время с начала Unix-эпохи в секундах (double) с точностью до мс:
 static inline double Time_now(double *x) {
     double result;
@@ -79,6 +182,24 @@ static inline void Time_sleep(double seconds) {
 }
 
 
+// Спать до момента deadline_ns по монотонным часам Time_get_ns (абсолютный срок, без накопления ошибки):
+static inline void Time_sleep_until_ns(uint64_t deadline_ns) {
+    uint64_t now = Time_get_ns();
+    if (deadline_ns <= now) return;
+    #if defined(__linux__)
+        // CLOCK_MONOTONIC_RAW нельзя ждать через clock_nanosleep, переводим срок в CLOCK_MONOTONIC:
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t target = (uint64_t)ts.tv_sec * TIME_NS_PER_SEC + (uint64_t)ts.tv_nsec + (deadline_ns - now);
+        ts.tv_sec  = (time_t)(target / TIME_NS_PER_SEC);
+        ts.tv_nsec = (long)(target % TIME_NS_PER_SEC);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+    #else
+        Time_sleep(Time_ns_to_sec(deadline_ns - now));
+    #endif
+}
+
+
 // Задержать выполнение кода на определенное время в секундах с дробной частью (большая точность чем у Time_sleep):
 // Комбинированный sleep (по возможности) + active wait для докрутки ожидания в коде.
 static inline void Time_delay(double seconds) {
@@ -90,11 +211,11 @@ static inline void Time_delay(double seconds) {
         const double OS_TICK = 0.001;
     #endif
 
-    double start = Time_now(NULL);                        // Получаем текущее время.
+    uint64_t start = Time_get_ns();                       // Получаем текущее время.
     double sleep_dur = seconds - fmod(seconds, OS_TICK);  // Сколько реально времени точно можно поспать.
     if (sleep_dur > 0.0) { Time_sleep(sleep_dur); }       // Спим не нагружая процессор циклом.
-    double target = start + seconds;
-    while (Time_now(NULL) < target);  // Докручиваем время проверяя текущее время с целевым временем.
+    uint64_t target = start + Time_sec_to_ns(seconds);
+    while (Time_get_ns() < target);  // Докручиваем время проверяя текущее время с целевым временем.
 }
 
 
@@ -188,3 +309,64 @@ static inline void Time_init(void) {
         tzset();
     #endif
 }
+
+
+// -------- Секундомер: --------
+
+
+// Запустить (или продолжить) секундомер:
+static inline void Time_stopwatch_start(TimeStopwatch *self) {
+    if (self && self->start_ns == 0) self->start_ns = Time_get_ns();
+}
+
+// Остановить секундомер (накопленное время сохраняется):
+static inline void Time_stopwatch_stop(TimeStopwatch *self) {
+    if (!self || self->start_ns == 0) return;
+    self->elapsed_ns += Time_get_ns() - self->start_ns;
+    self->start_ns = 0;
+}
+
+// Сбросить секундомер:
+static inline void Time_stopwatch_reset(TimeStopwatch *self) {
+    if (!self) return;
+    self->start_ns = 0;
+    self->elapsed_ns = 0;
+}
+
+// Получить прошедшее время в наносекундах (работает и на ходу):
+static inline uint64_t Time_stopwatch_elapsed_ns(const TimeStopwatch *self) {
+    if (!self) return 0;
+    return self->elapsed_ns + (self->start_ns ? Time_get_ns() - self->start_ns : 0);
+}
+
+// Получить прошедшее время в секундах:
+static inline double Time_stopwatch_elapsed(const TimeStopwatch *self) {
+    return Time_ns_to_sec(Time_stopwatch_elapsed_ns(self));
+}
+
+
+// -------- Скользящее среднее: --------
+
+
+// Инициализировать скользящее среднее (size - размер окна, не больше TIME_AVERAGE_MAX):
+static inline void Time_average_init(TimeAverage *self, size_t size) {
+    if (!self) return;
+    memset(self, 0, sizeof(TimeAverage));
+    self->size = size == 0 ? 1 : (size > TIME_AVERAGE_MAX ? TIME_AVERAGE_MAX : size);
+}
+
+// Добавить значение (самое старое значение выпадает из окна):
+static inline void Time_average_add(TimeAverage *self, double value) {
+    if (!self || self->size == 0) return;
+    if (self->count == self->size) self->sum -= self->samples[self->index];
+    else self->count++;
+    self->samples[self->index] = value;
+    self->sum += value;
+    self->index = (self->index + 1) % self->size;
+}
+
+// Получить среднее значение по окну:
+static inline double Time_average_get(const TimeAverage *self) {
+    if (!self || self->count == 0) return 0.0;
+    return self->sum / (double)self->count;
+}
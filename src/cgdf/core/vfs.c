@@ -0,0 +1,271 @@
+//
+// vfs.c - Реализация виртуальной файловой системы (пакеты ассетов).
+//
+// Формат пакета (little-endian, версия 2):
+//   Заголовок (56 байт): "CGDFPACK", u32 версия, u32 количество файлов, u32 размер хэш-таблицы (степень
+//                        двойки), u32 резерв, u64 смещение записей, u64 смещение хэш-таблицы,
+//                        u64 смещение имён, u64 размер имён.
+//   Записи (по 48 байт): u64 хэш пути, u64 смещение данных, u64 размер данных, u64 размер файла,
+//                        u32 смещение имени, u32 длина имени, u32 флаги (VFS_ENTRY_*), u32 резерв.
+//   Хэш-таблица: u32 на ячейку - номер записи + 1 (0 - пусто), открытая адресация с линейным пробированием.
+//   Имена: пути файлов без '\0' подряд ("data/textures/a.png").
+//   Данные файлов: каждый файл начинается с границы VFS_PACK_ALIGN. Сжатый файл - один LZ блок (lz.h).
+//
+
+
+// Подключаем:
+#include "std.h"
+#include "mm.h"
+#include "array.h"
+#include "logger.h"
+#include "files.h"
+#include "lz.h"
+#include "vfs.h"
+
+
+// Определения:
+#define VFS_PACK_VERSION     2  // Версия формата пакета.
+#define VFS_ENTRY_COMPRESSED 1  // Флаг записи: данные сжаты LZ блоком.
+
+
+// Заголовок пакета:
+typedef struct PackHeader {
+    char magic[8];            // "CGDFPACK".
+    uint32_t version;         // Версия формата.
+    uint32_t entry_count;     // Количество файлов.
+    uint32_t table_size;      // Размер хэш-таблицы (степень двойки).
+    uint32_t reserved;        // Резерв.
+    uint64_t entries_offset;  // Смещение записей.
+    uint64_t table_offset;    // Смещение хэш-таблицы.
+    uint64_t names_offset;    // Смещение имён.
+    uint64_t names_size;      // Размер имён.
+} PackHeader;
+
+
+// Запись о файле в пакете:
+typedef struct PackEntry {
+    uint64_t hash;         // Хэш пути.
+    uint64_t offset;       // Смещение данных.
+    uint64_t size;         // Размер данных.
+    uint64_t raw_size;     // Размер файла (после распаковки).
+    uint32_t name_offset;  // Смещение имени в блоке имён.
+    uint32_t name_length;  // Длина имени.
+    uint32_t flags;        // Флаги (VFS_ENTRY_*).
+    uint32_t reserved;     // Резерв.
+} PackEntry;
+
+
+// Смонтированный пакет:
+typedef struct VFSPack {
+    char *path;                // Путь к пакету.
+    FileMap file;              // Отображённый файл пакета.
+    const PackHeader *header;  // Заголовок.
+    const PackEntry *entries;  // Записи.
+    const uint32_t *table;     // Хэш-таблица.
+    const char *names;         // Имена.
+} VFSPack;
+
+
+// Смонтированные пакеты (VFSPack*):
+static Array *g_VFSPacks = NULL;
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Проверить, что диапазон лежит внутри файла:
+static bool range_ok(uint64_t offset, uint64_t size, size_t file_size) {
+    return offset <= file_size && size <= file_size - offset;
+}
+
+// Проверить заголовок и записи пакета:
+static bool validate_pack(VFSPack *pack) {
+    size_t file_size = pack->file.size;
+    if (file_size < sizeof(PackHeader)) return false;
+    const PackHeader *h = (const PackHeader*)pack->file.data;
+    if (memcmp(h->magic, "CGDFPACK", 8) != 0 || h->version != VFS_PACK_VERSION) return false;
+    if (h->table_size == 0 || (h->table_size & (h->table_size - 1)) != 0) return false;
+    if (h->entry_count >= h->table_size) return false;  // В таблице всегда должна быть пустая ячейка.
+    if (!range_ok(h->entries_offset, (uint64_t)h->entry_count * sizeof(PackEntry), file_size)) return false;
+    if (!range_ok(h->table_offset, (uint64_t)h->table_size * sizeof(uint32_t), file_size)) return false;
+    if (!range_ok(h->names_offset, h->names_size, file_size)) return false;
+    if (h->entries_offset % 8 != 0 || h->table_offset % 4 != 0) return false;
+
+    pack->header = h;
+    pack->entries = (const PackEntry*)(pack->file.data + h->entries_offset);
+    pack->table = (const uint32_t*)(pack->file.data + h->table_offset);
+    pack->names = (const char*)(pack->file.data + h->names_offset);
+    for (uint32_t i = 0; i < h->entry_count; i++) {
+        const PackEntry *e = &pack->entries[i];
+        if (!range_ok(e->offset, e->size, file_size)) return false;
+        if (!range_ok(e->name_offset, e->name_length, h->names_size)) return false;
+        if (!(e->flags & VFS_ENTRY_COMPRESSED) && e->raw_size != e->size) return false;
+    }
+    for (uint32_t i = 0; i < h->table_size; i++) {
+        if (pack->table[i] > h->entry_count) return false;
+    }
+    return true;
+}
+
+// Найти запись в пакете:
+static const PackEntry* pack_find(const VFSPack *pack, const char *path, size_t length, uint64_t hash) {
+    uint32_t mask = pack->header->table_size - 1;
+    for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1) & mask) {
+        uint32_t slot = pack->table[i];
+        if (slot == 0) return NULL;
+        const PackEntry *e = &pack->entries[slot - 1];
+        if (e->hash == hash && e->name_length == length && memcmp(pack->names + e->name_offset, path, length) == 0) {
+            return e;
+        }
+    }
+}
+
+// Освободить пакет:
+static void pack_free(VFSPack *pack) {
+    Files_unmap(&pack->file);
+    mm_free(pack->path);
+    mm_free(pack);
+}
+
+
+// -------- API виртуальной файловой системы: --------
+
+
+// Смонтировать пакет (пакеты смонтированные позже перекрывают более ранние):
+bool VFS_mount(const char *pack_path) {
+    if (!pack_path) return false;
+    if (!g_VFSPacks) g_VFSPacks = Array_create(sizeof(VFSPack*), 4);
+
+    VFSPack *pack = (VFSPack*)mm_alloc(sizeof(VFSPack));
+    memset(pack, 0, sizeof(VFSPack));
+    pack->file = Files_map(pack_path, FILE_MAP_NORMAL);  // Обычное чтение наперёд: файлы пакета лежат подряд.
+    if (!pack->file.data) {
+        log_msg("[E] VFS_mount: Pack \"%s\" not found.\n", pack_path);
+        mm_free(pack);
+        return false;
+    }
+    if (!validate_pack(pack)) {
+        log_msg("[E] VFS_mount: \"%s\" is not a valid pack.\n", pack_path);
+        Files_unmap(&pack->file);
+        mm_free(pack);
+        return false;
+    }
+    pack->path = mm_strdup(pack_path);
+    Array_push(g_VFSPacks, &pack);
+    log_msg("[I] VFS_mount: Mounted \"%s\" (%u files).\n", pack_path, pack->header->entry_count);
+    return true;
+}
+
+
+// Размонтировать пакет:
+bool VFS_unmount(const char *pack_path) {
+    if (!pack_path || !g_VFSPacks) return false;
+    for (size_t i = Array_len(g_VFSPacks); i > 0; i--) {
+        VFSPack *pack = *(VFSPack**)Array_get(g_VFSPacks, i - 1);
+        if (strcmp(pack->path, pack_path) != 0) continue;
+        Array_remove(g_VFSPacks, i - 1, NULL);
+        pack_free(pack);
+        return true;
+    }
+    return false;
+}
+
+
+// Размонтировать все пакеты:
+void VFS_unmount_all(void) {
+    if (!g_VFSPacks) return;
+    for (size_t i = 0; i < Array_len(g_VFSPacks); i++) pack_free(*(VFSPack**)Array_get(g_VFSPacks, i));
+    Array_destroy(&g_VFSPacks);
+}
+
+
+// Найти файл в смонтированных пакетах (данные остаются в пакете, их нельзя освобождать):
+bool VFS_find(const char *file_path, VFSFile *out_file) {
+    if (!file_path || !g_VFSPacks || Array_len(g_VFSPacks) == 0) return false;
+
+    char path[VFS_MAX_PATH];
+    size_t length = VFS_normalize_path(file_path, path, sizeof(path));
+    if (length == 0) return false;
+    uint64_t hash = VFS_hash_path(path, length);
+
+    // Позже смонтированные пакеты проверяются первыми:
+    for (size_t i = Array_len(g_VFSPacks); i > 0; i--) {
+        const VFSPack *pack = *(VFSPack**)Array_get(g_VFSPacks, i - 1);
+        const PackEntry *e = pack_find(pack, path, length, hash);
+        if (!e) continue;
+        if (out_file) {
+            out_file->data = pack->file.data + e->offset;
+            out_file->size = (size_t)e->size;
+            out_file->raw_size = (size_t)e->raw_size;
+            out_file->compressed = (e->flags & VFS_ENTRY_COMPRESSED) != 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+
+// Прочитать файл пакета в буфер размером не меньше raw_size (сжатый файл распаковывается):
+bool VFS_read(const VFSFile *file, void *dst) {
+    if (!file || (!dst && file->raw_size > 0)) return false;
+    if (!file->compressed) {
+        memcpy(dst, file->data, file->size);
+        return true;
+    }
+    return LZ_decompress(file->data, file->size, dst, file->raw_size) == file->raw_size;
+}
+
+
+// Получить количество смонтированных пакетов:
+size_t VFS_get_mount_count(void) {
+    return g_VFSPacks ? Array_len(g_VFSPacks) : 0;
+}
+
+
+// Привести путь к виду, в котором он хранится в пакете ("./a\\b/../c" -> "a/c"). Возвращает длину или 0:
+size_t VFS_normalize_path(const char *file_path, char *out, size_t out_size) {
+    if (!file_path || !out || out_size == 0) return 0;
+    size_t len = 0;
+    const char *s = file_path;
+    if (*s == '/' || *s == '\\') out[len++] = '/';  // Абсолютный путь остаётся абсолютным.
+
+    while (*s) {
+        // Выделяем очередной сегмент пути:
+        while (*s == '/' || *s == '\\') s++;
+        const char *seg = s;
+        while (*s && *s != '/' && *s != '\\') s++;
+        size_t seg_len = (size_t)(s - seg);
+        if (seg_len == 0 || (seg_len == 1 && seg[0] == '.')) continue;
+
+        // ".." убирает предыдущий сегмент (если он есть и сам не ".."):
+        if (seg_len == 2 && seg[0] == '.' && seg[1] == '.') {
+            size_t start = len;
+            while (start > 0 && out[start - 1] != '/') start--;
+            bool prev_is_up = (len - start == 2 && out[start] == '.' && out[start + 1] == '.');
+            if (len > start && !prev_is_up) {
+                len = start > 0 && !(start == 1 && out[0] == '/') ? start - 1 : start;
+                continue;
+            }
+        }
+
+        // Добавляем сегмент:
+        bool need_sep = len > 0 && out[len - 1] != '/';
+        if (len + need_sep + seg_len + 1 > out_size) return 0;
+        if (need_sep) out[len++] = '/';
+        memcpy(out + len, seg, seg_len);
+        len += seg_len;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+
+// Хэш пути в пакете (FNV-1a 64):
+uint64_t VFS_hash_path(const char *path, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)path[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
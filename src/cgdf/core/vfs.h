@@ -0,0 +1,65 @@
+//
+// vfs.h - Виртуальная файловая система (пакеты ассетов).
+//
+// Пакет - один файл со множеством ассетов и хэш-таблицей путей (собирается "build/tools/pack.py").
+// Смонтированный пакет целиком отображается в память, а Files_load, Files_load_bin, Files_map,
+// Files_exists (и всё что через них грузится: Pixmap_load, Texture_load, FontPixmap_create,
+// ObjLoader_load) сначала ищут путь в пакетах и только потом на диске. Поиск не делает
+// системных вызовов, а данные файла из пакета отдаются без копирования (через Files_map).
+// Файлы в пакете могут быть сжаты (lz.h) - тогда они распаковываются при чтении.
+//
+// Монтировать и размонтировать пакеты нужно пока никто не читает файлы (обычно при запуске).
+// После размонтирования указатели на данные из пакета становятся недействительными.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include "std.h"
+
+
+// Определения:
+#define VFS_PACK_ALIGN   4096  // Выравнивание данных файлов в пакете (размер страницы).
+#define VFS_MAX_PATH     1024  // Максимальная длина пути при поиске.
+
+
+// Объявление структур:
+typedef struct VFSFile VFSFile;  // Файл в пакете.
+
+
+// Файл в пакете:
+struct VFSFile {
+    const unsigned char *data;  // Данные в пакете (сжатый LZ блок, если compressed).
+    size_t size;                // Размер данных в пакете.
+    size_t raw_size;            // Размер самого файла.
+    bool compressed;            // Данные сжаты (lz.h).
+};
+
+
+// -------- API виртуальной файловой системы: --------
+
+
+// Смонтировать пакет (пакеты смонтированные позже перекрывают более ранние):
+bool VFS_mount(const char *pack_path);
+
+// Размонтировать пакет:
+bool VFS_unmount(const char *pack_path);
+
+// Размонтировать все пакеты:
+void VFS_unmount_all(void);
+
+// Найти файл в смонтированных пакетах (данные остаются в пакете, их нельзя освобождать):
+bool VFS_find(const char *file_path, VFSFile *out_file);
+
+// Прочитать файл пакета в буфер размером не меньше raw_size (сжатый файл распаковывается):
+bool VFS_read(const VFSFile *file, void *dst);
+
+// Получить количество смонтированных пакетов:
+size_t VFS_get_mount_count(void);
+
+// Привести путь к виду, в котором он хранится в пакете ("./a\\b/../c" -> "a/c"). Возвращает длину или 0:
+size_t VFS_normalize_path(const char *file_path, char *out, size_t out_size);
+
+// Хэш пути в пакете (FNV-1a 64):
+uint64_t VFS_hash_path(const char *path, size_t length);
@@ -20,12 +20,33 @@
 #include <cgdf/core/mm.h>
 #include <cgdf/core/files.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/profiler.h>
+#include <cgdf/core/counters.h>
+#include <cgdf/core/assetcache.h>
+#include <cgdf/core/pixconv.h>
 #include "renderer.h"
 #include "texture.h"
 #include "spritebatch.h"
 #include "font.h"
 
 
+// Растр глифа в кэше ассетов (запись: количество глифов, таблица по возрастанию кода, растры альфы):
+typedef struct CookedGlyph {
+    uint32_t codepoint;          // Код символа.
+    int32_t width, height;       // Размер растра.
+    int32_t offset_x, offset_y;  // Смещение растра.
+    int32_t advance;             // Насколько сдвигать курсор (px).
+    uint32_t offset;             // Где растр (от начала растров).
+} CookedGlyph;
+
+
+// Глиф, растеризованный в этом запуске (для записи в кэш):
+typedef struct BakedGlyph {
+    CookedGlyph info;       // Метрики глифа.
+    unsigned char *bitmap;  // Растр альфы (width * height).
+} BakedGlyph;
+
+
 // -------- Вспомогательные функции: --------
 
 
@@ -33,9 +54,7 @@
 static char* check_file_path(const char* file_path) {
     // Сначала пользовательский путь:
     if (file_path && file_path[0] != '\0') {
-        FILE *f = fopen(file_path, "rb");
-        if (f) {
-            fclose(f);
+        if (Files_exists(file_path)) {
             char *path = mm_alloc(strlen(file_path) + 1);
             strcpy(path, file_path);
             return path;
@@ -150,29 +169,128 @@ static bool glyph_insert_to_cache(FontPixmap *self, uint32_t codepoint, FontGlyp
     return true;
 }
 
+// Проверить запись кэша с растрами глифов (таблица и растры должны помещаться в данные):
+static bool cooked_glyphs_valid(const CookedAsset *cooked) {
+    uint32_t count;
+    if (cooked->size < sizeof(count)) return false;
+    memcpy(&count, cooked->data, sizeof(count));
+    size_t table_end = sizeof(count) + (size_t)count * sizeof(CookedGlyph);
+    if (table_end > cooked->size) return false;
+    for (uint32_t i = 0; i < count; i++) {
+        CookedGlyph glyph;
+        memcpy(&glyph, cooked->data + sizeof(count) + (size_t)i * sizeof(CookedGlyph), sizeof(glyph));
+        if (glyph.width < 0 || glyph.height < 0) return false;
+        if ((size_t)glyph.offset + (size_t)glyph.width * (size_t)glyph.height > cooked->size - table_end) return false;
+    }
+    return true;
+}
+
+// Найти растр глифа в кэше ассетов (двоичный поиск по таблице). Возвращает растр или NULL:
+static const unsigned char* find_cooked_glyph(FontPixmap *self, uint32_t codepoint, CookedGlyph *out) {
+    if (!self->cooked.data) return NULL;
+    uint32_t count;
+    memcpy(&count, self->cooked.data, sizeof(count));
+    const unsigned char *table = self->cooked.data + sizeof(count);
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        memcpy(out, table + mid * sizeof(CookedGlyph), sizeof(CookedGlyph));
+        if (out->codepoint == codepoint) return table + (size_t)count * sizeof(CookedGlyph) + out->offset;
+        if (out->codepoint < codepoint) lo = mid + 1; else hi = mid;
+    }
+    return NULL;
+}
+
+// Запомнить растеризованный глиф для записи в кэш ассетов:
+static void bake_glyph(FontPixmap *self, const CookedGlyph *info, const unsigned char *bitmap) {
+    if (!self->baked) return;
+    size_t size = (size_t)info->width * (size_t)info->height;
+    BakedGlyph baked = { .info = *info, .bitmap = (unsigned char*)mm_alloc(size > 0 ? size : 1) };
+    memcpy(baked.bitmap, bitmap, size);
+    Array_push(self->baked, &baked);
+}
+
+// Сравнить глифы по коду символа (для qsort):
+static int compare_baked(const void *a, const void *b) {
+    uint32_t ca = ((const BakedGlyph*)a)->info.codepoint;
+    uint32_t cb = ((const BakedGlyph*)b)->info.codepoint;
+    return (ca > cb) - (ca < cb);
+}
+
+// Записать в кэш ассетов все известные растры глифов (из кэша и растеризованные в этом запуске):
+static void store_cooked_glyphs(FontPixmap *self) {
+    if (!self->baked || Array_len(self->baked) == 0) return;
+
+    // Собираем все глифы (растры из старой записи остаются в отображении до конца записи):
+    uint32_t cooked_count = 0;
+    if (self->cooked.data) memcpy(&cooked_count, self->cooked.data, sizeof(cooked_count));
+    size_t total = cooked_count + Array_len(self->baked);
+    BakedGlyph *all = (BakedGlyph*)mm_alloc(total * sizeof(BakedGlyph));
+    for (uint32_t i = 0; i < cooked_count; i++) {
+        const unsigned char *table = self->cooked.data + sizeof(uint32_t);
+        memcpy(&all[i].info, table + i * sizeof(CookedGlyph), sizeof(CookedGlyph));
+        all[i].bitmap = (unsigned char*)table + cooked_count * sizeof(CookedGlyph) + all[i].info.offset;
+    }
+    memcpy(all + cooked_count, self->baked->data, Array_len(self->baked) * sizeof(BakedGlyph));
+    qsort(all, total, sizeof(BakedGlyph), compare_baked);
+
+    // Таблица без повторов (пересборка атласа растеризует глифы ещё раз) и растры за ней:
+    CookedGlyph *table = (CookedGlyph*)mm_alloc(total * sizeof(CookedGlyph));
+    Array *parts = Array_create(sizeof(CookedPart), total + 2);
+    uint32_t count = 0, offset = 0;
+    Array_push(parts, &(CookedPart){ &count, sizeof(count) });
+    Array_push(parts, &(CookedPart){ table, 0 });  // Размер таблицы известен после прохода.
+    for (size_t i = 0; i < total; i++) {
+        if (count > 0 && table[count - 1].codepoint == all[i].info.codepoint) continue;
+        table[count] = all[i].info;
+        table[count].offset = offset;
+        size_t size = (size_t)all[i].info.width * (size_t)all[i].info.height;
+        Array_push(parts, &(CookedPart){ all[i].bitmap, size });
+        offset += (uint32_t)size;
+        count++;
+    }
+    ((CookedPart*)Array_get(parts, 1))->size = count * sizeof(CookedGlyph);
+    AssetCache_store("glyphs", self->cache_key, (const CookedPart*)parts->data, Array_len(parts));
+
+    Array_destroy(&parts);
+    mm_free(table);
+    mm_free(all);
+}
+
 // Создать глиф и добавить в атлас:
 static FontGlyph* generate_glyph(FontPixmap *self, uint32_t codepoint) {
     if (!self) return NULL;
+    PROFILE_ZONE("FontPixmap generate_glyph");
 
     // Если нет такого глифа, то возвращаем FONT_FALLBACK_SUMB:
     if (stbtt_FindGlyphIndex(&self->info, codepoint) == 0) codepoint = FONT_FALLBACK_SUMB;
 
-    // Получаем bitmap символа:
-    int width, height, xoff, yoff;
-    unsigned char *bitmap = stbtt_GetCodepointBitmap(
-        &self->info, 0, self->scale, codepoint, &width, &height, &xoff, &yoff
-    );
-    if (!bitmap) return NULL;
+    // Получаем bitmap символа (из кэша ассетов либо растеризуем):
+    CookedGlyph raster;
+    unsigned char *bitmap = NULL;
+    const unsigned char *pixels = find_cooked_glyph(self, codepoint, &raster);
+    if (!pixels) {
+        int xoff, yoff, advance, lsb;
+        bitmap = stbtt_GetCodepointBitmap(
+            &self->info, 0, self->scale, codepoint, &raster.width, &raster.height, &xoff, &yoff
+        );
+        if (!bitmap) return NULL;
+        COUNTER_INC("font.glyphs_rasterized");
+        stbtt_GetCodepointHMetrics(&self->info, codepoint, &advance, &lsb);
+        raster.codepoint = codepoint;
+        raster.offset_x = xoff;
+        raster.offset_y = yoff;
+        raster.advance = (int)(advance * self->scale);
+        raster.offset = 0;
+        bake_glyph(self, &raster, bitmap);
+        pixels = bitmap;
+    }
+    int width = raster.width, height = raster.height;
 
     // Конвертируем bitmap в RGBA8:
     unsigned char *rgba = mm_alloc(width * height * 4);
-    for (int i = 0; i < width * height; i++) {
-        rgba[i*4+0] = 255;
-        rgba[i*4+1] = 255;
-        rgba[i*4+2] = 255;
-        rgba[i*4+3] = bitmap[i];  // Это альфа канал.
-    }
-    stbtt_FreeBitmap(bitmap, NULL);
+    PixConv_a_to_rgba(pixels, rgba, (size_t)width * (size_t)height);  // Покрытие глифа идёт в альфа канал.
+    if (bitmap) stbtt_FreeBitmap(bitmap, NULL);
 
     // Добавляем глиф в атлас:
     const int pad  = FONT_ATLAS_PADDING;
@@ -193,24 +311,19 @@ static FontGlyph* generate_glyph(FontPixmap *self, uint32_t codepoint) {
 
     // Загружаем bitmap в текстуру:
     // Данные вставляются от atlas_x, atlas_y и до atlas_x+width, atlas_y+height:
-    Texture_set_subdata(
-        self->atlas, 0, atlas_x, atlas_y, width, height,
+    TexUpload_subdata(
+        self->renderer->uploads, self->atlas, 0, atlas_x, atlas_y, width, height,
         TEX_FORMAT_RGBA, TEX_DATA_UBYTE, rgba
     );
     mm_free(rgba);  // Можно освободить. Больше не понадобится.
 
-    // Получаем advance:
-    int advance, lsb;
-    stbtt_GetCodepointHMetrics(&self->info, codepoint, &advance, &lsb);
-    advance = (int)(advance * self->scale);
-
     // Создаём глиф в куче:
     FontGlyph *glyph = (FontGlyph*)mm_alloc(sizeof(FontGlyph));
     glyph->width = width;
     glyph->height = height;
-    glyph->offset_x = (float)xoff;
-    glyph->offset_y = (float)yoff;
-    glyph->advance = (float)advance;
+    glyph->offset_x = (float)raster.offset_x;
+    glyph->offset_y = (float)raster.offset_y;
+    glyph->advance = (float)raster.advance;
     glyph->u0 = (float)atlas_x / (float)self->atlas->width;
     glyph->v0 = (float)atlas_y / (float)self->atlas->height;
     glyph->u1 = (float)(atlas_x + width) / (float)self->atlas->width;
@@ -296,17 +409,17 @@ FontPixmap* FontPixmap_create(Renderer *renderer, const char *file_path, int fon
     FontPixmap *font = (FontPixmap*)mm_alloc(sizeof(FontPixmap));
 
     // Загружаем шрифт и инициализируем его:
-    font->ttf_buffer = Files_load_bin(font_path, "rb", NULL);
-    if (!font->ttf_buffer) {
+    font->ttf_file = Files_map(font_path, FILE_MAP_RANDOM);  // stbtt читает таблицы шрифта вразброс.
+    if (!font->ttf_file.data) {
         log_msg("[E] FontPixmap_create: failed to read font file: %s\n", font_path);
         mm_free(font_path);
         mm_free(font);
         return NULL;
     }
-    if (!stbtt_InitFont(&font->info, font->ttf_buffer, 0)) {
+    if (!stbtt_InitFont(&font->info, font->ttf_file.data, 0)) {
         log_msg("[E] FontPixmap_create: stbtt_InitFont failed for: %s\n", font_path);
         mm_free(font_path);
-        mm_free(font->ttf_buffer);
+        Files_unmap(&font->ttf_file);
         mm_free(font);
         return NULL;
     }
@@ -325,7 +438,7 @@ FontPixmap* FontPixmap_create(Renderer *renderer, const char *file_path, int fon
     font->glyphs_array = Array_create(sizeof(uint32_t), FONT_ATLAS_SIZE);
     font->glyphs = HashTable_create();
     font->added_glyphs_count = 0;
-    // ttf_buffer - уже загружен выше.
+    // ttf_file - уже отображён выше.
 
     font->color = (Vec4f){1.0f, 1.0f, 1.0f, 1.0f};
     font->bg_color = (Vec4f){0.0f, 0.0f, 0.0f, 0.0f};
@@ -350,6 +463,19 @@ FontPixmap* FontPixmap_create(Renderer *renderer, const char *file_path, int fon
     stbtt_GetCodepointHMetrics(&font->info, ' ', &sp_adv, &sp_lsb);
     font->space_advance = sp_adv * font->scale;
 
+    // Растры глифов из кэша ассетов (ключ - байты шрифта и его размер):
+    font->cooked = (CookedAsset){ 0 };
+    font->baked = NULL;
+    font->cache_key = 0;
+    if (AssetCache_is_enabled()) {
+        int32_t settings = font_size;
+        font->cache_key = AssetCache_key("glyphs", font->ttf_file.data, font->ttf_file.size, &settings, sizeof(settings));
+        font->baked = Array_create(sizeof(BakedGlyph), ARRAY_DEFAULT_CAPACITY);
+        if (AssetCache_load("glyphs", font->cache_key, &font->cooked) && !cooked_glyphs_valid(&font->cooked)) {
+            AssetCache_release(&font->cooked);
+        }
+    }
+
     // Инициализируем атлас:
     int atlas_size = (int)sqrt(FONT_ATLAS_SIZE) * (font->font_size + FONT_ATLAS_PADDING * 2);
     if (atlas_size > max_size) atlas_size = max_size;  // Ограничиваем максимумом.
@@ -365,7 +491,17 @@ void FontPixmap_destroy(FontPixmap **font) {
     Texture_destroy(&(*font)->atlas);
     SpriteBatch_destroy(&(*font)->batch);
     Array_destroy(&(*font)->glyphs_array);
-    mm_free((*font)->ttf_buffer);  // Уничтожаем загруженный шрифт.
+    Files_unmap(&(*font)->ttf_file);  // Закрываем отображение файла шрифта.
+
+    // Дописываем новые растры глифов в кэш ассетов:
+    if ((*font)->baked) {
+        store_cooked_glyphs(*font);
+        for (size_t i = 0; i < Array_len((*font)->baked); i++) {
+            mm_free(((BakedGlyph*)Array_get((*font)->baked, i))->bitmap);
+        }
+        Array_destroy(&(*font)->baked);
+    }
+    AssetCache_release(&(*font)->cooked);
 
     HashTable_clear((*font)->glyphs, true);  // Уничтожаем ключи и глифы из памяти.
     HashTable_destroy(&(*font)->glyphs);
@@ -663,6 +799,7 @@ FontTextBlock FontPixmap_get_text_block(FontPixmap *self, const char *text, ...)
 // Отрисовать текст:
 void FontPixmap_render(FontPixmap *self, float x, float y, float angle, const char *text, ...) {
     if (!self || !text || isinf(x) || isinf(y)) return;
+    PROFILE_FUNC();
 
     // Форматируем text как f-строку:
     char stack_text[1024];   // 1024 байт-символов текста в стеке для быстроты.
@@ -828,3 +965,23 @@ void FontPixmap_render(FontPixmap *self, float x, float y, float angle, const ch
     SpriteBatch_end(self->batch);
     if (heap_text) mm_free(heap_text);
 }
+
+// Отрисовать значения счётчиков производительности за последний кадр (по строке на счётчик):
+void FontPixmap_render_counters(FontPixmap *self, float x, float y) {
+    if (!self) return;
+
+    // Собираем строки "имя: значение" в один текст, чтобы отрисовать одним вызовом:
+    char text[4096];
+    size_t len = 0;
+    size_t count = Counters_count();
+    for (size_t i = 0; i < count && len < sizeof(text); i++) {
+        Counter *c = Counters_get(i);
+        int n = snprintf(text + len, sizeof(text) - len, "%s: %lld\n", c->name, (long long)c->frame_value);
+        if (n < 0) break;
+        len += (size_t)n;
+    }
+    if (len == 0) return;
+    if (len >= sizeof(text)) len = sizeof(text) - 1;
+    text[len] = '\0';
+    FontPixmap_render(self, x, y, 0.0f, "%s", text);
+}
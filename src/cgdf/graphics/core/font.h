@@ -11,6 +11,8 @@
 #include <cgdf/core/math.h>
 #include <cgdf/core/array.h>
 #include <cgdf/core/hashtable.h>
+#include <cgdf/core/files.h>
+#include <cgdf/core/assetcache.h>
 #include "renderer.h"
 #include "texture.h"
 #include "spritebatch.h"
@@ -56,7 +58,10 @@ struct FontPixmap {
     Array          *glyphs_array;  // Массив глифов (просто коды символов). Нужен для расширения атласа.
     HashTable      *glyphs;        // Хэш-таблица глифов (символов). Нужен для немедленного доступа к глифам.
     int added_glyphs_count;        // Сколько глифов было добавлено в атлас. Нужен для авто-расширения атласа.
-    unsigned char  *ttf_buffer;    // Буфер данных файла шрифта.
+    FileMap        ttf_file;       // Отображённый в память файл шрифта.
+    CookedAsset    cooked;         // Растры глифов из кэша ассетов (пусто, если кэш выключен или промах).
+    Array          *baked;         // Глифы, растеризованные в этом запуске (для записи в кэш при уничтожении).
+    uint64_t       cache_key;      // Ключ шрифта в кэше ассетов.
 
     Vec4f     color;         // Цвет текста.
     Vec4f     bg_color;      // Фоновый цвет.
@@ -179,3 +184,6 @@ FontTextBlock FontPixmap_get_text_block(FontPixmap *self, const char *text, ...)
 
 // Отрисовать текст:
 void FontPixmap_render(FontPixmap *self, float x, float y, float angle, const char *text, ...);
+
+// Отрисовать значения счётчиков производительности за последний кадр (по строке на счётчик):
+void FontPixmap_render_counters(FontPixmap *self, float x, float y);
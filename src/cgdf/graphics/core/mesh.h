@@ -34,6 +34,15 @@ Mesh* Mesh_create(
 // Уничтожить сетку:
 void Mesh_destroy(Mesh **mesh);
 
+// Заменить вершины и индексы сетки (буферы и атрибуты остаются теми же):
+void Mesh_update(
+    Mesh *self,
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    uint32_t index_count
+);
+
 // Получить айди буфера вершин и индексов (x=vbo, y=ebo):
 Vec2i Mesh_get_buffers_ids(Mesh *self);
 
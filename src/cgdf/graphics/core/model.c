@@ -9,6 +9,7 @@
 #include <cgdf/core/math.h>
 #include <cgdf/core/array.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/hotreload.h>
 #include "renderer.h"
 #include "mesh.h"
 #include "model.h"
@@ -34,6 +35,7 @@ Model* Model_create(Renderer *renderer) {
 // Уничтожить модель:
 void Model_destroy(Model **model) {
     if (!model || !*model) return;
+    HotReload_unwatch(*model);
 
     // Удаляем сетки модели:
     for (size_t i = 0; i < Array_len((*model)->meshes); i++) {
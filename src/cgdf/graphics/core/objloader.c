@@ -4,6 +4,11 @@
 // Поддерживает загрузку PBR материалов с текстурами.
 // Поддерживает deduplicating вершин.
 //
+// Загрузка идёт в два шага: разбор геометрии в память (без OpenGL, можно в любом потоке) и создание
+// материалов, сеток и моделей. Горячая перезагрузка разбирает изменённый файл в фоне и обновляет
+// буферы сеток тех же моделей. Разобранная геометрия сохраняется в кэш ассетов (assetcache.h), и
+// пока OBJ-файл не изменился, следующие загрузки берут готовые вершины и индексы оттуда.
+//
 
 
 // Подключаем:
@@ -14,6 +19,8 @@
 #include <cgdf/core/hashtable.h>
 #include <cgdf/core/files.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/hotreload.h>
+#include <cgdf/core/assetcache.h>
 #include "material.h"
 #include "mesh.h"
 #include "model.h"
@@ -29,6 +36,24 @@ typedef struct {
     int p, t, n;  // p - индекс позиции, t - индекс текстурных координат, n - индекс нормали.
 } ObjIndex;
 
+// Сетка в памяти (до создания буферов):
+typedef struct {
+    Array *vertices;  // Вершины (Vertex).
+    Array *indices;   // Индексы (uint32_t).
+    char *material;   // Имя материала (NULL - материал по умолчанию).
+} ObjMeshData;
+
+// Модель в памяти:
+typedef struct {
+    Array *meshes;  // Сетки (ObjMeshData).
+} ObjModelData;
+
+// Разобранный OBJ-файл:
+typedef struct {
+    Array *models;   // Модели (ObjModelData).
+    Array *mtllibs;  // Пути к MTL-файлам (char*).
+} ObjGeometry;
+
 
 // -------- Вспомогательные функции: --------
 
@@ -47,6 +72,19 @@ static void trim_end(char *s) {
     }
 }
 
+// Прочитать следующую строку из отображённого файла в line (слишком длинная строка обрезается):
+static bool read_line(const char **cursor, const char *end, char *line, size_t size) {
+    const char *s = *cursor;
+    if (s >= end) return false;
+    const char *eol = memchr(s, '\n', (size_t)(end - s));
+    size_t len = (size_t)((eol ? eol : end) - s);
+    size_t copy = len < size - 1 ? len : size - 1;
+    memcpy(line, s, copy);
+    line[copy] = '\0';
+    *cursor = eol ? eol + 1 : end;
+    return true;
+}
+
 // Конвертируем индекс из obj файла в индекс массива:
 static int convert_obj_index(int index, Array *arr) {
     int len = (int)Array_len(arr);
@@ -93,31 +131,32 @@ static bool make_vertex(ObjIndex idx, Array *positions, Array *normals, Array *t
     return true;
 }
 
-// Закончить текущий меш и добавить в модель:
-static void flush_mesh(Model *model, Array *vertices, Array *indices, Material *material, HashTable *vertex_cache) {
-    if (!model || Array_len(vertices) == 0 || Array_len(indices) == 0) return;
-
-    Mesh *mesh = Mesh_create(
-        vertices->data, (uint32_t)Array_len(vertices),
-        indices->data, (uint32_t)Array_len(indices), 
-        false, material
-    );
-    Model_add_mesh(model, mesh);
-    Array_clear(vertices, false);
-    Array_clear(indices, false);
+// Закончить текущую сетку и добавить в модель (массивы вершин и индексов переходят в сетку):
+static void flush_mesh(
+    ObjModelData *model, Array **vertices, Array **indices, const char *material, HashTable *vertex_cache
+) {
+    if (!model || Array_len(*vertices) == 0 || Array_len(*indices) == 0) return;
+
+    ObjMeshData mesh = {
+        .vertices = *vertices,
+        .indices = *indices,
+        .material = material ? mm_strdup(material) : NULL
+    };
+    Array_push(model->meshes, &mesh);
+    *vertices = Array_create(sizeof(Vertex), ARRAY_DEFAULT_CAPACITY);
+    *indices = Array_create(sizeof(uint32_t), ARRAY_DEFAULT_CAPACITY);
     HashTable_clear(vertex_cache, false);
 }
 
-// Закончить текущую модель и добавить в массив моделей:
-static void flush_model(OBJFile *objfile, Model **model) {
-    if (!objfile || !model || !*model) return;
-    // Если сеток в модели больше нуля (хотя бы одна) то добавляем в модели, иначе удаляем:
-    if (Array_len((*model)->meshes) > 0) {
-        Array_push(objfile->models, model);
+// Закончить текущую модель и добавить в геометрию (модель без сеток пропускается):
+static void flush_model(ObjGeometry *geometry, ObjModelData *model) {
+    if (!geometry || !model) return;
+    if (Array_len(model->meshes) > 0) {
+        Array_push(geometry->models, model);
     } else {
-        Model_destroy(model);
+        Array_destroy(&model->meshes);
     }
-    *model = NULL;
+    model->meshes = Array_create(sizeof(ObjMeshData), MODEL_DEFAULT_MESHES_COUNT);
 }
 
 // Хэш-функция для ObjIndex:
@@ -168,20 +207,50 @@ static Material* find_material(Array *materials, const char *name) {
     return NULL;
 }
 
-// Загрузить текстуру из MTL-файла:
-static Texture* load_texture(Renderer *renderer, const char *mtl_dir, const char *raw_path) {
-    char *path = Files_path_join(mtl_dir, raw_path);
-    if (!path) return NULL;
-
-    Texture *texture = Texture_create(renderer);
-    Texture_load(texture, path, true);
-    if (!texture || texture->id == 0) {
-        Texture_destroy(&texture);
-        log_msg("[W] ObjLoader_load: texture not loaded: %s\n", path);
+// Текстура материала, ожидающая декодирования:
+typedef struct PendingTexture {
+    Texture **slot;  // Куда положить текстуру.
+    bool *owns;      // Флаг владения текстурой в материале.
+    char *path;      // Полный путь к файлу.
+} PendingTexture;
+
+// Поставить текстуру из MTL-файла в очередь (загружает только если текстура не указана):
+static bool queue_texture(Array *pending, const char *mtl_dir, const char *raw_path, Texture **slot, bool *owns) {
+    if (!raw_path || *slot) return false;
+    for (size_t i = 0; i < Array_len(pending); i++) {
+        if (((PendingTexture*)Array_get(pending, i))->slot == slot) return false;
     }
+    PendingTexture item = { slot, owns, Files_path_join(mtl_dir, raw_path) };
+    if (!item.path) return false;
+    Array_push(pending, &item);
+    return true;
+}
 
-    mm_free(path);
-    return texture;
+// Загрузить текстуры из очереди (картинки декодируются параллельно, текстуры создаются в этом потоке):
+static void load_textures(Renderer *renderer, Array *pending) {
+    size_t count = Array_len(pending);
+    if (count == 0) return;
+    PixmapLoadRequest *requests = (PixmapLoadRequest*)mm_calloc(count, sizeof(PixmapLoadRequest));
+    for (size_t i = 0; i < count; i++) {
+        requests[i].path = ((PendingTexture*)Array_get(pending, i))->path;
+        requests[i].channels = PIXMAP_RGBA;
+    }
+    Pixmap_load_many(requests, count, 0, NULL, NULL);
+
+    for (size_t i = 0; i < count; i++) {
+        PendingTexture *item = (PendingTexture*)Array_get(pending, i);
+        Texture *texture = Texture_create(renderer);
+        Texture_load_decoded(texture, item->path, requests[i].pixmap, true);
+        if (!texture || texture->id == 0) {
+            Texture_destroy(&texture);
+            log_msg("[W] ObjLoader_load: texture not loaded: %s\n", item->path);
+        }
+        *item->slot = texture;
+        *item->owns = texture != NULL;
+        Pixmap_destroy(&requests[i].pixmap);
+        mm_free(item->path);
+    }
+    mm_free(requests);
 }
 
 // Парсить путь к текстуре:
@@ -205,19 +274,22 @@ static char* parse_texture_path(char *args) {
 
 // Парсить MTL-файл:
 static void parse_mtl_file(Renderer *renderer, const char *filepath, Array *materials) {
-    FILE *f = fopen(filepath, "r");
-    if (!f) {
+    FileMap file = Files_map(filepath, FILE_MAP_SEQUENTIAL);
+    if (!file.data) {
         log_msg("[W] ObjLoader_load: MTL file not found: %s\n", filepath);
         return;
     }
+    const char *cursor = (const char*)file.data;
+    const char *end = cursor + file.size;
 
     // Получаем папку MTL-файла:
     char *mtl_dir = Files_dirname_dup(filepath);
     char line[2048];
     Material *mat = NULL;  // Текущий материал.
+    Array *pending = Array_create(sizeof(PendingTexture), 0);  // Текстуры декодируются пачкой после разбора.
 
     // Читаем файл построчно:
-    while (fgets(line, sizeof(line), f)) {
+    while (read_line(&cursor, end, line, sizeof(line))) {
         char *comment = strchr(line, '#');
         if (comment) *comment = '\0';
 
@@ -297,11 +369,7 @@ static void parse_mtl_file(Renderer *renderer, const char *filepath, Array *mate
         // Текстура альбедо:
         else if (mat && strncmp(s, "map_Kd", 6) == 0 && (s[6] == ' ' || s[6] == '\t')) {
             char *path = parse_texture_path(skip_ws(s + 6));
-            // Загружает только если текстура не указана:
-            if (path && !mat->albedo_map) {
-                mat->albedo_map = load_texture(renderer, mtl_dir, path);
-                mat->owns_albedo_map = mat->albedo_map != NULL;
-            }
+            queue_texture(pending, mtl_dir, path, &mat->albedo_map, &mat->owns_albedo_map);
         }
 
         // Карта прозрачности (влияет на альфа-канал):
@@ -318,21 +386,14 @@ static void parse_mtl_file(Renderer *renderer, const char *filepath, Array *mate
                 || strncmp(s, "bump", 4) == 0 || strncmp(s, "norm", 4) == 0)) {
             char *args = s + (s[0] == 'b' ? 4 : (s[4] == '_' ? 8 : 4));
             char *path = parse_texture_path(skip_ws(args));
-            // Загружает только если текстура не указана:
-            if (path && !mat->normal_map) {
-                mat->normal_map = load_texture(renderer, mtl_dir, path);
-                mat->owns_normal_map = mat->normal_map != NULL;
-            }
+            queue_texture(pending, mtl_dir, path, &mat->normal_map, &mat->owns_normal_map);
         }
 
         // Текстура свечения:
         else if (mat && strncmp(s, "map_Ke", 6) == 0 && (s[6] == ' ' || s[6] == '\t')) {
             char *path = parse_texture_path(skip_ws(s + 6));
-            // Загружает только если текстура не указана:
-            if (path && !mat->emissive_map) {
-                mat->emissive_map = load_texture(renderer, mtl_dir, path);
-                mat->owns_emissive_map = mat->emissive_map != NULL;
-                if (mat->emissive_map && mat->emissive_strength == 0.0f) mat->emissive_strength = 1.0f;
+            if (queue_texture(pending, mtl_dir, path, &mat->emissive_map, &mat->owns_emissive_map)) {
+                if (mat->emissive_strength == 0.0f) mat->emissive_strength = 1.0f;
             }
         }
 
@@ -340,72 +401,232 @@ static void parse_mtl_file(Renderer *renderer, const char *filepath, Array *mate
         else if (mat && (strncmp(s, "disp", 4) == 0 || strncmp(s, "map_disp", 8) == 0)) {
             char *args = s + (s[0] == 'd' ? 4 : 8);
             char *path = parse_texture_path(skip_ws(args));
-            // Загружает только если текстура не указана:
-            if (path && !mat->height_map) {
-                mat->height_map = load_texture(renderer, mtl_dir, path);
-                mat->owns_height_map = mat->height_map != NULL;
-            }
+            queue_texture(pending, mtl_dir, path, &mat->height_map, &mat->owns_height_map);
         }
 
         // PBR: Карта окклюзии (Ambient Occlusion):
         else if (mat && (strncmp(s, "map_Ao", 6) == 0 || strncmp(s, "map_ao", 6) == 0) && (s[6] == ' ' || s[6] == '\t')) {
             char *path = parse_texture_path(skip_ws(s + 6));
-            // Загружает только если текстура не указана:
-            if (path && !mat->occlusion_map) {
-                mat->occlusion_map = load_texture(renderer, mtl_dir, path);
-                mat->owns_occlusion_map = mat->occlusion_map != NULL;
-            }
+            queue_texture(pending, mtl_dir, path, &mat->occlusion_map, &mat->owns_occlusion_map);
         }
 
         // PBR: Карта шероховатости (Roughness):
         else if (mat && strncmp(s, "map_Pr", 6) == 0 && (s[6] == ' ' || s[6] == '\t')) {
             char *path = parse_texture_path(skip_ws(s + 6));
-            // Загружает только если текстура не указана:
-            if (path && !mat->roughness_map) {
-                mat->roughness_map = load_texture(renderer, mtl_dir, path);
-                mat->owns_roughness_map = mat->roughness_map != NULL;
-            }
+            queue_texture(pending, mtl_dir, path, &mat->roughness_map, &mat->owns_roughness_map);
         }
 
         // PBR: Карта металличности (Metallic):
         else if (mat && strncmp(s, "map_Pm", 6) == 0 && (s[6] == ' ' || s[6] == '\t')) {
             char *path = parse_texture_path(skip_ws(s + 6));
-            // Загружает только если текстура не указана:
-            if (path && !mat->metallic_map) {
-                mat->metallic_map = load_texture(renderer, mtl_dir, path);
-                mat->owns_metallic_map = mat->metallic_map != NULL;
-            }
+            queue_texture(pending, mtl_dir, path, &mat->metallic_map, &mat->owns_metallic_map);
         }
     }
 
+    load_textures(renderer, pending);
+    Array_destroy(&pending);
     mm_free(mtl_dir);
-    fclose(f);
+    Files_unmap(&file);
 }
 
 
-// -------- API загрузчика: --------
+// -------- Разбор геометрии и создание моделей: --------
 
 
-// Загрузить модели из OBJ-файла с материалами:
-OBJFile ObjLoader_load(Renderer *renderer, const char *filepath) {
-    if (!renderer || !filepath) return (OBJFile){ 0 };
+// Освободить разобранный OBJ-файл:
+static void free_geometry(ObjGeometry **geometry) {
+    if (!geometry || !*geometry) return;
+    for (size_t i = 0; i < Array_len((*geometry)->models); i++) {
+        ObjModelData *model = (ObjModelData*)Array_get((*geometry)->models, i);
+        for (size_t j = 0; j < Array_len(model->meshes); j++) {
+            ObjMeshData *mesh = (ObjMeshData*)Array_get(model->meshes, j);
+            Array_destroy(&mesh->vertices);
+            Array_destroy(&mesh->indices);
+            if (mesh->material) mm_free(mesh->material);
+        }
+        Array_destroy(&model->meshes);
+    }
+    for (size_t i = 0; i < Array_len((*geometry)->mtllibs); i++) mm_free(Array_get_ptr((*geometry)->mtllibs, i));
+    Array_destroy(&(*geometry)->models);
+    Array_destroy(&(*geometry)->mtllibs);
+    mm_free(*geometry);
+    *geometry = NULL;
+}
 
-    // Создаём структуру:
-    OBJFile objfile = {
-        .models = Array_create(sizeof(void*), ARRAY_DEFAULT_CAPACITY),
-        .materials = Array_create(sizeof(void*), ARRAY_DEFAULT_CAPACITY)
-    };
+// Создать пустую геометрию:
+static ObjGeometry* create_geometry(void) {
+    ObjGeometry *geometry = (ObjGeometry*)mm_alloc(sizeof(ObjGeometry));
+    geometry->models = Array_create(sizeof(ObjModelData), ARRAY_DEFAULT_CAPACITY);
+    geometry->mtllibs = Array_create(sizeof(char*), ARRAY_DEFAULT_CAPACITY);
+    return geometry;
+}
 
-    // Открываем файл:
-    FILE *f = fopen(filepath, "r");
-    if (!f) {
-        Array_destroy(&objfile.models);
-        Array_destroy(&objfile.materials);
-        return (OBJFile){ 0 };
+// Прочитать из подготовленных данных кусок size байт (NULL если данные кончились):
+static const unsigned char* cooked_take(const unsigned char **cursor, const unsigned char *end, size_t size) {
+    if ((size_t)(end - *cursor) < size) return NULL;
+    const unsigned char *data = *cursor;
+    *cursor += size;
+    return data;
+}
+
+// Прочитать из подготовленных данных строку (длина uint32_t и байты, UINT32_MAX - NULL):
+static bool cooked_take_string(const unsigned char **cursor, const unsigned char *end, char **out) {
+    uint32_t length;
+    const unsigned char *data = cooked_take(cursor, end, sizeof(length));
+    if (!data) return false;
+    memcpy(&length, data, sizeof(length));
+    *out = NULL;
+    if (length == UINT32_MAX) return true;
+    if (!(data = cooked_take(cursor, end, length))) return false;
+    *out = (char*)mm_alloc(length + 1);
+    memcpy(*out, data, length);
+    (*out)[length] = '\0';
+    return true;
+}
+
+// Записать в таблицу подготовленных данных uint32_t (cursor = NULL - только посчитать размер):
+static size_t cooked_put_u32(unsigned char **cursor, uint32_t value) {
+    if (cursor) { memcpy(*cursor, &value, sizeof(value)); *cursor += sizeof(value); }
+    return sizeof(value);
+}
+
+// Записать в таблицу подготовленных данных строку (cursor = NULL - только посчитать размер):
+static size_t cooked_put_string(unsigned char **cursor, const char *string) {
+    uint32_t length = string ? (uint32_t)strlen(string) : UINT32_MAX;
+    size_t size = cooked_put_u32(cursor, length);
+    if (!string) return size;
+    if (cursor) { memcpy(*cursor, string, length); *cursor += length; }
+    return size + length;
+}
+
+// Записать таблицу подготовленной геометрии (количества, пути MTL, имена материалов и размеры сеток):
+static size_t cooked_put_table(unsigned char **cursor, ObjGeometry *geometry) {
+    size_t size = cooked_put_u32(cursor, (uint32_t)Array_len(geometry->models));
+    size += cooked_put_u32(cursor, (uint32_t)Array_len(geometry->mtllibs));
+    for (size_t i = 0; i < Array_len(geometry->mtllibs); i++) {
+        size += cooked_put_string(cursor, (const char*)Array_get_ptr(geometry->mtllibs, i));
+    }
+    for (size_t i = 0; i < Array_len(geometry->models); i++) {
+        ObjModelData *model = (ObjModelData*)Array_get(geometry->models, i);
+        size += cooked_put_u32(cursor, (uint32_t)Array_len(model->meshes));
+        for (size_t j = 0; j < Array_len(model->meshes); j++) {
+            ObjMeshData *mesh = (ObjMeshData*)Array_get(model->meshes, j);
+            size += cooked_put_u32(cursor, (uint32_t)Array_len(mesh->vertices));
+            size += cooked_put_u32(cursor, (uint32_t)Array_len(mesh->indices));
+            size += cooked_put_string(cursor, mesh->material);
+        }
     }
+    return size;
+}
 
-    // Создаём временные массивы:
+// Сохранить разобранную геометрию в кэш ассетов (таблица, затем вершины и индексы сеток без копий):
+static void store_cooked_geometry(ObjGeometry *geometry, uint64_t key) {
+    size_t table_size = cooked_put_table(NULL, geometry);
+    unsigned char *table = (unsigned char*)mm_alloc(table_size);
+    unsigned char *cursor = table;
+    cooked_put_table(&cursor, geometry);
+
+    Array *parts = Array_create(sizeof(CookedPart), ARRAY_DEFAULT_CAPACITY);
+    Array_push(parts, &(CookedPart){ table, table_size });
+    for (size_t i = 0; i < Array_len(geometry->models); i++) {
+        ObjModelData *model = (ObjModelData*)Array_get(geometry->models, i);
+        for (size_t j = 0; j < Array_len(model->meshes); j++) {
+            ObjMeshData *mesh = (ObjMeshData*)Array_get(model->meshes, j);
+            Array_push(parts, &(CookedPart){ mesh->vertices->data, Array_len(mesh->vertices) * sizeof(Vertex) });
+            Array_push(parts, &(CookedPart){ mesh->indices->data, Array_len(mesh->indices) * sizeof(uint32_t) });
+        }
+    }
+    AssetCache_store("obj", key, (const CookedPart*)parts->data, Array_len(parts));
+    Array_destroy(&parts);
+    mm_free(table);
+}
+
+// Прочитать подготовленную геометрию (таблица, затем вершины и индексы сеток в том же порядке):
+static bool read_cooked_geometry(ObjGeometry *geometry, const unsigned char *cursor, const unsigned char *end) {
+    uint32_t counts[2];  // Количество моделей и MTL-файлов.
+    const unsigned char *data = cooked_take(&cursor, end, sizeof(counts));
+    if (!data) return false;
+    memcpy(counts, data, sizeof(counts));
+    for (uint32_t i = 0; i < counts[1]; i++) {
+        char *mtl_path;
+        if (!cooked_take_string(&cursor, end, &mtl_path) || !mtl_path) return false;
+        Array_push(geometry->mtllibs, &mtl_path);
+    }
+
+    // Модели и сетки (массивы сразу нужного размера, данные копируются ниже):
+    for (uint32_t i = 0; i < counts[0]; i++) {
+        uint32_t mesh_count;
+        if (!(data = cooked_take(&cursor, end, sizeof(mesh_count)))) return false;
+        memcpy(&mesh_count, data, sizeof(mesh_count));
+        ObjModelData model = { .meshes = Array_create(sizeof(ObjMeshData), mesh_count > 0 ? mesh_count : 1) };
+        Array_push(geometry->models, &model);
+        for (uint32_t j = 0; j < mesh_count; j++) {
+            uint32_t sizes[2];  // Количество вершин и индексов.
+            char *material;
+            if (!(data = cooked_take(&cursor, end, sizeof(sizes)))) return false;
+            memcpy(sizes, data, sizeof(sizes));
+            if (!cooked_take_string(&cursor, end, &material)) return false;
+            ObjMeshData mesh = {
+                .vertices = Array_create(sizeof(Vertex), sizes[0] > 0 ? sizes[0] : 1),
+                .indices = Array_create(sizeof(uint32_t), sizes[1] > 0 ? sizes[1] : 1),
+                .material = material,
+            };
+            mesh.vertices->len = sizes[0];
+            mesh.indices->len = sizes[1];
+            Array_push(model.meshes, &mesh);
+        }
+    }
+
+    // Вершины и индексы:
+    for (size_t i = 0; i < Array_len(geometry->models); i++) {
+        ObjModelData *model = (ObjModelData*)Array_get(geometry->models, i);
+        for (size_t j = 0; j < Array_len(model->meshes); j++) {
+            ObjMeshData *mesh = (ObjMeshData*)Array_get(model->meshes, j);
+            size_t vertices_size = Array_len(mesh->vertices) * sizeof(Vertex);
+            size_t indices_size = Array_len(mesh->indices) * sizeof(uint32_t);
+            if (!(data = cooked_take(&cursor, end, vertices_size))) return false;
+            memcpy(mesh->vertices->data, data, vertices_size);
+            if (!(data = cooked_take(&cursor, end, indices_size))) return false;
+            memcpy(mesh->indices->data, data, indices_size);
+        }
+    }
+    return cursor == end;
+}
+
+// Взять разобранную геометрию из кэша ассетов (NULL если её там нет):
+static ObjGeometry* load_cooked_geometry(uint64_t key) {
+    CookedAsset cooked;
+    if (!AssetCache_load("obj", key, &cooked)) return NULL;
+    ObjGeometry *geometry = create_geometry();
+    if (!read_cooked_geometry(geometry, cooked.data, cooked.data + cooked.size)) free_geometry(&geometry);
+    AssetCache_release(&cooked);
+    return geometry;
+}
+
+// Разобрать геометрию OBJ-файла в память (без OpenGL, можно вызывать из любого потока):
+static ObjGeometry* parse_geometry(const char *filepath) {
+    // Отображаем файл в память (читаем последовательно, без копии всего файла в куче):
+    FileMap file = Files_map(filepath, FILE_MAP_SEQUENTIAL);
+    if (!file.data) return NULL;
     char *obj_dir = Files_dirname_dup(filepath);
+
+    // Геометрия уже разобрана в кэше ассетов (ключ - байты файла и папка, от неё зависят пути MTL):
+    bool cache = AssetCache_is_enabled();
+    uint64_t key = 0;
+    if (cache) {
+        key = AssetCache_key("obj", file.data, file.size, obj_dir, strlen(obj_dir));
+        ObjGeometry *cooked = load_cooked_geometry(key);
+        if (cooked) {
+            mm_free(obj_dir);
+            Files_unmap(&file);
+            return cooked;
+        }
+    }
+
+    // Создаём структуру:
+    ObjGeometry *geometry = create_geometry();
+
+    // Создаём временные массивы:
     Array *positions = Array_create(sizeof(Vec3d), ARRAY_DEFAULT_CAPACITY);
     Array *normals = Array_create(sizeof(Vec3d), ARRAY_DEFAULT_CAPACITY);
     Array *texcoords = Array_create(sizeof(Vec2d), ARRAY_DEFAULT_CAPACITY);
@@ -415,14 +636,14 @@ OBJFile ObjLoader_load(Renderer *renderer, const char *filepath) {
     vertex_cache->hash_func = hash_obj_index;      // Устанавливаем свою функцию хэширования.
 
     // Временные переменные для парсинга:
-    Material *default_mat = Material_create_default(NULL);
-    Array_push(objfile.materials, &default_mat);
-    Material *current_mat = default_mat;
-    Model *current_model = Model_create(renderer);
+    char *current_mat = NULL;  // Имя текущего материала (NULL - материал по умолчанию).
+    ObjModelData current_model = { .meshes = Array_create(sizeof(ObjMeshData), MODEL_DEFAULT_MESHES_COUNT) };
 
     // Парсим файл:
+    const char *cursor = (const char*)file.data;
+    const char *end = cursor + file.size;
     char line[2048];  // Ограничение строки файла в 2048 символов.
-    while (fgets(line, sizeof(line), f)) {
+    while (read_line(&cursor, end, line, sizeof(line))) {
         // Чистим строку:
         char *comment = strchr(line, '#');
         if (comment) *comment = '\0';
@@ -430,7 +651,7 @@ OBJFile ObjLoader_load(Renderer *renderer, const char *filepath) {
         trim_end(s);
         if (!*s) continue;
 
-        // Загружаем материалы:
+        // Запоминаем файлы материалов (загружаются при создании моделей):
         if (strncmp(s, "mtllib", 6) == 0 && (s[6] == ' ' || s[6] == '\t')) {
             char *libs = skip_ws(s + 6);
             // Проходимся по всем перечисленным файлам материалов:
@@ -440,12 +661,11 @@ OBJFile ObjLoader_load(Renderer *renderer, const char *filepath) {
                 char *end = start;
                 while (*end && *end != ' ' && *end != '\t' && *end != '\r' && *end != '\n') end++;
 
-                // Загружаем материалы из файла:
+                // Добавляем путь к файлу:
                 char old = *end;
                 *end = '\0';
                 char *mtl_path = Files_path_join(obj_dir, start);
-                parse_mtl_file(renderer, mtl_path, objfile.materials);
-                mm_free(mtl_path);
+                if (mtl_path) Array_push(geometry->mtllibs, &mtl_path);
 
                 if (!old) break;
                 *end = old;
@@ -455,21 +675,15 @@ OBJFile ObjLoader_load(Renderer *renderer, const char *filepath) {
 
         // Начинаем новую модель:
         else if ((s[0] == 'o' || s[0] == 'g') && (s[1] == ' ' || s[1] == '\t')) {
-            flush_mesh(current_model, vertices, indices, current_mat, vertex_cache);
-            flush_model(&objfile, &current_model);
-            current_model = Model_create(renderer);
+            flush_mesh(&current_model, &vertices, &indices, current_mat, vertex_cache);
+            flush_model(geometry, &current_model);
         }
 
-        // Если используем другой материал, то ищем или создаём новый материал и начинаем новый меш:
+        // Если используем другой материал, то начинаем новую сетку:
         else if (strncmp(s, "usemtl", 6) == 0 && (s[6] == ' ' || s[6] == '\t')) {
-            flush_mesh(current_model, vertices, indices, current_mat, vertex_cache);
-            char *name = skip_ws(s + 6);
-            Material *mat = find_material(objfile.materials, name);
-            if (!mat) {
-                mat = Material_create_default(name);
-                Array_push(objfile.materials, &mat);
-            }
-            current_mat = mat;
+            flush_mesh(&current_model, &vertices, &indices, current_mat, vertex_cache);
+            if (current_mat) mm_free(current_mat);
+            current_mat = mm_strdup(skip_ws(s + 6));
         }
 
         // Сохраняем позиции, нормали и текстурные координаты:
@@ -508,11 +722,13 @@ OBJFile ObjLoader_load(Renderer *renderer, const char *filepath) {
         }
     }
 
-    // Закрываем последний меш и модель:
-    flush_mesh(current_model, vertices, indices, current_mat, vertex_cache);
-    flush_model(&objfile, &current_model);
+    // Закрываем последнюю сетку и модель:
+    flush_mesh(&current_model, &vertices, &indices, current_mat, vertex_cache);
+    flush_model(geometry, &current_model);
 
     // Освобождаем временные массивы и закрываем файл:
+    Array_destroy(&current_model.meshes);
+    if (current_mat) mm_free(current_mat);
     Array_destroy(&positions);
     Array_destroy(&normals);
     Array_destroy(&texcoords);
@@ -520,7 +736,123 @@ OBJFile ObjLoader_load(Renderer *renderer, const char *filepath) {
     Array_destroy(&indices);
     HashTable_destroy(&vertex_cache);
     mm_free(obj_dir);
-    fclose(f);
+    Files_unmap(&file);
+    if (cache) store_cooked_geometry(geometry, key);
+    return geometry;
+}
+
+// Создать сетки модели (materials - где искать материал по имени, fallback - если не нашли):
+static void build_meshes(Model *model, ObjModelData *data, Array *materials, Material *fallback) {
+    for (size_t i = 0; i < Array_len(data->meshes); i++) {
+        ObjMeshData *mesh_data = (ObjMeshData*)Array_get(data->meshes, i);
+        Material *material = mesh_data->material ? find_material(materials, mesh_data->material) : fallback;
+        Mesh *mesh = Mesh_create(
+            mesh_data->vertices->data, (uint32_t)Array_len(mesh_data->vertices),
+            mesh_data->indices->data, (uint32_t)Array_len(mesh_data->indices),
+            false, material ? material : fallback
+        );
+        Model_add_mesh(model, mesh);
+    }
+}
+
+// Горячая перезагрузка: разобрать OBJ-файл (фоновый поток):
+static void* import_geometry(const char *path) {
+    return parse_geometry(path);
+}
+
+// Горячая перезагрузка: обновить сетки модели номер index:
+static bool apply_geometry(void *target, void *data, intptr_t index) {
+    Model *model = (Model*)target;
+    ObjGeometry *geometry = (ObjGeometry*)data;
+    ObjModelData *model_data = (ObjModelData*)Array_get(geometry->models, (size_t)index);
+    if (!model_data) {
+        log_msg("[W] ObjLoader: Model #%d is gone from the reloaded file, keeping the old one.\n", (int)index);
+        return false;
+    }
+
+    // Та же раскладка сеток - меняем только данные в буферах:
+    size_t count = Array_len(model->meshes);
+    if (count == Array_len(model_data->meshes)) {
+        for (size_t i = 0; i < count; i++) {
+            Mesh *mesh = (Mesh*)Array_get_ptr(model->meshes, i);
+            ObjMeshData *mesh_data = (ObjMeshData*)Array_get(model_data->meshes, i);
+            Mesh_update(
+                mesh, mesh_data->vertices->data, (uint32_t)Array_len(mesh_data->vertices),
+                mesh_data->indices->data, (uint32_t)Array_len(mesh_data->indices)
+            );
+        }
+        return true;
+    }
+
+    // Иначе пересоздаём сетки со старыми материалами (новые материалы подхватятся только при загрузке):
+    Array *materials = Array_create(sizeof(Material*), count > 0 ? count : 1);
+    for (size_t i = 0; i < count; i++) {
+        Mesh *mesh = (Mesh*)Array_get_ptr(model->meshes, i);
+        Material *material = Mesh_get_material(mesh);
+        if (material && !Array_find(materials, &material)) Array_push(materials, &material);
+        Mesh_destroy(&mesh);
+    }
+    Array_clear(model->meshes, false);
+    build_meshes(model, model_data, materials, (Material*)Array_get_ptr(materials, 0));
+    Array_destroy(&materials);
+    return true;
+}
+
+// Горячая перезагрузка: освободить разобранный файл:
+static void release_geometry(void *data) {
+    ObjGeometry *geometry = (ObjGeometry*)data;
+    free_geometry(&geometry);
+}
+
+// Обработчик горячей перезагрузки моделей:
+static const HotReloadHandler g_ObjReload = {
+    .name = "obj", .import = import_geometry, .apply = apply_geometry, .release = release_geometry,
+};
+
+
+// -------- API загрузчика: --------
+
+
+// Загрузить модели из OBJ-файла с материалами. Следит за файлом, если запущен HotReload:
+OBJFile ObjLoader_load(Renderer *renderer, const char *filepath) {
+    if (!renderer || !filepath) return (OBJFile){ 0 };
+
+    // Разбираем геометрию:
+    ObjGeometry *geometry = parse_geometry(filepath);
+    if (!geometry) return (OBJFile){ 0 };
+
+    // Создаём структуру:
+    OBJFile objfile = {
+        .models = Array_create(sizeof(void*), ARRAY_DEFAULT_CAPACITY),
+        .materials = Array_create(sizeof(void*), ARRAY_DEFAULT_CAPACITY)
+    };
+
+    // Загружаем материалы:
+    Material *default_mat = Material_create_default(NULL);
+    Array_push(objfile.materials, &default_mat);
+    for (size_t i = 0; i < Array_len(geometry->mtllibs); i++) {
+        parse_mtl_file(renderer, (const char*)Array_get_ptr(geometry->mtllibs, i), objfile.materials);
+    }
+
+    // Материалы, которых нет в MTL-файлах, создаём по умолчанию:
+    for (size_t i = 0; i < Array_len(geometry->models); i++) {
+        ObjModelData *model_data = (ObjModelData*)Array_get(geometry->models, i);
+        for (size_t j = 0; j < Array_len(model_data->meshes); j++) {
+            const char *name = ((ObjMeshData*)Array_get(model_data->meshes, j))->material;
+            if (!name || find_material(objfile.materials, name)) continue;
+            Material *mat = Material_create_default(name);
+            Array_push(objfile.materials, &mat);
+        }
+    }
+
+    // Создаём модели и следим за файлом:
+    for (size_t i = 0; i < Array_len(geometry->models); i++) {
+        Model *model = Model_create(renderer);
+        build_meshes(model, (ObjModelData*)Array_get(geometry->models, i), objfile.materials, default_mat);
+        Array_push(objfile.models, &model);
+        HotReload_watch(filepath, &g_ObjReload, model, (intptr_t)i);
+    }
 
+    free_geometry(&geometry);
     return objfile;
 }
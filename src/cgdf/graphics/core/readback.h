@@ -0,0 +1,103 @@
+//
+// readback.h - Асинхронное чтение текстур и кадра из видеокарты, сохранение и запись кадров в файлы.
+//
+// Texture_get_pixmap читает текстуру через glGetTexImage: главный поток ждёт, пока видеокарта дорисует всё,
+// что было до чтения, а Pixmap_save кодирует PNG в том же потоке. Здесь чтение пишется в буфер упаковки
+// (PBO) и закрывается fence, а картинка отдаётся через кадр-два, когда видеокарта прошла fence, и главный
+// поток не ждёт. Сохранение в файл кодируется в потоке JobSystem. Если буфер отображён постоянно
+// (GL_ARB_buffer_storage), то и копию из буфера в картинку делает поток, а не главный.
+//
+// Кадр окна читается в Readback_present (его вызывает Window_display перед сменой буферов), поэтому запросы
+// кадра можно делать в любом месте кадра. Картинки кадра - RGB, строки сверху вниз, как в файлах.
+//
+// Запись кадров (Readback_capture_start) сохраняет N кадров подряд. Если кодировщики не успевают
+// (READBACK_MAX_ENCODES в очереди) или все буферы заняты, кадр пропускается, а запись продолжается
+// со следующего, поэтому номера файлов идут подряд.
+//
+// Счётчики кадра: readback.bytes, readback.count, readback.skipped, readback.encodes (см. counters.h).
+//
+// define CGDF_READBACK_NO_PERSISTENT - Не использовать постоянное отображение: данные копируются из буфера
+//                                      в главном потоке через glMapBufferRange.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <cgdf/core/std.h>
+#include <cgdf/core/pixmap.h>
+#include "texture.h"
+
+
+// Определения:
+#define READBACK_MAX_PENDING  8  // Сколько чтений может быть в полёте (буферов упаковки).
+#define READBACK_MAX_ENCODES  4  // Сколько картинок может ждать кодирования в потоках.
+#define READBACK_PATH_SIZE    512
+
+
+// Обработчик прочитанной картинки (главный поток, pixmap = NULL при ошибке). Картинку уничтожает обработчик:
+typedef void (*ReadbackCallback)(Pixmap *pixmap, void *arg);
+
+
+// Объявление структур:
+typedef struct Renderer Renderer;
+typedef struct Readback Readback;            // Асинхронное чтение из видеокарты.
+typedef struct ReadbackStats ReadbackStats;  // Статистика чтения.
+
+
+// Статистика чтения:
+struct ReadbackStats {
+    size_t requests;       // Сколько чтений поставлено.
+    size_t delivered;      // Сколько картинок отдано обработчикам.
+    size_t saved;          // Сколько файлов сохранено.
+    size_t save_failures;  // Сколько файлов не удалось сохранить.
+    size_t skipped;        // Сколько кадров записи пропущено (кодировщики или буферы заняты).
+    size_t total_bytes;    // Байт прочитано за всё время.
+    int last_latency;      // Через сколько кадров пришло последнее чтение.
+};
+
+
+// -------- API чтения из видеокарты: --------
+
+
+// Создать чтение из видеокарты. Нужен контекст OpenGL:
+Readback* Readback_create(Renderer *renderer);
+
+// Уничтожить чтение (дожидается всех чтений и сохранений):
+void Readback_destroy(Readback **readback);
+
+// Прочитать текстуру (уровень 0, channels - количество каналов картинки). false - нет свободного буфера:
+bool Readback_texture(Readback *self, Texture *texture, int channels, ReadbackCallback callback, void *arg);
+
+// Прочитать текстуру и сохранить в файл в потоке (формат по расширению, по умолчанию png):
+bool Readback_texture_save(Readback *self, Texture *texture, int channels, const char *filepath);
+
+// Прочитать кадр окна (в Readback_present этого кадра):
+bool Readback_screen(Readback *self, ReadbackCallback callback, void *arg);
+
+// Прочитать кадр окна и сохранить в файл в потоке (формат по расширению, по умолчанию png):
+bool Readback_screen_save(Readback *self, const char *filepath);
+
+// Начать запись кадров (path_format - путь с одним %d для номера кадра, например "capture/frame_%05d.png"):
+bool Readback_capture_start(Readback *self, const char *path_format, int frames);
+
+// Остановить запись кадров (уже прочитанные кадры всё равно сохранятся):
+void Readback_capture_stop(Readback *self);
+
+// Идёт ли запись кадров:
+bool Readback_is_capturing(Readback *self);
+
+// Прочитать кадр для запросов кадра и записи (перед сменой буферов, width и height - размер кадра):
+void Readback_present(Readback *self, int width, int height);
+
+// Отдать готовые картинки и сохранения (главный поток, раз в кадр):
+void Readback_update(Readback *self);
+
+// Дождаться всех чтений и сохранений (блокирует):
+void Readback_wait(Readback *self);
+
+// Получить статистику чтения:
+ReadbackStats Readback_get_stats(Readback *self);
+
+// Постоянно ли отображены буферы (иначе данные копируются в главном потоке):
+bool Readback_is_persistent(Readback *self);
@@ -12,6 +12,8 @@
 #include "mesh.h"
 #include "shader.h"
 #include "texture.h"
+#include "texupload.h"
+#include "readback.h"
 
 
 // Объявление структур:
@@ -72,6 +74,8 @@ struct Renderer {
     // Другое:
     Mesh *sprite_mesh;          // Сетка спрайта.
     Texture *fallback_texture;  // Пустая текстура как заглушка для шейдеров.
+    TexUpload *uploads;         // Кольцо асинхронной загрузки текстур (см. texupload.h).
+    Readback *readback;         // Асинхронное чтение текстур и кадра (см. readback.h).
 };
 
 
@@ -65,6 +65,7 @@ struct Shader {
     const char* vertex;
     const char* fragment;
     const char* geometry;
+    char* _sources_[3];  // Свои копии исходников (Shader_load и горячая перезагрузка).
     char* error;
     uint32_t id;
     Renderer *renderer;
@@ -84,6 +85,9 @@ struct Shader {
 // Создать шейдерную программу:
 Shader* Shader_create(Renderer *renderer, const char *vert, const char *frag, const char *geom);
 
+// Загрузить шейдерную программу из файлов (geom может быть NULL). Следит за файлами, если запущен HotReload:
+Shader* Shader_load(Renderer *renderer, const char *vert_path, const char *frag_path, const char *geom_path);
+
 // Уничтожить шейдерную программу:
 void Shader_destroy(Shader **shader);
 
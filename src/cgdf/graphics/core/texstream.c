@@ -0,0 +1,387 @@
+//
+// texstream.c - Реализация потоковой загрузки текстур (решения о загрузке и выгрузке уровней).
+//
+// У каждой текстуры загружены уровни от resident до последнего (resident = количество уровней - ничего).
+// Уровни грузятся и выгружаются по одному с точного конца, поэтому загруженное всегда идёт подряд, и
+// видеокарте достаточно сказать, с какого уровня читать. Сам менеджер видеокарту не трогает.
+//
+
+
+// Подключаем:
+#include <cgdf/core/std.h>
+#include <cgdf/core/mm.h>
+#include <cgdf/core/array.h>
+#include <cgdf/core/logger.h>
+#include <cgdf/core/counters.h>
+#include <cgdf/core/texfile.h>
+#include "texture.h"
+#include "texstream.h"
+
+
+// Определения:
+#define NO_REQUEST INT_MAX  // Текстуру в этом кадре не запрашивали.
+
+
+// Потоковая текстура:
+struct StreamTexture {
+    TexStream *stream;   // Менеджер текстуры.
+    Texture *texture;    // Текстура для отрисовки.
+    TexFile file;        // Открытый файл текстуры (уровни в отображении).
+    int tail;            // Первый уровень хвоста, который грузится сразу и не выгружается.
+    int resident;        // Самый точный загруженный уровень.
+    int wanted;          // Запрошенный уровень (последний запрос).
+    int request;         // Самый точный запрос за текущий кадр.
+    uint64_t last_used;  // Кадр последнего запроса.
+    size_t index;        // Место в массиве текстур менеджера.
+    size_t sizes[MIPMAP_MAX_LEVELS];  // Сколько видеопамяти занимает каждый загруженный уровень.
+};
+
+
+// Менеджер потоковых текстур:
+struct TexStream {
+    TexStreamBackend backend;    // Загрузка уровней в видеокарту.
+    TexStreamSettings settings;  // Настройки.
+    Array *textures;             // Текстуры (StreamTexture*).
+    Array *order;                // Временный список для сортировки (StreamTexture*).
+    Array *lru;                  // Кандидаты на выгрузку за кадр, давно не запрошенные первыми (StreamTexture*).
+    size_t lru_next;             // Первый кандидат, у которого ещё может быть что выгрузить.
+    bool lru_ready;              // Кандидаты кадра уже собраны.
+    size_t resident_bytes;       // Занято видеопамяти.
+    uint64_t frame;              // Номер кадра (TexStream_update).
+    size_t frame_uploads;        // Уровней загружено за текущий кадр.
+    size_t frame_bytes;          // Байт загружено за текущий кадр.
+    size_t frame_evictions;      // Уровней выгружено за текущий кадр.
+    TexStreamStats stats;        // Статистика (frame_* - за прошлый кадр).
+};
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Размер уровня по большей стороне:
+static inline int level_extent(const StreamTexture *texture, int level) {
+    const TexFileLevel *data = &texture->file.levels[level];
+    return data->width > data->height ? data->width : data->height;
+}
+
+// Сделать видимыми загруженные уровни:
+static void apply_levels(TexStream *self, StreamTexture *texture) {
+    int last = texture->file.count - 1;
+    self->backend.set_levels(self->backend.user, texture->texture, texture->resident < last ? texture->resident : last, last);
+}
+
+// Загрузить следующий (более точный) уровень текстуры:
+static bool upload_level(TexStream *self, StreamTexture *texture) {
+    int level = texture->resident - 1;
+    size_t size = self->backend.upload(self->backend.user, texture->texture, &texture->file, level);
+    if (size == 0) return false;  // Обработчик сейчас не может (например, кончилось место для загрузки).
+    texture->sizes[level] = size;
+    texture->resident = level;
+    apply_levels(self, texture);
+    self->resident_bytes += size;
+    self->frame_uploads++;
+    self->frame_bytes += size;
+    COUNTER_INC("texstream.uploads");
+    COUNTER_ADD("texstream.upload_bytes", size);
+    return true;
+}
+
+// Выгрузить самый точный загруженный уровень текстуры (сначала видеокарта перестаёт из него читать):
+static void evict_level(TexStream *self, StreamTexture *texture) {
+    int level = texture->resident++;
+    apply_levels(self, texture);
+    self->backend.evict(self->backend.user, texture->texture, level);
+    self->resident_bytes -= texture->sizes[level];
+    texture->sizes[level] = 0;
+    self->frame_evictions++;
+    COUNTER_INC("texstream.evictions");
+}
+
+// Сравнить текстуры для выгрузки (для qsort): сначала давно не запрошенные, затем с более точным уровнем:
+static int compare_lru(const void *a, const void *b) {
+    const StreamTexture *ta = *(const StreamTexture* const*)a, *tb = *(const StreamTexture* const*)b;
+    if (ta->last_used != tb->last_used) return ta->last_used < tb->last_used ? -1 : 1;
+    return (ta->resident > tb->resident) - (ta->resident < tb->resident);
+}
+
+// Сравнить текстуры для загрузки (для qsort): сначала у кого следующий уровень грубее, затем у кого отставание больше:
+static int compare_upload(const void *a, const void *b) {
+    const StreamTexture *ta = *(const StreamTexture* const*)a, *tb = *(const StreamTexture* const*)b;
+    int ea = level_extent(ta, ta->resident - 1), eb = level_extent(tb, tb->resident - 1);
+    if (ea != eb) return (ea > eb) - (ea < eb);
+    int ga = ta->resident - ta->wanted, gb = tb->resident - tb->wanted;
+    if (ga != gb) return (ga < gb) - (ga > gb);
+    return (ta->index > tb->index) - (ta->index < tb->index);
+}
+
+// До какого уровня можно выгружать текстуру (hard - ради бюджета, вплоть до хвоста):
+static inline int evict_limit(const TexStream *self, const StreamTexture *texture, bool hard) {
+    if (hard || texture->last_used != self->frame) return texture->tail;
+    return texture->wanted < texture->tail ? texture->wanted : texture->tail;  // Запрошенное в этом кадре не трогаем.
+}
+
+// Собрать кандидатов на выгрузку по LRU:
+static void collect_lru(TexStream *self, Array *list, bool hard) {
+    Array_clear(list, false);
+    for (size_t i = 0; i < Array_len(self->textures); i++) {
+        StreamTexture *texture = (StreamTexture*)Array_get_ptr(self->textures, i);
+        if (texture->resident < evict_limit(self, texture, hard)) Array_push(list, &texture);
+    }
+    qsort(list->data, Array_len(list), sizeof(StreamTexture*), compare_lru);
+}
+
+// Освободить место под need байт, выгружая уровни по LRU (keep - кому нужно место, её не трогаем).
+// Кандидаты собираются раз в кадр: за кадр грузятся только запрошенные текстуры, а их уровни до
+// запрошенного выгружать нельзя, поэтому новых кандидатов внутри кадра не появляется:
+static bool make_room(TexStream *self, size_t need, StreamTexture *keep, bool hard) {
+    if (self->resident_bytes + need <= self->settings.budget) return true;
+    Array *list = self->lru;
+    if (hard) {
+        list = self->order;
+        collect_lru(self, list, true);
+    } else if (!self->lru_ready) {
+        collect_lru(self, list, false);
+        self->lru_next = 0;
+        self->lru_ready = true;
+    }
+    size_t i = hard ? 0 : self->lru_next;
+    for (; i < Array_len(list); i++) {
+        StreamTexture *texture = (StreamTexture*)Array_get_ptr(list, i);
+        if (texture == keep) continue;
+        int limit = evict_limit(self, texture, hard);
+        while (texture->resident < limit && self->resident_bytes + need > self->settings.budget) {
+            evict_level(self, texture);
+        }
+        if (self->resident_bytes + need <= self->settings.budget) break;
+    }
+    if (!hard) {  // Пропускаем выгруженных до предела с начала списка:
+        while (self->lru_next < Array_len(list)) {
+            StreamTexture *texture = (StreamTexture*)Array_get_ptr(list, self->lru_next);
+            if (texture->resident < evict_limit(self, texture, false)) break;
+            self->lru_next++;
+        }
+    }
+    return self->resident_bytes + need <= self->settings.budget;
+}
+
+// Нужно ли текстуре догрузить уровень (хвост - всегда, остальное - если запрошено в этом кадре):
+static inline bool wants_upload(const TexStream *self, const StreamTexture *texture) {
+    if (texture->resident > texture->tail) return true;
+    return texture->last_used == self->frame && texture->resident > texture->wanted;
+}
+
+// Догрузить уровни в пределах бюджета кадра (проходами по одному уровню на текстуру, от грубых к точным):
+static void upload_levels(TexStream *self) {
+    bool done = false;
+    while (!done) {
+        Array_clear(self->order, false);
+        for (size_t i = 0; i < Array_len(self->textures); i++) {
+            StreamTexture *texture = (StreamTexture*)Array_get_ptr(self->textures, i);
+            if (wants_upload(self, texture)) Array_push(self->order, &texture);
+        }
+        if (Array_len(self->order) == 0) break;
+        qsort(self->order->data, Array_len(self->order), sizeof(StreamTexture*), compare_upload);
+
+        bool progress = false;
+        for (size_t i = 0; i < Array_len(self->order) && !done; i++) {
+            StreamTexture *texture = (StreamTexture*)Array_get_ptr(self->order, i);
+            int level = texture->resident - 1;
+            size_t estimate = texture->file.levels[level].size;
+
+            // Бюджет кадра (первый уровень кадра грузится всегда, иначе большой уровень не загрузится никогда):
+            if (self->frame_bytes > 0 && self->frame_bytes + estimate > self->settings.upload_budget) {
+                done = true;
+                break;
+            }
+
+            // Бюджет видеопамяти (хвост грузится всегда):
+            if (level < texture->tail && !make_room(self, estimate, texture, false)) {
+                self->stats.blocked++;
+                continue;
+            }
+            if (!upload_level(self, texture)) done = true;
+            else progress = true;
+        }
+        if (!progress) break;
+    }
+}
+
+
+// -------- API потоковых текстур: --------
+
+
+// Создать менеджер (settings = NULL - настройки по умолчанию):
+TexStream* TexStream_create(const TexStreamBackend *backend, const TexStreamSettings *settings) {
+    if (!backend || !backend->create || !backend->upload || !backend->evict || !backend->set_levels || !backend->destroy) {
+        log_msg("[E] TexStream_create: The backend is incomplete.\n");
+        return NULL;
+    }
+    TexStream *stream = (TexStream*)mm_calloc(1, sizeof(TexStream));
+    stream->backend = *backend;
+    stream->settings = settings ? *settings : (TexStreamSettings){
+        TEXSTREAM_DEFAULT_BUDGET, TEXSTREAM_DEFAULT_UPLOAD_BUDGET, TEXSTREAM_DEFAULT_RESIDENT_SIZE
+    };
+    if (stream->settings.resident_size <= 0) stream->settings.resident_size = 1;
+    stream->textures = Array_create(sizeof(StreamTexture*), 64);
+    stream->order = Array_create(sizeof(StreamTexture*), 64);
+    stream->lru = Array_create(sizeof(StreamTexture*), 64);
+    return stream;
+}
+
+// Уничтожить менеджер вместе со всеми его текстурами:
+void TexStream_destroy(TexStream **stream) {
+    if (!stream || !*stream) return;
+    TexStream *self = *stream;
+    while (Array_len(self->textures) > 0) {
+        StreamTexture *texture = (StreamTexture*)Array_get_ptr(self->textures, Array_len(self->textures) - 1);
+        TexStream_remove(self, &texture);
+    }
+    Array_destroy(&self->textures);
+    Array_destroy(&self->order);
+    Array_destroy(&self->lru);
+    mm_free(self);
+    *stream = NULL;
+}
+
+// Открыть файл текстуры и добавить потоковую текстуру (сразу грузится хвост маленьких уровней):
+StreamTexture* TexStream_load(TexStream *self, const char *filepath) {
+    if (!self || !filepath) return NULL;
+    TexFile file;
+    if (!TexFile_open(filepath, &file)) return NULL;
+    StreamTexture *texture = TexStream_add(self, &file);
+    if (!texture) TexFile_close(&file);
+    return texture;
+}
+
+// Добавить потоковую текстуру из открытого файла (файл переходит менеджеру и закрывается им):
+StreamTexture* TexStream_add(TexStream *self, TexFile *file) {
+    if (!self || !file || file->count <= 0) return NULL;
+    Texture *handle = self->backend.create(self->backend.user, file);
+    if (!handle) return NULL;
+
+    StreamTexture *texture = (StreamTexture*)mm_calloc(1, sizeof(StreamTexture));
+    texture->stream = self;
+    texture->texture = handle;
+    texture->file = *file;
+    *file = (TexFile){ 0 };
+
+    // Хвост - уровни не больше resident_size (у текстуры без маленьких уровней - самый маленький):
+    int count = texture->file.count;
+    texture->tail = count - 1;
+    while (texture->tail > 0 && level_extent(texture, texture->tail - 1) <= self->settings.resident_size) texture->tail--;
+    texture->resident = count;
+    texture->wanted = texture->tail;
+    texture->request = NO_REQUEST;
+    texture->last_used = self->frame;
+    texture->index = Array_len(self->textures);
+    Array_push(self->textures, &texture);
+
+    // Хвост грузим сразу, чтобы текстуру было чем рисовать (что не влезет, догрузит TexStream_update):
+    while (texture->resident > texture->tail && upload_level(self, texture));
+    return texture;
+}
+
+// Удалить потоковую текстуру:
+void TexStream_remove(TexStream *self, StreamTexture **texture) {
+    if (!self || !texture || !*texture || (*texture)->stream != self) return;
+    StreamTexture *tex = *texture;
+    for (int i = tex->resident; i < tex->file.count; i++) self->resident_bytes -= tex->sizes[i];
+    self->backend.destroy(self->backend.user, tex->texture);
+    TexFile_close(&tex->file);
+
+    // Убираем из массива, последняя текстура встаёт на её место:
+    Array_remove_swap(self->textures, tex->index, NULL);
+    if (tex->index < Array_len(self->textures)) {
+        ((StreamTexture*)Array_get_ptr(self->textures, tex->index))->index = tex->index;
+    }
+    mm_free(tex);
+    *texture = NULL;
+}
+
+// Запросить уровень на этот кадр (0 - самый точный). Из запросов за кадр берётся самый точный:
+void TexStream_request(StreamTexture *texture, int level) {
+    if (!texture) return;
+    if (level < 0) level = 0;
+    if (level > texture->tail) level = texture->tail;
+    if (level < texture->request) texture->request = level;
+    texture->last_used = texture->stream->frame;
+}
+
+// Запросить уровень по размеру текстуры на экране в пикселях (по большей стороне):
+void TexStream_request_size(StreamTexture *texture, float pixels) {
+    if (!texture) return;
+    if (pixels <= 0.0f) {  // Не видна, но используется: достаточно хвоста.
+        TexStream_request(texture, texture->tail);
+        return;
+    }
+    float extent = (float)level_extent(texture, 0);
+    int level = extent > pixels ? (int)floorf(log2f(extent / pixels)) : 0;
+    TexStream_request(texture, level);
+}
+
+// Запросить уровень по расстоянию (pixels_at_unit - размер на экране на расстоянии 1):
+void TexStream_request_distance(StreamTexture *texture, float distance, float pixels_at_unit) {
+    if (!texture) return;
+    if (distance <= 0.0f) TexStream_request(texture, 0);
+    else TexStream_request_size(texture, pixels_at_unit / distance);
+}
+
+// Обработать кадр: догрузить запрошенные уровни в пределах бюджетов и выгрузить лишнее (до TexUpload_frame):
+void TexStream_update(TexStream *self) {
+    if (!self) return;
+
+    // Запросы кадра становятся запрошенными уровнями:
+    size_t count = Array_len(self->textures);
+    for (size_t i = 0; i < count; i++) {
+        StreamTexture *texture = (StreamTexture*)Array_get_ptr(self->textures, i);
+        if (texture->request != NO_REQUEST) texture->wanted = texture->request;
+        texture->request = NO_REQUEST;
+    }
+
+    // Бюджет могли уменьшить: выгружаем всё лишнее по LRU, потом догружаем запрошенное:
+    self->lru_ready = false;
+    if (self->resident_bytes > self->settings.budget) make_room(self, 0, NULL, true);
+    upload_levels(self);
+
+    // Статистика кадра:
+    size_t pending = 0;
+    for (size_t i = 0; i < count; i++) pending += wants_upload(self, (StreamTexture*)Array_get_ptr(self->textures, i));
+    self->stats.resident_bytes = self->resident_bytes;
+    self->stats.textures = count;
+    self->stats.pending = pending;
+    self->stats.frame_uploads = self->frame_uploads;
+    self->stats.frame_bytes = self->frame_bytes;
+    self->stats.frame_evictions = self->frame_evictions;
+    self->stats.total_uploads += self->frame_uploads;
+    self->stats.total_evictions += self->frame_evictions;
+    self->frame_uploads = self->frame_bytes = self->frame_evictions = 0;
+    GAUGE_SET("texstream.resident", self->resident_bytes);
+    self->frame++;
+}
+
+// Изменить бюджеты (лишнее выгрузится в следующем TexStream_update):
+void TexStream_set_budget(TexStream *self, size_t budget, size_t upload_budget) {
+    if (!self) return;
+    self->settings.budget = budget;
+    self->settings.upload_budget = upload_budget;
+}
+
+// Получить текстуру для отрисовки:
+Texture* TexStream_get_texture(StreamTexture *texture) {
+    return texture ? texture->texture : NULL;
+}
+
+// Получить самый точный загруженный уровень (количество уровней - ничего не загружено):
+int TexStream_get_resident_level(StreamTexture *texture) {
+    return texture ? texture->resident : 0;
+}
+
+// Получить запрошенный уровень:
+int TexStream_get_wanted_level(StreamTexture *texture) {
+    return texture ? texture->wanted : 0;
+}
+
+// Получить статистику менеджера:
+TexStreamStats TexStream_get_stats(TexStream *self) {
+    return self ? self->stats : (TexStreamStats){ 0 };
+}
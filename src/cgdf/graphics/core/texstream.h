@@ -0,0 +1,124 @@
+//
+// texstream.h - Потоковая загрузка текстур: уровни мипмапов по мере надобности и бюджет видеопамяти.
+//
+// Texture_load грузит сразу все уровни всех текстур, и большая сцена не влезает в видеопамять (или долго
+// грузится). Потоковая текстура берёт уровни из файла текстуры (.ctex, отображается в память, см. texfile.h)
+// по одному. Сразу грузится только хвост маленьких уровней (не больше resident_size), дальше каждый кадр
+// запрашивается нужный уровень (TexStream_request_*: по размеру на экране или расстоянию), и TexStream_update
+// догружает уровни от грубых к точным в пределах бюджета байт на кадр. Сначала улучшаются самые грубые
+// текстуры, поэтому вся сцена быстро становится сносной, а потом уже чёткой. Если загрузка не помещается
+// в бюджет видеопамяти, выгружаются самые точные уровни текстур, которые дольше всех не запрашивались (LRU).
+// Хвост маленьких уровней не выгружается никогда.
+//
+// Решения о загрузке не зависят от видеокарты: уровни грузятся и выгружаются через TexStreamBackend.
+// TexStream_get_default_backend грузит в Texture через кольцо TexUpload, а тест может подставить свой
+// обработчик, который только записывает вызовы.
+//
+// Счётчики кадра: texstream.uploads, texstream.upload_bytes, texstream.evictions, texstream.resident (см. counters.h).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <cgdf/core/std.h>
+#include <cgdf/core/texfile.h>
+#include "texture.h"
+
+
+// Определения:
+#define TEXSTREAM_DEFAULT_BUDGET         (512*1024*1024)  // Бюджет видеопамяти по умолчанию.
+#define TEXSTREAM_DEFAULT_UPLOAD_BUDGET  (8*1024*1024)    // Байт загрузки за кадр по умолчанию.
+#define TEXSTREAM_DEFAULT_RESIDENT_SIZE  64               // Уровни не больше этого размера грузятся сразу.
+
+
+// Объявление структур:
+typedef struct Renderer Renderer;
+typedef struct TexStream TexStream;                  // Менеджер потоковых текстур.
+typedef struct StreamTexture StreamTexture;          // Потоковая текстура.
+typedef struct TexStreamBackend TexStreamBackend;    // Загрузка уровней в видеокарту.
+typedef struct TexStreamSettings TexStreamSettings;  // Настройки менеджера.
+typedef struct TexStreamStats TexStreamStats;        // Статистика менеджера.
+
+
+// Загрузка уровней в видеокарту (все функции вызываются из главного потока):
+struct TexStreamBackend {
+    void *user;  // Аргумент функций.
+    Texture* (*create)(void *user, const TexFile *file);                             // Создать текстуру без уровней.
+    size_t (*upload)(void *user, Texture *texture, const TexFile *file, int level);  // Загрузить уровень (0 - не сейчас).
+    void (*evict)(void *user, Texture *texture, int level);                          // Освободить уровень.
+    void (*set_levels)(void *user, Texture *texture, int base_level, int max_level); // Уровни, из которых читать.
+    void (*destroy)(void *user, Texture *texture);                                   // Уничтожить текстуру.
+};
+
+
+// Настройки менеджера:
+struct TexStreamSettings {
+    size_t budget;         // Бюджет видеопамяти в байтах.
+    size_t upload_budget;  // Сколько байт загружать за кадр (один уровень за кадр грузится всегда).
+    int resident_size;     // Уровни не больше этого размера грузятся сразу и не выгружаются.
+};
+
+
+// Статистика менеджера:
+struct TexStreamStats {
+    size_t resident_bytes;  // Сколько видеопамяти занято уровнями.
+    size_t textures;        // Сколько текстур.
+    size_t pending;         // Сколько запрошенных текстур ещё не догружены.
+    size_t frame_uploads;   // Уровней загружено за прошлый кадр.
+    size_t frame_bytes;     // Байт загружено за прошлый кадр.
+    size_t frame_evictions; // Уровней выгружено за прошлый кадр.
+    size_t total_uploads;   // Уровней загружено за всё время.
+    size_t total_evictions; // Уровней выгружено за всё время.
+    size_t blocked;         // Сколько раз загрузка не поместилась в бюджет видеопамяти.
+};
+
+
+// -------- API потоковых текстур: --------
+
+
+// Создать менеджер (settings = NULL - настройки по умолчанию):
+TexStream* TexStream_create(const TexStreamBackend *backend, const TexStreamSettings *settings);
+
+// Уничтожить менеджер вместе со всеми его текстурами:
+void TexStream_destroy(TexStream **stream);
+
+// Получить обработчик загрузки в Texture через кольцо загрузки рендерера:
+TexStreamBackend TexStream_get_default_backend(Renderer *renderer);
+
+// Открыть файл текстуры и добавить потоковую текстуру (сразу грузится хвост маленьких уровней):
+StreamTexture* TexStream_load(TexStream *self, const char *filepath);
+
+// Добавить потоковую текстуру из открытого файла (файл переходит менеджеру и закрывается им):
+StreamTexture* TexStream_add(TexStream *self, TexFile *file);
+
+// Удалить потоковую текстуру:
+void TexStream_remove(TexStream *self, StreamTexture **texture);
+
+// Запросить уровень на этот кадр (0 - самый точный). Из запросов за кадр берётся самый точный:
+void TexStream_request(StreamTexture *texture, int level);
+
+// Запросить уровень по размеру текстуры на экране в пикселях (по большей стороне):
+void TexStream_request_size(StreamTexture *texture, float pixels);
+
+// Запросить уровень по расстоянию (pixels_at_unit - размер на экране на расстоянии 1, например
+// object_size * screen_height / (2 * tan(fov_y / 2))):
+void TexStream_request_distance(StreamTexture *texture, float distance, float pixels_at_unit);
+
+// Обработать кадр: догрузить запрошенные уровни в пределах бюджетов и выгрузить лишнее (до TexUpload_frame):
+void TexStream_update(TexStream *self);
+
+// Изменить бюджеты (лишнее выгрузится в следующем TexStream_update):
+void TexStream_set_budget(TexStream *self, size_t budget, size_t upload_budget);
+
+// Получить текстуру для отрисовки:
+Texture* TexStream_get_texture(StreamTexture *texture);
+
+// Получить самый точный загруженный уровень (количество уровней - ничего не загружено):
+int TexStream_get_resident_level(StreamTexture *texture);
+
+// Получить запрошенный уровень:
+int TexStream_get_wanted_level(StreamTexture *texture);
+
+// Получить статистику менеджера:
+TexStreamStats TexStream_get_stats(TexStream *self);
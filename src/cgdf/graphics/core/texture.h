@@ -8,6 +8,9 @@
 // Подключаем:
 #include <cgdf/core/std.h>
 #include <cgdf/core/pixmap.h>
+#include <cgdf/core/mipmap.h>
+#include <cgdf/core/bcn.h>
+#include <cgdf/core/texfile.h>
 
 
 // Формат текстуры (channels):
@@ -31,6 +34,7 @@ typedef enum TextureInternalFormat {
     TEX_INTERNAL_RGBA8,
 
     TEX_INTERNAL_R16F,
+    TEX_INTERNAL_RG16F,
     TEX_INTERNAL_RGB16F,
     TEX_INTERNAL_RGBA16F,
 
@@ -45,6 +49,15 @@ typedef enum TextureInternalFormat {
     TEX_INTERNAL_DEPTH32F,
 
     TEX_INTERNAL_DEPTH24_STENCIL8,
+
+    TEX_INTERNAL_BC1,  // Сжатые форматы (блоки 4x4, см. bcn.h), данные через Texture_set_compressed.
+    TEX_INTERNAL_BC1_SRGB,
+    TEX_INTERNAL_BC3,
+    TEX_INTERNAL_BC3_SRGB,
+    TEX_INTERNAL_BC4,
+    TEX_INTERNAL_BC5,
+    TEX_INTERNAL_BC7,
+    TEX_INTERNAL_BC7_SRGB,
 } TextureInternalFormat;
 
 
@@ -54,6 +67,7 @@ typedef enum TextureDataType {
     TEX_DATA_USHORT, TEX_DATA_SHORT,
     TEX_DATA_UINT,   TEX_DATA_INT,
     TEX_DATA_FLOAT,
+    TEX_DATA_HALF_FLOAT,  // 16 бит half float (картинки с Pixmap.is_half).
 } TextureDataType;
 
 
@@ -66,6 +80,7 @@ typedef enum TextureType {
 
 // Объявление структур:
 typedef struct Renderer Renderer;
+typedef struct TexUpload TexUpload;
 typedef struct Texture Texture;  // Текстура 2D.
 
 
@@ -77,6 +92,7 @@ struct Texture {
     int height;          // Высота текстуры.
     int channels;        // Количество каналов текстуры.
     bool has_mipmap;     // Наличие мипмапов.
+    bool explicit_mips;  // Уровни мипмапов заданы явно (Texture_set_subdata их не пересчитывает).
     bool _is_begin_;     // Признак активности текстуры (внутренняя логика).
     TextureFormat format;              // Формат текстуры (каналы).
     TextureInternalFormat internal;    // Внутренний формат текстуры.
@@ -108,12 +124,38 @@ void Texture_empty(
     TextureFormat format, TextureInternalFormat internal, TextureDataType dtype
 );
 
-// Загрузить текстуру (из файла):
+// Загрузить текстуру (из файла). Следит за файлом, если запущен HotReload:
 void Texture_load(Texture *self, const char *filepath, bool use_mipmap);
 
+// Загрузить текстуру из уже декодированного файла (Pixmap_load_many). Следит за файлом, если запущен HotReload:
+void Texture_load_decoded(Texture *self, const char *filepath, Pixmap *img, bool use_mipmap);
+
 // Загрузить текстуру (из картинки):
 void Texture_load_pixmap(Texture *self, Pixmap *pixmap, bool use_mipmap);
 
+// Загрузить текстуру с готовой цепочкой мипмапов (Pixmap_generate_mips). srgb - хранить цвет в sRGB формате:
+void Texture_load_mips(Texture *self, const MipChain *chain, bool srgb);
+
+// Загрузить текстуру с готовой цепочкой мипмапов, сжав каждый уровень в BCn (settings = NULL - BC7, качественно).
+// Если видеокарта не поддерживает формат, текстура загружается без сжатия:
+void Texture_load_mips_compressed(Texture *self, const MipChain *chain, const BCSettings *settings, bool srgb);
+
+// Загрузить текстуру из файла текстуры (TexFile_save). Уровни отдаются в видеокарту прямо из отображения файла.
+// Сжатые уровни без поддержки формата распаковываются на процессоре. Следит за файлом, если запущен HotReload:
+void Texture_load_texfile(Texture *self, const char *filepath);
+
+// Подготовить текстуру к загрузке уровней файла текстуры по одному (уровни не заданы, читать её ещё нельзя):
+void Texture_prepare_texfile(Texture *self, const TexFile *file);
+
+// Загрузить один уровень файла текстуры (upload = NULL - напрямую). Возвращает размер уровня в видеопамяти:
+size_t Texture_load_texfile_level(Texture *self, const TexFile *file, int level, TexUpload *upload);
+
+// Освободить видеопамять уровня текстуры (уровень должен быть вне Texture_set_level_range):
+void Texture_unload_level(Texture *self, int level);
+
+// Ограничить уровни, из которых читает видеокарта (base_level - самый большой из них):
+void Texture_set_level_range(Texture *self, int base_level, int max_level);
+
 // Загрузить текстуру (из файла) расширенный режим:
 void Texture_load_advanced(
     Texture *self, const char *filepath, bool use_mipmap,
@@ -126,6 +168,15 @@ void Texture_set_data(
     TextureFormat format, TextureInternalFormat internal, TextureDataType dtype
 );
 
+// Поддерживает ли видеокарта внутренний формат (для сжатых форматов проверяются расширения):
+bool Texture_is_compression_supported(TextureInternalFormat internal);
+
+// Установить сжатые данные уровня текстуры (BCn). Уровень 0 задаёт размер и формат текстуры:
+void Texture_set_compressed(
+    Texture *self, int miplevel, int width, int height,
+    TextureInternalFormat internal, const void *data, size_t size
+);
+
 // Установить данные текстуры (подмассив):
 void Texture_set_subdata(
     Texture *self, int miplevel, int offset_x, int offset_y, int width, int height,
@@ -0,0 +1,102 @@
+//
+// texupload.h - Асинхронная загрузка текстур через кольцо буферов распаковки (PBO).
+//
+// Texture_set_subdata отдаёт драйверу память программы, и он копирует её сразу, останавливая главный поток.
+// Кольцо загрузки держит один буфер распаковки, отображённый в память: пиксели пишутся прямо в него (в том
+// числе из потоков JobSystem), а видеокарта забирает их сама, когда дойдёт до команды загрузки. Занятое
+// место освобождается по fence: в конце кадра ставится fence, и когда видеокарта его прошла, память отданных
+// до него загрузок снова свободна. Если места не хватает, кольцо ждёт самый старый fence (время ожидания
+// считается в статистике), а блок больше всего кольца грузится обычным Texture_set_subdata.
+//
+// Порядок работы: TexUpload_reserve (главный поток) -> заполнить block.data (любой поток) ->
+// TexUpload_commit (любой поток) -> загрузка отдаётся видеокарте в TexUpload_flush или TexUpload_frame
+// (главный поток). Текстура должна жить, пока её загрузка не отдана.
+//
+// Счётчики кадра: texupload.bytes, texupload.count, texupload.stall_us, texupload.fallbacks (см. counters.h).
+//
+// define CGDF_TEXUPLOAD_NO_PERSISTENT - Не использовать постоянное отображение (GL_ARB_buffer_storage):
+//                                       пиксели пишутся в копию буфера в памяти и отдаются glBufferSubData.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <cgdf/core/std.h>
+#include "texture.h"
+
+
+// Определения:
+#define TEXUPLOAD_DEFAULT_SIZE  (32*1024*1024)  // Размер кольца рендерера по умолчанию.
+#define TEXUPLOAD_ALIGN         256             // Выравнивание блоков в кольце.
+#define TEXUPLOAD_MAX_FENCES    8               // Сколько кадров может быть в полёте.
+#define TEXUPLOAD_WAIT_TIMEOUT  (1000000000ull) // Сколько ждать fence за один вызов ожидания (нс).
+
+
+// Объявление структур:
+typedef struct Renderer Renderer;
+typedef struct TexUpload TexUpload;            // Кольцо загрузки текстур.
+typedef struct TexUploadBlock TexUploadBlock;  // Выделенный в кольце блок одной загрузки.
+typedef struct TexUploadStats TexUploadStats;  // Статистика кольца.
+
+
+// Выделенный в кольце блок одной загрузки:
+struct TexUploadBlock {
+    void *data;      // Куда писать пиксели (строки подряд без выравнивания).
+    size_t size;     // Размер блока в байтах.
+    size_t pitch;    // Байт в строке.
+    void *_entry_;   // Загрузка в очереди (внутренняя логика).
+};
+
+
+// Статистика кольца:
+struct TexUploadStats {
+    size_t frame_bytes;      // Байт отдано видеокарте за прошлый кадр.
+    size_t frame_count;      // Загрузок за прошлый кадр.
+    uint64_t frame_stall_ns; // Ожидание свободного места за прошлый кадр.
+    size_t total_bytes;      // Байт отдано за всё время.
+    size_t total_count;      // Загрузок за всё время.
+    uint64_t total_stall_ns; // Ожидание за всё время.
+    size_t fallbacks;        // Загрузок мимо кольца (не хватило места).
+    size_t peak_used;        // Максимум занятого места в байтах.
+};
+
+
+// -------- API кольца загрузки: --------
+
+
+// Создать кольцо загрузки (size = 0 - TEXUPLOAD_DEFAULT_SIZE). Нужен контекст OpenGL:
+TexUpload* TexUpload_create(Renderer *renderer, size_t size);
+
+// Уничтожить кольцо загрузки (ждёт видеокарту и отдаёт все заполненные загрузки):
+void TexUpload_destroy(TexUpload **upload);
+
+// Выделить блок под загрузку области текстуры (главный поток). false - места нет, грузите Texture_set_subdata:
+bool TexUpload_reserve(
+    TexUpload *self, Texture *texture, int miplevel, int offset_x, int offset_y, int width, int height,
+    TextureFormat format, TextureDataType dtype, TexUploadBlock *out_block
+);
+
+// Отметить, что блок заполнен (любой поток). После этого блок трогать нельзя:
+void TexUpload_commit(TexUploadBlock *block);
+
+// Загрузить область текстуры через кольцо (копия данных, загрузка отдаётся сразу). self = NULL - напрямую:
+void TexUpload_subdata(
+    TexUpload *self, Texture *texture, int miplevel, int offset_x, int offset_y, int width, int height,
+    TextureFormat format, TextureDataType dtype, const void *data
+);
+
+// Отдать видеокарте все заполненные загрузки (главный поток):
+void TexUpload_flush(TexUpload *self);
+
+// Закончить кадр: отдать загрузки, поставить fence, освободить пройденное видеокартой, снять статистику:
+void TexUpload_frame(TexUpload *self);
+
+// Получить статистику кольца:
+TexUploadStats TexUpload_get_stats(TexUpload *self);
+
+// Получить размер кольца в байтах:
+size_t TexUpload_get_size(TexUpload *self);
+
+// Постоянно ли отображён буфер (иначе данные идут через копию в памяти):
+bool TexUpload_is_persistent(TexUpload *self);
@@ -8,6 +8,7 @@
 // Подключаем:
 #include <cgdf/core/std.h>
 #include <cgdf/core/pixmap.h>
+#include <cgdf/core/framepacer.h>
 #include "scene.h"
 #include "renderer.h"
 #include "input.h"
@@ -231,6 +232,9 @@ double Window_get_dtime(Window *self);
 // Получить время со старта окна:
 double Window_get_time(Window *self);
 
+// Получить статистику времени кадра (перцентили, пропущенные кадры, время ожидания):
+void Window_get_frame_stats(Window *self, FramePacerStats *stats);
+
 // Установить сцену окна:
 void Window_set_scene(Window *self, const WindowScene *scene);
 
@@ -242,3 +246,6 @@ void Window_clear(Window *self, float r, float g, float b);
 
 // Отрисовка содержимого окна:
 void Window_display(Window *self);
+
+// Сохранить снимок окна в файл (читается в Window_display, кодируется в потоке, см. readback.h):
+bool Window_screenshot(Window *self, const char *filepath);
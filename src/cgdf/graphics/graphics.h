@@ -27,6 +27,9 @@ extern "C" {
 #include "core/sprite.h"
 #include "core/spritebatch.h"
 #include "core/texture.h"
+#include "core/texupload.h"
+#include "core/readback.h"
+#include "core/texstream.h"
 #include "core/utils.h"
 #include "core/vertex.h"
 #include "core/window.h"
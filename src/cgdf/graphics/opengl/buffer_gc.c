@@ -26,6 +26,7 @@ static size_t find_max_stacks_len(void) {
     if (Array_len(g_buffer_gc_gl.ebo)  > max_stack_len) max_stack_len = Array_len(g_buffer_gc_gl.ebo);
     if (Array_len(g_buffer_gc_gl.vao)  > max_stack_len) max_stack_len = Array_len(g_buffer_gc_gl.vao);
     if (Array_len(g_buffer_gc_gl.tbo)  > max_stack_len) max_stack_len = Array_len(g_buffer_gc_gl.tbo);
+    if (Array_len(g_buffer_gc_gl.pbo)  > max_stack_len) max_stack_len = Array_len(g_buffer_gc_gl.pbo);
     // ...
     return max_stack_len;
 }
@@ -48,6 +49,7 @@ void BufferGC_GL_init(void) {
     g_buffer_gc_gl.ebo  = Array_create(sizeof(uint32_t), BUFFER_GC_GL_START_CAPACITY);
     g_buffer_gc_gl.vao  = Array_create(sizeof(uint32_t), BUFFER_GC_GL_START_CAPACITY);
     g_buffer_gc_gl.tbo  = Array_create(sizeof(uint32_t), BUFFER_GC_GL_START_CAPACITY);
+    g_buffer_gc_gl.pbo  = Array_create(sizeof(uint32_t), BUFFER_GC_GL_START_CAPACITY);
     // ...
 }
 
@@ -62,6 +64,7 @@ void BufferGC_GL_destroy(void) {
     Array_destroy(&g_buffer_gc_gl.ebo);
     Array_destroy(&g_buffer_gc_gl.vao);
     Array_destroy(&g_buffer_gc_gl.tbo);
+    Array_destroy(&g_buffer_gc_gl.pbo);
     // ...
 }
 
@@ -77,6 +80,7 @@ void BufferGC_GL_push(BufferGC_GL_Type type, unsigned int id) {
         case BGC_GL_EBO:  Array_push(g_buffer_gc_gl.ebo,  &id); break;
         case BGC_GL_VAO:  Array_push(g_buffer_gc_gl.vao,  &id); break;
         case BGC_GL_TBO:  Array_push(g_buffer_gc_gl.tbo,  &id); break;
+        case BGC_GL_PBO:  Array_push(g_buffer_gc_gl.pbo,  &id); break;
         // ...
     }
 }
@@ -130,6 +134,11 @@ void BufferGC_GL_flush(void) {
         glDeleteTextures(Array_len(g_buffer_gc_gl.tbo), (uint32_t*)g_buffer_gc_gl.tbo->data);
         stack_flush(g_buffer_gc_gl.tbo);
     }
+    // Очищаем стек буферов PBO:
+    if (Array_len(g_buffer_gc_gl.pbo) > 0) {
+        glDeleteBuffers(Array_len(g_buffer_gc_gl.pbo), (uint32_t*)g_buffer_gc_gl.pbo->data);
+        stack_flush(g_buffer_gc_gl.pbo);
+    }
 
     // ...
 }
@@ -23,6 +23,7 @@ typedef enum BufferGC_GL_Type {
     BGC_GL_EBO,
     BGC_GL_VAO,
     BGC_GL_TBO,
+    BGC_GL_PBO,
     // ...
 } BufferGC_GL_Type;
 
@@ -41,6 +42,7 @@ struct BufferGC_GL {
     Array *ebo;
     Array *vao;
     Array *tbo;
+    Array *pbo;
     // ...
 };
 
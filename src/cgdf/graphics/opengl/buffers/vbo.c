@@ -7,6 +7,7 @@
 #include <cgdf/core/std.h>
 #include <cgdf/core/mm.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/counters.h>
 #include "../gl.h"
 #include "../buffer_gc.h"
 #include "buffers.h"
@@ -81,6 +82,7 @@ size_t BufferVBO_get_size(BufferVBO *self) {
 void BufferVBO_set_data(BufferVBO *self, const void *data, const size_t size, int mode) {
     if (!self) return;
     glBufferData(GL_ARRAY_BUFFER, size, data, mode);
+    COUNTER_ADD("gl.vbo_bytes_uploaded", size);
     self->size = size;
 }
 
@@ -88,4 +90,5 @@ void BufferVBO_set_data(BufferVBO *self, const void *data, const size_t size, in
 void BufferVBO_set_subdata(BufferVBO *self, const void *data, const size_t offset, const size_t size) {
     if (!self) return;
     glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    COUNTER_ADD("gl.vbo_bytes_uploaded", size);
 }
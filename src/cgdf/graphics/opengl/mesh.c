@@ -93,6 +93,30 @@ void Mesh_destroy(Mesh **mesh) {
 // -------- API сетки: --------
 
 
+// Заменить вершины и индексы сетки (буферы и атрибуты остаются теми же):
+void Mesh_update(
+    Mesh *self,
+    const Vertex* vertices,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    uint32_t index_count
+) {
+    if (!self || !vertices || !indices) return;
+    int mode = self->is_dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+
+    // Буфер индексов привязан к VAO, поэтому загружаем его с нашим VAO:
+    BufferVAO_begin(self->vao);
+    BufferVBO_begin(self->vbo);
+    BufferVBO_set_data(self->vbo, vertices, vertex_count * sizeof(Vertex), mode);
+    BufferEBO_begin(self->ebo);
+    BufferEBO_set_data(self->ebo, indices, index_count * sizeof(uint32_t), mode);
+    BufferVBO_end(self->vbo);
+    BufferVAO_end(self->vao);
+    BufferEBO_end(self->ebo);
+    self->vertex_count = vertex_count;
+    self->index_count = index_count;
+}
+
 // Получить айди буфера вершин и индексов (x=vbo, y=ebo):
 Vec2i Mesh_get_buffers_ids(Mesh *self) {
     if (!self) return (Vec2i){-1, -1};
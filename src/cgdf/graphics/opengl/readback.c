@@ -0,0 +1,587 @@
+//
+// readback.c - Реализация асинхронного чтения из видеокарты через буферы упаковки (PBO).
+//
+// Каждое чтение занимает свой буфер (слот) и закрывается fence. Readback_update каждый кадр без ожидания
+// проверяет fence по порядку постановки и отдаёт готовые чтения в том же порядке. Буфер слота растёт под
+// самое большое чтение и переиспользуется. При постоянном отображении сохранение забирает слот в поток
+// кодирования целиком (busy): поток сам копирует строки в картинку и только потом отпускает слот.
+//
+
+
+// Подключаем:
+#include <ctype.h>
+#include <cgdf/core/std.h>
+#include <cgdf/core/mm.h>
+#include <cgdf/core/logger.h>
+#include <cgdf/core/counters.h>
+#include <cgdf/core/jobsystem.h>
+#include <cgdf/core/pixmap.h>
+#include "../core/texture.h"
+#include "../core/readback.h"
+#include "buffer_gc.h"
+#include "gl.h"
+
+
+// Определения:
+#define READBACK_BUFFER_ALIGN  (64*1024)  // Размер буфера слота округляется до этого.
+
+
+// Слот чтения (буфер упаковки с одним чтением в полёте):
+typedef struct ReadbackSlot {
+    uint32_t buffer;             // Айди буфера упаковки.
+    size_t capacity;             // Размер буфера.
+    uint8_t *memory;             // Постоянное отображение буфера (NULL - отображать при чтении).
+    GLsync sync;                 // Fence чтения.
+    uint64_t seq;                // Порядковый номер чтения.
+    uint64_t frame;              // Кадр, в котором чтение поставлено.
+    int width, height;           // Размер картинки.
+    int src_channels;            // Каналов в буфере.
+    int channels;                // Каналов в картинке.
+    bool is_hdr, is_half;        // Тип данных картинки.
+    bool flip;                   // Строки в буфере снизу вверх (кадр окна).
+    ReadbackCallback callback;   // Обработчик картинки.
+    void *arg;                   // Аргумент обработчика.
+    char *filepath;              // Путь сохранения (NULL - отдать обработчику).
+    bool pending;                // Чтение в полёте.
+    atomic_bool busy;            // Память буфера читает поток кодирования.
+} ReadbackSlot;
+
+
+// Запрос чтения кадра окна (до Readback_present):
+typedef struct ScreenRequest {
+    ReadbackCallback callback;  // Обработчик картинки.
+    void *arg;                  // Аргумент обработчика.
+    char *filepath;             // Путь сохранения (NULL - отдать обработчику).
+} ScreenRequest;
+
+
+// Задача кодирования картинки в файл:
+typedef struct EncodeJob {
+    Readback *readback;  // Чтение (счётчики сохранений).
+    ReadbackSlot *slot;  // Слот, из памяти которого копировать (или NULL, если картинка уже есть).
+    Pixmap *pixmap;      // Картинка.
+    char *filepath;      // Путь сохранения.
+} EncodeJob;
+
+
+// Асинхронное чтение из видеокарты:
+struct Readback {
+    Renderer *renderer;  // Указатель на рендерер.
+    bool persistent;     // Отображать буферы постоянно.
+    ReadbackSlot slots[READBACK_MAX_PENDING];  // Слоты чтения.
+    uint64_t seq;        // Счётчик порядка чтений.
+    uint64_t frame;      // Счётчик кадров (Readback_update).
+    ScreenRequest screen[READBACK_MAX_PENDING];  // Запросы чтения кадра окна.
+    int screen_count;    // Количество запросов кадра окна.
+    bool capturing;      // Идёт запись кадров.
+    char capture_format[READBACK_PATH_SIZE];  // Путь кадров записи с %d.
+    int capture_index;   // Номер следующего кадра записи.
+    int capture_frames;  // Сколько кадров записать.
+    mtx_t mutex;         // Мьютекс счётчиков кодирования.
+    cnd_t idle;          // Сигнал окончания кодирования.
+    size_t encodes;      // Картинок в очереди кодирования.
+    size_t saved;        // Сохранено файлов (потоками).
+    size_t save_failures;  // Не удалось сохранить (потоками).
+    ReadbackStats stats;   // Статистика.
+};
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Формат файла по расширению пути:
+static const char* get_save_format(const char *filepath) {
+    static const char *formats[] = { "png", "jpg", "jpeg", "bmp", "tga", "hdr" };
+    const char *dot = strrchr(filepath, '.');
+    if (!dot || strchr(dot, '/') || strchr(dot, '\\')) return "png";
+    for (size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); i++) {
+        const char *a = dot + 1, *b = formats[i];
+        while (*a && *b && tolower((unsigned char)*a) == *b) { a++; b++; }
+        if (*a == '\0' && *b == '\0') return formats[i];
+    }
+    return "png";
+}
+
+// Путь записи должен содержать ровно одно целое (%d с флагами и шириной), остальные % - только %%:
+static bool check_path_format(const char *format) {
+    int count = 0;
+    for (const char *c = format; *c; c++) {
+        if (*c != '%') continue;
+        if (c[1] == '%') { c++; continue; }
+        c++;
+        while (*c && strchr("-+ 0#", *c)) c++;
+        while (*c >= '0' && *c <= '9') c++;
+        if (*c != 'd') return false;
+        count++;
+    }
+    return count == 1;
+}
+
+// Байт на канал картинки слота:
+static inline size_t channel_size(const ReadbackSlot *slot) {
+    if (!slot->is_hdr) return 1;
+    return slot->is_half ? sizeof(uint16_t) : sizeof(float);
+}
+
+// Скопировать пиксели из буфера в новую картинку (переворачивает строки и отбрасывает лишние каналы):
+static Pixmap* copy_pixmap(const ReadbackSlot *slot, const uint8_t *src) {
+    Pixmap *pixmap = (Pixmap*)mm_alloc(sizeof(Pixmap));
+    pixmap->width = slot->width;
+    pixmap->height = slot->height;
+    pixmap->channels = slot->channels;
+    pixmap->from_stbi = false;
+    pixmap->is_hdr = slot->is_hdr;
+    pixmap->is_half = slot->is_half;
+    pixmap->data = mm_alloc(Pixmap_get_size(pixmap));
+
+    size_t csize = channel_size(slot);
+    size_t src_pitch = (size_t)slot->width * (size_t)slot->src_channels * csize;
+    size_t dst_pitch = (size_t)slot->width * (size_t)slot->channels * csize;
+    for (int y = 0; y < slot->height; y++) {
+        const uint8_t *row = src + (size_t)(slot->flip ? slot->height - 1 - y : y) * src_pitch;
+        uint8_t *dst = (uint8_t*)pixmap->data + (size_t)y * dst_pitch;
+        if (slot->src_channels == slot->channels) {
+            memcpy(dst, row, dst_pitch);
+            continue;
+        }
+        size_t src_pixel = (size_t)slot->src_channels * csize, dst_pixel = (size_t)slot->channels * csize;
+        for (int x = 0; x < slot->width; x++) memcpy(dst + x * dst_pixel, row + x * src_pixel, dst_pixel);
+    }
+    return pixmap;
+}
+
+// Отпустить буфер слота:
+static void release_buffer(ReadbackSlot *slot) {
+    if (!slot->buffer) return;
+    if (slot->memory) {
+        int32_t prev_buffer = 0;
+        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prev_buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, (uint32_t)prev_buffer == slot->buffer ? 0 : (uint32_t)prev_buffer);
+    }
+    BufferGC_GL_push(BGC_GL_PBO, slot->buffer);
+    slot->buffer = 0;
+    slot->capacity = 0;
+    slot->memory = NULL;
+}
+
+// Подготовить буфер слота нужного размера (буфер упаковки остаётся привязанным):
+static bool prepare_buffer(Readback *self, ReadbackSlot *slot, size_t size) {
+    if (slot->capacity >= size) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        return true;
+    }
+    release_buffer(slot);
+    size = (size + READBACK_BUFFER_ALIGN - 1) & ~(size_t)(READBACK_BUFFER_ALIGN - 1);
+    glGenBuffers(1, &slot->buffer);
+    if (slot->buffer == 0) {
+        log_msg("[E] Readback: Creating PBO failed.\n");
+        return false;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+
+    // Постоянное отображение: поток кодирования читает прямо из памяти буфера:
+    if (self->persistent) {
+        GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, flags | GL_CLIENT_STORAGE_BIT);
+        slot->memory = (uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size, flags);
+        if (!slot->memory) {  // Хранилище неизменяемое, поэтому без отображения буфер пересоздаём.
+            log_msg("[W] Readback: Persistent mapping failed, falling back to glMapBufferRange.\n");
+            self->persistent = false;
+            glDeleteBuffers(1, &slot->buffer);
+            glGenBuffers(1, &slot->buffer);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        }
+    }
+    if (!slot->memory) glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_READ);
+    slot->capacity = size;
+    return true;
+}
+
+// Найти свободный слот:
+static ReadbackSlot* find_slot(Readback *self) {
+    for (int i = 0; i < READBACK_MAX_PENDING; i++) {
+        ReadbackSlot *slot = &self->slots[i];
+        if (!slot->pending && !atomic_load_explicit(&slot->busy, memory_order_acquire)) return slot;
+    }
+    return NULL;
+}
+
+// Сколько сохранений в полёте (в слотах и в очереди кодирования):
+static size_t saves_in_flight(Readback *self) {
+    size_t count = 0;
+    for (int i = 0; i < READBACK_MAX_PENDING; i++) count += self->slots[i].pending && self->slots[i].filepath;
+    mtx_lock(&self->mutex);
+    count += self->encodes;
+    mtx_unlock(&self->mutex);
+    return count;
+}
+
+// Поставить fence за чтением и отметить слот:
+static void finish_issue(Readback *self, ReadbackSlot *slot, ReadbackCallback callback, void *arg, char *filepath) {
+    slot->sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->seq = self->seq++;
+    slot->frame = self->frame;
+    slot->callback = callback;
+    slot->arg = arg;
+    slot->filepath = filepath;
+    slot->pending = true;
+    size_t bytes = (size_t)slot->width * (size_t)slot->height * (size_t)slot->src_channels * channel_size(slot);
+    self->stats.requests++;
+    self->stats.total_bytes += bytes;
+    COUNTER_ADD("readback.bytes", bytes);
+    COUNTER_INC("readback.count");
+}
+
+// Поставить чтение текстуры:
+static bool read_texture(
+    Readback *self, Texture *texture, int channels, ReadbackCallback callback, void *arg, const char *filepath
+) {
+    if (!self || !texture || texture->width <= 0 || texture->height <= 0) return false;
+    switch (texture->internal) {
+        case TEX_INTERNAL_DEPTH16:
+        case TEX_INTERNAL_DEPTH24:
+        case TEX_INTERNAL_DEPTH32F:
+        case TEX_INTERNAL_DEPTH24_STENCIL8: {
+            log_msg("[E] Readback_texture: Depth textures are not supported.\n");
+            return false;
+        }
+        default: break;
+    }
+    ReadbackSlot *slot = find_slot(self);
+    if (!slot) return false;
+
+    // Тип данных как у текстуры (half читается как есть, без преобразования во float):
+    GLenum gl_type = GL_UNSIGNED_BYTE;
+    slot->is_hdr = slot->is_half = false;
+    switch (texture->internal) {
+        case TEX_INTERNAL_R16F:
+        case TEX_INTERNAL_RG16F:
+        case TEX_INTERNAL_RGB16F:
+        case TEX_INTERNAL_RGBA16F: { gl_type = GL_HALF_FLOAT; slot->is_hdr = slot->is_half = true; break; }
+        case TEX_INTERNAL_RGB32F:
+        case TEX_INTERNAL_RGBA32F: { gl_type = GL_FLOAT; slot->is_hdr = true; break; }
+        default: break;
+    }
+    if (channels < PIXMAP_R || channels > PIXMAP_RGBA) channels = PIXMAP_RGBA;
+    static const GLenum gl_formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+    slot->width = texture->width;
+    slot->height = texture->height;
+    slot->src_channels = slot->channels = channels;
+    slot->flip = false;
+
+    int32_t prev_buffer = 0, prev_pack = 0;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prev_buffer);
+    glGetIntegerv(GL_PACK_ALIGNMENT, &prev_pack);
+    size_t size = (size_t)slot->width * (size_t)slot->height * (size_t)channels * channel_size(slot);
+    if (!prepare_buffer(self, slot, size)) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, (uint32_t)prev_buffer);
+        return false;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    Texture_begin(texture);
+    glGetTexImage(GL_TEXTURE_2D, 0, gl_formats[channels - 1], gl_type, (void*)0);  // С буфером - смещение.
+    Texture_end(texture);
+    glPixelStorei(GL_PACK_ALIGNMENT, prev_pack);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, (uint32_t)prev_buffer);
+    finish_issue(self, slot, callback, arg, filepath ? mm_strdup(filepath) : NULL);
+    return true;
+}
+
+// Поставить чтение кадра из текущего буфера чтения (RGBA - быстрый путь драйвера, альфа отбрасывается).
+// filepath переходит слоту только при успехе:
+static bool read_screen(Readback *self, int width, int height, ReadbackCallback callback, void *arg, char *filepath) {
+    ReadbackSlot *slot = find_slot(self);
+    if (!slot) return false;
+    slot->width = width;
+    slot->height = height;
+    slot->src_channels = PIXMAP_RGBA;
+    slot->channels = PIXMAP_RGB;
+    slot->is_hdr = slot->is_half = false;
+    slot->flip = true;
+
+    int32_t prev_buffer = 0, prev_pack = 0;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prev_buffer);
+    glGetIntegerv(GL_PACK_ALIGNMENT, &prev_pack);
+    if (!prepare_buffer(self, slot, (size_t)width * (size_t)height * 4)) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, (uint32_t)prev_buffer);
+        return false;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glPixelStorei(GL_PACK_ALIGNMENT, prev_pack);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, (uint32_t)prev_buffer);
+    finish_issue(self, slot, callback, arg, filepath);
+    return true;
+}
+
+// Поставить запрос кадра окна:
+static bool queue_screen(Readback *self, ReadbackCallback callback, void *arg, const char *filepath) {
+    if (!self || self->screen_count >= READBACK_MAX_PENDING) return false;
+    self->screen[self->screen_count++] = (ScreenRequest){ callback, arg, filepath ? mm_strdup(filepath) : NULL };
+    return true;
+}
+
+// Задача кодирования картинки в файл (поток JobSystem):
+static int encode_job(void *args) {
+    EncodeJob *job = (EncodeJob*)args;
+    Readback *self = job->readback;
+
+    // Из постоянно отображённого буфера копируем сами и сразу отпускаем слот:
+    if (job->slot) {
+        job->pixmap = copy_pixmap(job->slot, job->slot->memory);
+        atomic_store_explicit(&job->slot->busy, false, memory_order_release);
+    }
+    bool success = Pixmap_save(job->pixmap, job->filepath, get_save_format(job->filepath));
+    Pixmap_destroy(&job->pixmap);
+    mm_free(job->filepath);
+    mm_free(job);
+
+    mtx_lock(&self->mutex);
+    if (success) self->saved++;
+    else self->save_failures++;
+    self->encodes--;
+    cnd_broadcast(&self->idle);
+    mtx_unlock(&self->mutex);
+    return 0;
+}
+
+// Отдать картинку в кодирование (без JobSystem кодируем сразу, иначе задача потеряется):
+static void start_encode(Readback *self, EncodeJob *job) {
+    mtx_lock(&self->mutex);
+    self->encodes++;
+    mtx_unlock(&self->mutex);
+    if (g_JobSystem.initialized) JobSystem_create_job(encode_job, job);
+    else encode_job(job);
+}
+
+// Отдать готовое чтение (fence пройден):
+static void deliver(Readback *self, ReadbackSlot *slot) {
+    glDeleteSync(slot->sync);
+    slot->sync = NULL;
+    slot->pending = false;
+    self->stats.last_latency = (int)(self->frame - slot->frame);
+
+    // Сохранение из постоянного отображения: копирует и кодирует поток, слот занят до копии:
+    if (slot->filepath && slot->memory) {
+        EncodeJob *job = (EncodeJob*)mm_alloc(sizeof(EncodeJob));
+        *job = (EncodeJob){ self, slot, NULL, slot->filepath };
+        slot->filepath = NULL;
+        atomic_store_explicit(&slot->busy, true, memory_order_relaxed);
+        start_encode(self, job);
+        return;
+    }
+
+    // Иначе копируем в главном потоке:
+    Pixmap *pixmap = NULL;
+    if (slot->memory) pixmap = copy_pixmap(slot, slot->memory);
+    else {
+        int32_t prev_buffer = 0;
+        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prev_buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        size_t size = (size_t)slot->width * (size_t)slot->height * (size_t)slot->src_channels * channel_size(slot);
+        const uint8_t *src = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_READ_BIT);
+        if (src) {
+            pixmap = copy_pixmap(slot, src);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else log_msg("[E] Readback: Mapping PBO failed.\n");
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, (uint32_t)prev_buffer);
+    }
+
+    if (slot->filepath) {
+        if (!pixmap) {
+            mtx_lock(&self->mutex);
+            self->save_failures++;
+            mtx_unlock(&self->mutex);
+            mm_free(slot->filepath);
+        } else {
+            EncodeJob *job = (EncodeJob*)mm_alloc(sizeof(EncodeJob));
+            *job = (EncodeJob){ self, NULL, pixmap, slot->filepath };
+            start_encode(self, job);
+        }
+        slot->filepath = NULL;
+        return;
+    }
+    self->stats.delivered++;
+    if (slot->callback) slot->callback(pixmap, slot->arg);
+    else Pixmap_destroy(&pixmap);
+}
+
+// Самое старое чтение в полёте:
+static ReadbackSlot* oldest_pending(Readback *self) {
+    ReadbackSlot *oldest = NULL;
+    for (int i = 0; i < READBACK_MAX_PENDING; i++) {
+        ReadbackSlot *slot = &self->slots[i];
+        if (slot->pending && (!oldest || slot->seq < oldest->seq)) oldest = slot;
+    }
+    return oldest;
+}
+
+// Снять счётчики потоков кодирования в статистику:
+static void sync_stats(Readback *self) {
+    mtx_lock(&self->mutex);
+    self->stats.saved = self->saved;
+    self->stats.save_failures = self->save_failures;
+    size_t encodes = self->encodes;
+    mtx_unlock(&self->mutex);
+    GAUGE_SET("readback.encodes", encodes);
+}
+
+
+// -------- API чтения из видеокарты: --------
+
+
+// Создать чтение из видеокарты. Нужен контекст OpenGL:
+Readback* Readback_create(Renderer *renderer) {
+    Readback *readback = (Readback*)mm_calloc(1, sizeof(Readback));
+    readback->renderer = renderer;
+    #ifndef CGDF_READBACK_NO_PERSISTENT
+        readback->persistent = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+    #endif
+    for (int i = 0; i < READBACK_MAX_PENDING; i++) atomic_init(&readback->slots[i].busy, false);
+    mtx_init(&readback->mutex, mtx_plain);
+    cnd_init(&readback->idle);
+    return readback;
+}
+
+// Уничтожить чтение (дожидается всех чтений и сохранений):
+void Readback_destroy(Readback **readback) {
+    if (!readback || !*readback) return;
+    Readback *self = *readback;
+
+    // Непрочитанные запросы кадра отдаём как ошибку:
+    for (int i = 0; i < self->screen_count; i++) {
+        ScreenRequest *request = &self->screen[i];
+        if (request->filepath) mm_free(request->filepath);
+        else if (request->callback) request->callback(NULL, request->arg);
+    }
+    self->screen_count = 0;
+    Readback_wait(self);
+
+    for (int i = 0; i < READBACK_MAX_PENDING; i++) release_buffer(&self->slots[i]);
+    cnd_destroy(&self->idle);
+    mtx_destroy(&self->mutex);
+    mm_free(self);
+    *readback = NULL;
+}
+
+// Прочитать текстуру (уровень 0, channels - количество каналов картинки). false - нет свободного буфера:
+bool Readback_texture(Readback *self, Texture *texture, int channels, ReadbackCallback callback, void *arg) {
+    return read_texture(self, texture, channels, callback, arg, NULL);
+}
+
+// Прочитать текстуру и сохранить в файл в потоке (формат по расширению, по умолчанию png):
+bool Readback_texture_save(Readback *self, Texture *texture, int channels, const char *filepath) {
+    if (!filepath) return false;
+    return read_texture(self, texture, channels, NULL, NULL, filepath);
+}
+
+// Прочитать кадр окна (в Readback_present этого кадра):
+bool Readback_screen(Readback *self, ReadbackCallback callback, void *arg) {
+    return queue_screen(self, callback, arg, NULL);
+}
+
+// Прочитать кадр окна и сохранить в файл в потоке (формат по расширению, по умолчанию png):
+bool Readback_screen_save(Readback *self, const char *filepath) {
+    if (!filepath) return false;
+    return queue_screen(self, NULL, NULL, filepath);
+}
+
+// Начать запись кадров (path_format - путь с одним %d для номера кадра, например "capture/frame_%05d.png"):
+bool Readback_capture_start(Readback *self, const char *path_format, int frames) {
+    if (!self || !path_format || frames <= 0) return false;
+    if (strlen(path_format) >= READBACK_PATH_SIZE - 16 || !check_path_format(path_format)) {
+        log_msg("[E] Readback_capture_start: Path must contain exactly one %%d: \"%s\"\n", path_format);
+        return false;
+    }
+    strcpy(self->capture_format, path_format);
+    self->capture_index = 0;
+    self->capture_frames = frames;
+    self->capturing = true;
+    return true;
+}
+
+// Остановить запись кадров (уже прочитанные кадры всё равно сохранятся):
+void Readback_capture_stop(Readback *self) {
+    if (!self) return;
+    self->capturing = false;
+}
+
+// Идёт ли запись кадров:
+bool Readback_is_capturing(Readback *self) {
+    return self && self->capturing;
+}
+
+// Прочитать кадр для запросов кадра и записи (перед сменой буферов, width и height - размер кадра):
+void Readback_present(Readback *self, int width, int height) {
+    if (!self || width <= 0 || height <= 0) return;
+
+    // Запросы кадра (если буферов не хватило, остаются до следующего кадра):
+    int done = 0;
+    for (; done < self->screen_count; done++) {
+        ScreenRequest *request = &self->screen[done];
+        if (!read_screen(self, width, height, request->callback, request->arg, request->filepath)) break;
+    }
+    if (done > 0) {
+        memmove(self->screen, self->screen + done, (size_t)(self->screen_count - done) * sizeof(ScreenRequest));
+        self->screen_count -= done;
+    }
+
+    // Запись кадров: пока кодировщики заняты, кадр пропускаем, а номер не тратим:
+    if (!self->capturing) return;
+    if (saves_in_flight(self) >= READBACK_MAX_ENCODES || !find_slot(self)) {
+        self->stats.skipped++;
+        COUNTER_INC("readback.skipped");
+        return;
+    }
+    char filepath[READBACK_PATH_SIZE];
+    snprintf(filepath, sizeof(filepath), self->capture_format, self->capture_index);
+    char *path = mm_strdup(filepath);  // При успехе путь забирает слот, при ошибке - освобождаем сами.
+    if (!read_screen(self, width, height, NULL, NULL, path)) {
+        mm_free(path);
+        return;
+    }
+    if (++self->capture_index >= self->capture_frames) self->capturing = false;
+}
+
+// Отдать готовые картинки и сохранения (главный поток, раз в кадр):
+void Readback_update(Readback *self) {
+    if (!self) return;
+    self->frame++;
+    ReadbackSlot *slot;
+    while ((slot = oldest_pending(self))) {
+        GLenum result = glClientWaitSync(slot->sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (result == GL_TIMEOUT_EXPIRED) break;  // Более поздние чтения тоже не готовы.
+        if (result == GL_WAIT_FAILED) log_msg("[W] Readback: Waiting for the fence failed.\n");
+        deliver(self, slot);
+    }
+    sync_stats(self);
+}
+
+// Дождаться всех чтений и сохранений (блокирует):
+void Readback_wait(Readback *self) {
+    if (!self) return;
+    ReadbackSlot *slot;
+    while ((slot = oldest_pending(self))) {
+        GLenum result;
+        do {
+            result = glClientWaitSync(slot->sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        } while (result == GL_TIMEOUT_EXPIRED);
+        deliver(self, slot);
+    }
+    mtx_lock(&self->mutex);
+    while (self->encodes > 0) cnd_wait(&self->idle, &self->mutex);
+    mtx_unlock(&self->mutex);
+    sync_stats(self);
+}
+
+// Получить статистику чтения:
+ReadbackStats Readback_get_stats(Readback *self) {
+    return self ? self->stats : (ReadbackStats){ 0 };
+}
+
+// Постоянно ли отображены буферы (иначе данные копируются в главном потоке):
+bool Readback_is_persistent(Readback *self) {
+    return self && self->persistent;
+}
@@ -9,12 +9,14 @@
 #include <cgdf/core/mm.h>
 #include <cgdf/core/array.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/counters.h>
 #include "../core/vertex.h"
 #include "../core/mesh.h"
 #include "../core/model.h"
 #include "../core/camera.h"
 #include "../core/shader.h"
 #include "../core/texture.h"
+#include "../core/texupload.h"
 #include "../core/renderer.h"
 #include "shaders/default_shader.h"
 #include "shaders/model_shader.h"
@@ -242,6 +244,8 @@ Renderer* Renderer_create(void) {
     // Другое:
     rnd->sprite_mesh = NULL;
     rnd->fallback_texture = NULL;
+    rnd->uploads = NULL;
+    rnd->readback = NULL;
     return rnd;
 }
 
@@ -258,6 +262,12 @@ void Renderer_destroy(Renderer **rnd) {
     // Удаляем текстуру заглушку:
     Texture_destroy(&(*rnd)->fallback_texture);
 
+    // Удаляем кольцо загрузки текстур:
+    TexUpload_destroy(&(*rnd)->uploads);
+
+    // Удаляем чтение из видеокарты (дожидается сохранений):
+    Readback_destroy(&(*rnd)->readback);
+
     // Уничтожение стеков буферов:
     BufferGC_GL_flush();
     BufferGC_GL_destroy();
@@ -356,6 +366,12 @@ void Renderer_init(Renderer *self) {
     self->fallback_texture = Texture_create(self);
     Texture_empty(self->fallback_texture, 1, 1, false, TEX_FORMAT_RGBA, TEX_INTERNAL_RGBA8, TEX_DATA_UBYTE);
 
+    // Кольцо асинхронной загрузки текстур:
+    self->uploads = TexUpload_create(self, 0);
+
+    // Асинхронное чтение текстур и кадра:
+    self->readback = Readback_create(self);
+
     // Инициализация текстурных юнитов:
     TextureUnits_init(self);
 
@@ -402,6 +418,7 @@ void Renderer_display(Renderer *self) {
             // Рисуем сетку:
             Mesh_render(mesh, model->wireframe);
             self->draw_calls_count++;
+            COUNTER_INC("gl.draw_calls");
         }
     }
 
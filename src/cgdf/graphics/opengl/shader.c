@@ -8,7 +8,9 @@
 #include <cgdf/core/math.h>
 #include <cgdf/core/mm.h>
 #include <cgdf/core/array.h>
+#include <cgdf/core/files.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/hotreload.h>
 #include "../core/texture.h"
 #include "../core/renderer.h"
 #include "../core/shader.h"
@@ -142,6 +144,128 @@ static uint32_t _compile_shader_(Shader *program, const char* source, GLenum typ
     return shader;
 }
 
+// Собрать программу из текущих исходников (сам шейдер не трогается). Возвращает айди программы или 0:
+static uint32_t _build_program_(Shader *self) {
+    // Создаём шейдерную программу:
+    uint32_t program = glCreateProgram();
+    uint32_t shaders[3] = {0};
+    bool attached[3] = {false, false, false};
+
+    if (!program) {
+        _shader_set_error_(self, "ShaderCreateError: The OpenGL context has not been created or is inactive.\n");
+        return 0;
+    }
+
+    // Компилируем шейдеры:
+    shaders[0] = _compile_shader_(self, self->vertex, GL_VERTEX_SHADER);
+    if (!shaders[0]) { _cleanup_shaders_(program, shaders, attached); return 0; }
+    shaders[1] = _compile_shader_(self, self->fragment, GL_FRAGMENT_SHADER);
+    if (!shaders[1]) { _cleanup_shaders_(program, shaders, attached); return 0; }
+    if (self->geometry) {
+        shaders[2] = _compile_shader_(self, self->geometry, GL_GEOMETRY_SHADER);
+        if (!shaders[2]) { _cleanup_shaders_(program, shaders, attached); return 0; }
+    }
+
+    // Линкуем программу:
+    for (int i = 0; i < 3; ++i) {
+        if (shaders[i]) {
+            glAttachShader(program, shaders[i]);
+            attached[i] = true;
+        }
+    }
+    glLinkProgram(program);
+
+    // Проверяем статус линковки:
+    int linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char *log_msg_str = _get_shader_info_log_(program, true);
+        _shader_set_error_(self, "ShaderLinkingError:\n%s\n", log_msg_str);
+        mm_free(log_msg_str);
+        _cleanup_shaders_(program, shaders, attached);
+        return 0;
+    }
+
+    // Удаляем отдельные шейдеры:
+    for (int i = 0; i < 3; ++i) {
+        if (shaders[i]) {
+            if (attached[i]) glDetachShader(program, shaders[i]);
+            glDeleteShader(shaders[i]);
+        }
+    }
+    return program;
+}
+
+// Горячая перезагрузка: прочитать исходник стадии (фоновый поток):
+static void* _import_source_(const char *path) {
+    return Files_load(path, "r");
+}
+
+// Горячая перезагрузка: освободить прочитанный исходник:
+static void _release_source_(void *data) {
+    mm_free(data);
+}
+
+// Горячая перезагрузка: заменить исходник стадии и пересобрать программу (при ошибке остаётся старая):
+static bool _apply_source_(void *target, void *data, intptr_t stage) {
+    Shader *self = (Shader*)target;
+    const char **fields[3] = { &self->vertex, &self->fragment, &self->geometry };
+    if (stage < 0 || stage > 2) return false;
+    if (self->_sources_[stage]) mm_free(self->_sources_[stage]);
+    self->_sources_[stage] = mm_strdup((const char*)data);
+    *fields[stage] = self->_sources_[stage];
+
+    uint32_t program = _build_program_(self);
+    if (!program) return false;  // Ошибка уже в логе и в self->error.
+
+    // Запоминаем значения юниформов по именам (в новой программе другие локации):
+    Array *saved = Array_create(sizeof(ShaderCacheUniformValue), 16);
+    Array *names = Array_create(sizeof(char*), 16);
+    for (size_t i = 0; i < Array_len(self->uniform_values); i++) {
+        ShaderCacheUniformValue *value = (ShaderCacheUniformValue*)Array_get(self->uniform_values, i);
+        for (size_t j = 0; j < Array_len(self->uniform_locations); j++) {
+            ShaderCacheUniformLocation *u = (ShaderCacheUniformLocation*)Array_get(self->uniform_locations, j);
+            if (u->location != value->location) continue;
+            char *name = mm_strdup(u->name);
+            Array_push(saved, value);
+            Array_push(names, &name);
+            break;
+        }
+    }
+
+    // Подменяем программу:
+    _clear_caches_(self, false);
+    if (self->id) glDeleteProgram(self->id);
+    self->id = program;
+
+    // Возвращаем значения юниформов:
+    Shader_begin(self);
+    for (size_t i = 0; i < Array_len(saved); i++) {
+        ShaderCacheUniformValue *v = (ShaderCacheUniformValue*)Array_get(saved, i);
+        char *name = (char*)Array_get_ptr(names, i);
+        switch (v->type) {
+            case SHADERCACHE_UNIFORM_BOOL:  Shader_set_bool(self, name, v->vbool); break;
+            case SHADERCACHE_UNIFORM_INT:   Shader_set_int(self, name, v->vint); break;
+            case SHADERCACHE_UNIFORM_FLOAT: Shader_set_float(self, name, v->vfloat); break;
+            case SHADERCACHE_UNIFORM_VEC2:  Shader_set_vec2(self, name, (Vec2f){v->vec2[0], v->vec2[1]}); break;
+            case SHADERCACHE_UNIFORM_VEC3:  Shader_set_vec3(self, name, (Vec3f){v->vec3[0], v->vec3[1], v->vec3[2]}); break;
+            case SHADERCACHE_UNIFORM_VEC4:
+                Shader_set_vec4(self, name, (Vec4f){v->vec4[0], v->vec4[1], v->vec4[2], v->vec4[3]});
+                break;
+        }
+        mm_free(name);
+    }
+    Shader_end(self);
+    Array_destroy(&saved);
+    Array_destroy(&names);
+    return true;
+}
+
+// Обработчик горячей перезагрузки шейдеров:
+static const HotReloadHandler g_ShaderReload = {
+    .name = "shader", .import = _import_source_, .apply = _apply_source_, .release = _release_source_,
+};
+
 static void _set_sampler_(Shader *self, const char* name, uint32_t tex_id, TextureType type) {
     int32_t loc = Shader_get_location(self, name);
     if (loc < 0) return; // Униформа не найдена.
@@ -223,6 +347,7 @@ Shader* Shader_create(Renderer *renderer, const char *vert, const char *frag, co
     shader->vertex = vert;
     shader->fragment = frag;
     shader->geometry = geom;
+    shader->_sources_[0] = shader->_sources_[1] = shader->_sources_[2] = NULL;
     shader->error = NULL;
     shader->id = 0;
     shader->renderer = renderer;
@@ -234,9 +359,38 @@ Shader* Shader_create(Renderer *renderer, const char *vert, const char *frag, co
     return shader;
 }
 
+// Загрузить шейдерную программу из файлов (geom может быть NULL). Следит за файлами, если запущен HotReload:
+Shader* Shader_load(Renderer *renderer, const char *vert_path, const char *frag_path, const char *geom_path) {
+    if (!renderer || !vert_path || !frag_path) return NULL;
+
+    // Читаем исходники:
+    const char *paths[3] = { vert_path, frag_path, geom_path };
+    char *sources[3] = { NULL, NULL, NULL };
+    for (int i = 0; i < 3; i++) {
+        if (!paths[i]) continue;
+        sources[i] = Files_load(paths[i], "r");
+        if (sources[i]) continue;
+        log_msg("[E] Shader_load: File \"%s\" not found.\n", paths[i]);
+        for (int j = 0; j < i; j++) if (sources[j]) mm_free(sources[j]);
+        return NULL;
+    }
+
+    // Создаём и компилируем (исходники остаются у шейдера):
+    Shader *shader = Shader_create(renderer, sources[0], sources[1], sources[2]);
+    for (int i = 0; i < 3; i++) shader->_sources_[i] = sources[i];
+    Shader_compile(shader);
+
+    // Следим за файлами (даже при ошибке компиляции - исправленный файл подхватится):
+    for (int i = 0; i < 3; i++) {
+        if (paths[i]) HotReload_watch(paths[i], &g_ShaderReload, shader, i);
+    }
+    return shader;
+}
+
 // Уничтожить шейдерную программу:
 void Shader_destroy(Shader **shader) {
     if (!shader || !*shader) return;
+    HotReload_unwatch(*shader);
 
     // Освобождаем кэш:
     _clear_caches_(*shader, true);
@@ -249,6 +403,7 @@ void Shader_destroy(Shader **shader) {
     }
 
     // Освобождаем структуру:
+    for (int i = 0; i < 3; i++) if ((*shader)->_sources_[i]) mm_free((*shader)->_sources_[i]);
     if ((*shader)->error) mm_free((*shader)->error);
     mm_free(*shader);
     *shader = NULL;
@@ -276,54 +431,9 @@ void Shader_compile(Shader *self) {
         self->id = 0;
     }
 
-    // Создаём шейдерную программу:
-    uint32_t program = glCreateProgram();
-    uint32_t shaders[3] = {0};
-    bool attached[3] = {false, false, false};
-
-    if (!program) {
-        _shader_set_error_(self, "ShaderCreateError: The OpenGL context has not been created or is inactive.\n");
-        return;
-    }
-
-    // Компилируем шейдеры:
-    shaders[0] = _compile_shader_(self, self->vertex, GL_VERTEX_SHADER);
-    if (!shaders[0]) { _cleanup_shaders_(program, shaders, attached); return; }
-    shaders[1] = _compile_shader_(self, self->fragment, GL_FRAGMENT_SHADER);
-    if (!shaders[1]) { _cleanup_shaders_(program, shaders, attached); return; }
-    if (self->geometry) {
-        shaders[2] = _compile_shader_(self, self->geometry, GL_GEOMETRY_SHADER);
-        if (!shaders[2]) { _cleanup_shaders_(program, shaders, attached); return; }
-    }
-
-    // Линкуем программу:
-    for (int i = 0; i < 3; ++i) {
-        if (shaders[i]) {
-            glAttachShader(program, shaders[i]);
-            attached[i] = true;
-        }
-    }
-    glLinkProgram(program);
-
-    // Проверяем статус линковки:
-    int linked = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        char *log_msg_str = _get_shader_info_log_(program, true);
-        _shader_set_error_(self, "ShaderLinkingError:\n%s\n", log_msg_str);
-        mm_free(log_msg_str);
-        _cleanup_shaders_(program, shaders, attached);
-        return;
-    }
-
-    // Удаляем отдельные шейдеры:
-    for (int i = 0; i < 3; ++i) {
-        if (shaders[i]) {
-            if (attached[i]) glDetachShader(program, shaders[i]);
-            glDeleteShader(shaders[i]);
-        }
-    }
-    self->id = program;
+    // Собираем новую программу:
+    self->id = _build_program_(self);
+    if (!self->id) return;
 
     // Очищаем кэш:
     _clear_caches_(self, false);
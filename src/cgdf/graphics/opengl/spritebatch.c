@@ -8,6 +8,8 @@
 #include <cgdf/core/math.h>
 #include <cgdf/core/mm.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/profiler.h>
+#include <cgdf/core/counters.h>
 #include "../core/camera.h"
 #include "../core/shader.h"
 #include "../core/spritebatch.h"
@@ -67,6 +69,7 @@ static void _batch_flush_(SpriteBatch *self) {
         self->vertex_count = 0;
         return;
     }
+    PROFILE_ZONE("SpriteBatch flush");
 
     // Обновляем в шейдере текстуру (предположительно, шейдер уже должен быть активен после вызова SpriteBatch_begin):
     Shader *shader = self->renderer->shader_spritebatch;
@@ -78,6 +81,8 @@ static void _batch_flush_(SpriteBatch *self) {
 
     // Рисуем (буфер VAO должен быть активен):
     glDrawElements(GL_TRIANGLES, BATCH_INDCS_PER_SPRITE * self->sprite_count, GL_UNSIGNED_INT, 0);
+    COUNTER_INC("gl.draw_calls");
+    COUNTER_ADD("spritebatch.sprites", self->sprite_count);
 
     // Сбрасываем данные:
     self->sprite_count = 0;
@@ -0,0 +1,65 @@
+//
+// texstream.c - Загрузка уровней потоковых текстур в OpenGL (обработчик TexStream по умолчанию).
+//
+// Несжатые уровни идут через кольцо загрузки рендерера (TexUpload), сжатые - прямо из отображения файла.
+//
+
+
+// Подключаем:
+#include <cgdf/core/std.h>
+#include <cgdf/core/texfile.h>
+#include "../core/renderer.h"
+#include "../core/texture.h"
+#include "../core/texupload.h"
+#include "../core/texstream.h"
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Создать текстуру без уровней:
+static Texture* backend_create(void *user, const TexFile *file) {
+    Texture *texture = Texture_create((Renderer*)user);
+    Texture_prepare_texfile(texture, file);
+    if (texture && texture->id == 0) Texture_destroy(&texture);
+    return texture;
+}
+
+// Загрузить уровень:
+static size_t backend_upload(void *user, Texture *texture, const TexFile *file, int level) {
+    return Texture_load_texfile_level(texture, file, level, ((Renderer*)user)->uploads);
+}
+
+// Освободить уровень:
+static void backend_evict(void *user, Texture *texture, int level) {
+    (void)user;
+    Texture_unload_level(texture, level);
+}
+
+// Уровни, из которых читать:
+static void backend_set_levels(void *user, Texture *texture, int base_level, int max_level) {
+    (void)user;
+    Texture_set_level_range(texture, base_level, max_level);
+}
+
+// Уничтожить текстуру:
+static void backend_destroy(void *user, Texture *texture) {
+    (void)user;
+    Texture_destroy(&texture);
+}
+
+
+// -------- API потоковых текстур: --------
+
+
+// Получить обработчик загрузки в Texture через кольцо загрузки рендерера:
+TexStreamBackend TexStream_get_default_backend(Renderer *renderer) {
+    return (TexStreamBackend){
+        .user = renderer,
+        .create = backend_create,
+        .upload = backend_upload,
+        .evict = backend_evict,
+        .set_levels = backend_set_levels,
+        .destroy = backend_destroy,
+    };
+}
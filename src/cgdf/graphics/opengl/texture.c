@@ -7,14 +7,30 @@
 #include <cgdf/core/std.h>
 #include <cgdf/core/mm.h>
 #include <cgdf/core/pixmap.h>
+#include <cgdf/core/mipmap.h>
+#include <cgdf/core/bcn.h>
+#include <cgdf/core/texfile.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/hotreload.h>
 #include "../core/renderer.h"
 #include "../core/texture.h"
+#include "../core/texupload.h"
 #include "buffer_gc.h"
 #include "texunit.h"
 #include "gl.h"
 
 
+// Форматы S3TC (расширения GL_EXT_texture_compression_s3tc и GL_EXT_texture_sRGB, в glad их нет):
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT       0x83F1
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT       0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+
 // -------- Вспомогательные функции: --------
 
 
@@ -41,6 +57,7 @@ static int get_internal_format(TextureInternalFormat internal) {
         case TEX_INTERNAL_RGB8:                return GL_RGB8;
         case TEX_INTERNAL_RGBA8:               return GL_RGBA8;
         case TEX_INTERNAL_R16F:                return GL_R16F;
+        case TEX_INTERNAL_RG16F:               return GL_RG16F;
         case TEX_INTERNAL_RGB16F:              return GL_RGB16F;
         case TEX_INTERNAL_RGBA16F:             return GL_RGBA16F;
         case TEX_INTERNAL_RGB32F:              return GL_RGB32F;
@@ -51,6 +68,14 @@ static int get_internal_format(TextureInternalFormat internal) {
         case TEX_INTERNAL_DEPTH24:             return GL_DEPTH_COMPONENT24;
         case TEX_INTERNAL_DEPTH32F:            return GL_DEPTH_COMPONENT32F;
         case TEX_INTERNAL_DEPTH24_STENCIL8:    return GL_DEPTH24_STENCIL8;
+        case TEX_INTERNAL_BC1:                 return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case TEX_INTERNAL_BC1_SRGB:            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case TEX_INTERNAL_BC3:                 return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TEX_INTERNAL_BC3_SRGB:            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case TEX_INTERNAL_BC4:                 return GL_COMPRESSED_RED_RGTC1;
+        case TEX_INTERNAL_BC5:                 return GL_COMPRESSED_RG_RGTC2;
+        case TEX_INTERNAL_BC7:                 return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case TEX_INTERNAL_BC7_SRGB:            return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
         default:                               return GL_RGBA8;
     }
 }
@@ -58,17 +83,24 @@ static int get_internal_format(TextureInternalFormat internal) {
 // Подбираем тип данных текстуры:
 static int get_data_type(TextureDataType dtype) {
     switch (dtype) {
-        case TEX_DATA_UBYTE:   return GL_UNSIGNED_BYTE;
-        case TEX_DATA_BYTE:    return GL_BYTE;
-        case TEX_DATA_USHORT:  return GL_UNSIGNED_SHORT;
-        case TEX_DATA_SHORT:   return GL_SHORT;
-        case TEX_DATA_UINT:    return GL_UNSIGNED_INT;
-        case TEX_DATA_INT:     return GL_INT;
-        case TEX_DATA_FLOAT:   return GL_FLOAT;
-        default:               return GL_UNSIGNED_BYTE;
+        case TEX_DATA_UBYTE:      return GL_UNSIGNED_BYTE;
+        case TEX_DATA_BYTE:       return GL_BYTE;
+        case TEX_DATA_USHORT:     return GL_UNSIGNED_SHORT;
+        case TEX_DATA_SHORT:      return GL_SHORT;
+        case TEX_DATA_UINT:       return GL_UNSIGNED_INT;
+        case TEX_DATA_INT:        return GL_INT;
+        case TEX_DATA_FLOAT:      return GL_FLOAT;
+        case TEX_DATA_HALF_FLOAT: return GL_HALF_FLOAT;
+        default:                  return GL_UNSIGNED_BYTE;
     }
 }
 
+// Тип данных пикселей картинки:
+static TextureDataType get_pixmap_data_type(const Pixmap *pixmap) {
+    if (!pixmap->is_hdr) return TEX_DATA_UBYTE;
+    return pixmap->is_half ? TEX_DATA_HALF_FLOAT : TEX_DATA_FLOAT;
+}
+
 // Размер одного пикселя internal format:
 static size_t bytes_per_internal(TextureInternalFormat internal)
 {
@@ -80,6 +112,7 @@ static size_t bytes_per_internal(TextureInternalFormat internal)
         case TEX_INTERNAL_RGBA8:    return 4;
 
         case TEX_INTERNAL_R16F:     return 2;
+        case TEX_INTERNAL_RG16F:    return 4;
         case TEX_INTERNAL_RGB16F:   return 6;
         case TEX_INTERNAL_RGBA16F:  return 8;
 
@@ -97,13 +130,75 @@ static size_t bytes_per_internal(TextureInternalFormat internal)
     }
 }
 
+// Размер блока 4x4 сжатого формата (0 - формат не сжатый):
+static size_t get_block_size(TextureInternalFormat internal) {
+    switch (internal) {
+        case TEX_INTERNAL_BC1:
+        case TEX_INTERNAL_BC1_SRGB:
+        case TEX_INTERNAL_BC4:      return 8;
+        case TEX_INTERNAL_BC3:
+        case TEX_INTERNAL_BC3_SRGB:
+        case TEX_INTERNAL_BC5:
+        case TEX_INTERNAL_BC7:
+        case TEX_INTERNAL_BC7_SRGB: return 16;
+        default:                    return 0;
+    }
+}
+
+// Размер одного уровня текстуры в байтах:
+static size_t get_level_size(TextureInternalFormat internal, int width, int height) {
+    size_t block = get_block_size(internal);
+    if (block) return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * block;
+    return (size_t)width * (size_t)height * bytes_per_internal(internal);
+}
+
+// Сжатый внутренний формат для блочного формата:
+static TextureInternalFormat get_compressed_internal(BCFormat format, bool srgb) {
+    switch (format) {
+        case BC_FORMAT_BC1: return srgb ? TEX_INTERNAL_BC1_SRGB : TEX_INTERNAL_BC1;
+        case BC_FORMAT_BC3: return srgb ? TEX_INTERNAL_BC3_SRGB : TEX_INTERNAL_BC3;
+        case BC_FORMAT_BC4: return TEX_INTERNAL_BC4;
+        case BC_FORMAT_BC5: return TEX_INTERNAL_BC5;
+        default:            return srgb ? TEX_INTERNAL_BC7_SRGB : TEX_INTERNAL_BC7;
+    }
+}
+
+// Форматы несжатой текстуры по каналам картинки (sRGB форматы есть только у 8-битных RGB и RGBA):
+static void get_channel_formats(
+    int channels, bool is_hdr, bool srgb, TextureFormat *out_format, TextureInternalFormat *out_internal
+) {
+    TextureFormat format = TEX_FORMAT_RGBA;
+    TextureInternalFormat internal = TEX_INTERNAL_RGBA8;
+    switch (channels) {
+        case PIXMAP_R:    { format = TEX_FORMAT_R;    internal = is_hdr ? TEX_INTERNAL_R16F : TEX_INTERNAL_R8; break; }
+        case PIXMAP_RG:   { format = TEX_FORMAT_RG;   internal = is_hdr ? TEX_INTERNAL_RG16F : TEX_INTERNAL_RG8; break; }
+        case PIXMAP_RGB:  { format = TEX_FORMAT_RGB;  internal = is_hdr ? TEX_INTERNAL_RGB16F : TEX_INTERNAL_RGB8; break; }
+        default:          { format = TEX_FORMAT_RGBA; internal = is_hdr ? TEX_INTERNAL_RGBA16F : TEX_INTERNAL_RGBA8; break; }
+    }
+    if (srgb && !is_hdr && internal == TEX_INTERNAL_RGB8) internal = TEX_INTERNAL_SRGB8;
+    if (srgb && !is_hdr && internal == TEX_INTERNAL_RGBA8) internal = TEX_INTERNAL_SRGBA8;
+    *out_format = format;
+    *out_internal = internal;
+}
+
+// Есть ли расширение OpenGL:
+static bool has_gl_extension(const char *name) {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; i++) {
+        const char *ext = (const char*)glGetStringi(GL_EXTENSIONS, (uint32_t)i);
+        if (ext && strcmp(ext, name) == 0) return true;
+    }
+    return false;
+}
+
 // Получить размер текстуры:
 static size_t get_tex_size(Texture *self) {
     if (!self) return 0;
     size_t total = 0;
     int width = self->width, height = self->height;
     while (true) {
-        total += width * height * bytes_per_internal(self->internal);
+        total += get_level_size(self->internal, width, height);
         if (!self->has_mipmap) break;
         if (width == 1 && height == 1) break;
         width  = width  > 1 ? width  / 2 : 1;
@@ -112,6 +207,127 @@ static size_t get_tex_size(Texture *self) {
     return total;
 }
 
+// Декодировать картинку для текстуры. HDR переводится в half float RGBA: вдвое меньше памяти и данных
+// на загрузку, и драйвер получает RGBA16F как есть, без своего преобразования:
+static Pixmap* decode_pixmap(const char *path) {
+    Pixmap *img = Pixmap_load(path, PIXMAP_RGBA);
+    if (img && img->is_hdr) Pixmap_to_half(img, PIXMAP_RGBA);
+    return img;
+}
+
+// Горячая перезагрузка: декодировать картинку (фоновый поток):
+static void* import_pixmap(const char *path) {
+    return decode_pixmap(path);
+}
+
+// Горячая перезагрузка: загрузить картинку в ту же текстуру (айди не меняется):
+static bool apply_pixmap(void *target, void *data, intptr_t use_mipmap) {
+    Texture_load_pixmap((Texture*)target, (Pixmap*)data, use_mipmap != 0);
+    return true;
+}
+
+// Горячая перезагрузка: освободить картинку:
+static void release_pixmap(void *data) {
+    Pixmap *pixmap = (Pixmap*)data;
+    Pixmap_destroy(&pixmap);
+}
+
+// Обработчик горячей перезагрузки текстур:
+static const HotReloadHandler g_TextureReload = {
+    .name = "texture", .import = import_pixmap, .apply = apply_pixmap, .release = release_pixmap,
+};
+
+// Загрузить уровни открытого файла текстуры:
+static void upload_texfile(Texture *self, const TexFile *file) {
+    if (TexFileFormat_is_compressed(file->format)) {
+        TextureInternalFormat internal = get_compressed_internal(TexFileFormat_get_bc(file->format), file->srgb);
+        if (Texture_is_compression_supported(internal)) {
+            for (int i = 0; i < file->count; i++) {
+                const TexFileLevel *level = &file->levels[i];
+                Texture_set_compressed(self, i, level->width, level->height, internal, level->data, level->size);
+                if (self->id == 0) break;
+            }
+            return;
+        }
+
+        // Видеокарта не умеет формат - распаковываем уровни на процессоре:
+        log_msg(
+            "[W] Texture_load_texfile: %s is not available, the texture is decoded on the CPU.\n",
+            TexFileFormat_get_name(file->format)
+        );
+        MipChain chain = { 0 };
+        for (int i = 0; i < file->count; i++) {
+            chain.levels[i] = TexFile_get_pixmap(file, i);
+            if (!chain.levels[i]) break;
+            chain.count++;
+        }
+        Texture_load_mips(self, &chain, file->srgb);
+        for (int i = 0; i < chain.count; i++) Pixmap_destroy(&chain.levels[i]);
+        return;
+    }
+
+    // Несжатые уровни отдаём прямо из отображения (картинки-обёртки без своих данных):
+    Pixmap views[MIPMAP_MAX_LEVELS];
+    MipChain chain = { .count = file->count };
+    for (int i = 0; i < file->count; i++) {
+        views[i] = (Pixmap){
+            .width = file->levels[i].width,
+            .height = file->levels[i].height,
+            .channels = TexFileFormat_get_channels(file->format),
+            .from_stbi = false,
+            .is_hdr = TexFileFormat_is_hdr(file->format),
+            .is_half = TexFileFormat_is_half(file->format),
+            .data = (void*)file->levels[i].data,
+        };
+        chain.levels[i] = &views[i];
+    }
+    Texture_load_mips(self, &chain, file->srgb);
+}
+
+// Форматы текстуры для уровней файла текстуры (сжатые без поддержки видеокарты распаковываются в 8 бит):
+static void get_texfile_formats(
+    const TexFile *file, TextureFormat *out_format, TextureInternalFormat *out_internal, TextureDataType *out_dtype
+) {
+    *out_dtype = TEX_DATA_UBYTE;
+    if (TexFileFormat_is_compressed(file->format)) {
+        TextureInternalFormat internal = get_compressed_internal(TexFileFormat_get_bc(file->format), file->srgb);
+        if (Texture_is_compression_supported(internal)) {
+            *out_internal = internal;
+            *out_format = internal == TEX_INTERNAL_BC4 ? TEX_FORMAT_R : (internal == TEX_INTERNAL_BC5 ? TEX_FORMAT_RG : TEX_FORMAT_RGBA);
+            return;
+        }
+    }
+    bool is_hdr = TexFileFormat_is_hdr(file->format);
+    get_channel_formats(TexFileFormat_get_channels(file->format), is_hdr, file->srgb, out_format, out_internal);
+    if (is_hdr) *out_dtype = TexFileFormat_is_half(file->format) ? TEX_DATA_HALF_FLOAT : TEX_DATA_FLOAT;
+}
+
+// Горячая перезагрузка: открыть файл текстуры (фоновый поток):
+static void* import_texfile(const char *path) {
+    TexFile *file = (TexFile*)mm_alloc(sizeof(TexFile));
+    if (TexFile_open(path, file)) return file;
+    mm_free(file);
+    return NULL;
+}
+
+// Горячая перезагрузка: загрузить уровни файла в ту же текстуру (айди не меняется):
+static bool apply_texfile(void *target, void *data, intptr_t tag) {
+    (void)tag;
+    upload_texfile((Texture*)target, (const TexFile*)data);
+    return true;
+}
+
+// Горячая перезагрузка: закрыть файл текстуры:
+static void release_texfile(void *data) {
+    TexFile_close((TexFile*)data);
+    mm_free(data);
+}
+
+// Обработчик горячей перезагрузки файлов текстур:
+static const HotReloadHandler g_TexFileReload = {
+    .name = "texfile", .import = import_texfile, .apply = apply_texfile, .release = release_texfile,
+};
+
 
 // -------- API текстуры: --------
 
@@ -128,6 +344,7 @@ Texture* Texture_create(Renderer *renderer) {
     texture->height = 1;
     texture->channels = 4;
     texture->has_mipmap = false;
+    texture->explicit_mips = false;
     texture->_is_begin_ = false;
     texture->format = TEX_FORMAT_RGBA;
     texture->internal = TEX_INTERNAL_RGBA8;
@@ -141,6 +358,7 @@ Texture* Texture_create(Renderer *renderer) {
 // Уничтожить текстуру:
 void Texture_destroy(Texture **texture) {
     if (!texture || !*texture) return;
+    HotReload_unwatch(*texture);
 
     // Удаляем саму текстуру:
     Texture_end(*texture);
@@ -190,37 +408,28 @@ void Texture_empty(
 
 // Загрузить текстуру (из файла):
 void Texture_load(Texture *self, const char *filepath, bool use_mipmap) {
-    Pixmap *img = Pixmap_load(filepath, PIXMAP_RGBA);
+    Pixmap *img = decode_pixmap(filepath);
     if (!img) return;
+    Texture_load_decoded(self, filepath, img, use_mipmap);
+    Pixmap_destroy(&img);
+}
 
+// Загрузить текстуру из уже декодированного файла (Pixmap_load_many). Следит за файлом, если запущен HotReload:
+void Texture_load_decoded(Texture *self, const char *filepath, Pixmap *img, bool use_mipmap) {
+    if (!self || !img) return;
     TextureFormat format = TEX_FORMAT_RGBA;
     TextureInternalFormat internal = TEX_INTERNAL_RGBA8;
     TextureDataType dtype = TEX_DATA_UBYTE;
 
     // Определяем формат текстуры:
-    switch (img->channels) {
-        case PIXMAP_R:    { format = TEX_FORMAT_R; break; }
-        case PIXMAP_RG:   { format = TEX_FORMAT_RG; break; }
-        case PIXMAP_RGB:  { format = TEX_FORMAT_RGB; break; }
-        case PIXMAP_RGBA: { format = TEX_FORMAT_RGBA; break; }
-        default: break;
-    }
-
-    // Определяем внутренний формат текстуры:
-    if (img->is_hdr) {
-        dtype = TEX_DATA_FLOAT;
-        internal = (format == TEX_FORMAT_RGBA) ? TEX_INTERNAL_RGBA16F : TEX_INTERNAL_RGB16F;
-    } else {
-        switch (format) {
-            case TEX_FORMAT_RGBA: internal = TEX_INTERNAL_RGBA8; break;
-            case TEX_FORMAT_RGB:  internal = TEX_INTERNAL_RGB8;  break;
-            case TEX_FORMAT_RG:   internal = TEX_INTERNAL_RG8;   break;
-            default:              internal = TEX_INTERNAL_R8;    break;
-        }
-    }
+    get_channel_formats(img->channels, img->is_hdr, false, &format, &internal);
+    if (img->is_hdr) dtype = img->is_half ? TEX_DATA_HALF_FLOAT : TEX_DATA_FLOAT;
 
     Texture_set_data(self, img->width, img->height, img->data, use_mipmap, format, internal, dtype);
-    Pixmap_destroy(&img);
+
+    // Следим за файлом (если запущена горячая перезагрузка):
+    HotReload_unwatch(self);
+    HotReload_watch(filepath, &g_TextureReload, self, use_mipmap);
 }
 
 // Загрузить текстуру (из картинки):
@@ -228,33 +437,195 @@ void Texture_load_pixmap(Texture *self, Pixmap *pixmap, bool use_mipmap) {
     if (!self || !pixmap) return;
 
     // Подбираем формат данных:
-    TextureFormat tex_format = TEX_FORMAT_RGBA;
-    TextureInternalFormat tex_internal = TEX_INTERNAL_RGBA8;
-    switch (pixmap->channels) {
-        case PIXMAP_R:    { tex_format = TEX_FORMAT_R;    tex_internal = TEX_INTERNAL_R8; break; }
-        case PIXMAP_RG:   { tex_format = TEX_FORMAT_RG;   tex_internal = TEX_INTERNAL_RG8; break; }
-        case PIXMAP_RGB:  { tex_format = TEX_FORMAT_RGB;  tex_internal = TEX_INTERNAL_RGB8; break; }
-        case PIXMAP_RGBA: { tex_format = TEX_FORMAT_RGBA; tex_internal = TEX_INTERNAL_RGBA8; break; }
-        default:          { tex_format = TEX_FORMAT_RGBA; tex_internal = TEX_INTERNAL_RGBA8; break; }
-    }
-
-    // Если это HDR:
-    if (pixmap->is_hdr) {
-        switch (pixmap->channels) {
-            case PIXMAP_R:    { tex_internal = TEX_INTERNAL_R16F; break; }
-            case PIXMAP_RGB:  { tex_internal = TEX_INTERNAL_RGB16F; break; }
-            case PIXMAP_RGBA: { tex_internal = TEX_INTERNAL_RGBA16F; break; }
-            default:          { tex_internal = TEX_INTERNAL_RGB16F; break; }
-        }
-    }
+    TextureFormat tex_format;
+    TextureInternalFormat tex_internal;
+    get_channel_formats(pixmap->channels, pixmap->is_hdr, false, &tex_format, &tex_internal);
 
     // Выделяем память под данные:
     Texture_set_data(
         self, pixmap->width, pixmap->height, pixmap->data, use_mipmap,
-        tex_format, tex_internal, pixmap->is_hdr ? TEX_DATA_FLOAT : TEX_DATA_UBYTE
+        tex_format, tex_internal, get_pixmap_data_type(pixmap)
     );
 }
 
+// Загрузить текстуру с готовой цепочкой мипмапов (Pixmap_generate_mips). srgb - хранить цвет в sRGB формате:
+void Texture_load_mips(Texture *self, const MipChain *chain, bool srgb) {
+    if (!self || !chain || chain->count <= 0) return;
+    const Pixmap *base = chain->levels[0];
+
+    // Подбираем формат данных:
+    TextureFormat format;
+    TextureInternalFormat internal;
+    get_channel_formats(base->channels, base->is_hdr, srgb, &format, &internal);
+    TextureDataType dtype = get_pixmap_data_type(base);
+
+    // Нулевой уровень создаёт текстуру, остальные догружаем:
+    Texture_set_data(self, base->width, base->height, base->data, false, format, internal, dtype);
+    if (self->id == 0) return;
+    if (self->width != base->width || self->height != base->height) {
+        log_msg("[W] Texture_load_mips: The base level was clamped, mip levels are skipped.\n");
+        return;
+    }
+    int gl_format    = get_format(format);
+    int gl_internal  = get_internal_format(internal);
+    int gl_data_type = get_data_type(dtype);
+
+    Texture_begin(self);
+    int prev_unpack = 0;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_unpack);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Строки уровней не выровнены на 4 байта.
+    size_t size = (size_t)self->width * (size_t)self->height * bytes_per_internal(internal);
+    for (int i = 1; i < chain->count; i++) {
+        const Pixmap *level = chain->levels[i];
+        glTexImage2D(GL_TEXTURE_2D, i, gl_internal, level->width, level->height, 0, gl_format, gl_data_type, level->data);
+        size += (size_t)level->width * (size_t)level->height * bytes_per_internal(internal);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, prev_unpack);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, chain->count - 1);
+
+    self->has_mipmap = chain->count > 1;
+    self->explicit_mips = true;
+    Texture_set_linear(self);
+    self->size = size;
+    Texture_end(self);
+}
+
+// Загрузить текстуру с готовой цепочкой мипмапов, сжав каждый уровень в BCn (settings = NULL - BC7, качественно):
+void Texture_load_mips_compressed(Texture *self, const MipChain *chain, const BCSettings *settings, bool srgb) {
+    if (!self || !chain || chain->count <= 0) return;
+    BCSettings opts = settings ? *settings : (BCSettings){ BC_FORMAT_BC7, BC_QUALITY_HIGH, 0 };
+    TextureInternalFormat internal = get_compressed_internal(opts.format, srgb);
+
+    // Без поддержки формата (например, BC7 на OpenGL 4.1) или для HDR загружаем без сжатия:
+    if (chain->levels[0]->is_hdr || !Texture_is_compression_supported(internal)) {
+        log_msg(
+            "[W] Texture_load_mips_compressed: %s is not available, the texture is uploaded uncompressed.\n",
+            BCFormat_get_name(opts.format)
+        );
+        Texture_load_mips(self, chain, srgb);
+        return;
+    }
+    for (int i = 0; i < chain->count; i++) {
+        BCImage *image = BCImage_encode(chain->levels[i], &opts);
+        if (!image) break;
+        Texture_set_compressed(self, i, image->width, image->height, internal, image->data, image->size);
+        BCImage_destroy(&image);
+        if (self->id == 0) break;
+    }
+}
+
+// Загрузить текстуру из файла текстуры (TexFile_save). Уровни отдаются в видеокарту прямо из отображения файла:
+void Texture_load_texfile(Texture *self, const char *filepath) {
+    if (!self || !filepath) return;
+    TexFile file;
+    if (!TexFile_open(filepath, &file)) return;
+    upload_texfile(self, &file);
+    TexFile_close(&file);
+
+    // Следим за файлом (если запущена горячая перезагрузка):
+    HotReload_unwatch(self);
+    HotReload_watch(filepath, &g_TexFileReload, self, 0);
+}
+
+// Подготовить текстуру к загрузке уровней файла текстуры по одному (уровни не заданы, читать её ещё нельзя):
+void Texture_prepare_texfile(Texture *self, const TexFile *file) {
+    if (!self || !file || file->count <= 0) return;
+
+    // Старые уровни не нужны, поэтому текстуру пересоздаём:
+    if (self->id != 0) {
+        Texture_end(self);
+        BufferGC_GL_push(BGC_GL_TBO, self->id);
+        TexUnits_invalidate_texture(self->id);
+        self->id = 0;
+    }
+    glGenTextures(1, &self->id);
+    if (self->id == 0) {
+        log_msg("[E] Texture_prepare_texfile: The texture could not be created.\n");
+        return;
+    }
+    get_texfile_formats(file, &self->format, &self->internal, &self->dtype);
+    self->width = file->width;
+    self->height = file->height;
+    self->channels = TexFileFormat_get_channels(file->format);
+    self->has_mipmap = file->count > 1;
+    self->explicit_mips = true;
+    self->size = 0;
+
+    // Пока уровней нет, видеокарта читает только из самого маленького:
+    Texture_begin(self);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, file->count - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, file->count - 1);
+    Texture_set_linear(self);
+    Texture_end(self);
+}
+
+// Загрузить один уровень файла текстуры (upload = NULL - напрямую). Возвращает размер уровня в видеопамяти:
+size_t Texture_load_texfile_level(Texture *self, const TexFile *file, int level, TexUpload *upload) {
+    if (!self || self->id == 0 || !file || level < 0 || level >= file->count) return 0;
+    const TexFileLevel *data = &file->levels[level];
+    size_t size = get_level_size(self->internal, data->width, data->height);
+
+    // Сжатые уровни отдаём прямо из отображения файла:
+    if (get_block_size(self->internal)) {
+        Texture_begin(self);
+        glCompressedTexImage2D(
+            GL_TEXTURE_2D, level, get_internal_format(self->internal),
+            data->width, data->height, 0, (int)data->size, data->data
+        );
+        Texture_end(self);
+        self->size += size;
+        return size;
+    }
+
+    // Сжатые уровни без поддержки видеокарты распаковываем на процессоре:
+    Pixmap *decoded = NULL;
+    const void *pixels = data->data;
+    if (TexFileFormat_is_compressed(file->format)) {
+        decoded = TexFile_get_pixmap(file, level);
+        if (!decoded) return 0;
+        pixels = decoded->data;
+    }
+
+    // Уровень создаём пустым, а данные идут через кольцо загрузки (если уровень в него помещается):
+    bool use_ring = upload && !decoded && data->size <= TexUpload_get_size(upload);
+    Texture_begin(self);
+    int prev_unpack = 0;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_unpack);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Строки уровней в файле не выровнены.
+    glTexImage2D(
+        GL_TEXTURE_2D, level, get_internal_format(self->internal), data->width, data->height, 0,
+        get_format(self->format), get_data_type(self->dtype), use_ring ? NULL : pixels
+    );
+    Texture_end(self);
+    if (use_ring) {
+        TexUpload_subdata(upload, self, level, 0, 0, data->width, data->height, self->format, self->dtype, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, prev_unpack);
+    Pixmap_destroy(&decoded);
+    self->size += size;
+    return size;
+}
+
+// Освободить видеопамять уровня текстуры (уровень должен быть вне Texture_set_level_range):
+void Texture_unload_level(Texture *self, int level) {
+    if (!self || self->id == 0 || level < 0) return;
+    int width = self->width >> level, height = self->height >> level;
+    size_t size = get_level_size(self->internal, width > 0 ? width : 1, height > 0 ? height : 1);
+    Texture_begin(self);
+    glTexImage2D(GL_TEXTURE_2D, level, get_internal_format(self->internal), 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    Texture_end(self);
+    self->size = self->size > size ? self->size - size : 0;
+}
+
+// Ограничить уровни, из которых читает видеокарта (base_level - самый большой из них):
+void Texture_set_level_range(Texture *self, int base_level, int max_level) {
+    if (!self || self->id == 0) return;
+    Texture_begin(self);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, base_level > 0 ? base_level : 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, max_level > base_level ? max_level : base_level);
+    Texture_end(self);
+}
+
 // Загрузить текстуру (из файла) расширенный режим:
 void Texture_load_advanced(
     Texture *self, const char *filepath, bool use_mipmap,
@@ -321,6 +692,8 @@ void Texture_set_data(
     self->internal = internal;
     self->dtype = dtype;
     glTexImage2D(GL_TEXTURE_2D, 0, gl_internal, self->width, self->height, 0, gl_format, gl_data_type, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);     // Сбрасываем ограничения уровней
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);  // (Texture_load_mips, Texture_set_level_range).
 
     if (gl_format == GL_RGB || gl_format == GL_BGR) {
         glPixelStorei(GL_UNPACK_ALIGNMENT, prev_unpack);
@@ -328,6 +701,7 @@ void Texture_set_data(
 
     // Если надо использовать мипмапы, создаём их:
     self->has_mipmap = use_mipmap;
+    self->explicit_mips = false;
     if (use_mipmap) glGenerateMipmap(GL_TEXTURE_2D);
 
     // Устанавливаем фильтры по умолчанию:
@@ -338,6 +712,80 @@ void Texture_set_data(
     Texture_end(self);
 }
 
+// Поддерживает ли видеокарта внутренний формат (для сжатых форматов проверяются расширения):
+bool Texture_is_compression_supported(TextureInternalFormat internal) {
+    switch (internal) {
+        case TEX_INTERNAL_BC1:
+        case TEX_INTERNAL_BC3:      return has_gl_extension("GL_EXT_texture_compression_s3tc");
+        case TEX_INTERNAL_BC1_SRGB:
+        case TEX_INTERNAL_BC3_SRGB: {
+            return has_gl_extension("GL_EXT_texture_compression_s3tc") && has_gl_extension("GL_EXT_texture_sRGB");
+        }
+        case TEX_INTERNAL_BC7:
+        case TEX_INTERNAL_BC7_SRGB: return GLAD_GL_VERSION_4_2 || has_gl_extension("GL_ARB_texture_compression_bptc");
+        default:                    return true;  // RGTC (BC4, BC5) есть в OpenGL 3.0, остальные форматы не сжатые.
+    }
+}
+
+// Установить сжатые данные уровня текстуры (BCn). Уровень 0 задаёт размер и формат текстуры:
+void Texture_set_compressed(
+    Texture *self, int miplevel, int width, int height,
+    TextureInternalFormat internal, const void *data, size_t size
+) {
+    if (!self || !data || miplevel < 0) return;
+    if (!get_block_size(internal)) {
+        log_msg("[E] Texture_set_compressed: The internal format %d is not compressed.\n", (int)internal);
+        return;
+    }
+    width = width <= 0 ? 1 : width;
+    height = height <= 0 ? 1 : height;
+    size_t level_size = get_level_size(internal, width, height);
+    if (size < level_size) {
+        log_msg("[E] Texture_set_compressed: Not enough data: %zu bytes, expected %zu.\n", size, level_size);
+        return;
+    }
+
+    // Сжатые данные нельзя уменьшить на лету, поэтому слишком большая текстура не загружается:
+    if (miplevel == 0) {
+        int max_tex_size = Renderer_get_max_texture_size(self->renderer);
+        if (width > max_tex_size || height > max_tex_size) {
+            log_msg(
+                "[E] Texture_set_compressed: The texture is too large. Requested: [w%d x h%d]. Max texture size: [w%d x h%d].\n",
+                width, height, max_tex_size, max_tex_size
+            );
+            return;
+        }
+        if (self->id == 0) glGenTextures(1, &self->id);
+        if (self->id == 0) {
+            log_msg("[E] Texture_set_compressed: The texture could not be created.\n");
+            return;
+        }
+    } else if (self->id == 0 || self->internal != internal) {
+        log_msg("[E] Texture_set_compressed: Level 0 with the same format must be set first.\n");
+        return;
+    }
+
+    Texture_begin(self);
+    glCompressedTexImage2D(GL_TEXTURE_2D, miplevel, get_internal_format(internal), width, height, 0, (int)level_size, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, miplevel);
+    if (miplevel == 0) {
+        self->width = width;
+        self->height = height;
+        self->internal = internal;
+        self->format = internal == TEX_INTERNAL_BC4 ? TEX_FORMAT_R : (internal == TEX_INTERNAL_BC5 ? TEX_FORMAT_RG : TEX_FORMAT_RGBA);
+        self->dtype = TEX_DATA_UBYTE;
+        self->has_mipmap = false;
+        self->explicit_mips = false;
+        self->size = level_size;
+    } else {
+        self->has_mipmap = true;
+        self->explicit_mips = true;
+        self->size += level_size;
+    }
+    Texture_set_linear(self);
+    Texture_end(self);
+}
+
 // Установить данные текстуры (подмассив):
 void Texture_set_subdata(
     Texture *self, int miplevel, int offset_x, int offset_y, int width, int height,
@@ -366,11 +814,8 @@ void Texture_set_subdata(
         glPixelStorei(GL_UNPACK_ALIGNMENT, prev_unpack);
     }
 
-    // Если надо использовать мипмапы, создаём их:
-    if (self->has_mipmap) glGenerateMipmap(GL_TEXTURE_2D);
-
-    // Получаем размер текстуры:
-    self->size = get_tex_size(self);
+    // Если мипмапы генерируются, пересчитываем их (явно заданные уровни не трогаем):
+    if (self->has_mipmap && !self->explicit_mips) glGenerateMipmap(GL_TEXTURE_2D);
     Texture_end(self);
 }
 
@@ -382,6 +827,7 @@ Pixmap* Texture_get_pixmap(Texture *self, int channels) {
     TextureDataType type = TEX_DATA_UBYTE;
     switch (self->internal) {
         case TEX_INTERNAL_R16F:
+        case TEX_INTERNAL_RG16F:
         case TEX_INTERNAL_RGB16F:
         case TEX_INTERNAL_RGBA16F:
         case TEX_INTERNAL_RGB32F:
@@ -22,6 +22,7 @@
 #include <cgdf/core/std.h>
 #include <cgdf/core/array.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/counters.h>
 #include "../core/texture.h"
 #include "../core/renderer.h"
 #include "gl.h"
@@ -242,6 +243,7 @@ int TexUnits_rebind_owned(uint32_t shd_id, int32_t loc_id, uint32_t tex_id, Text
         glActiveTexture(GL_TEXTURE0 + find_unit);
         glBindTexture(gl_type, tex_id);
         glActiveTexture(GL_TEXTURE0);
+        COUNTER_INC("gl.texture_binds");
 
         // Сохраняем новые параметры:
         u->tex_id = tex_id;
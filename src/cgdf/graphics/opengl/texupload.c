@@ -0,0 +1,373 @@
+//
+// texupload.c - Реализация кольца асинхронной загрузки текстур через буфер распаковки (PBO).
+//
+// Положения в кольце считаются монотонными счётчиками байт (смещение в буфере - счётчик по модулю размера):
+// head - конец выделенного, tail - всё до него свободно. Загрузки отдаются видеокарте по мере заполнения
+// (в любом порядке), а issued двигается только по непрерывно отданному началу очереди. Fence кадра закрывает
+// всё до issued, и когда видеокарта его прошла, tail сдвигается на это место. Блок, который не помещается
+// до конца буфера, начинается с нуля, а пропущенный хвост считается частью блока.
+//
+
+
+// Подключаем:
+#include <cgdf/core/std.h>
+#include <cgdf/core/mm.h>
+#include <cgdf/core/array.h>
+#include <cgdf/core/logger.h>
+#include <cgdf/core/counters.h>
+#include <cgdf/core/time.h>
+#include "../core/texture.h"
+#include "../core/texupload.h"
+#include "buffer_gc.h"
+#include "gl.h"
+
+
+// Загрузка в очереди:
+typedef struct UploadEntry {
+    Texture *texture;        // Текстура.
+    int miplevel;            // Уровень мипмапа.
+    int x, y;                // Смещение области.
+    int width, height;       // Размер области.
+    TextureFormat format;    // Формат пикселей.
+    TextureDataType dtype;   // Тип данных пикселей.
+    size_t offset;           // Смещение данных в буфере.
+    size_t size;             // Размер данных.
+    uint64_t end;            // Счётчик head после этого блока.
+    atomic_bool ready;       // Блок заполнен (TexUpload_commit).
+    bool issued;             // Загрузка отдана видеокарте.
+} UploadEntry;
+
+
+// Fence кадра:
+typedef struct UploadFence {
+    GLsync sync;   // Объект синхронизации.
+    uint64_t end;  // Всё до этого счётчика отдано до fence.
+} UploadFence;
+
+
+// Кольцо загрузки текстур:
+struct TexUpload {
+    Renderer *renderer;     // Указатель на рендерер.
+    uint32_t buffer;        // Айди буфера распаковки.
+    uint8_t *memory;        // Отображение буфера (или копия в памяти без постоянного отображения).
+    bool persistent;        // Буфер постоянно отображён.
+    size_t size;            // Размер кольца.
+    uint64_t head;          // Конец выделенного.
+    uint64_t tail;          // Начало занятого.
+    uint64_t issued;        // Конец непрерывно отданного начала очереди.
+    uint64_t fenced;        // Конец, закрытый последним fence.
+    Array *entries;         // Очередь загрузок (UploadEntry*), начинается с first.
+    size_t first;           // Первая не убранная загрузка очереди.
+    UploadFence fences[TEXUPLOAD_MAX_FENCES];  // Fence кадров по кругу.
+    int fence_first;        // Самый старый fence.
+    int fence_count;        // Сколько fence в полёте.
+    TexUploadStats stats;   // Статистика (frame_* - за прошлый кадр).
+    size_t frame_bytes;     // Байт за текущий кадр.
+    size_t frame_count;     // Загрузок за текущий кадр.
+    uint64_t frame_stall;   // Ожидание за текущий кадр.
+};
+
+
+// -------- Вспомогательные функции: --------
+
+
+// Байт на пиксель:
+static size_t pixel_size(TextureFormat format, TextureDataType dtype) {
+    size_t channels = 4, bytes = 1;
+    switch (format) {
+        case TEX_FORMAT_R:
+        case TEX_FORMAT_DEPTH:
+        case TEX_FORMAT_DEPTH_STENCIL: channels = 1; break;
+        case TEX_FORMAT_RG:            channels = 2; break;
+        case TEX_FORMAT_RGB:
+        case TEX_FORMAT_BGR:           channels = 3; break;
+        default:                       channels = 4; break;
+    }
+    switch (dtype) {
+        case TEX_DATA_USHORT:
+        case TEX_DATA_SHORT:
+        case TEX_DATA_HALF_FLOAT: bytes = 2; break;
+        case TEX_DATA_UINT:
+        case TEX_DATA_INT:
+        case TEX_DATA_FLOAT:      bytes = 4; break;
+        default:                  bytes = 1; break;
+    }
+    return channels * bytes;
+}
+
+// Сколько места свободно:
+static inline size_t free_space(const TexUpload *self) {
+    return self->size - (size_t)(self->head - self->tail);
+}
+
+// Отдать загрузку видеокарте (буфер уже привязан, выравнивание распаковки 1):
+static void issue_entry(TexUpload *self, UploadEntry *entry) {
+    if (!self->persistent) {
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, (GLintptr)entry->offset, (GLsizeiptr)entry->size, self->memory + entry->offset);
+    }
+    Texture_set_subdata(
+        entry->texture, entry->miplevel, entry->x, entry->y, entry->width, entry->height,
+        entry->format, entry->dtype, (const void*)(uintptr_t)entry->offset  // С буфером распаковки - смещение.
+    );
+    entry->issued = true;
+    self->frame_bytes += entry->size;
+    self->frame_count++;
+    COUNTER_ADD("texupload.bytes", entry->size);
+    COUNTER_INC("texupload.count");
+}
+
+// Поставить fence за всем отданным (если есть что закрывать и есть место под fence):
+static bool push_fence(TexUpload *self) {
+    if (self->issued == self->fenced || self->fence_count >= TEXUPLOAD_MAX_FENCES) return false;
+    GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (!sync) return false;
+    int index = (self->fence_first + self->fence_count) % TEXUPLOAD_MAX_FENCES;
+    self->fences[index] = (UploadFence){ sync, self->issued };
+    self->fence_count++;
+    self->fenced = self->issued;
+    return true;
+}
+
+// Освободить место самого старого fence (wait = false - только если видеокарта его уже прошла):
+static bool retire_fence(TexUpload *self, bool wait) {
+    if (self->fence_count == 0) return false;
+    UploadFence *fence = &self->fences[self->fence_first];
+    GLenum result = glClientWaitSync(fence->sync, 0, 0);
+    if (wait && result == GL_TIMEOUT_EXPIRED) {
+        uint64_t start = Time_get_ns();
+        do {
+            result = glClientWaitSync(fence->sync, GL_SYNC_FLUSH_COMMANDS_BIT, TEXUPLOAD_WAIT_TIMEOUT);
+        } while (result == GL_TIMEOUT_EXPIRED);
+        uint64_t stall = Time_get_ns() - start;
+        self->frame_stall += stall;
+        COUNTER_ADD("texupload.stall_us", stall / 1000);
+    }
+    if (result == GL_TIMEOUT_EXPIRED) return false;
+    if (result == GL_WAIT_FAILED) log_msg("[W] TexUpload: Waiting for the fence failed, the memory is reused.\n");
+    glDeleteSync(fence->sync);
+    self->tail = fence->end;
+    self->fence_first = (self->fence_first + 1) % TEXUPLOAD_MAX_FENCES;
+    self->fence_count--;
+    return true;
+}
+
+// Освободить место всех fence, пройденных видеокартой:
+static void retire_fences(TexUpload *self) {
+    while (retire_fence(self, false));
+}
+
+
+// -------- API кольца загрузки: --------
+
+
+// Создать кольцо загрузки (size = 0 - TEXUPLOAD_DEFAULT_SIZE). Нужен контекст OpenGL:
+TexUpload* TexUpload_create(Renderer *renderer, size_t size) {
+    if (size == 0) size = TEXUPLOAD_DEFAULT_SIZE;
+    size = (size + TEXUPLOAD_ALIGN - 1) & ~(size_t)(TEXUPLOAD_ALIGN - 1);
+
+    TexUpload *upload = (TexUpload*)mm_calloc(1, sizeof(TexUpload));
+    upload->renderer = renderer;
+    upload->size = size;
+    upload->entries = Array_create(sizeof(UploadEntry*), 64);
+
+    int32_t prev_buffer = 0;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &prev_buffer);
+    glGenBuffers(1, &upload->buffer);
+    if (upload->buffer == 0) {
+        log_msg("[E] TexUpload_create: Creating PBO failed.\n");
+        Array_destroy(&upload->entries);
+        mm_free(upload);
+        return NULL;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->buffer);
+
+    // Постоянное отображение: пиксели пишутся прямо в память буфера, и её не надо отображать каждый раз:
+    #ifndef CGDF_TEXUPLOAD_NO_PERSISTENT
+        if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, NULL, flags);
+            upload->memory = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size, flags);
+            upload->persistent = upload->memory != NULL;
+            if (!upload->persistent) {  // Хранилище неизменяемое, поэтому без отображения буфер пересоздаём.
+                glDeleteBuffers(1, &upload->buffer);
+                glGenBuffers(1, &upload->buffer);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->buffer);
+            }
+        }
+    #endif
+
+    // Иначе пиксели пишутся в копию в памяти и отдаются в буфер перед загрузкой:
+    if (!upload->persistent) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_DRAW);
+        upload->memory = (uint8_t*)mm_alloc(size);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, (uint32_t)prev_buffer);
+    return upload;
+}
+
+// Уничтожить кольцо загрузки (ждёт видеокарту и отдаёт все заполненные загрузки):
+void TexUpload_destroy(TexUpload **upload) {
+    if (!upload || !*upload) return;
+    TexUpload *self = *upload;
+    TexUpload_flush(self);
+
+    // Незаполненные блоки просто выбрасываем:
+    size_t dropped = 0;
+    for (size_t i = self->first; i < Array_len(self->entries); i++) {
+        UploadEntry *entry = (UploadEntry*)Array_get_ptr(self->entries, i);
+        dropped += !entry->issued;
+        mm_free(entry);
+    }
+    if (dropped) log_msg("[W] TexUpload_destroy: %zu reserved uploads were never committed.\n", dropped);
+    Array_destroy(&self->entries);
+
+    // Буфер удаляется вместе с остальными, а видеокарта сама дочитает его до удаления:
+    for (int i = 0; i < self->fence_count; i++) {
+        glDeleteSync(self->fences[(self->fence_first + i) % TEXUPLOAD_MAX_FENCES].sync);
+    }
+    if (self->persistent) {
+        int32_t prev_buffer = 0;
+        glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &prev_buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, self->buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, (uint32_t)prev_buffer == self->buffer ? 0 : (uint32_t)prev_buffer);
+    } else mm_free(self->memory);
+    BufferGC_GL_push(BGC_GL_PBO, self->buffer);
+    mm_free(self);
+    *upload = NULL;
+}
+
+// Выделить блок под загрузку области текстуры (главный поток). false - места нет, грузите Texture_set_subdata:
+bool TexUpload_reserve(
+    TexUpload *self, Texture *texture, int miplevel, int offset_x, int offset_y, int width, int height,
+    TextureFormat format, TextureDataType dtype, TexUploadBlock *out_block
+) {
+    if (!self || !texture || !out_block || width <= 0 || height <= 0 || miplevel < 0) return false;
+    size_t pitch = (size_t)width * pixel_size(format, dtype);
+    size_t size = pitch * (size_t)height;
+    size_t aligned = (size + TEXUPLOAD_ALIGN - 1) & ~(size_t)(TEXUPLOAD_ALIGN - 1);
+    if (aligned > self->size) return false;
+
+    // Блок не режем на конце буфера: если не помещается, начинаем с нуля, а хвост отдаём этому блоку:
+    size_t offset = (size_t)(self->head % self->size);
+    size_t skip = offset + aligned > self->size ? self->size - offset : 0;
+    size_t need = skip + aligned;
+
+    // Освобождаем место: пройденные fence, потом ставим fence на отданное и ждём самый старый:
+    retire_fences(self);
+    while (free_space(self) < need) {
+        if (self->fence_count == 0) {
+            TexUpload_flush(self);
+            if (!push_fence(self)) return false;  // Место держат ещё не заполненные блоки.
+        }
+        retire_fence(self, true);
+    }
+
+    UploadEntry *entry = (UploadEntry*)mm_alloc(sizeof(UploadEntry));
+    *entry = (UploadEntry){
+        .texture = texture, .miplevel = miplevel, .x = offset_x, .y = offset_y, .width = width, .height = height,
+        .format = format, .dtype = dtype, .offset = skip ? 0 : offset, .size = size, .end = self->head + need,
+    };
+    atomic_init(&entry->ready, false);
+    Array_push(self->entries, &entry);
+    self->head += need;
+    size_t used = (size_t)(self->head - self->tail);
+    if (used > self->stats.peak_used) self->stats.peak_used = used;
+
+    out_block->data = self->memory + entry->offset;
+    out_block->size = size;
+    out_block->pitch = pitch;
+    out_block->_entry_ = entry;
+    return true;
+}
+
+// Отметить, что блок заполнен (любой поток). После этого блок трогать нельзя:
+void TexUpload_commit(TexUploadBlock *block) {
+    if (!block || !block->_entry_) return;
+    atomic_store_explicit(&((UploadEntry*)block->_entry_)->ready, true, memory_order_release);
+    block->_entry_ = NULL;
+}
+
+// Загрузить область текстуры через кольцо (копия данных, загрузка отдаётся сразу). self = NULL - напрямую:
+void TexUpload_subdata(
+    TexUpload *self, Texture *texture, int miplevel, int offset_x, int offset_y, int width, int height,
+    TextureFormat format, TextureDataType dtype, const void *data
+) {
+    if (!texture || !data) return;
+    TexUploadBlock block;
+    if (!TexUpload_reserve(self, texture, miplevel, offset_x, offset_y, width, height, format, dtype, &block)) {
+        if (self) {
+            self->stats.fallbacks++;
+            COUNTER_INC("texupload.fallbacks");
+        }
+        Texture_set_subdata(texture, miplevel, offset_x, offset_y, width, height, format, dtype, data);
+        return;
+    }
+    memcpy(block.data, data, block.size);
+    TexUpload_commit(&block);
+    TexUpload_flush(self);
+}
+
+// Отдать видеокарте все заполненные загрузки (главный поток):
+void TexUpload_flush(TexUpload *self) {
+    if (!self || self->first >= Array_len(self->entries)) return;
+
+    int32_t prev_buffer = 0, prev_unpack = 0;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &prev_buffer);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_unpack);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, self->buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Строки в кольце лежат без выравнивания.
+    for (size_t i = self->first; i < Array_len(self->entries); i++) {
+        UploadEntry *entry = (UploadEntry*)Array_get_ptr(self->entries, i);
+        if (!entry->issued && atomic_load_explicit(&entry->ready, memory_order_acquire)) issue_entry(self, entry);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, prev_unpack);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, (uint32_t)prev_buffer);
+
+    // Убираем отданное начало очереди (место освободит следующий fence):
+    while (self->first < Array_len(self->entries)) {
+        UploadEntry *entry = (UploadEntry*)Array_get_ptr(self->entries, self->first);
+        if (!entry->issued) break;
+        self->issued = entry->end;
+        mm_free(entry);
+        self->first++;
+    }
+    if (self->first == Array_len(self->entries)) {
+        Array_clear(self->entries, false);
+        self->first = 0;
+    }
+}
+
+// Закончить кадр: отдать загрузки, поставить fence, освободить пройденное видеокартой, снять статистику:
+void TexUpload_frame(TexUpload *self) {
+    if (!self) return;
+    TexUpload_flush(self);
+    if (self->fence_count >= TEXUPLOAD_MAX_FENCES) retire_fence(self, true);
+    push_fence(self);
+    retire_fences(self);
+
+    self->stats.frame_bytes = self->frame_bytes;
+    self->stats.frame_count = self->frame_count;
+    self->stats.frame_stall_ns = self->frame_stall;
+    self->stats.total_bytes += self->frame_bytes;
+    self->stats.total_count += self->frame_count;
+    self->stats.total_stall_ns += self->frame_stall;
+    self->frame_bytes = self->frame_count = 0;
+    self->frame_stall = 0;
+    GAUGE_SET("texupload.used", self->head - self->tail);
+}
+
+// Получить статистику кольца:
+TexUploadStats TexUpload_get_stats(TexUpload *self) {
+    return self ? self->stats : (TexUploadStats){ 0 };
+}
+
+// Получить размер кольца в байтах:
+size_t TexUpload_get_size(TexUpload *self) {
+    return self ? self->size : 0;
+}
+
+// Постоянно ли отображён буфер (иначе данные идут через копию в памяти):
+bool TexUpload_is_persistent(TexUpload *self) {
+    return self && self->persistent;
+}
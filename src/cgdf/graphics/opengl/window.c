@@ -9,6 +9,12 @@
 #include <cgdf/core/mm.h>
 #include <cgdf/core/pixmap.h>
 #include <cgdf/core/logger.h>
+#include <cgdf/core/time.h>
+#include <cgdf/core/profiler.h>
+#include <cgdf/core/counters.h>
+#include <cgdf/core/asyncio.h>
+#include <cgdf/core/hotreload.h>
+#include <cgdf/core/framepacer.h>
 #include "../core/input.h"
 #include "../core/scene.h"
 #include "../core/renderer.h"
@@ -29,8 +35,8 @@ struct WinVars {
     SDL_Window *window;
     SDL_GLContext context;
     char title[256];  // 255 символа для заголовка окна + 1 для '\0'.
-    uint64_t perf_freq;
-    double start_time;
+    uint64_t start_ns;  // Время создания окна (по монотонным часам).
+    FramePacer *pacer;  // Ограничитель частоты кадров.
     double dtime;
     bool create_failed;
     bool running;
@@ -130,6 +136,7 @@ void Window_destroy(Window **window) {
 
     // Освобождаем память глобальных переменных:
     if (vars) {
+        FramePacer_destroy(&vars->pacer);
         mm_free(vars);
         vars = NULL;
     }
@@ -155,7 +162,7 @@ static void MainLoop(Window *self, WinConfig *config) {
     vars->running = true;
     while (vars->running) {
         // Настраиваем переменные:
-        double frame_start = Window_get_time(self);
+        uint64_t frame_start = Time_get_ns();
         vars->focused = false;
         vars->defocused = false;
 
@@ -198,10 +205,12 @@ static void MainLoop(Window *self, WinConfig *config) {
 
             // Запускаем новую текущую сцену:
             if (self->scene.start) self->scene.start(self);
+            FramePacer_reset(vars->pacer);  // Загрузка сцены не считается пропущенными кадрами.
         }
         const WindowScene *scene = &self->scene;  // Получаем текущую сцену (для удобства).
 
         // Обрабатываем события:
+        PROFILE_BEGIN(events_zone, "Window events");
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
             switch (event.type) {
@@ -301,12 +310,34 @@ static void MainLoop(Window *self, WinConfig *config) {
             }
         }
 
+        PROFILE_END(events_zone);
+
+        // Доставляем завершённые асинхронные чтения файлов:
+        AsyncIO_poll();
+
+        // Подменяем перезагруженные ассеты (до обновления и отрисовки кадра):
+        HotReload_poll();
+
         // Обработка основных функций (обновление и отрисовка):
-        if (scene->update) scene->update(self, Window_get_dtime(self));
-        if (scene->render) scene->render(self, Window_get_dtime(self));
+        if (scene->update) {
+            PROFILE_ZONE("Window update");
+            scene->update(self, Window_get_dtime(self));
+        }
+        if (scene->render) {
+            PROFILE_ZONE("Window render");
+            scene->render(self, Window_get_dtime(self));
+        }
+
+        // Отдаём заполненные загрузки текстур и ставим fence кадра:
+        TexUpload_frame(self->renderer->uploads);
+
+        // Отдаём прочитанные из видеокарты картинки и сохранения:
+        Readback_update(self->renderer->readback);
 
         // Очищаем все буфера (массивное удаление всех буферов за раз):
+        PROFILE_BEGIN(flush_zone, "Renderer_buffers_flush");
         Renderer_buffers_flush(self->renderer);
+        PROFILE_END(flush_zone);
 
         // Проверяем что окно хотят закрыть:
         if (vars->closing) {
@@ -314,21 +345,20 @@ static void MainLoop(Window *self, WinConfig *config) {
             return;
         }
 
-        // Делаем задержку между кадрами:
-        if (!self->config->vsync && cfg->fps > 0) {
-            double target = 1.0f / (float)cfg->fps;
-            double elapsed;  // Сколько прошло времени с начала кадра в секундах.
-            do {
-                elapsed = Window_get_time(self) - frame_start;
-                if (target - elapsed > 0.002) {  // По 2 мс ожидание:
-                    SDL_Delay(1);  // Задержка 1 мс + затраты на тайминги ос примерно >1 мс.
-                }
-            } while (elapsed < target);  // Цикл ожидания тайминга до нужного времени.
-        } else if (!self->config->vsync && cfg->fps <= 0) { /* Никакой задержки. */ }
-        else { SDL_Delay(0); }  // При vsync можно не задерживать - SDL будет синхронизировать кадры.
+        // Делаем задержку между кадрами (срок считается от срока прошлого кадра, см. framepacer.h):
+        PROFILE_BEGIN(wait_zone, "Window frame wait");
+        if (!self->config->vsync && cfg->fps > 0) FramePacer_frame(vars->pacer, (double)cfg->fps);
+        else {
+            FramePacer_frame(vars->pacer, 0.0);  // Без ограничения, только статистика кадров.
+            if (self->config->vsync) SDL_Delay(0);  // При vsync SDL сам синхронизирует кадры.
+        }
+        PROFILE_END(wait_zone);
 
         // Получаем дельту времени (время кадра или же время обработки одного цикла окна):
-        vars->dtime = Window_get_time(self) - frame_start;
+        vars->dtime = Time_ns_to_sec(Time_get_ns() - frame_start);
+        GAUGE_SET("window.frame_us", vars->dtime * 1000000.0);
+        Counters_frame();  // Снимок счётчиков кадра.
+        PROFILE_FRAME();   // Граница кадра для профилировщика.
     }
 
     // Закрываем окно:
@@ -440,8 +470,8 @@ bool Window_open(Window *self) {
 
     // Устанавливаем значения в глобальные переменные:
     vars->window = window;
-    vars->perf_freq = SDL_GetPerformanceFrequency();
-    vars->start_time = Window_get_time(self);
+    vars->start_ns = Time_get_ns();
+    if (!vars->pacer) vars->pacer = FramePacer_create();
     vars->dtime = cfg->fps <= 0 ? 1e-6f : 1.0/cfg->fps;
     vars->closing = false;
 
@@ -827,7 +857,13 @@ double Window_get_time(Window *self) {
     if (!self || !self->vars) return 0.0;
     WinVars *vars = self->vars;
     // Получаем время с начала создания окна в секундах:
-    return ((double)SDL_GetPerformanceCounter() / (double)vars->perf_freq) - vars->start_time;
+    return Time_ns_to_sec(Time_get_ns() - vars->start_ns);
+}
+
+// Получить статистику времени кадра (перцентили, пропущенные кадры, время ожидания):
+void Window_get_frame_stats(Window *self, FramePacerStats *stats) {
+    if (!self || !self->vars) { FramePacer_get_stats(NULL, stats); return; }
+    FramePacer_get_stats(self->vars->pacer, stats);
 }
 
 // Установить сцену окна:
@@ -859,10 +895,20 @@ void Window_clear(Window *self, float r, float g, float b) {
 void Window_display(Window *self) {
     if (!self || !self->vars || !self->vars->window) return;
     WinVars *vars = self->vars;
+    PROFILE_FUNC();
     Renderer_display(self->renderer);  // Насильно вызываем рендеринг моделей.
+    int width, height;
+    SDL_GetWindowSizeInPixels(vars->window, &width, &height);
+    Readback_present(self->renderer->readback, width, height);  // Чтение кадра до смены буферов.
     SDL_GL_SwapWindow(vars->window);
 }
 
+// Сохранить снимок окна в файл (читается в Window_display, кодируется в потоке, см. readback.h):
+bool Window_screenshot(Window *self, const char *filepath) {
+    if (!self || !self->renderer) return false;
+    return Readback_screen_save(self->renderer->readback, filepath);
+}
+
 
 // -------- Реализация функций ввода: --------
 
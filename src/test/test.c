@@ -39,17 +39,6 @@ static void print_after_free() {
 }
 
 
-static void load_shader(Shader *shader, const char *vert, const char *frag) {
-    char *grid_vert = Files_load(vert, "r");
-    char *grid_frag = Files_load(frag, "r");
-    shader->vertex = grid_vert;
-    shader->fragment = grid_frag;
-    Shader_compile(shader);
-    mm_free(grid_vert);
-    mm_free(grid_frag);
-}
-
-
 static size_t calculate_mesh_size(OBJFile *file) {
     size_t size = 0;
     for (size_t i=0; i < Array_len(file->models); i++) {
@@ -101,8 +90,7 @@ void start(Window *self) {
 
     draw = SimpleDraw_create(self->renderer);
 
-    grid = Shader_create(self->renderer, NULL, NULL, NULL);
-    load_shader(grid, "data/shaders/grid.vert", "data/shaders/grid.frag");
+    grid = Shader_load(self->renderer, "data/shaders/grid.vert", "data/shaders/grid.frag", NULL);
 
     font = FontPixmap_create(self->renderer, "data/fonts/pixel.ttf", 32);
     FontPixmap_set_pixelized(font, true);
@@ -352,6 +340,8 @@ WindowScene TestScene = {
 // Точка входа в программу:
 int main(int argc, char *argv[]) {
     CGDF_init();
+    AssetCache_init(NULL);  // Декодированные картинки, разобранные модели и глифы берём из "cache/".
+    HotReload_init();       // Подхватываем изменения текстур, шейдеров и моделей без перезапуска.
 
     log_msg("[I] CWD: \"%s\"\n", Files_get_cwd(NULL, 0));
 
@@ -0,0 +1,116 @@
+//
+// bench_bcn.c - Замер сжатия BCn во всех форматах и качествах на картинке из "data/textures/".
+//
+// Каждый формат распаковывается обратно и сверяется с исходной картинкой по PSNR. Векторный поиск палитры
+// и скалярный, один поток и все потоки должны давать одинаковые блоки байт в байт.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define FIXTURE_PATH "data/textures/gradient_uv_checker.png"
+#define SIZE         256  // Сторона вырезанной картинки (4096 блоков - сжатие идёт параллельно).
+#define REPEATS      3    // Берём лучший из замеров.
+
+
+// Наименьший PSNR, дБ (по формату и качеству):
+static const float g_MinPsnr[BC_FORMAT_COUNT][2] = {
+    [BC_FORMAT_BC1] = { 35.0f, 36.5f },
+    [BC_FORMAT_BC3] = { 34.0f, 35.5f },
+    [BC_FORMAT_BC4] = { 42.0f, 43.0f },
+    [BC_FORMAT_BC5] = { 42.0f, 43.0f },
+    [BC_FORMAT_BC7] = { 37.5f, 40.5f },
+};
+
+
+// Картинка: кусок текстуры с гладкой альфой и вырезом по кругу (прозрачность для BC1):
+static Pixmap* make_fixture(void) {
+    Pixmap *texture = Pixmap_load(FIXTURE_PATH, 4);
+    Pixmap *pixmap = Pixmap_crop(texture, texture->width / 4, texture->height / 4, SIZE, SIZE);
+    Pixmap_destroy(&texture);
+    uint8_t *data = (uint8_t*)pixmap->data;
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++) {
+            float dx = x - SIZE * 0.5f, dy = y - SIZE * 0.5f;
+            bool cut = dx * dx + dy * dy < SIZE * SIZE / 16;
+            data[((size_t)y * SIZE + x) * 4 + 3] = cut ? 0 : (uint8_t)(128 + (x + y) * 127 / (2 * SIZE));
+        }
+    }
+    return pixmap;
+}
+
+// Одинаковые ли блоки:
+static bool same_image(const BCImage *a, const BCImage *b) {
+    return a && b && a->size == b->size && memcmp(a->data, b->data, a->size) == 0;
+}
+
+// Сжать картинку:
+static BCImage* encode(const Pixmap *pixmap, BCFormat format, BCQuality quality, size_t workers) {
+    BCSettings settings = { format, quality, workers };
+    return BCImage_encode(pixmap, &settings);
+}
+
+
+int main(void) {
+    CGDF_init();
+    Pixmap *pixmap = make_fixture();
+    size_t max_workers = JobSystem_get_max_workers_count();
+    size_t top = max_workers < 4 ? 4 : max_workers;  // Как в bench_scenegraph_parallel.
+    bool simd = BC_is_simd();
+    printf("%dx%d, best of %d (CPU threads: %zu, SIMD: %s):\n", SIZE, SIZE, REPEATS, max_workers, simd ? "yes" : "no");
+    printf("  %-6s %-5s %8s %10s %7zu w Mpx/s\n", "format", "mode", "PSNR dB", "1 w Mpx/s", top);
+
+    for (int f = 0; f < BC_FORMAT_COUNT; f++) {
+        for (int q = BC_QUALITY_FAST; q <= BC_QUALITY_HIGH; q++) {
+            BCFormat format = (BCFormat)f;
+            BCQuality quality = (BCQuality)q;
+            const char *name = BCFormat_get_name(format), *mode = q == BC_QUALITY_FAST ? "fast" : "high";
+
+            // Один поток и все потоки (лучшее время):
+            BCImage *single = NULL, *parallel = NULL;
+            double single_ms = 1e30, parallel_ms = 1e30;
+            for (int r = 0; r < REPEATS; r++) {
+                BCImage_destroy(&single);
+                BCImage_destroy(&parallel);
+                double t0 = Tests_now_ms();
+                single = encode(pixmap, format, quality, 1);
+                double t1 = Tests_now_ms();
+                parallel = encode(pixmap, format, quality, top);
+                double t2 = Tests_now_ms();
+                if (t1 - t0 < single_ms) single_ms = t1 - t0;
+                if (t2 - t1 < parallel_ms) parallel_ms = t2 - t1;
+            }
+            TEST_CHECK(same_image(single, parallel), "%s %s: 1 and %zu workers give different blocks.", name, mode, top);
+
+            // Скалярный поиск палитры:
+            if (simd) {
+                BC_set_simd(false);
+                BCImage *scalar = encode(pixmap, format, quality, 0);
+                BC_set_simd(true);
+                TEST_CHECK(same_image(single, scalar), "%s %s: SIMD and scalar give different blocks.", name, mode);
+                BCImage_destroy(&scalar);
+            }
+
+            // Распаковка и качество:
+            Pixmap *decoded = BCImage_decode(single);
+            int channels = format == BC_FORMAT_BC4 ? 1 : format == BC_FORMAT_BC5 ? 2 : 4;
+            TEST_CHECK(decoded && decoded->width == SIZE && decoded->height == SIZE && decoded->channels == channels,
+                       "%s %s: wrong decoded image.", name, mode);
+            Pixmap_destroy(&decoded);
+            float psnr = BCImage_get_psnr(single, pixmap);
+            TEST_CHECK(psnr >= g_MinPsnr[f][q], "%s %s: PSNR %.2f dB is below %.1f dB.", name, mode, psnr, g_MinPsnr[f][q]);
+
+            double mpx = (double)SIZE * SIZE / 1e6;
+            printf("  %-6s %-5s %8.2f %10.2f %10.2f\n", name, mode, psnr, mpx / (single_ms / 1e3), mpx / (parallel_ms / 1e3));
+            BCImage_destroy(&single);
+            BCImage_destroy(&parallel);
+        }
+    }
+
+    Pixmap_destroy(&pixmap);
+    CGDF_destroy();
+    return Tests_result();
+}
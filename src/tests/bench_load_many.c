@@ -0,0 +1,105 @@
+//
+// bench_load_many.c - Замер Pixmap_load_many на текстурах из "data/textures/" от 1 до N потоков.
+//
+// Каждая картинка пакета сверяется побайтово с Pixmap_load того же файла. Обработчик должен прийти ровно
+// один раз на запрос, а отсутствующий файл - получить стандартную картинку и loaded = false.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define REPEATS      5                            // Берём лучший из замеров.
+#define MISSING_PATH "data/textures/missing.png"  // Файла нет (проверка ошибки внутри пакета).
+
+
+// Текстуры пакета:
+static const char *g_Files[] = {
+    "data/textures/blue-noise.bmp", "data/textures/circle.png", "data/textures/dark-meter.png",
+    "data/textures/flash-light.png", "data/textures/gradient_uv_checker.png", "data/textures/light.png",
+    "data/textures/skysphere.png", "data/textures/square.png", "data/textures/texture-1.png",
+    "data/textures/texture-2.png", "data/textures/texture-3.png", "data/textures/triangle.png",
+    "data/textures/uv_checker.png", "data/textures/white-meter.png",
+};
+#define FILES_COUNT (sizeof(g_Files) / sizeof(g_Files[0]))
+
+
+// Сколько раз пришёл обработчик для каждого запроса:
+static atomic_int g_Calls[FILES_COUNT];
+
+
+// Обработчик готовой картинки:
+static void on_loaded(PixmapLoadRequest *request, size_t index, void *user) {
+    (void)request; (void)user;
+    atomic_fetch_add(&g_Calls[index], 1);
+}
+
+// Совпадают ли картинки:
+static bool same_pixmap(const Pixmap *a, const Pixmap *b) {
+    return a && b && a->width == b->width && a->height == b->height && a->channels == b->channels &&
+           memcmp(a->data, b->data, (size_t)a->width * a->height * a->channels) == 0;
+}
+
+
+int main(void) {
+    CGDF_init();
+    size_t max_workers = JobSystem_get_max_workers_count();
+
+    // Эталон и последовательная загрузка:
+    Pixmap *reference[FILES_COUNT];
+    double serial = Tests_now_ms();
+    for (size_t i = 0; i < FILES_COUNT; i++) reference[i] = Pixmap_load(g_Files[i], 4);
+    serial = Tests_now_ms() - serial;
+    printf("%zu files, best of %d, ms (CPU threads: %zu):\n", FILES_COUNT, REPEATS, max_workers);
+    printf("  Pixmap_load one by one  %9.3f\n", serial);
+
+    // Степени двойки и само количество потоков процессора (не меньше 4, как в bench_scenegraph_parallel):
+    size_t top = max_workers < 4 ? 4 : max_workers;
+    size_t workers[32], workers_count = 0;
+    for (size_t w = 1; w < top && workers_count < 31; w *= 2) workers[workers_count++] = w;
+    workers[workers_count++] = top;
+
+    for (size_t w = 0; w < workers_count; w++) {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; r++) {
+            PixmapLoadRequest requests[FILES_COUNT];
+            for (size_t i = 0; i < FILES_COUNT; i++) {
+                requests[i] = (PixmapLoadRequest){ g_Files[i], 4, NULL, false };
+                atomic_store(&g_Calls[i], 0);
+            }
+            double t0 = Tests_now_ms();
+            size_t loaded = Pixmap_load_many(requests, FILES_COUNT, workers[w], on_loaded, NULL);
+            double t = Tests_now_ms() - t0;
+            if (t < best) best = t;
+
+            TEST_CHECK(loaded == FILES_COUNT, "%zu workers: %zu of %zu files loaded.", workers[w], loaded, FILES_COUNT);
+            for (size_t i = 0; i < FILES_COUNT; i++) {
+                TEST_CHECK(atomic_load(&g_Calls[i]) == 1, "%s: %d callbacks.", g_Files[i], atomic_load(&g_Calls[i]));
+                TEST_CHECK(requests[i].loaded, "%s: not loaded.", g_Files[i]);
+                TEST_CHECK(same_pixmap(requests[i].pixmap, reference[i]), "%s (%zu workers): differs from Pixmap_load.",
+                           g_Files[i], workers[w]);
+                Pixmap_destroy(&requests[i].pixmap);
+            }
+        }
+        printf("  Pixmap_load_many %3zu w  %9.3f\n", workers[w], best);
+    }
+
+    // Отсутствующий файл внутри пакета не мешает остальным:
+    PixmapLoadRequest requests[3] = {
+        { g_Files[1], 4, NULL, false }, { MISSING_PATH, 4, NULL, false }, { g_Files[2], 4, NULL, false },
+    };
+    for (size_t i = 0; i < 3; i++) atomic_store(&g_Calls[i], 0);
+    size_t loaded = Pixmap_load_many(requests, 3, 0, on_loaded, NULL);
+    TEST_CHECK(loaded == 2 && requests[0].loaded && !requests[1].loaded && requests[2].loaded, "Wrong result with a missing file.");
+    TEST_CHECK(requests[1].pixmap != NULL, "No default pixmap for the missing file.");
+    for (size_t i = 0; i < 3; i++) {
+        TEST_CHECK(atomic_load(&g_Calls[i]) == 1, "Request %zu: %d callbacks.", i, atomic_load(&g_Calls[i]));
+        Pixmap_destroy(&requests[i].pixmap);
+    }
+
+    for (size_t i = 0; i < FILES_COUNT; i++) Pixmap_destroy(&reference[i]);
+    CGDF_destroy();
+    return Tests_result();
+}
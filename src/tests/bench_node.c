@@ -0,0 +1,132 @@
+//
+// bench_node.c - Замер O(1) пометки изменений Node: глубокое и широкое дерево, много сеттеров за кадр.
+//
+// Итоговые матрицы сверяются с матрицами, посчитанными заново от корня теми же операциями (побитово).
+// Отдельно проверяется, что изменения в одном дереве не сбрасывают проверки в другом, и перенос
+// поддерева между деревьями.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define FRAMES        10
+#define SETTERS_COUNT 8
+
+
+// Посчитать итоговую матрицу узла заново от корня (теми же операциями, что и Node_recalculate_matrix):
+static void reference_transform(Node *node, mat4 dest) {
+    mat4 local;
+    glm_mat4_identity(local);
+    glm_translate(local, (vec3){node->position.x, node->position.y, node->position.z});
+    glm_quat_rotate(local, node->quaternion, local);
+    glm_scale(local, (vec3){node->scale.x, node->scale.y, node->scale.z});
+    if (node->parent) {
+        mat4 parent;
+        reference_transform(node->parent, parent);
+        glm_mat4_mul(parent, local, dest);
+    } else glm_mat4_copy(local, dest);
+}
+
+// Сверить итоговые матрицы выборки узлов с посчитанными заново:
+static bool check_nodes(Node **nodes, size_t count, size_t step) {
+    mat4 a, b;
+    for (size_t i = 0; i < count; i += step) {
+        Node_get_transform(nodes[i], a);
+        reference_transform(nodes[i], b);
+        if (memcmp(a, b, sizeof(mat4)) != 0) return false;
+    }
+    return true;
+}
+
+// Построить дерево: глубокое (цепочка) или широкое (по 16 потомков):
+static Node** build_tree(size_t count, bool deep) {
+    Node **nodes = (Node**)mm_alloc(sizeof(Node*) * count);
+    nodes[0] = Node_create(NULL);
+    for (size_t i = 1; i < count; i++) {
+        nodes[i] = Node_create(deep ? nodes[i - 1] : nodes[(i - 1) / 16]);
+        Node_set_position(nodes[i], (Vec3d){0.001, 0.0, 0.0});
+    }
+    return nodes;
+}
+
+// Кадры: SETTERS_COUNT сдвигов корня и поворотов середины, затем чтение всех матриц:
+static void run(const char *name, size_t count, bool deep) {
+    Node **nodes = build_tree(count, deep);
+    mat4 m;
+    for (size_t i = 0; i < count; i++) Node_get_transform(nodes[i], m);
+
+    double t0 = Tests_now_ms();
+    for (int f = 0; f < FRAMES; f++) {
+        for (int k = 0; k < SETTERS_COUNT; k++) Node_set_position(nodes[0], (Vec3d){f, k, 0});
+        for (int k = 0; k < SETTERS_COUNT; k++) Node_rotate(nodes[count / 2], (Vec3d){0, 1, 0}, 1.0f);
+        for (size_t i = 0; i < count; i++) Node_get_transform(nodes[i], m);
+    }
+    double t1 = Tests_now_ms();
+    for (int f = 0; f < FRAMES; f++) {
+        for (int k = 0; k < SETTERS_COUNT; k++) Node_set_position(nodes[0], (Vec3d){f, k, 0});
+    }
+    double t2 = Tests_now_ms();
+
+    // Глубокую цепочку сверяем выборкой (заново от корня - это O(глубина) на узел):
+    TEST_CHECK(check_nodes(nodes, count, deep ? count / 64 : 1), "%s: world matrices differ from the reference.", name);
+    printf("  %-5s %7zu nodes: frame (2x%d setters + read all) %.3f ms, setters only %.4f ms\n",
+           name, count, SETTERS_COUNT, (t1 - t0) / FRAMES, (t2 - t1) / FRAMES);
+    Node_destroy(&nodes[0]);
+    mm_free(nodes);
+}
+
+// Эпоха у каждого дерева своя, перенос поддерева между деревьями даёт верные матрицы:
+static void check_trees(void) {
+    Node **a = build_tree(1000, false);
+    Node **b = build_tree(1000, false);
+    mat4 m;
+    for (size_t i = 0; i < 1000; i++) Node_get_transform(a[i], m);
+
+    // Изменения в дереве b не должны сбрасывать проверки дерева a:
+    uint64_t epoch = a[500]->valid_epoch;
+    Node_set_position(b[0], (Vec3d){1, 2, 3});
+    Node_set_parent(b[10], b[20]);
+    TEST_CHECK(a[0]->tree_epoch == epoch, "A setter in another tree changed this tree's epoch.");
+    Node_get_transform(a[500], m);
+    TEST_CHECK(a[500]->valid_epoch == epoch, "A setter in another tree invalidated this tree.");
+
+    // Перенос поддерева из b в a и обратно в самостоятельное дерево:
+    Node_set_position(a[0], (Vec3d){5, 0, 0});
+    Node_set_parent(b[1], a[3]);
+    TEST_CHECK(b[17]->root == a[0], "Moved subtree does not point at its new root.");
+    TEST_CHECK(check_nodes(a, 1000, 1) && check_nodes(b, 1000, 1), "World matrices differ after moving a subtree.");
+    Node_set_position(a[3], (Vec3d){0, 7, 0});
+    TEST_CHECK(check_nodes(b, 1000, 1), "Moved subtree did not follow its new parent.");
+    Node_set_parent(b[1], NULL);
+    TEST_CHECK(b[1]->root == b[1] && b[17]->root == b[1], "Detached subtree is not its own tree.");
+    Node_set_position(a[3], (Vec3d){0, 9, 0});
+    TEST_CHECK(check_nodes(a, 1000, 1) && check_nodes(b, 1000, 1), "World matrices differ after detaching a subtree.");
+
+    // Копия попадает в дерево нового родителя:
+    Node *copy = Node_copy(b[1], a[7]);
+    TEST_CHECK(copy->root == a[0], "Copied subtree does not point at its new root.");
+    Node_get_transform(copy, m);
+    mat4 ref;
+    reference_transform(copy, ref);
+    TEST_CHECK(memcmp(m, ref, sizeof(mat4)) == 0, "Copied node matrix differs from the reference.");
+
+    Node_destroy(&b[1]);
+    Node_destroy(&a[0]);
+    Node_destroy(&b[0]);
+    mm_free(a);
+    mm_free(b);
+}
+
+
+int main(void) {
+    CGDF_init();
+    printf("%d frames, ms per frame:\n", FRAMES);
+    run("deep", 20000, true);
+    run("wide", 200000, false);
+    check_trees();
+    CGDF_destroy();
+    return Tests_result();
+}
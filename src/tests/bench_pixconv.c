@@ -0,0 +1,209 @@
+//
+// bench_pixconv.c - Замер преобразований pixconv.h во всех наборах инструкций, которые есть у процессора.
+//
+// Перед замером каждый векторный набор сверяется со скалярным эталоном: целочисленные преобразования и half
+// float должны совпадать бит в бит (на всех длинах хвоста), float sRGB - с относительной ошибкой не больше 1e-5.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define PIXELS      (1 << 20)  // Пикселей в замере пропускной способности.
+#define TAIL_COUNTS 200        // Длины 0..199 для проверки хвостов.
+#define GUARD       32         // Байт за концом результата, которые не должны меняться.
+#define REPEATS     7          // Повторов замера (берётся лучший).
+#define MAX_REL_ERR 1e-5       // Допустимая ошибка float sRGB.
+
+
+// Преобразование в общем виде (src, dst, count):
+typedef void (*Kernel)(const uint8_t *src, uint8_t *dst, size_t count);
+
+typedef struct KernelInfo {
+    const char *name;
+    Kernel kernel;
+    int src_bytes;  // Байт на пиксель источника.
+    int dst_bytes;  // Байт на пиксель результата.
+} KernelInfo;
+
+
+// Буферы:
+static uint8_t g_Src[PIXELS * 4 + GUARD], g_Ref[PIXELS * 4 + GUARD], g_Out[PIXELS * 4 + GUARD];
+static float g_FloatSrc[PIXELS], g_FloatRef[PIXELS], g_FloatOut[PIXELS];
+static uint16_t g_HalfRef[PIXELS], g_HalfOut[PIXELS];
+
+
+// Обёртки с параметрами:
+static void extract_g(const uint8_t *src, uint8_t *dst, size_t count) { PixConv_extract_channel(src, 4, 1, dst, count); }
+static void extract_a(const uint8_t *src, uint8_t *dst, size_t count) { PixConv_extract_channel(src, 4, 3, dst, count); }
+static void srgb_lin8(const uint8_t *src, uint8_t *dst, size_t count) { PixConv_srgb_to_linear8(src, dst, count, 4); }
+static void lin_srgb8(const uint8_t *src, uint8_t *dst, size_t count) { PixConv_linear_to_srgb8(src, dst, count, 4); }
+
+static const KernelInfo g_Kernels[] = {
+    { "r_to_rgba",     PixConv_r_to_rgba,     1, 4 },
+    { "a_to_rgba",     PixConv_a_to_rgba,     1, 4 },
+    { "rgb_to_rgba",   PixConv_rgb_to_rgba,   3, 4 },
+    { "rgba_to_rgb",   PixConv_rgba_to_rgb,   4, 3 },
+    { "swizzle_bgra",  PixConv_swizzle_bgra,  4, 4 },
+    { "premultiply",   PixConv_premultiply,   4, 4 },
+    { "unpremultiply", PixConv_unpremultiply, 4, 4 },
+    { "extract_g",     extract_g,             4, 1 },
+    { "extract_a",     extract_a,             4, 1 },
+    { "srgb_to_lin8",  srgb_lin8,             4, 4 },
+    { "lin_to_srgb8",  lin_srgb8,             4, 4 },
+};
+#define KERNELS_COUNT (int)(sizeof(g_Kernels) / sizeof(g_Kernels[0]))
+
+
+// Заполнить буфер случайными байтами:
+static void fill_random(uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) data[i] = (uint8_t)rand();
+}
+
+// Все длины хвоста: результат совпадает с эталоном, байты за концом не тронуты:
+static void check_kernel(const KernelInfo *info, PixConvBackend backend) {
+    for (size_t count = 0; count < TAIL_COUNTS; count++) {
+        fill_random(g_Src, count * info->src_bytes + GUARD);
+        memset(g_Ref, 0xAB, count * info->dst_bytes + GUARD);
+        memset(g_Out, 0xAB, count * info->dst_bytes + GUARD);
+        PixConv_set_backend(PIXCONV_SCALAR);
+        info->kernel(g_Src, g_Ref, count);
+        PixConv_set_backend(backend);
+        info->kernel(g_Src, g_Out, count);
+        if (memcmp(g_Ref, g_Out, count * info->dst_bytes + GUARD) != 0) {
+            TEST_CHECK(false, "%s: %s differs from scalar (%zu pixels).", PixConv_get_backend_name(backend), info->name, count);
+            return;
+        }
+    }
+}
+
+// Все пары (цвет, альфа) для premultiply и unpremultiply:
+static void check_alpha_pairs(PixConvBackend backend) {
+    for (int c = 0; c < 256; c++) {
+        for (int a = 0; a < 256; a++) {
+            uint8_t *p = g_Src + (c * 256 + a) * 4;
+            p[0] = (uint8_t)c; p[1] = (uint8_t)(255 - c); p[2] = (uint8_t)(c ^ a); p[3] = (uint8_t)a;
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        Kernel kernel = i == 0 ? PixConv_premultiply : PixConv_unpremultiply;
+        PixConv_set_backend(PIXCONV_SCALAR);
+        kernel(g_Src, g_Ref, 65536);
+        PixConv_set_backend(backend);
+        kernel(g_Src, g_Out, 65536);
+        TEST_CHECK(memcmp(g_Ref, g_Out, 65536 * 4) == 0, "%s: %s differs from scalar on some (color, alpha) pair.",
+                   PixConv_get_backend_name(backend), i == 0 ? "premultiply" : "unpremultiply");
+    }
+}
+
+// Наибольшая относительная ошибка float sRGB:
+static double float_error(void (*convert)(const float*, float*, size_t), PixConvBackend backend) {
+    PixConv_set_backend(PIXCONV_SCALAR);
+    convert(g_FloatSrc, g_FloatRef, PIXELS);
+    PixConv_set_backend(backend);
+    convert(g_FloatSrc, g_FloatOut, PIXELS);
+    double worst = 0.0;
+    for (size_t i = 0; i < PIXELS; i++) {
+        double error = fabs((double)g_FloatRef[i] - g_FloatOut[i]) / fmax(fabs((double)g_FloatRef[i]), 1e-6);
+        if (error > worst) worst = error;
+    }
+    return worst;
+}
+
+// Half float: все 65536 значений в float и случайные биты float в half:
+static void check_half(PixConvBackend backend) {
+    for (uint32_t i = 0; i < 65536; i++) g_HalfRef[i] = (uint16_t)i;
+    PixConv_set_backend(PIXCONV_SCALAR);
+    PixConv_f16_to_f32(g_HalfRef, g_FloatRef, 65536);
+    PixConv_set_backend(backend);
+    PixConv_f16_to_f32(g_HalfRef, g_FloatOut, 65536);
+    TEST_CHECK(memcmp(g_FloatRef, g_FloatOut, 65536 * sizeof(float)) == 0, "%s: f16_to_f32 differs from scalar.",
+               PixConv_get_backend_name(backend));
+
+    float *bits = (float*)g_Src;  // Случайные биты (в том числе NaN, бесконечности и денормали).
+    fill_random(g_Src, PIXELS * sizeof(float) / 4);
+    for (size_t count = 0; count < TAIL_COUNTS; count++) {
+        PixConv_set_backend(PIXCONV_SCALAR);
+        PixConv_f32_to_f16(bits, g_HalfRef, count);
+        PixConv_set_backend(backend);
+        PixConv_f32_to_f16(bits, g_HalfOut, count);
+        if (memcmp(g_HalfRef, g_HalfOut, count * sizeof(uint16_t)) != 0) {
+            TEST_CHECK(false, "%s: f32_to_f16 differs from scalar (%zu values).", PixConv_get_backend_name(backend), count);
+            break;
+        }
+    }
+    PixConv_set_backend(PIXCONV_SCALAR);
+    PixConv_f32_to_f16(bits, g_HalfRef, PIXELS / 4);
+    PixConv_set_backend(backend);
+    PixConv_f32_to_f16(bits, g_HalfOut, PIXELS / 4);
+    TEST_CHECK(memcmp(g_HalfRef, g_HalfOut, PIXELS / 4 * sizeof(uint16_t)) == 0, "%s: f32_to_f16 differs from scalar.",
+               PixConv_get_backend_name(backend));
+}
+
+// Лучшее время одного прогона в секундах (index - преобразование, после g_Kernels идут float и half):
+static double bench_kernel(int index) {
+    double best = 1e9;
+    for (int r = 0; r < REPEATS; r++) {
+        double start = Tests_now_ms();
+        if (index < KERNELS_COUNT) g_Kernels[index].kernel(g_Src, g_Out, PIXELS);
+        else if (index == KERNELS_COUNT + 0) PixConv_srgb_to_linear_f32(g_FloatSrc, g_FloatOut, PIXELS);
+        else if (index == KERNELS_COUNT + 1) PixConv_linear_to_srgb_f32(g_FloatSrc, g_FloatOut, PIXELS);
+        else if (index == KERNELS_COUNT + 2) PixConv_f32_to_f16(g_FloatSrc, g_HalfOut, PIXELS);
+        else PixConv_f16_to_f32(g_HalfRef, g_FloatOut, PIXELS);
+        double sec = (Tests_now_ms() - start) / 1e3;
+        if (sec < best) best = sec;
+    }
+    return best;
+}
+
+
+int main(void) {
+    CGDF_init();
+    srand(7);
+    PixConvBackend default_backend = PixConv_get_backend();
+    printf("Default backend: %s\n", PixConv_get_backend_name(default_backend));
+
+    // Значения float: от 0 до 1.5 и несколько отрицательных:
+    for (size_t i = 0; i < PIXELS; i++) g_FloatSrc[i] = (float)i / (PIXELS - 1) * 1.5f;
+    g_FloatSrc[1] = -0.1f;
+    g_FloatSrc[2] = -1.0f;
+
+    // Точность векторных наборов:
+    for (int b = PIXCONV_SCALAR + 1; b < PIXCONV_BACKEND_COUNT; b++) {
+        PixConvBackend backend = (PixConvBackend)b;
+        if (!PixConv_is_supported(backend)) continue;
+        for (int i = 0; i < KERNELS_COUNT; i++) check_kernel(&g_Kernels[i], backend);
+        check_alpha_pairs(backend);
+        check_half(backend);
+        double to_linear = float_error(PixConv_srgb_to_linear_f32, backend);
+        double to_srgb = float_error(PixConv_linear_to_srgb_f32, backend);
+        printf("%s: float sRGB max relative error %.2e (to linear), %.2e (to sRGB)\n",
+               PixConv_get_backend_name(backend), to_linear, to_srgb);
+        TEST_CHECK(to_linear <= MAX_REL_ERR && to_srgb <= MAX_REL_ERR, "%s: float sRGB error is above %.0e.",
+                   PixConv_get_backend_name(backend), MAX_REL_ERR);
+    }
+
+    // Пропускная способность (миллионов пикселей или значений в секунду):
+    static const char *extra_names[] = { "srgb_to_lin", "lin_to_srgb", "f32_to_f16", "f16_to_f32" };
+    fill_random(g_Src, sizeof(g_Src));
+    for (size_t i = 0; i < PIXELS; i++) g_HalfRef[i] = (uint16_t)(i & 0x7BFF);
+    printf("\n%-14s", "Mpx/s");
+    for (int b = 0; b < PIXCONV_BACKEND_COUNT; b++) {
+        if (PixConv_is_supported((PixConvBackend)b)) printf("%10s", PixConv_get_backend_name((PixConvBackend)b));
+    }
+    printf("\n");
+    for (int i = 0; i < KERNELS_COUNT + 4; i++) {
+        printf("%-14s", i < KERNELS_COUNT ? g_Kernels[i].name : extra_names[i - KERNELS_COUNT]);
+        for (int b = 0; b < PIXCONV_BACKEND_COUNT; b++) {
+            if (!PixConv_set_backend((PixConvBackend)b)) continue;
+            printf("%10.0f", PIXELS / bench_kernel(i) / 1e6);
+        }
+        printf("\n");
+    }
+
+    PixConv_set_backend(default_backend);
+    CGDF_destroy();
+    return Tests_result();
+}
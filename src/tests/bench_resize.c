@@ -0,0 +1,188 @@
+//
+// bench_resize.c - Замер Pixmap_resize на 4K (уменьшение до 1080p и увеличение обратно) и операций pixops.h.
+//
+// Качество проверяется по PSNR на гладкой картинке: уменьшенная копия сравнивается с той же функцией,
+// посчитанной сразу в 1080p, а увеличенная - с исходной 4K. Ближайший пиксель, обрезка, копирование
+// областей и заливка сверяются побайтово.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define BIG_W       3840
+#define BIG_H       2160
+#define SMALL_W     1920
+#define SMALL_H     1080
+#define REPEATS     3      // Берём лучший из замеров.
+#define MIN_PSNR_DB 48.0   // Наименьший PSNR билинейного фильтра и Ланцоша (ближайший пиксель даёт около 40).
+
+
+// Гладкая функция картинки (период 64 пикселя по ширине 4K; u, v - центр пикселя в 0..1, значение 0..1):
+static float smooth_value(float u, float v, int channel) {
+    float phase = (float)channel * 0.7f;
+    return 0.5f + 0.3f * sinf(6.2831853f * (60.0f * u + phase)) * cosf(6.2831853f * (34.0f * v - phase)) + 0.15f * (u - v);
+}
+
+// Создать картинку RGBA с гладкой функцией (hdr - float на канал):
+static Pixmap* make_smooth(int width, int height, bool hdr) {
+    Pixmap *pixmap = Pixmap_create(width, height, 4);
+    if (hdr) {  // Своего конструктора у float картинок нет, меняем блок данных:
+        mm_free(pixmap->data);
+        pixmap->is_hdr = true;
+        pixmap->data = mm_alloc(Pixmap_get_size(pixmap));
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 4; c++) {
+                float value = smooth_value((x + 0.5f) / width, (y + 0.5f) / height, c);
+                size_t i = ((size_t)y * width + x) * 4 + c;
+                if (hdr) ((float*)pixmap->data)[i] = value;
+                else ((uint8_t*)pixmap->data)[i] = (uint8_t)(value * 255.0f + 0.5f);
+            }
+        }
+    }
+    return pixmap;
+}
+
+// Создать картинку со случайными байтами:
+static Pixmap* make_random(int width, int height, int channels) {
+    Pixmap *pixmap = Pixmap_create(width, height, channels);
+    for (size_t i = 0; i < (size_t)width * height * channels; i++) ((uint8_t*)pixmap->data)[i] = (uint8_t)rand();
+    return pixmap;
+}
+
+// PSNR в дБ (у 8 бит пик 255, у float - 1):
+static double get_psnr(const Pixmap *a, const Pixmap *b) {
+    size_t count = (size_t)a->width * a->height * a->channels;
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double d = a->is_hdr ? (double)((float*)a->data)[i] - ((float*)b->data)[i]
+                             : ((double)((uint8_t*)a->data)[i] - ((uint8_t*)b->data)[i]) / 255.0;
+        sum += d * d;
+    }
+    return sum > 0.0 ? 10.0 * log10(count / sum) : INFINITY;
+}
+
+// Лучшее время масштабирования в мс (проверяется размер результата):
+static double bench_resize(const Pixmap *src, int width, int height, PixmapFilter filter, Pixmap **out) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        if (*out) Pixmap_destroy(out);
+        double t0 = Tests_now_ms();
+        *out = Pixmap_resize(src, width, height, filter);
+        double t = Tests_now_ms() - t0;
+        if (t < best) best = t;
+    }
+    TEST_CHECK(*out && (*out)->width == width && (*out)->height == height, "%s: wrong result size.", PixmapFilter_get_name(filter));
+    return best;
+}
+
+// Ближайший пиксель, обрезка, копирование областей и заливка на маленьких картинках:
+static void check_exact(void) {
+    Pixmap *src = make_random(37, 23, 3), *dst = make_random(50, 40, 3), *before = Pixmap_copy(dst);
+
+    // Копирование области, частично за краем:
+    Pixmap_blit(dst, -5, 30, src, 2, 1, 0, 0);
+    bool ok = true;
+    for (int y = 0; y < 40; y++) {
+        for (int x = 0; x < 50; x++) {
+            int sx = x + 5 + 2, sy = y - 30 + 1;
+            bool inside = sx >= 2 && sx < 37 && sy >= 1 && sy < 23;
+            const uint8_t *expect = inside ? (uint8_t*)src->data + (sy * 37 + sx) * 3 : (uint8_t*)before->data + (y * 50 + x) * 3;
+            ok &= memcmp(expect, (uint8_t*)dst->data + (y * 50 + x) * 3, 3) == 0;
+        }
+    }
+    TEST_CHECK(ok, "Pixmap_blit copied the wrong pixels.");
+
+    // Обрезка за краем:
+    Pixmap *crop = Pixmap_crop(src, 30, 20, 100, 100);
+    TEST_CHECK(crop && crop->width == 7 && crop->height == 3 &&
+               memcmp(crop->data, (uint8_t*)src->data + (20 * 37 + 30) * 3, 7 * 3) == 0, "Pixmap_crop cut the wrong area.");
+    Pixmap_destroy(&crop);
+
+    // Заливка за краем:
+    const float color[4] = { 1.0f, 0.5f, 0.0f, 1.0f };
+    Pixmap_fill_rect(dst, 45, -3, 100, 5, color);
+    ok = true;
+    for (int y = 0; y < 2; y++) {
+        for (int x = 45; x < 50; x++) {
+            const uint8_t *p = (uint8_t*)dst->data + (y * 50 + x) * 3;
+            ok &= p[0] == 255 && p[1] == 128 && p[2] == 0;
+        }
+    }
+    TEST_CHECK(ok, "Pixmap_fill_rect filled the wrong pixels.");
+
+    // Ближайший пиксель берёт исходный пиксель под центром результата:
+    Pixmap *near = Pixmap_resize(src, 70, 9, PIXMAP_FILTER_NEAREST);
+    ok = near != NULL;
+    for (int y = 0; ok && y < 9; y++) {
+        for (int x = 0; x < 70; x++) {
+            int sx = (int)((x + 0.5) * 37 / 70), sy = (int)((y + 0.5) * 23 / 9);
+            ok &= memcmp((uint8_t*)near->data + (y * 70 + x) * 3, (uint8_t*)src->data + (sy * 37 + sx) * 3, 3) == 0;
+        }
+    }
+    TEST_CHECK(ok, "Nearest resize picked the wrong pixels.");
+
+    Pixmap_destroy(&near);
+    Pixmap_destroy(&src);
+    Pixmap_destroy(&dst);
+    Pixmap_destroy(&before);
+}
+
+
+int main(void) {
+    CGDF_init();
+    srand(9);
+    check_exact();
+    printf("Best of %d, ms (CPU threads: %zu):\n", REPEATS, JobSystem_get_max_workers_count());
+
+    for (int hdr = 0; hdr < 2; hdr++) {
+        Pixmap *big = make_smooth(BIG_W, BIG_H, hdr);
+        Pixmap *small = make_smooth(SMALL_W, SMALL_H, hdr);
+        const char *format = hdr ? "RGBA32F" : "RGBA8";
+
+        for (int f = PIXMAP_FILTER_NEAREST; f <= PIXMAP_FILTER_LANCZOS; f++) {
+            PixmapFilter filter = (PixmapFilter)f;
+            Pixmap *down = NULL, *up = NULL;
+            double down_ms = bench_resize(big, SMALL_W, SMALL_H, filter, &down);
+            double up_ms = bench_resize(small, BIG_W, BIG_H, filter, &up);
+            double down_psnr = down ? get_psnr(down, small) : 0.0;
+            double up_psnr = up ? get_psnr(up, big) : 0.0;
+            printf("  %-7s %-8s 4K->1080p %8.2f (%5.1f dB)  1080p->4K %8.2f (%5.1f dB)\n",
+                   format, PixmapFilter_get_name(filter), down_ms, down_psnr, up_ms, up_psnr);
+            if (filter != PIXMAP_FILTER_NEAREST) {
+                TEST_CHECK(down_psnr >= MIN_PSNR_DB && up_psnr >= MIN_PSNR_DB, "%s %s: PSNR below %.0f dB.",
+                           format, PixmapFilter_get_name(filter), MIN_PSNR_DB);
+            }
+            Pixmap_destroy(&down);
+            Pixmap_destroy(&up);
+        }
+
+        // Копирование, заливка и обрезка на 4K:
+        const float color[4] = { 0.25f, 0.5f, 0.75f, 1.0f };
+        Pixmap *dst = Pixmap_copy(big);
+        double blit = Tests_now_ms();
+        for (int r = 0; r < REPEATS; r++) Pixmap_blit(dst, 0, 0, big, 0, 0, 0, 0);
+        blit = (Tests_now_ms() - blit) / REPEATS;
+        double fill = Tests_now_ms();
+        for (int r = 0; r < REPEATS; r++) Pixmap_fill_rect(dst, 0, 0, BIG_W, BIG_H, color);
+        fill = (Tests_now_ms() - fill) / REPEATS;
+        double crop = Tests_now_ms();
+        for (int r = 0; r < REPEATS; r++) {
+            Pixmap *part = Pixmap_crop(big, BIG_W / 4, BIG_H / 4, SMALL_W, SMALL_H);
+            Pixmap_destroy(&part);
+        }
+        crop = (Tests_now_ms() - crop) / REPEATS;
+        printf("  %-7s blit 4K %.2f, fill 4K %.2f, crop 1080p %.2f\n", format, blit, fill, crop);
+
+        Pixmap_destroy(&dst);
+        Pixmap_destroy(&big);
+        Pixmap_destroy(&small);
+    }
+
+    CGDF_destroy();
+    return Tests_result();
+}
@@ -0,0 +1,98 @@
+//
+// bench_scenegraph.c - Замер пересчёта мировых матриц: дерево Node против плоского SceneGraph (100k узлов).
+//
+// Случайное дерево строится одинаково в обоих видах, матрицы сравниваются побитово.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define NODES_COUNT 100000
+#define FRAMES      20
+
+
+// Сравнить мировые матрицы Node и SceneGraph (true - побитово одинаковы):
+static bool compare_all(Node **nodes, SceneGraph *graph, SceneHandle *handles, size_t count) {
+    mat4 a, b;
+    for (size_t i = 0; i < count; i++) {
+        Node_get_transform(nodes[i], a);
+        SceneGraph_get_transform(graph, handles[i], b);
+        if (memcmp(a, b, sizeof(mat4)) != 0) return false;
+    }
+    return true;
+}
+
+
+int main(void) {
+    CGDF_init();
+    Node **nodes = (Node**)mm_alloc(sizeof(Node*) * NODES_COUNT);
+    SceneHandle *handles = (SceneHandle*)mm_alloc(sizeof(SceneHandle) * NODES_COUNT);
+    SceneGraph *graph = SceneGraph_create(NODES_COUNT);
+
+    // Случайное дерево (родитель всегда создан раньше):
+    srand(1);
+    nodes[0] = Node_create(NULL);
+    handles[0] = SceneGraph_add(graph, SCENE_HANDLE_NULL);
+    for (size_t i = 1; i < NODES_COUNT; i++) {
+        size_t parent = (size_t)rand() % i;
+        Vec3d position = { rand() % 10, 1, 2 };
+        float angle = (float)(rand() % 90);
+        nodes[i] = Node_create(nodes[parent]);
+        Node_set_position(nodes[i], position);
+        Node_rotate(nodes[i], (Vec3d){0, 1, 0}, angle);
+        handles[i] = SceneGraph_add(graph, handles[parent]);
+        SceneGraph_set_position(graph, handles[i], position);
+        SceneGraph_set_quaternion(graph, handles[i], nodes[i]->quaternion);
+    }
+    TEST_CHECK(compare_all(nodes, graph, handles, NODES_COUNT), "World matrices differ after build.");
+
+    // Сдвиг корня и чтение всех матриц:
+    mat4 m;
+    double t0 = Tests_now_ms();
+    for (int f = 0; f < FRAMES; f++) {
+        Node_set_position(nodes[0], (Vec3d){f, 0, 0});
+        for (size_t i = 0; i < NODES_COUNT; i++) Node_get_transform(nodes[i], m);
+    }
+    double t1 = Tests_now_ms();
+    for (int f = 0; f < FRAMES; f++) {
+        SceneGraph_set_position(graph, handles[0], (Vec3d){f, 0, 0});
+        SceneGraph_update(graph);
+        for (size_t i = 0; i < NODES_COUNT; i++) SceneGraph_get_transform(graph, handles[i], m);
+    }
+    double t2 = Tests_now_ms();
+    for (int f = 0; f < FRAMES; f++) {
+        SceneGraph_set_position(graph, handles[0], (Vec3d){f, 0, 0});
+        SceneGraph_update(graph);
+    }
+    double t3 = Tests_now_ms();
+    TEST_CHECK(compare_all(nodes, graph, handles, NODES_COUNT), "World matrices differ after moving the root.");
+
+    // Сдвиг каждого узла:
+    double t4 = Tests_now_ms();
+    for (int f = 0; f < FRAMES; f++) {
+        for (size_t i = 0; i < NODES_COUNT; i++) Node_set_position(nodes[i], (Vec3d){f, 0, (double)i});
+        for (size_t i = 0; i < NODES_COUNT; i++) Node_get_transform(nodes[i], m);
+    }
+    double t5 = Tests_now_ms();
+    for (int f = 0; f < FRAMES; f++) {
+        for (size_t i = 0; i < NODES_COUNT; i++) SceneGraph_set_position(graph, handles[i], (Vec3d){f, 0, (double)i});
+        SceneGraph_update(graph);
+    }
+    double t6 = Tests_now_ms();
+    TEST_CHECK(compare_all(nodes, graph, handles, NODES_COUNT), "World matrices differ after moving every node.");
+
+    printf("%d nodes, ms per frame:\n", NODES_COUNT);
+    printf("  root moved, all world matrices read:  Node %.2f, SceneGraph %.2f\n", (t1 - t0) / FRAMES, (t2 - t1) / FRAMES);
+    printf("  root moved, update only:              SceneGraph %.2f\n", (t3 - t2) / FRAMES);
+    printf("  every node moved:                     Node %.2f, SceneGraph %.2f\n", (t5 - t4) / FRAMES, (t6 - t5) / FRAMES);
+
+    SceneGraph_destroy(&graph);
+    Node_destroy(&nodes[0]);
+    mm_free(nodes);
+    mm_free(handles);
+    CGDF_destroy();
+    return Tests_result();
+}
@@ -0,0 +1,95 @@
+//
+// bench_scenegraph_parallel.c - Масштабирование SceneGraph_update_parallel от 1 до N потоков (10k - 1M узлов).
+//
+// Каждый замер сверяет все мировые матрицы с последовательным SceneGraph_update побитово.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define REPEATS 5  // Берём лучший из замеров.
+
+
+// Построить случайный граф (8 корней, родитель всегда создан раньше):
+static SceneGraph* build_graph(size_t count, SceneHandle *handles) {
+    SceneGraph *graph = SceneGraph_create(count);
+    srand(1);
+    for (size_t i = 0; i < count; i++) {
+        SceneHandle parent = i < 8 ? SCENE_HANDLE_NULL : handles[(size_t)rand() % i];
+        handles[i] = SceneGraph_add(graph, parent);
+        SceneGraph_set_position(graph, handles[i], (Vec3d){rand() % 100 * 0.01, rand() % 100 * 0.01, 0.5});
+        SceneGraph_rotate(graph, handles[i], (Vec3d){0, 1, 0}, (float)(rand() % 360));
+    }
+    return graph;
+}
+
+// Сдвинуть корни (весь граф становится грязным):
+static void move_roots(SceneGraph *graph, SceneHandle *handles) {
+    for (size_t k = 0; k < 8; k++) SceneGraph_rotate(graph, handles[k], (Vec3d){0, 0, 1}, 1.0f);
+}
+
+// Сравнить мировые матрицы двух графов по хэндлам (порядок хранения у них может отличаться):
+static bool compare_graphs(SceneGraph *a, SceneHandle *ha, SceneGraph *b, SceneHandle *hb, size_t count) {
+    mat4 ma, mb;
+    for (size_t i = 0; i < count; i++) {
+        SceneGraph_get_transform(a, ha[i], ma);
+        SceneGraph_get_transform(b, hb[i], mb);
+        if (memcmp(ma, mb, sizeof(mat4)) != 0) return false;
+    }
+    return true;
+}
+
+
+int main(void) {
+    CGDF_init();
+    size_t max_workers = JobSystem_get_max_workers_count();
+    size_t sizes[] = { 10000, 100000, 1000000 };
+    printf("Random tree, whole tree dirty, best of %d, ms (CPU threads: %zu):\n", REPEATS, max_workers);
+
+    // Степени двойки и само количество потоков процессора (не меньше 4, чтобы параллельный путь
+    // проверялся и на машинах с 1-2 потоками):
+    size_t top = max_workers < 4 ? 4 : max_workers;
+    size_t workers[32], workers_count = 0;
+    for (size_t w = 1; w < top && workers_count < 31; w *= 2) workers[workers_count++] = w;
+    workers[workers_count++] = top;
+    printf("  %8s", "nodes");
+    for (size_t i = 0; i < workers_count; i++) printf("  %7zu w", workers[i]);
+    printf("\n");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t count = sizes[s];
+        SceneHandle *ha = (SceneHandle*)mm_alloc(sizeof(SceneHandle) * count);
+        SceneHandle *hb = (SceneHandle*)mm_alloc(sizeof(SceneHandle) * count);
+        SceneGraph *serial = build_graph(count, ha);
+        SceneGraph *parallel = build_graph(count, hb);
+        SceneGraph_update(serial);
+        SceneGraph_update_parallel(parallel, 0);  // Сортировка по глубине - вне замеров.
+        printf("  %8zu", count);
+
+        for (size_t i = 0; i < workers_count; i++) {
+            size_t w = workers[i];
+            double best = 1e30;
+            for (int r = 0; r < REPEATS; r++) {
+                move_roots(serial, ha);
+                move_roots(parallel, hb);
+                SceneGraph_update(serial);
+                double t0 = Tests_now_ms();
+                SceneGraph_update_parallel(parallel, w);
+                double t = Tests_now_ms() - t0;
+                if (t < best) best = t;
+            }
+            TEST_CHECK(compare_graphs(serial, ha, parallel, hb, count), "%zu nodes, %zu workers: differs from the serial path.", count, w);
+            printf("  %9.3f", best);
+        }
+        printf("\n");
+        SceneGraph_destroy(&serial);
+        SceneGraph_destroy(&parallel);
+        mm_free(ha);
+        mm_free(hb);
+    }
+    CGDF_destroy();
+    return Tests_result();
+}
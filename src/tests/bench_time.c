@@ -0,0 +1,125 @@
+//
+// bench_time.c - Замер часов из time.h: стоимость вызова, наименьший шаг и калибровка счётчика тактов.
+//
+// Проверяется монотонность Time_get_ns, совпадение сна по часам и по тактам, секундомер и скользящее среднее.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define CALLS_COUNT 2000000  // Вызовов на замер стоимости.
+#define STEP_TRIES  100000   // Попыток на поиск наименьшего шага.
+#define SLEEP_SEC   0.1      // Длительность сна для сверки часов и тактов.
+
+
+// Сток для результатов, чтобы компилятор не выкинул вызовы:
+static volatile uint64_t g_Sink = 0;
+
+
+// Стоимость одного вызова каждого источника времени в наносекундах:
+static void bench_calls(void) {
+    uint64_t t0, t1;
+
+    t0 = Time_get_ns();
+    for (int i = 0; i < CALLS_COUNT; i++) g_Sink += Time_get_ns();
+    t1 = Time_get_ns();
+    printf("  Time_get_ns      %6.1f ns/call\n", (double)(t1 - t0) / CALLS_COUNT);
+
+    t0 = Time_get_ns();
+    for (int i = 0; i < CALLS_COUNT; i++) g_Sink += Time_get_cycles();
+    t1 = Time_get_ns();
+    printf("  Time_get_cycles  %6.1f ns/call\n", (double)(t1 - t0) / CALLS_COUNT);
+
+    #if !defined(_WIN32) && !defined(_WIN64)
+        struct timeval tv;
+        t0 = Time_get_ns();
+        for (int i = 0; i < CALLS_COUNT; i++) { gettimeofday(&tv, NULL); g_Sink += (uint64_t)tv.tv_usec; }
+        t1 = Time_get_ns();
+        printf("  gettimeofday     %6.1f ns/call\n", (double)(t1 - t0) / CALLS_COUNT);
+    #endif
+
+    t0 = Time_get_ns();
+    for (int i = 0; i < CALLS_COUNT; i++) g_Sink += (uint64_t)Time_now(NULL);
+    t1 = Time_get_ns();
+    printf("  Time_now         %6.1f ns/call\n", (double)(t1 - t0) / CALLS_COUNT);
+}
+
+// Наименьший ненулевой шаг часов (заодно проверяется, что Time_get_ns не идёт назад):
+static void bench_steps(void) {
+    uint64_t best_ns = UINT64_MAX;
+    size_t backwards = 0;
+    for (int i = 0; i < STEP_TRIES; i++) {
+        uint64_t a = Time_get_ns(), b;
+        do {
+            b = Time_get_ns();
+            if (b < a) backwards++;
+        } while (b <= a);
+        if (b - a < best_ns) best_ns = b - a;
+    }
+    TEST_CHECK(backwards == 0, "Time_get_ns went backwards %zu times.", backwards);
+
+    double best_now = 1.0;
+    for (int i = 0; i < STEP_TRIES / 10; i++) {
+        double a = Time_now(NULL), b;
+        do b = Time_now(NULL); while (b == a);
+        if (b > a && b - a < best_now) best_now = b - a;
+    }
+    printf("  Time_get_ns smallest step %llu ns, Time_now smallest step %.0f ns\n",
+           (unsigned long long)best_ns, best_now * 1e9);
+}
+
+// Калибровка тактов: сон, измеренный часами и тактами, должен совпадать:
+static void check_cycles(void) {
+    Time_calibrate_cycles(0.05);
+    TEST_CHECK(atomic_load(&g_TimeCyclesPerNs) > 0.0, "Cycle counter is not calibrated.");
+    uint64_t c0 = Time_get_cycles(), n0 = Time_get_ns();
+    Time_sleep(SLEEP_SEC);
+    uint64_t c1 = Time_get_cycles(), n1 = Time_get_ns();
+    double by_clock = Time_ns_to_ms(n1 - n0), by_cycles = Time_cycles_to_ns(c1 - c0) / 1e6;
+    printf("  cycles per ns %.4f, %.0f ms sleep: %.3f ms by clock, %.3f ms by cycles\n",
+           atomic_load(&g_TimeCyclesPerNs), SLEEP_SEC * 1e3, by_clock, by_cycles);
+    TEST_CHECK(by_clock >= SLEEP_SEC * 1e3 * 0.99, "Sleep was shorter than requested: %.3f ms.", by_clock);
+    TEST_CHECK(fabs(by_cycles - by_clock) <= by_clock * 0.05, "Cycles and clock disagree: %.3f vs %.3f ms.", by_cycles, by_clock);
+
+    // Time_sleep_until_ns спит до абсолютного срока:
+    uint64_t deadline = Time_get_ns() + Time_sec_to_ns(0.02);
+    Time_sleep_until_ns(deadline);
+    TEST_CHECK(Time_get_ns() >= deadline, "Time_sleep_until_ns woke up before the deadline.");
+}
+
+// Секундомер и скользящее среднее:
+static void check_helpers(void) {
+    TimeStopwatch sw = {0};
+    Time_stopwatch_start(&sw);
+    Time_sleep(0.01);
+    Time_stopwatch_stop(&sw);
+    uint64_t first = Time_stopwatch_elapsed_ns(&sw);
+    Time_sleep(0.01);  // Остановленный секундомер не идёт.
+    TEST_CHECK(Time_stopwatch_elapsed_ns(&sw) == first, "Stopped stopwatch kept running.");
+    Time_stopwatch_start(&sw);
+    Time_sleep(0.01);
+    TEST_CHECK(Time_stopwatch_elapsed_ns(&sw) >= first + Time_sec_to_ns(0.0099), "Stopwatch did not accumulate.");
+    Time_stopwatch_reset(&sw);
+    TEST_CHECK(Time_stopwatch_elapsed_ns(&sw) == 0, "Stopwatch was not reset.");
+
+    TimeAverage avg;
+    Time_average_init(&avg, 4);
+    for (int i = 1; i <= 6; i++) Time_average_add(&avg, i);
+    TEST_CHECK(Time_average_get(&avg) == 4.5, "Average of the last 4 of 1..6 is %g, expected 4.5.", Time_average_get(&avg));
+}
+
+
+int main(void) {
+    CGDF_init();
+    printf("Cost per call (%d calls):\n", CALLS_COUNT);
+    bench_calls();
+    printf("Resolution and calibration:\n");
+    bench_steps();
+    check_cycles();
+    check_helpers();
+    CGDF_destroy();
+    return Tests_result();
+}
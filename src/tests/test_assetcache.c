@@ -0,0 +1,185 @@
+//
+// test_assetcache.c - Проверка кэша подготовленных ассетов: ключи, запись и чтение, битые записи.
+//
+// Ключ должен меняться от любого байта исходника, настроек или вида ассета, записи с чужим заголовком,
+// ключом или размером - отбрасываться. В конце замеряется Pixmap_load по текстурам из "data/textures/"
+// с пустым кэшем (декодирование и запись) и с заполненным (только чтение записи).
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define CACHE_DIR TESTS_TMP_DIR "assetcache"
+#define KIND      "test"
+#define REPEATS   3  // Берём лучший из замеров с заполненным кэшем.
+
+
+// Текстуры для замера:
+static const char *g_Files[] = {
+    "data/textures/blue-noise.bmp", "data/textures/gradient_uv_checker.png", "data/textures/skysphere.png",
+    "data/textures/texture-1.png", "data/textures/texture-2.png", "data/textures/texture-3.png",
+    "data/textures/uv_checker.png",
+};
+#define FILES_COUNT (sizeof(g_Files) / sizeof(g_Files[0]))
+
+
+// Путь к записи кэша (как в assetcache.c):
+static void entry_path(const char *kind, uint64_t key, char *out, size_t size) {
+    snprintf(out, size, "%s/%s-%016llx.ck", CACHE_DIR, kind, (unsigned long long)key);
+}
+
+// Совпадает ли запись кэша с ожидаемыми данными:
+static bool load_equals(uint64_t key, const void *data, size_t size) {
+    CookedAsset asset;
+    if (!AssetCache_load(KIND, key, &asset)) return false;
+    bool same = asset.size == size && memcmp(asset.data, data, size) == 0;
+    AssetCache_release(&asset);
+    return same;
+}
+
+// Совпадают ли картинки:
+static bool same_pixmap(const Pixmap *a, const Pixmap *b) {
+    return a && b && a->width == b->width && a->height == b->height && a->channels == b->channels &&
+           a->is_hdr == b->is_hdr && memcmp(a->data, b->data, Pixmap_get_size((Pixmap*)a)) == 0;
+}
+
+
+// Хэш совпадает с XXH64, ключ зависит от всех входов:
+static void check_keys(void) {
+    TEST_CHECK(AssetCache_hash("", 0, 0) == 0xEF46DB3751D8E999ULL, "XXH64 of empty data is wrong.");
+    TEST_CHECK(AssetCache_hash("abc", 3, 0) == 0x44BC2CF5AD770999ULL, "XXH64 of \"abc\" is wrong.");
+
+    unsigned char source[100];
+    for (size_t i = 0; i < sizeof(source); i++) source[i] = (unsigned char)(i * 7);
+    int32_t settings = 4, other_settings = 3;
+    uint64_t key = AssetCache_key(KIND, source, sizeof(source), &settings, sizeof(settings));
+    TEST_CHECK(key == AssetCache_key(KIND, source, sizeof(source), &settings, sizeof(settings)), "Key is not stable.");
+    TEST_CHECK(key != AssetCache_key(KIND, source, sizeof(source), &other_settings, sizeof(other_settings)),
+               "Key does not depend on the settings.");
+    TEST_CHECK(key != AssetCache_key("other", source, sizeof(source), &settings, sizeof(settings)),
+               "Key does not depend on the asset kind.");
+    for (size_t i = 0; i < sizeof(source); i += 33) {
+        source[i] ^= 1;
+        bool changed = key != AssetCache_key(KIND, source, sizeof(source), &settings, sizeof(settings));
+        source[i] ^= 1;
+        TEST_CHECK(changed, "Key does not depend on source byte %zu.", i);
+    }
+}
+
+// Запись и чтение, промах при изменённом исходнике или настройках:
+static void check_store_load(void) {
+    const char source[] = "source bytes", cooked_a[] = "cooked ", cooked_b[] = "data";
+    int32_t settings = (int32_t)(Time_get_ns() & 0x7FFFFFFF);  // Свои настройки на каждый запуск: кэш от прошлых пуст.
+    uint64_t key = AssetCache_key(KIND, source, sizeof(source), &settings, sizeof(settings));
+    CookedPart parts[2] = { { cooked_a, 7 }, { cooked_b, 4 } };
+    CookedAsset asset;
+
+    TEST_CHECK(!AssetCache_load(KIND, key, &asset), "Hit before the entry was stored.");
+    TEST_CHECK(AssetCache_store(KIND, key, parts, 2), "AssetCache_store failed.");
+    TEST_CHECK(load_equals(key, "cooked data", 11), "Stored entry reads back wrong.");
+
+    // Изменённый исходник или настройки дают другой ключ - промах:
+    char changed[sizeof(source)];
+    memcpy(changed, source, sizeof(source));
+    changed[0] ^= 1;
+    int32_t other_settings = settings + 1;
+    uint64_t changed_key = AssetCache_key(KIND, changed, sizeof(changed), &settings, sizeof(settings));
+    uint64_t settings_key = AssetCache_key(KIND, source, sizeof(source), &other_settings, sizeof(other_settings));
+    TEST_CHECK(!AssetCache_load(KIND, changed_key, &asset), "Hit after the source bytes changed.");
+    TEST_CHECK(!AssetCache_load(KIND, settings_key, &asset), "Hit after the settings changed.");
+
+    // Повреждённая сигнатура:
+    char path[1024];
+    entry_path(KIND, key, path, sizeof(path));
+    size_t size = 0;
+    unsigned char *data = Files_load_bin(path, "rb", &size);
+    TEST_CHECK(data && size == 24 + 11, "Entry file has %zu bytes.", size);
+    if (!data) return;
+    data[0] ^= 0xFF;
+    Files_save_bin(path, data, size, "wb");
+    TEST_CHECK(!AssetCache_load(KIND, key, &asset), "Entry with a corrupted header was accepted.");
+
+    // Обрезанные данные (размер в заголовке не сходится с файлом):
+    data[0] ^= 0xFF;
+    Files_save_bin(path, data, size - 1, "wb");
+    TEST_CHECK(!AssetCache_load(KIND, key, &asset), "Truncated entry was accepted.");
+
+    // Запись другого ключа под этим именем:
+    Files_save_bin(path, data, size, "wb");
+    TEST_CHECK(load_equals(key, "cooked data", 11), "Restored entry reads back wrong.");
+    entry_path(KIND, changed_key, path, sizeof(path));
+    Files_save_bin(path, data, size, "wb");
+    TEST_CHECK(!AssetCache_load(KIND, changed_key, &asset), "Entry of another key was accepted.");
+    mm_free(data);
+
+    // Записи этого запуска больше не нужны:
+    remove(path);
+    entry_path(KIND, key, path, sizeof(path));
+    remove(path);
+}
+
+// Pixmap_load с пустым и заполненным кэшем:
+static void bench_pixmaps(void) {
+    Pixmap *reference[FILES_COUNT];
+    double plain = Tests_now_ms();
+    for (size_t i = 0; i < FILES_COUNT; i++) reference[i] = Pixmap_load(g_Files[i], 4);
+    plain = Tests_now_ms() - plain;
+
+    // Удаляем записи прошлых запусков:
+    TEST_CHECK(AssetCache_init(CACHE_DIR), "AssetCache_init failed.");
+    char paths[FILES_COUNT][1024];
+    for (size_t i = 0; i < FILES_COUNT; i++) {
+        size_t size = 0;
+        unsigned char *data = Files_load_bin(g_Files[i], "rb", &size);
+        int32_t settings = 4;
+        entry_path("pixmap", AssetCache_key("pixmap", data, size, &settings, sizeof(settings)), paths[i], sizeof(paths[i]));
+        remove(paths[i]);
+        mm_free(data);
+    }
+
+    double cold = Tests_now_ms();
+    for (size_t i = 0; i < FILES_COUNT; i++) {
+        Pixmap *pixmap = Pixmap_load(g_Files[i], 4);
+        TEST_CHECK(same_pixmap(pixmap, reference[i]), "%s: cold cache load differs.", g_Files[i]);
+        Pixmap_destroy(&pixmap);
+    }
+    cold = Tests_now_ms() - cold;
+    for (size_t i = 0; i < FILES_COUNT; i++) TEST_CHECK(Files_exists(paths[i]), "%s: no cache entry after load.", g_Files[i]);
+
+    double warm = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        double t0 = Tests_now_ms();
+        for (size_t i = 0; i < FILES_COUNT; i++) {
+            Pixmap *pixmap = Pixmap_load(g_Files[i], 4);
+            TEST_CHECK(same_pixmap(pixmap, reference[i]), "%s: warm cache load differs.", g_Files[i]);
+            Pixmap_destroy(&pixmap);
+        }
+        double t = Tests_now_ms() - t0;
+        if (t < warm) warm = t;
+    }
+    printf("Pixmap_load of %zu files, ms: no cache %.2f, cold cache %.2f, warm cache %.2f\n",
+           FILES_COUNT, plain, cold, warm);
+
+    for (size_t i = 0; i < FILES_COUNT; i++) Pixmap_destroy(&reference[i]);
+}
+
+
+int main(void) {
+    CGDF_init();
+    TEST_CHECK(Tests_make_dir(TESTS_TMP_DIR), "Failed to create %s.", TESTS_TMP_DIR);
+
+    check_keys();
+    TEST_CHECK(AssetCache_init(CACHE_DIR), "AssetCache_init failed.");
+    TEST_CHECK(AssetCache_is_enabled() && strcmp(AssetCache_get_dir(), CACHE_DIR) == 0, "Cache is not enabled.");
+    check_store_load();
+    AssetCache_destroy();
+    TEST_CHECK(!AssetCache_is_enabled(), "Cache is still enabled after AssetCache_destroy.");
+
+    bench_pixmaps();
+    AssetCache_destroy();
+    CGDF_destroy();
+    return Tests_result();
+}
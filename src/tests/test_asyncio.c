@@ -0,0 +1,215 @@
+//
+// test_asyncio.c - Проверка AsyncIO: файлы с диска и из пакетов, дескрипторы запросов, отмена и доставка.
+//
+// Обратный вызов не должен приходить внутри AsyncIO_read*, а дескриптор доставленного запроса (в том числе
+// после повторного использования его слота) не должен влиять на новые запросы.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define DIR_PATH    TESTS_TMP_DIR "asyncio/"
+#define PACK_DIR    DIR_PATH "pack/"
+#define PACK_PATH   DIR_PATH "asyncio.pack"
+#define LOOSE_PATH  DIR_PATH "loose.bin"
+#define SPARSE_PATH DIR_PATH "sparse.bin"   // Разреженный файл больше 2 ГБ.
+#define FAR_OFFSET  3000000000ull             // Смещение за пределами long в 32 бита.
+#define TEXT_PATH   "pack/text.txt"    // Путь в пакете (сжимается).
+#define RANDOM_PATH "pack/random.bin"  // Путь в пакете (не сжимается).
+#define FILE_SIZE   200000
+#define STRESS      2000
+
+
+// Результаты запросов:
+typedef struct Result {
+    AsyncIOStatus status;
+    size_t size;
+    bool matches;     // Данные совпали с ожидаемыми.
+    atomic_int calls; // Сколько раз пришёл обратный вызов.
+} Result;
+
+
+// Ожидаемое содержимое файлов и состояние проверки:
+static unsigned char g_Loose[FILE_SIZE], g_Text[FILE_SIZE], g_Random[FILE_SIZE];
+static thrd_t g_MainThread;
+static atomic_bool g_InSubmit;      // Главный поток сейчас внутри AsyncIO_read*.
+static atomic_int g_InsideSubmit;   // Обратных вызовов внутри AsyncIO_read*.
+static atomic_int g_Calls;          // Всего обратных вызовов.
+
+
+// Ожидаемые данные по пути:
+static const unsigned char* expected(const char *path) {
+    if (strcmp(path, LOOSE_PATH) == 0) return g_Loose;
+    if (strcmp(path, TEXT_PATH) == 0) return g_Text;
+    return g_Random;
+}
+
+// Обратный вызов целого файла (user - Result):
+static void on_file(const AsyncIOResult *result) {
+    Result *r = (Result*)result->user;
+    if (atomic_load(&g_InSubmit) && thrd_equal(thrd_current(), g_MainThread)) atomic_fetch_add(&g_InsideSubmit, 1);
+    r->status = result->status;
+    r->size = result->size;
+    r->matches = result->status == ASYNCIO_DONE && result->size == FILE_SIZE &&
+                 memcmp(result->data, expected(result->path), FILE_SIZE) == 0 && result->data[FILE_SIZE] == '\0';
+    mm_free(result->data);
+    atomic_fetch_add(&r->calls, 1);
+    atomic_fetch_add(&g_Calls, 1);
+}
+
+// Обратный вызов части файла (данные сверяются в main):
+static void on_part(const AsyncIOResult *result) {
+    Result *r = (Result*)result->user;
+    if (atomic_load(&g_InSubmit) && thrd_equal(thrd_current(), g_MainThread)) atomic_fetch_add(&g_InsideSubmit, 1);
+    r->status = result->status;
+    r->size = result->size;
+    atomic_fetch_add(&r->calls, 1);
+    atomic_fetch_add(&g_Calls, 1);
+}
+
+// Прочитать файл целиком (с пометкой, что главный поток внутри отправки):
+static AsyncIOHandle read_file(const char *path, Result *r, AsyncIODelivery delivery) {
+    atomic_store(&g_InSubmit, true);
+    AsyncIOHandle handle = AsyncIO_read_file(path, on_file, r, delivery);
+    atomic_store(&g_InSubmit, false);
+    return handle;
+}
+
+// Создать файлы и пакет:
+static bool prepare_files(void) {
+    srand(3);
+    for (size_t i = 0; i < FILE_SIZE; i++) {
+        g_Loose[i] = (unsigned char)rand();
+        g_Random[i] = (unsigned char)rand();
+        g_Text[i] = (unsigned char)("asyncio test text "[i % 18]);
+    }
+    if (!Tests_make_dir(TESTS_TMP_DIR) || !Tests_make_dir(DIR_PATH) || !Tests_make_dir(PACK_DIR)) return false;
+    if (!Files_save_bin(LOOSE_PATH, g_Loose, FILE_SIZE, "wb")) return false;
+    if (!Files_save_bin(PACK_DIR "text.txt", g_Text, FILE_SIZE, "wb")) return false;
+    if (!Files_save_bin(PACK_DIR "random.bin", g_Random, FILE_SIZE, "wb")) return false;
+    return Tests_build_pack(PACK_DIR, PACK_PATH, true) && VFS_mount(PACK_PATH);
+}
+
+// Целые файлы с диска и из пакета, доставка в главный поток и задачей:
+static void check_files(void) {
+    const char *paths[] = { LOOSE_PATH, TEXT_PATH, RANDOM_PATH };
+    for (int delivery = 0; delivery < 2; delivery++) {
+        for (int i = 0; i < 3; i++) {
+            Result r = { 0 };
+            AsyncIOHandle handle = read_file(paths[i], &r, (AsyncIODelivery)delivery);
+            TEST_CHECK(handle.index != UINT32_MAX, "%s: no handle.", paths[i]);
+            AsyncIO_wait_all();
+            TEST_CHECK(atomic_load(&r.calls) == 1 && r.matches, "%s (delivery %d): wrong data or %d callbacks.",
+                       paths[i], delivery, atomic_load(&r.calls));
+            TEST_CHECK(!AsyncIO_is_pending(handle), "%s: delivered request is still pending.", paths[i]);
+            AsyncIO_cancel(handle);  // Дескриптор доставленного запроса ничего не делает.
+        }
+    }
+}
+
+// Часть файла со смещением (в том числе за концом файла):
+static void check_parts(void) {
+    const char *paths[] = { LOOSE_PATH, TEXT_PATH, RANDOM_PATH };
+    static unsigned char buffer[4096];
+    for (int i = 0; i < 3; i++) {
+        Result r = { 0 };
+        AsyncIO_read(paths[i], buffer, 12345, sizeof(buffer), on_part, &r, ASYNCIO_DELIVER_MAIN);
+        AsyncIO_wait_all();
+        TEST_CHECK(r.status == ASYNCIO_DONE && r.size == sizeof(buffer) && memcmp(buffer, expected(paths[i]) + 12345, sizeof(buffer)) == 0,
+                   "%s: wrong partial read.", paths[i]);
+        r = (Result){ 0 };
+        AsyncIO_read(paths[i], buffer, FILE_SIZE - 100, sizeof(buffer), on_part, &r, ASYNCIO_DELIVER_MAIN);
+        AsyncIO_wait_all();
+        TEST_CHECK(r.status == ASYNCIO_DONE && r.size == 100 && memcmp(buffer, expected(paths[i]) + FILE_SIZE - 100, 100) == 0,
+                   "%s: wrong read past the end (%zu bytes).", paths[i], r.size);
+    }
+}
+
+// Дескриптор доставленного запроса не отменяет новый запрос в том же слоте:
+static void check_stale_handle(void) {
+    Result a = { 0 }, b = { 0 };
+    AsyncIOHandle old = read_file(LOOSE_PATH, &a, ASYNCIO_DELIVER_MAIN);
+    AsyncIO_wait_all();
+    AsyncIOHandle handle = read_file(LOOSE_PATH, &b, ASYNCIO_DELIVER_MAIN);
+    TEST_CHECK(handle.index == old.index && handle.generation != old.generation, "Slot was not reused with a new generation.");
+    AsyncIO_cancel(old);
+    AsyncIO_wait_all();
+    TEST_CHECK(b.status == ASYNCIO_DONE && b.matches, "A stale handle canceled the new request.");
+
+    Result c = { 0 };
+    handle = read_file(RANDOM_PATH, &c, ASYNCIO_DELIVER_MAIN);
+    AsyncIO_cancel(handle);  // Пакет читается потоком ввода-вывода, поэтому запрос ещё можно отменить.
+    AsyncIO_wait_all();
+    TEST_CHECK(atomic_load(&c.calls) == 1 && (c.status == ASYNCIO_CANCELED || c.status == ASYNCIO_DONE),
+               "Canceled request: %d callbacks, status %d.", atomic_load(&c.calls), c.status);
+}
+
+// Чтение по смещению больше 2 ГБ (разреженный файл, место на диске почти не занимает):
+static void check_large_offset(void) {
+    FILE *f = fopen(SPARSE_PATH, "wb");
+    #if defined(_WIN32) || defined(_WIN64)
+        bool seeked = f && _fseeki64(f, (__int64)FAR_OFFSET, SEEK_SET) == 0;
+    #else
+        bool seeked = f && fseeko(f, (off_t)FAR_OFFSET, SEEK_SET) == 0;
+    #endif
+    bool written = seeked && fwrite(g_Loose, 1, 4096, f) == 4096;
+    if (f) fclose(f);
+    if (!written) {
+        printf("Skipping the large offset check: cannot create a sparse file.\n");
+        remove(SPARSE_PATH);
+        return;
+    }
+    static unsigned char buffer[4096];
+    Result r = { 0 };
+    AsyncIO_read(SPARSE_PATH, buffer, FAR_OFFSET, sizeof(buffer), on_part, &r, ASYNCIO_DELIVER_MAIN);
+    AsyncIO_wait_all();
+    TEST_CHECK(r.status == ASYNCIO_DONE && r.size == sizeof(buffer) && memcmp(buffer, g_Loose, sizeof(buffer)) == 0,
+               "Wrong read at a 3 GB offset (status %d, %zu bytes).", r.status, r.size);
+    remove(SPARSE_PATH);
+}
+
+// Много запросов с доставкой задачей и отменой сразу после отправки:
+static void check_stress(void) {
+    static Result results[STRESS];
+    const char *paths[] = { LOOSE_PATH, TEXT_PATH, RANDOM_PATH };
+    memset(results, 0, sizeof(results));
+    atomic_store(&g_Calls, 0);
+    for (int i = 0; i < STRESS; i++) {
+        AsyncIOHandle handle = read_file(paths[i % 3], &results[i], i % 4 == 0 ? ASYNCIO_DELIVER_MAIN : ASYNCIO_DELIVER_JOB);
+        if (i % 2) AsyncIO_cancel(handle);
+    }
+    AsyncIO_wait_all();
+    int wrong = 0;
+    for (int i = 0; i < STRESS; i++) {
+        Result *r = &results[i];
+        bool ok = atomic_load(&r->calls) == 1 &&
+                  (r->status == ASYNCIO_CANCELED ? i % 2 == 1 && r->size == 0 : r->matches);
+        wrong += !ok;
+    }
+    TEST_CHECK(atomic_load(&g_Calls) == STRESS, "%d callbacks for %d requests.", atomic_load(&g_Calls), STRESS);
+    TEST_CHECK(wrong == 0, "%d requests finished wrong.", wrong);
+    TEST_CHECK(AsyncIO_get_pending_count() == 0, "%zu requests still pending.", AsyncIO_get_pending_count());
+}
+
+
+int main(void) {
+    CGDF_init();
+    g_MainThread = thrd_current();
+    bool prepared = prepare_files();
+    TEST_CHECK(prepared, "Failed to create the test files and the pack.");
+    if (prepared) {
+        printf("Backend: %s\n", AsyncIO_is_uring() ? "io_uring" : "thread pool");
+        check_files();
+        check_parts();
+        check_stale_handle();
+        check_large_offset();
+        check_stress();
+        TEST_CHECK(atomic_load(&g_InsideSubmit) == 0, "%d callbacks ran inside AsyncIO_read*.", atomic_load(&g_InsideSubmit));
+        VFS_unmount_all();
+    }
+    CGDF_destroy();
+    return Tests_result();
+}
@@ -0,0 +1,100 @@
+//
+// test_files.c - Проверка Files_load_bin, Files_map и Files_load_bin_lz для файлов с диска и из пакетов.
+//
+// Files_load_bin и Files_map должны отдавать одно и то же содержимое для одного пути, а сжатие через
+// Files_save_bin_lz разворачивается только явно (Files_load_bin_lz).
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define DIR_PATH  TESTS_TMP_DIR "files/"
+#define PACK_DIR  DIR_PATH "data/"
+#define PACK_PATH DIR_PATH "files.pack"
+#define DATA_SIZE 300000
+
+
+// Исходные данные:
+static unsigned char g_Random[DATA_SIZE], g_Text[DATA_SIZE], g_Fake[64];
+
+
+// Files_load_bin и Files_map отдают для пути ожидаемые байты:
+static void check_same(const char *path, const void *data, size_t size) {
+    size_t loaded_size = 0;
+    unsigned char *loaded = Files_load_bin(path, "rb", &loaded_size);
+    FileMap map = Files_map(path, FILE_MAP_SEQUENTIAL);
+    TEST_CHECK(loaded && loaded_size == size && memcmp(loaded, data, size) == 0, "%s: Files_load_bin returned other bytes.", path);
+    TEST_CHECK(map.data && map.size == size && memcmp(map.data, data, size) == 0, "%s: Files_map returned other bytes.", path);
+    if (loaded) mm_free(loaded);
+    Files_unmap(&map);
+}
+
+// Files_load_bin_lz распаковывает файл в ожидаемые данные:
+static void check_lz(const char *path, const void *data, size_t size) {
+    size_t raw_size = 0;
+    unsigned char *raw = Files_load_bin_lz(path, &raw_size);
+    TEST_CHECK(raw && raw_size == size && memcmp(raw, data, size) == 0, "%s: Files_load_bin_lz returned other bytes.", path);
+    if (raw) mm_free(raw);
+}
+
+
+int main(void) {
+    CGDF_init();
+    srand(5);
+    for (size_t i = 0; i < DATA_SIZE; i++) {
+        g_Random[i] = (unsigned char)rand();
+        g_Text[i] = (unsigned char)("files test "[i % 11]);
+    }
+
+    // Двоичные данные, которые начинаются как заголовок сжатого кадра ("CGLZ", размер блока и размер данных):
+    for (size_t i = 0; i < sizeof(g_Fake); i++) g_Fake[i] = (unsigned char)(i < 16 ? 0 : i);
+    memcpy(g_Fake, LZ_FRAME_MAGIC, 4);
+    g_Fake[4] = LZ_BLOCK_SIZE & 0xFF;
+    g_Fake[5] = (LZ_BLOCK_SIZE >> 8) & 0xFF;
+    g_Fake[6] = (LZ_BLOCK_SIZE >> 16) & 0xFF;
+    g_Fake[8] = 16;
+    TEST_CHECK(LZ_frame_get_size(g_Fake, sizeof(g_Fake), NULL), "The fake header is not recognized as a frame.");
+
+    bool prepared = Tests_make_dir(TESTS_TMP_DIR) && Tests_make_dir(DIR_PATH) && Tests_make_dir(PACK_DIR) &&
+                    Files_save_bin(PACK_DIR "random.bin", g_Random, DATA_SIZE, "wb") &&
+                    Files_save_bin(PACK_DIR "text.txt", g_Text, DATA_SIZE, "wb") &&
+                    Files_save_bin(PACK_DIR "fake.bin", g_Fake, sizeof(g_Fake), "wb") &&
+                    Files_save_bin_lz(PACK_DIR "text.lz", g_Text, DATA_SIZE);
+    TEST_CHECK(prepared, "Failed to create the test files.");
+    if (!prepared) {
+        CGDF_destroy();
+        return Tests_result();
+    }
+
+    // Файлы с диска. Сжатый файл без явной распаковки - это байты кадра:
+    check_same(PACK_DIR "random.bin", g_Random, DATA_SIZE);
+    check_same(PACK_DIR "fake.bin", g_Fake, sizeof(g_Fake));
+    size_t frame_size = 0;
+    unsigned char *frame = Files_load_bin(PACK_DIR "text.lz", "rb", &frame_size);
+    TEST_CHECK(frame && frame_size < DATA_SIZE && memcmp(frame, LZ_FRAME_MAGIC, 4) == 0, "Files_load_bin unpacked an LZ file.");
+    if (frame) {
+        check_same(PACK_DIR "text.lz", frame, frame_size);
+        mm_free(frame);
+    }
+    check_lz(PACK_DIR "text.lz", g_Text, DATA_SIZE);
+    TEST_CHECK(Files_load_bin_lz(PACK_DIR "fake.bin", NULL) == NULL, "Files_load_bin_lz accepted a broken frame.");
+    TEST_CHECK(Files_load_bin_lz(PACK_DIR "random.bin", NULL) == NULL, "Files_load_bin_lz accepted a plain file.");
+
+    // Те же файлы из сжатого пакета (пути начинаются с имени папки):
+    bool mounted = Tests_build_pack(PACK_DIR, PACK_PATH, true) && VFS_mount(PACK_PATH);
+    TEST_CHECK(mounted, "Failed to build or mount the pack.");
+    if (mounted) {
+        check_same("data/random.bin", g_Random, DATA_SIZE);
+        check_same("data/text.txt", g_Text, DATA_SIZE);
+        check_same("data/fake.bin", g_Fake, sizeof(g_Fake));
+        check_lz("data/text.lz", g_Text, DATA_SIZE);
+        TEST_CHECK(Files_load_bin_lz("data/random.bin", NULL) == NULL, "Files_load_bin_lz accepted a plain packed file.");
+        VFS_unmount_all();
+    }
+
+    CGDF_destroy();
+    return Tests_result();
+}
@@ -0,0 +1,66 @@
+//
+// test_framepacer.c - Проверка сроков FramePacer: первый кадр, сброс и смена частоты занимают период, а не работа + период.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define PERIOD_MS 20.0  // 50 кадров в секунду.
+#define WORK_MS   12.0  // Работа кадра до FramePacer_frame.
+#define SLACK_MS  6.0   // Допуск на опоздание пробуждения (срок абсолютный, поэтому за поздним кадром идёт короткий).
+
+
+// Кадр: работа WORK_MS и ожидание срока. Возвращает длительность кадра в мс:
+static double frame(FramePacer *pacer, double fps) {
+    Time_delay(WORK_MS / 1e3);
+    FramePacer_frame(pacer, fps);
+    return Time_ns_to_ms(pacer->samples[(pacer->samples_index + FRAMEPACER_HISTORY - 1) % FRAMEPACER_HISTORY]);
+}
+
+// Длительность кадра в пределах period +- SLACK_MS (без исправления первый кадр длится period + WORK_MS):
+static bool in_period(double ms, double period_ms) {
+    return ms >= period_ms - SLACK_MS && ms <= period_ms + SLACK_MS;
+}
+
+
+int main(void) {
+    CGDF_init();
+    FramePacer *pacer = FramePacer_create();
+    double fps = 1e3 / PERIOD_MS;
+
+    // Первый кадр:
+    double ms = frame(pacer, fps);
+    TEST_CHECK(in_period(ms, PERIOD_MS), "First frame took %.3f ms, expected %.1f.", ms, PERIOD_MS);
+
+    // Обычные кадры (сроки абсолютные, поэтому сумма кадров не копит ошибку):
+    double sum = 0.0;
+    for (int i = 0; i < 5; i++) sum += frame(pacer, fps);
+    TEST_CHECK(in_period(sum, PERIOD_MS * 5.0), "5 frames took %.3f ms, expected %.1f.", sum, PERIOD_MS * 5.0);
+
+    // После сброса (долгая загрузка не считается кадром, следующий кадр - ровно период от сброса):
+    Time_sleep(0.05);
+    FramePacer_reset(pacer);
+    ms = frame(pacer, fps);
+    TEST_CHECK(in_period(ms, PERIOD_MS), "Frame after reset took %.3f ms, expected %.1f.", ms, PERIOD_MS);
+
+    // Смена частоты:
+    ms = frame(pacer, fps / 2.0);
+    TEST_CHECK(in_period(ms, PERIOD_MS * 2.0), "Frame after a rate change took %.3f ms, expected %.1f.", ms, PERIOD_MS * 2.0);
+
+    // Работа дольше периода: срок не раньше текущего момента, кадр не ждёт:
+    FramePacer_reset(pacer);
+    Time_delay(PERIOD_MS * 1.5 / 1e3);
+    FramePacer_frame(pacer, fps);
+    ms = Time_ns_to_ms(pacer->samples[(pacer->samples_index + FRAMEPACER_HISTORY - 1) % FRAMEPACER_HISTORY]);
+    TEST_CHECK(in_period(ms, PERIOD_MS * 1.5), "Long frame after reset took %.3f ms, expected %.1f.", ms, PERIOD_MS * 1.5);
+    FramePacerStats stats;
+    FramePacer_get_stats(pacer, &stats);
+    TEST_CHECK(stats.missed == 0, "%llu frames counted as missed.", (unsigned long long)stats.missed);
+
+    FramePacer_destroy(&pacer);
+    CGDF_destroy();
+    return Tests_result();
+}
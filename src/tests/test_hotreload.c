@@ -0,0 +1,147 @@
+//
+// test_hotreload.c - Проверка HotReload: изменение файла на диске доходит до ресурсов через HotReload_poll.
+//
+// Два ресурса следят за одним файлом через разные написания пути: файл должен импортироваться один раз и
+// примениться к обоим. Проверяются запись на месте, сохранение через переименование и снятие наблюдения
+// (в том числе из apply другого ресурса).
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define DIR_PATH   TESTS_TMP_DIR "hotreload/"
+#define FILE_PATH  DIR_PATH "asset.txt"
+#define TEMP_PATH  DIR_PATH ".asset.tmp"
+#define WRITES     10
+#define TIMEOUT_MS 3000.0
+
+
+// Ресурс: последнее применённое содержимое:
+typedef struct Asset {
+    char text[64];
+    int applies;
+} Asset;
+
+
+// Счётчики обработчика:
+static atomic_int g_Imports;
+static int g_Applies;
+static Asset *g_UnwatchInApply;  // Ресурс, который снимается с наблюдения из apply (или NULL).
+
+
+// Импорт (фоновый поток):
+static void* import_text(const char *path) {
+    atomic_fetch_add(&g_Imports, 1);
+    return Files_load(path, "r");
+}
+
+// Применение (главный поток):
+static bool apply_text(void *target, void *data, intptr_t tag) {
+    (void)tag;
+    Asset *asset = (Asset*)target;
+    snprintf(asset->text, sizeof(asset->text), "%s", (const char*)data);
+    asset->applies++;
+    g_Applies++;
+    if (g_UnwatchInApply && g_UnwatchInApply != asset) HotReload_unwatch(g_UnwatchInApply);
+    return true;
+}
+
+// Освобождение данных импорта:
+static void release_text(void *data) {
+    mm_free(data);
+}
+
+static const HotReloadHandler g_TextHandler = { "text", import_text, apply_text, release_text };
+
+
+// Записать файл:
+static void write_file(const char *path, const char *text) {
+    TEST_CHECK(Files_save(path, text, "w"), "Failed to write %s.", path);
+}
+
+// Вызывать HotReload_poll пока оба ресурса не получат текст. Возвращает время в мс (-1 - не дождались):
+static double wait_text(Asset *a, Asset *b, const char *text) {
+    double start = Tests_now_ms();
+    while (strcmp(a->text, text) != 0 || strcmp(b->text, text) != 0) {
+        if (Tests_now_ms() - start > TIMEOUT_MS) return -1.0;
+        HotReload_poll();
+        Time_sleep(0.0002);
+    }
+    return Tests_now_ms() - start;
+}
+
+
+int main(void) {
+    CGDF_init();
+    HotReload_init();
+    printf("Backend: %s\n", HotReload_is_inotify() ? "inotify" : "polling");
+    TEST_CHECK(Tests_make_dir(TESTS_TMP_DIR) && Tests_make_dir(DIR_PATH), "Failed to create %s.", DIR_PATH);
+    write_file(FILE_PATH, "v0");
+
+    // Один файл через разные написания пути:
+    Asset a = { "v0", 0 }, b = { "v0", 0 };
+    TEST_CHECK(HotReload_watch(DIR_PATH "./sub/../asset.txt", &g_TextHandler, &a, 0), "Failed to watch the file.");
+    TEST_CHECK(HotReload_watch(FILE_PATH, &g_TextHandler, &b, 0), "Failed to watch the file.");
+    TEST_CHECK(HotReload_get_watch_count() == 2, "Watch count is %zu, expected 2.", HotReload_get_watch_count());
+
+    // Запись на месте:
+    double worst = 0.0, sum = 0.0;
+    int missed = 0;
+    for (int i = 1; i <= WRITES; i++) {
+        char text[16];
+        snprintf(text, sizeof(text), "v%d", i);
+        Time_sleep(0.02);
+        write_file(FILE_PATH, text);
+        double ms = wait_text(&a, &b, text);
+        if (ms < 0.0) { missed++; continue; }
+        sum += ms;
+        if (ms > worst) worst = ms;
+    }
+    TEST_CHECK(missed == 0, "%d of %d writes were not reloaded within %.0f ms.", missed, WRITES, TIMEOUT_MS);
+    HotReload_wait_imports();
+    HotReload_poll();
+    int imports = atomic_load(&g_Imports);
+    TEST_CHECK(g_Applies == imports * 2, "%d imports applied %d times: the shared file was not imported once.", imports, g_Applies);
+    printf("In-place writes: %d imports for %d writes, average %.2f ms, worst %.2f ms\n",
+           imports, WRITES, WRITES > missed ? sum / (WRITES - missed) : 0.0, worst);
+
+    // Сохранение через переименование (так сохраняют многие редакторы):
+    Time_sleep(0.02);
+    write_file(TEMP_PATH, "renamed");
+    TEST_CHECK(rename(TEMP_PATH, FILE_PATH) == 0, "Failed to rename the temporary file.");
+    double ms = wait_text(&a, &b, "renamed");
+    TEST_CHECK(ms >= 0.0, "Rename save was not reloaded.");
+    printf("Rename save: %.2f ms\n", ms);
+
+    // apply первого ресурса снимает наблюдение со второго: второй уже не получает данные:
+    g_UnwatchInApply = &b;
+    Time_sleep(0.02);
+    write_file(FILE_PATH, "unwatched");
+    double start = Tests_now_ms();
+    while (strcmp(a.text, "unwatched") != 0 && Tests_now_ms() - start < TIMEOUT_MS) {
+        HotReload_poll();
+        Time_sleep(0.0002);
+    }
+    g_UnwatchInApply = NULL;
+    TEST_CHECK(strcmp(a.text, "unwatched") == 0 && strcmp(b.text, "renamed") == 0,
+               "Unwatch from apply: \"%s\" and \"%s\".", a.text, b.text);
+    TEST_CHECK(HotReload_get_watch_count() == 1, "Watch count is %zu after unwatch from apply.", HotReload_get_watch_count());
+
+    // После снятия наблюдения изменения не применяются:
+    HotReload_unwatch(&a);
+    HotReload_unwatch(&b);
+    TEST_CHECK(HotReload_get_watch_count() == 0, "Watch count is %zu after unwatch.", HotReload_get_watch_count());
+    int applies = g_Applies;
+    write_file(FILE_PATH, "ignored");
+    Time_sleep(HOTRELOAD_POLL_MS * 2 / 1e3);
+    HotReload_wait_imports();
+    HotReload_poll();
+    TEST_CHECK(g_Applies == applies && strcmp(a.text, "unwatched") == 0, "A change was applied after unwatch.");
+
+    HotReload_destroy();
+    CGDF_destroy();
+    return Tests_result();
+}
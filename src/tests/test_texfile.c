@@ -0,0 +1,147 @@
+//
+// test_texfile.c - Проверка файла текстуры: TexFile_save -> TexFile_open.
+//
+// Каждый уровень после открытия должен совпадать с сохранённым байт в байт и лежать со смещения, кратного
+// TEXFILE_ALIGN. Обрезанный файл должен отвергаться. В конце сравнивается время открытия файла текстуры
+// (отображение в память и проход по всем уровням) и распаковки того же PNG.
+//
+
+
+// Подключаем:
+#include "tests.h"
+
+
+// Определения:
+#define DIR_PATH     TESTS_TMP_DIR "texfile/"
+#define FIXTURE_PATH "data/textures/gradient_uv_checker.png"
+#define REPEATS      5  // Берём лучший из замеров.
+
+
+// Совпадают ли уровни открытого файла с сохранёнными и выровнены ли они:
+static void check_levels(const char *name, const TexFile *file, const TexFileLevel *levels, int count) {
+    TEST_CHECK(file->count == count, "%s: %d levels, expected %d.", name, file->count, count);
+    for (int i = 0; i < count && i < file->count; i++) {
+        const TexFileLevel *level = &file->levels[i];
+        size_t offset = (size_t)((const unsigned char*)level->data - (const unsigned char*)file->file.data);
+        TEST_CHECK(level->width == levels[i].width && level->height == levels[i].height && level->size == levels[i].size,
+                   "%s: level %d is %dx%d (%zu bytes).", name, i, level->width, level->height, level->size);
+        TEST_CHECK(level->size == levels[i].size && memcmp(level->data, levels[i].data, level->size) == 0,
+                   "%s: level %d differs.", name, i);
+        TEST_CHECK(offset % TEXFILE_ALIGN == 0, "%s: level %d at offset %zu.", name, i, offset);
+    }
+}
+
+// Цепочка уровней с нечётными размерами и случайными байтами:
+static void check_random_levels(TexFileFormat format) {
+    char path[256];
+    snprintf(path, sizeof(path), DIR_PATH "random-%s" TEXFILE_EXTENSION, TexFileFormat_get_name(format));
+    TexFileLevel levels[MIPMAP_MAX_LEVELS];
+    int count = 0;
+    for (int w = 37, h = 23; ; w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1) {
+        size_t size = TexFileFormat_get_size(format, w, h);
+        uint8_t *data = (uint8_t*)mm_alloc(size);
+        for (size_t i = 0; i < size; i++) data[i] = (uint8_t)rand();
+        levels[count++] = (TexFileLevel){ w, h, size, data };
+        if (w == 1 && h == 1) break;
+    }
+
+    TexFile file;
+    TEST_CHECK(TexFile_save(path, format, false, levels, count), "%s: TexFile_save failed.", path);
+    if (TexFile_open(path, &file)) {
+        TEST_CHECK(file.format == format && !file.srgb, "%s: wrong format or sRGB flag.", path);
+        check_levels(path, &file, levels, count);
+        TexFile_close(&file);
+    } else TEST_CHECK(false, "TexFile_open of %s failed.", path);
+    for (int i = 0; i < count; i++) mm_free((void*)levels[i].data);
+}
+
+// Обрезанный файл отвергается (обрезка в заголовке, в таблице уровней и в последнем уровне):
+static void check_truncated(const char *path) {
+    size_t size = 0;
+    unsigned char *data = Files_load_bin(path, "rb", &size);
+    TEST_CHECK(data && size > 64, "%s: cannot read the file back.", path);
+    if (!data) return;
+    const size_t cuts[] = { 8, 40, size - 1 };
+    for (size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); i++) {
+        Files_save_bin(DIR_PATH "truncated" TEXFILE_EXTENSION, data, cuts[i], "wb");
+        TexFile file;
+        TEST_CHECK(!TexFile_open(DIR_PATH "truncated" TEXFILE_EXTENSION, &file), "File cut to %zu of %zu bytes was accepted.",
+                   cuts[i], size);
+    }
+    mm_free(data);
+}
+
+
+int main(void) {
+    CGDF_init();
+    srand(5);
+    TEST_CHECK(Tests_make_dir(TESTS_TMP_DIR) && Tests_make_dir(DIR_PATH), "Failed to create %s.", DIR_PATH);
+
+    // Несжатые форматы с нечётными размерами уровней:
+    check_random_levels(TEXFILE_FORMAT_R8);
+    check_random_levels(TEXFILE_FORMAT_RGB8);
+    check_random_levels(TEXFILE_FORMAT_RGBA16F);
+    check_random_levels(TEXFILE_FORMAT_RGB32F);
+
+    // Мипмапы настоящей текстуры, без сжатия и в BC7:
+    Pixmap *pixmap = Pixmap_load(FIXTURE_PATH, 4);
+    MipChain *chain = Pixmap_generate_mips(pixmap, NULL);
+    TexFileLevel levels[MIPMAP_MAX_LEVELS];
+    for (int i = 0; i < chain->count; i++) {
+        Pixmap *level = chain->levels[i];
+        levels[i] = (TexFileLevel){ level->width, level->height, Pixmap_get_size(level), level->data };
+    }
+    const char *mips_path = DIR_PATH "mips" TEXFILE_EXTENSION;
+    TexFile file;
+    TEST_CHECK(TexFile_save_mips(mips_path, chain, true), "TexFile_save_mips failed.");
+    if (TexFile_open(mips_path, &file)) {
+        TEST_CHECK(file.format == TEXFILE_FORMAT_RGBA8 && file.srgb, "Mips: wrong format or sRGB flag.");
+        check_levels(mips_path, &file, levels, chain->count);
+        TexFile_close(&file);
+    } else TEST_CHECK(false, "TexFile_open of %s failed.", mips_path);
+
+    const char *bc7_path = DIR_PATH "bc7" TEXFILE_EXTENSION;
+    BCSettings settings = { BC_FORMAT_BC7, BC_QUALITY_FAST, 0 };
+    BCImage *images[MIPMAP_MAX_LEVELS];
+    for (int i = 0; i < chain->count; i++) {
+        images[i] = BCImage_encode(chain->levels[i], &settings);
+        levels[i] = (TexFileLevel){ images[i]->width, images[i]->height, images[i]->size, images[i]->data };
+    }
+    TEST_CHECK(TexFile_save_compressed(bc7_path, chain, &settings, false), "TexFile_save_compressed failed.");
+    if (TexFile_open(bc7_path, &file)) {
+        TEST_CHECK(file.format == TEXFILE_FORMAT_BC7, "BC7: wrong format %s.", TexFileFormat_get_name(file.format));
+        check_levels(bc7_path, &file, levels, chain->count);
+        TexFile_close(&file);
+    } else TEST_CHECK(false, "TexFile_open of %s failed.", bc7_path);
+    for (int i = 0; i < chain->count; i++) BCImage_destroy(&images[i]);
+
+    check_truncated(mips_path);
+
+    // Открытие файла текстуры со всеми уровнями против распаковки PNG (только нулевой уровень):
+    double map_ms = 1e30, png_ms = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        double t0 = Tests_now_ms();
+        uint64_t sum = 0;
+        if (TexFile_open(mips_path, &file)) {
+            for (int i = 0; i < file.count; i++) {
+                const uint8_t *data = (const uint8_t*)file.levels[i].data;
+                for (size_t j = 0; j < file.levels[i].size; j += 64) sum += data[j];  // Читаем каждую строку кэша.
+            }
+            TexFile_close(&file);
+        }
+        double t1 = Tests_now_ms();
+        Pixmap *decoded = Pixmap_load(FIXTURE_PATH, 4);
+        double t2 = Tests_now_ms();
+        Pixmap_destroy(&decoded);
+        if (t1 - t0 < map_ms) map_ms = t1 - t0;
+        if (t2 - t1 < png_ms) png_ms = t2 - t1;
+        TEST_CHECK(sum > 0, "Mapped levels are empty.");
+    }
+    printf("%dx%d, %d levels, best of %d, ms: TexFile_open + read %.3f, PNG decode %.3f (%.1fx)\n",
+           pixmap->width, pixmap->height, chain->count, REPEATS, map_ms, png_ms, png_ms / map_ms);
+
+    MipChain_destroy(&chain);
+    Pixmap_destroy(&pixmap);
+    CGDF_destroy();
+    return Tests_result();
+}
@@ -0,0 +1,221 @@
+//
+// test_texstream.c - Проверка решений TexStream через обработчик, который только записывает вызовы.
+//
+// Обработчик следит за уровнями каждой текстуры: грузить можно только следующий более точный уровень,
+// выгружать - только самый точный и после того, как видеокарта перестала из него читать, а хвост
+// маленьких уровней не выгружается никогда. Проверяются бюджет байт за кадр, порядок от грубых уровней
+// к точным, бюджет видеопамяти с выгрузкой давно не запрошенных текстур и занятый обработчик.
+//
+// Исходники: src/cgdf/graphics/core/texstream.c
+//
+
+
+// Подключаем:
+#include "tests.h"
+#include <cgdf/graphics/core/texstream.h>
+
+
+// Определения:
+#define TEX_COUNT     40
+#define TEX_SIZE      1024
+#define SET_SIZE      10                  // Текстур в одном наборе запросов.
+#define BUDGET        (64 * 1024 * 1024)  // Два набора по 10 текстур 1024x1024 RGBA не помещаются.
+#define UPLOAD_BUDGET (2 * 1024 * 1024)
+#define RESIDENT_SIZE 64
+#define MAX_FRAMES    200
+
+
+// Записывающий обработчик:
+typedef struct Recorder {
+    int creates, destroys, uploads, evicts;
+    int bad_uploads;    // Загрузки не следующего уровня.
+    int bad_evicts;     // Выгрузки не самого точного уровня, уровня хвоста или уровня, из которого читают.
+    int bad_levels;     // set_levels с незагруженными уровнями.
+    int bad_order;      // За кадр загружен более точный уровень раньше более грубого.
+    int last_extent;    // Размер последнего загруженного за кадр уровня.
+    bool busy;          // Отказывать в загрузке.
+} Recorder;
+
+// Текстура обработчика:
+typedef struct RecordedTexture {
+    Texture texture;
+    int count;                           // Уровней в файле.
+    int tail;                            // Первый уровень хвоста (не больше RESIDENT_SIZE).
+    int base;                            // Самый точный уровень, из которого читает видеокарта.
+    bool loaded[MIPMAP_MAX_LEVELS];      // Загруженные уровни.
+} RecordedTexture;
+
+
+// Данные уровней (обработчик их не читает):
+static uint8_t g_Dummy[1];
+
+
+static Texture* rec_create(void *user, const TexFile *file) {
+    Recorder *rec = (Recorder*)user;
+    RecordedTexture *tex = (RecordedTexture*)mm_calloc(1, sizeof(RecordedTexture));
+    tex->count = file->count;
+    tex->base = file->count - 1;
+    tex->tail = file->count - 1;
+    while (tex->tail > 0 && file->levels[tex->tail - 1].width <= RESIDENT_SIZE) tex->tail--;
+    rec->last_extent = 0;  // Хвост новой текстуры грузится сразу, со своего самого грубого уровня.
+    rec->creates++;
+    return &tex->texture;
+}
+
+static size_t rec_upload(void *user, Texture *texture, const TexFile *file, int level) {
+    Recorder *rec = (Recorder*)user;
+    RecordedTexture *tex = (RecordedTexture*)texture;
+    if (rec->busy) return 0;
+    bool next = !tex->loaded[level] && (level == tex->count - 1 || tex->loaded[level + 1]);
+    rec->bad_uploads += !next;
+    if (file->levels[level].width < rec->last_extent) rec->bad_order++;
+    rec->last_extent = file->levels[level].width;
+    tex->loaded[level] = true;
+    rec->uploads++;
+    return file->levels[level].size;
+}
+
+static void rec_evict(void *user, Texture *texture, int level) {
+    Recorder *rec = (Recorder*)user;
+    RecordedTexture *tex = (RecordedTexture*)texture;
+    bool finest = tex->loaded[level] && (level == 0 || !tex->loaded[level - 1]);
+    rec->bad_evicts += !finest || level >= tex->tail || level >= tex->base;
+    tex->loaded[level] = false;
+    rec->evicts++;
+}
+
+static void rec_set_levels(void *user, Texture *texture, int base_level, int max_level) {
+    Recorder *rec = (Recorder*)user;
+    RecordedTexture *tex = (RecordedTexture*)texture;
+    tex->base = base_level;
+    bool any = false;
+    for (int i = base_level; i <= max_level; i++) any |= tex->loaded[i];
+    for (int i = base_level; any && i <= max_level; i++) rec->bad_levels += !tex->loaded[i];
+}
+
+static void rec_destroy(void *user, Texture *texture) {
+    ((Recorder*)user)->destroys++;
+    mm_free(texture);
+}
+
+
+// Файл текстуры RGBA8 с полной цепочкой уровней:
+static TexFile make_file(int size) {
+    TexFile file = { 0 };
+    file.format = TEXFILE_FORMAT_RGBA8;
+    file.width = file.height = size;
+    for (int w = size; ; w /= 2) {
+        file.levels[file.count++] = (TexFileLevel){ w, w, (size_t)w * w * 4, g_Dummy };
+        if (w == 1) break;
+    }
+    return file;
+}
+
+// Обработать кадр:
+static void update(TexStream *stream, Recorder *rec) {
+    rec->last_extent = 0;
+    TexStream_update(stream);
+}
+
+// Запрашивать уровень 0 у текстур [first, first + count) пока всё не догрузится. Возвращает число кадров:
+static int stream_set(TexStream *stream, StreamTexture **textures, int first, int count, Recorder *rec) {
+    for (int frame = 1; frame <= MAX_FRAMES; frame++) {
+        for (int i = first; i < first + count; i++) TexStream_request(textures[i], 0);
+        update(stream, rec);
+        TexStreamStats stats = TexStream_get_stats(stream);
+        TEST_CHECK(stats.frame_bytes <= UPLOAD_BUDGET || stats.frame_uploads == 1,
+                   "Frame %d: %zu bytes in %zu uploads over the per-frame budget.", frame, stats.frame_bytes, stats.frame_uploads);
+        TEST_CHECK(stats.resident_bytes <= BUDGET, "Frame %d: %zu resident bytes over the budget.", frame, stats.resident_bytes);
+        if (stats.pending == 0) return frame;
+    }
+    return -1;
+}
+
+// Сколько текстур [first, first + count) загружены до уровня 0:
+static int count_full(StreamTexture **textures, int first, int count) {
+    int full = 0;
+    for (int i = first; i < first + count; i++) full += TexStream_get_resident_level(textures[i]) == 0;
+    return full;
+}
+
+
+int main(void) {
+    CGDF_init();
+    Recorder rec = { 0 };
+    TexStreamBackend backend = { &rec, rec_create, rec_upload, rec_evict, rec_set_levels, rec_destroy };
+    TexStreamSettings settings = { BUDGET, UPLOAD_BUDGET, RESIDENT_SIZE };
+    TexStream *stream = TexStream_create(&backend, &settings);
+
+    // Хвост маленьких уровней грузится сразу:
+    StreamTexture *textures[TEX_COUNT];
+    for (int i = 0; i < TEX_COUNT; i++) {
+        TexFile file = make_file(TEX_SIZE);
+        textures[i] = TexStream_add(stream, &file);
+    }
+    RecordedTexture *first = (RecordedTexture*)TexStream_get_texture(textures[0]);
+    int tail = first->tail;
+    size_t tails = 0;
+    for (int i = tail; i < first->count; i++) tails += (size_t)TEX_COUNT * ((TEX_SIZE >> i) * (TEX_SIZE >> i) * 4);
+    TEST_CHECK(TexStream_get_resident_level(textures[0]) == tail, "Resident level %d after add, expected the tail level %d.",
+               TexStream_get_resident_level(textures[0]), tail);
+    TEST_CHECK(rec.uploads == TEX_COUNT * (first->count - tail), "%d tail uploads.", rec.uploads);
+
+    // Один набор: догружается от грубых уровней к точным в пределах бюджета кадра:
+    int frames = stream_set(stream, textures, 0, SET_SIZE, &rec);
+    TEST_CHECK(frames > 0 && count_full(textures, 0, SET_SIZE) == SET_SIZE, "First set: not fully loaded (%d frames).", frames);
+    TEST_CHECK(rec.evicts == 0, "First set fits the budget but %d levels were evicted.", rec.evicts);
+    printf("First set: %d frames\n", frames);
+
+    // Второй набор: бюджета на оба нет, выгружаются уровни давно не запрошенного первого набора:
+    frames = stream_set(stream, textures, SET_SIZE, SET_SIZE, &rec);
+    TEST_CHECK(frames > 0 && count_full(textures, SET_SIZE, SET_SIZE) == SET_SIZE, "Second set: not fully loaded (%d frames).", frames);
+    TEST_CHECK(rec.evicts > 0 && count_full(textures, 0, SET_SIZE) < SET_SIZE, "The old set kept all its levels.");
+    TexStreamStats stats = TexStream_get_stats(stream);
+    printf("Second set: %d frames, %zu evictions, %.1f MB resident\n", frames, stats.total_evictions, stats.resident_bytes / 1048576.0);
+
+    // По расстоянию: чем дальше, тем грубее уровень:
+    for (int i = 20; i < 30; i++) TexStream_request_distance(textures[i], (float)(i - 19), TEX_SIZE);
+    update(stream, &rec);
+    for (int i = 21; i < 30; i++) {
+        TEST_CHECK(TexStream_get_wanted_level(textures[i]) >= TexStream_get_wanted_level(textures[i - 1]),
+                   "Distance %d wants a finer level than distance %d.", i - 19, i - 20);
+    }
+    TEST_CHECK(TexStream_get_wanted_level(textures[20]) == 0, "Distance 1 wants level %d.", TexStream_get_wanted_level(textures[20]));
+
+    // Бюджет меньше хвостов: выгружается всё, кроме хвостов:
+    TexStream_set_budget(stream, 1, UPLOAD_BUDGET);
+    update(stream, &rec);
+    stats = TexStream_get_stats(stream);
+    TEST_CHECK(stats.resident_bytes == tails, "%zu bytes resident with a tiny budget, tails take %zu.", stats.resident_bytes, tails);
+    for (int i = 0; i < TEX_COUNT; i++) {
+        TEST_CHECK(TexStream_get_resident_level(textures[i]) == tail, "Texture %d: level %d, expected the tail.",
+                   i, TexStream_get_resident_level(textures[i]));
+    }
+
+    // Занятый обработчик: загрузок нет, после освобождения загрузка продолжается:
+    TexStream_set_budget(stream, BUDGET, UPLOAD_BUDGET);
+    rec.busy = true;
+    int uploads = rec.uploads;
+    for (int i = 30; i < 35; i++) TexStream_request(textures[i], 0);
+    update(stream, &rec);
+    TEST_CHECK(rec.uploads == uploads && TexStream_get_stats(stream).pending > 0, "Uploads while the backend is busy.");
+    rec.busy = false;
+    frames = stream_set(stream, textures, 30, 5, &rec);
+    TEST_CHECK(frames > 0 && count_full(textures, 30, 5) == 5, "Not loaded after the backend became free.");
+
+    // Инварианты обработчика за весь тест:
+    TEST_CHECK(rec.bad_uploads == 0, "%d uploads of a level that is not the next one.", rec.bad_uploads);
+    TEST_CHECK(rec.bad_evicts == 0, "%d evictions of a tail, visible or not finest level.", rec.bad_evicts);
+    TEST_CHECK(rec.bad_levels == 0, "%d visible levels that are not loaded.", rec.bad_levels);
+    TEST_CHECK(rec.bad_order == 0, "%d finer levels uploaded before coarser ones in a frame.", rec.bad_order);
+
+    // Удаление и уничтожение освобождают текстуры обработчика:
+    StreamTexture *removed = textures[5];
+    TexStream_remove(stream, &removed);
+    TEST_CHECK(removed == NULL && rec.destroys == 1, "TexStream_remove did not destroy the texture.");
+    TexStream_destroy(&stream);
+    TEST_CHECK(rec.creates == TEX_COUNT && rec.destroys == TEX_COUNT, "%d textures created, %d destroyed.", rec.creates, rec.destroys);
+
+    CGDF_destroy();
+    return Tests_result();
+}
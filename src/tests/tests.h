@@ -0,0 +1,70 @@
+//
+// tests.h - Общие помощники тестов и замеров.
+//
+// Каждый файл в "src/tests/" - отдельная программа: test_*.c проверяют поведение, bench_*.c печатают
+// замеры (и тоже проверяют результат). Сборка и запуск: "build/tools/tests.py". Программа провалена,
+// если вернула не 0.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <cgdf/cgdf.h>
+#if defined(_WIN32) || defined(_WIN64)
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+
+// Определения:
+#define TESTS_TMP_DIR "build/tests/"  // Папка для временных файлов тестов (программы запускаются из корня проекта).
+
+
+// Количество проваленных проверок:
+static int g_TestsFailed = 0;
+
+
+// Проверить условие (при провале печатается место и сообщение):
+#define TEST_CHECK(cond, ...) do {                                \
+    if (!(cond)) {                                                \
+        g_TestsFailed++;                                          \
+        printf("[FAIL] %s:%d: ", __FILE__, __LINE__);             \
+        printf(__VA_ARGS__);                                      \
+        printf("\n");                                             \
+    }                                                             \
+} while (0)
+
+
+// Текущее время в миллисекундах (монотонные часы):
+static inline double Tests_now_ms(void) {
+    return Time_ns_to_ms(Time_get_ns());
+}
+
+// Результат программы для main:
+static inline int Tests_result(void) {
+    if (g_TestsFailed > 0) printf("Failed checks: %d\n", g_TestsFailed);
+    return g_TestsFailed > 0 ? 1 : 0;
+}
+
+// Создать папку (если её нет):
+static inline bool Tests_make_dir(const char *path) {
+    #if defined(_WIN32) || defined(_WIN64)
+        return _mkdir(path) == 0 || errno == EEXIST;
+    #else
+        return mkdir(path, 0755) == 0 || errno == EEXIST;
+    #endif
+}
+
+// Собрать пакет из папки скриптом "build/tools/pack.py" (compress - сжимать файлы):
+static inline bool Tests_build_pack(const char *folder, const char *pack_path, bool compress) {
+    char command[1024];
+    #if defined(_WIN32) || defined(_WIN64)
+        const char *python = "python";
+    #else
+        const char *python = "python3";
+    #endif
+    snprintf(command, sizeof(command), "%s build/tools/pack.py %s\"%s\" \"%s\"", python, compress ? "-c " : "", folder, pack_path);
+    return system(command) == 0;
+}